@@ -26,6 +26,9 @@ AtomicCounters::setupAtomicCounters()
     // Allocate the memory for input array
     input = (cl_uint*)malloc(length * sizeof(cl_uint));
     CHECK_ALLOCATION(input, "Allocation failed(input)");
+    // Indices of the occurrences found by the host compaction
+    hostIndices = (cl_uint*)malloc(length * sizeof(cl_uint));
+    CHECK_ALLOCATION(hostIndices, "Allocation failed(hostIndices)");
     // Set the input data
     value = 2;
     for(cl_uint i = 0; i < length; ++i)
@@ -261,6 +264,17 @@ AtomicCounters::initialize()
     numLoops->_value = &iterations;
     sampleArgs->AddOption(numLoops);
     delete numLoops;
+
+    Option* numThreads = new Option;
+    CHECK_ALLOCATION(numThreads, "Allocation failed(numThreads)");
+    numThreads->_sVersion = "";
+    numThreads->_lVersion = "threads";
+    numThreads->_description =
+        "Number of host threads of the stream compaction (0 uses every core)";
+    numThreads->_type = CA_ARG_INT;
+    numThreads->_value = &cpuThreads;
+    sampleArgs->AddOption(numThreads);
+    delete numThreads;
     return SDK_SUCCESS;
 }
 
@@ -273,6 +287,7 @@ AtomicCounters::setup()
 void
 AtomicCounters::cpuRefImplementation()
 {
+    refOut = 0;
     for(cl_uint i = 0; i < length; ++i)
         if(value == input[i])
         {
@@ -287,8 +302,15 @@ int AtomicCounters::verifyResults()
         // Calculate the reference output
         cpuRefImplementation();
         // Compare the results and see if they match
+        // The compacted indices must be exactly the occurrences, in order
+        bool hostResult = (refOut == hostCount) && (refOut == hostSelected);
+        for(cl_uint i = 0; hostResult && i < hostSelected; ++i)
+        {
+            hostResult = (input[hostIndices[i]] == value) &&
+                         (i == 0 || hostIndices[i - 1] < hostIndices[i]);
+        }
         // if(refOut == counterOut && refOut == globalOut)
-        if(refOut == globalOut)
+        if(refOut == globalOut && hostResult)
         {
             std::cout << "Passed!\n" << std::endl;
             return SDK_SUCCESS;
@@ -551,6 +573,40 @@ AtomicCounters::run()
     {
         printArray<cl_uint>("Global atomics Output", &globalOut, 1, 1);
     }
+    return runHostCompaction();
+}
+
+int
+AtomicCounters::runHostCompaction()
+{
+    compactor.setPredicate(COMPACT_EQUAL, value);
+    compactor.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+    for(int i = 0; i < iterations; i++)
+    {
+        hostCount = compactor.count(input, length);
+    }
+    sampleTimer->stopTimer(timer);
+    hostCountTime = sampleTimer->readTimer(timer) / iterations;
+
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+    for(int i = 0; i < iterations; i++)
+    {
+        hostSelected = compactor.selectIndices(input, length, hostIndices);
+    }
+    sampleTimer->stopTimer(timer);
+    hostSelectTime = sampleTimer->readTimer(timer) / iterations;
+
+    if(!sampleArgs->quiet)
+    {
+        printArray<cl_uint>("Host count Output", &hostCount, 1, 1);
+        printArray<cl_uint>("Host selected indices", hostIndices,
+                            std::min(hostSelected, (cl_uint)256), 1);
+    }
     return SDK_SUCCESS;
 }
 
@@ -566,6 +622,16 @@ AtomicCounters::printStats()
         stats[2]  = toString(kTimeAtomCounter, std::dec);
         stats[3]  = toString(kTimeAtomGlobal, std::dec);
         printStatistics(strArray, stats, 4);
+
+        // Host count and compaction read the input once, report input GB/s
+        double inputBytes = (double)length * sizeof(cl_uint);
+        std::string hostStrArray[4] = {"HostCount(sec)", "HostCount(GB/s)", "HostCompaction(sec)", "HostCompaction(GB/s)"};
+        std::string hostStats[4];
+        hostStats[0]  = toString(hostCountTime, std::dec);
+        hostStats[1]  = toString(hostCountTime > 0 ? inputBytes / hostCountTime / 1e9 : 0, std::dec);
+        hostStats[2]  = toString(hostSelectTime, std::dec);
+        hostStats[3]  = toString(hostSelectTime > 0 ? inputBytes / hostSelectTime / 1e9 : 0, std::dec);
+        printStatistics(hostStrArray, hostStats, 4);
     }
 }
 
@@ -591,6 +657,7 @@ AtomicCounters::cleanup()
     status = clReleaseContext(context);
     CHECK_OPENCL_ERROR(status, "clReleaseContext(context) failed.");
     free(input);
+    FREE(hostIndices);
     return SDK_SUCCESS;
 }
 
@@ -27,6 +27,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <string.h>
 
 #include "CLUtil.hpp"
+#include "StreamCompact.hpp"
 
 using namespace appsdk;
 
@@ -46,6 +47,13 @@ class AtomicCounters
         cl_uint counterOut;            /**< Output from Atomic Counter kernel */
         cl_uint globalOut;             /**< Output from Global Atomic kernel */
         cl_uint initValue;             /**< Initial value for counter */
+        StreamCompact compactor;       /**< Host SIMD stream compaction */
+        cl_uint *hostIndices;          /**< Indices selected by the host compaction */
+        cl_uint hostCount;             /**< Occurrences counted by the host */
+        cl_uint hostSelected;          /**< Occurrences selected by the host */
+        cl_double hostCountTime;       /**< time taken by the host count */
+        cl_double hostSelectTime;      /**< time taken by the host compaction */
+        int cpuThreads;                /**< Host threads, 0 uses every core */
         cl_context context;            /**< CL context */
         cl_device_id *devices;         /**< CL device list */
         cl_mem inBuf;                  /**< CL memory buffer */
@@ -80,6 +88,12 @@ class AtomicCounters
              counterOut(0),
              globalOut(0),
              initValue(0),
+             hostIndices(NULL),
+             hostCount(0),
+             hostSelected(0),
+             hostCountTime(0),
+             hostSelectTime(0),
+             cpuThreads(0),
              devices(NULL),
              counterWorkGroupSize(GROUP_SIZE),
              globalWorkGroupSize(GROUP_SIZE),
@@ -163,6 +177,11 @@ class AtomicCounters
          * @return SDK_SUCCESS on success and SDK_FAILURE on failure
          */
         int runGlobalAtomicKernel();
+        /**
+         * Counts and compacts the occurrences on the host
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int runHostCompaction();
 
         /**
          * Reference implementation to find
@@ -0,0 +1,335 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "StreamCompact.hpp"
+#include <algorithm>
+#include <emmintrin.h>
+
+/*
+ * Elements below which another thread does not pay off
+ */
+#define MIN_ELEMENTS_PER_THREAD 16384
+
+/*
+ * Lanes selected by every 4-bit compare mask, lowest lane first
+ */
+static const cl_uchar laneTable[16][4] =
+{
+    {0, 0, 0, 0}, {0, 0, 0, 0}, {1, 0, 0, 0}, {0, 1, 0, 0},
+    {2, 0, 0, 0}, {0, 2, 0, 0}, {1, 2, 0, 0}, {0, 1, 2, 0},
+    {3, 0, 0, 0}, {0, 3, 0, 0}, {1, 3, 0, 0}, {0, 1, 3, 0},
+    {2, 3, 0, 0}, {0, 2, 3, 0}, {1, 2, 3, 0}, {0, 1, 2, 3}
+};
+
+static const cl_uchar laneCount[16] =
+{
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+};
+
+/*
+ * Predicate of one element, PRED is a CompactPredicate
+ */
+template<int PRED>
+static inline bool selected(cl_uint x, cl_uint value)
+{
+    switch(PRED)
+    {
+    case COMPACT_EQUAL:
+        return x == value;
+    case COMPACT_NOT_EQUAL:
+        return x != value;
+    case COMPACT_LESS:
+        return x < value;
+    default:
+        return x >= value;
+    }
+}
+
+/*
+ * All ones in the lanes of x matching the predicate. SSE2 only has signed
+ * compares, so unsigned ordering flips the sign bits of both operands;
+ * biasedValue already has its sign bit flipped for those predicates.
+ */
+template<int PRED>
+static inline __m128i compare(__m128i x, __m128i biasedValue)
+{
+    const __m128i bias = _mm_set1_epi32((int)0x80000000);
+    const __m128i ones = _mm_set1_epi32(-1);
+    switch(PRED)
+    {
+    case COMPACT_EQUAL:
+        return _mm_cmpeq_epi32(x, biasedValue);
+    case COMPACT_NOT_EQUAL:
+        return _mm_xor_si128(_mm_cmpeq_epi32(x, biasedValue), ones);
+    case COMPACT_LESS:
+        return _mm_cmplt_epi32(_mm_xor_si128(x, bias), biasedValue);
+    default:
+        return _mm_xor_si128(_mm_cmplt_epi32(_mm_xor_si128(x, bias), biasedValue),
+                             ones);
+    }
+}
+
+static inline __m128i biasValue(CompactPredicate predicate, cl_uint value)
+{
+    if(predicate == COMPACT_LESS || predicate == COMPACT_GREATER_EQUAL)
+    {
+        value ^= 0x80000000;
+    }
+    return _mm_set1_epi32((int)value);
+}
+
+/*
+ * Number of matching elements in input[begin...end)
+ */
+template<int PRED>
+static cl_uint countRange(const cl_uint *input, cl_uint begin, cl_uint end,
+                          cl_uint value)
+{
+    const __m128i biasedValue = biasValue((CompactPredicate)PRED, value);
+    cl_uint i = begin;
+
+    // Compare results are -1 per matching lane, subtracting them counts
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    for(; i + 8 <= end; i += 8)
+    {
+        __m128i x0 = _mm_loadu_si128((const __m128i*)(input + i));
+        __m128i x1 = _mm_loadu_si128((const __m128i*)(input + i + 4));
+        acc0 = _mm_sub_epi32(acc0, compare<PRED>(x0, biasedValue));
+        acc1 = _mm_sub_epi32(acc1, compare<PRED>(x1, biasedValue));
+    }
+    __m128i acc = _mm_add_epi32(acc0, acc1);
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    cl_uint total = (cl_uint)_mm_cvtsi128_si32(acc);
+
+    for(; i < end; i++)
+    {
+        total += selected<PRED>(input[i], value) ? 1 : 0;
+    }
+    return total;
+}
+
+/*
+ * Copies the lanes selected by mask to out. With at least four free slots
+ * left before outEnd all four table entries are stored, which needs no
+ * branch per lane; the surplus stores are overwritten by the next group.
+ * @return number of selected lanes
+ */
+static inline cl_uint writeLanes(const cl_uint *lanes, int mask, cl_uint *out,
+                                 const cl_uint *outEnd)
+{
+    const cl_uchar *lane = laneTable[mask];
+    cl_uint n = laneCount[mask];
+    if(out + 4 <= outEnd)
+    {
+        out[0] = lanes[lane[0]];
+        out[1] = lanes[lane[1]];
+        out[2] = lanes[lane[2]];
+        out[3] = lanes[lane[3]];
+    }
+    else
+    {
+        for(cl_uint k = 0; k < n; k++)
+        {
+            out[k] = lanes[lane[k]];
+        }
+    }
+    return n;
+}
+
+/*
+ * Writes the numSelected selected elements (or their indices) of
+ * input[begin...end) to selectedOut and, if rejectedOut is not NULL, the
+ * others to rejectedOut. Nothing is written past either part.
+ */
+template<int PRED>
+static void writeRange(const cl_uint *input, cl_uint begin, cl_uint end,
+                       cl_uint value, bool writeIndices, cl_uint numSelected,
+                       cl_uint *selectedOut, cl_uint *rejectedOut)
+{
+    const cl_uint *selectedEnd = selectedOut + numSelected;
+    const cl_uint *rejectedEnd = rejectedOut + (end - begin - numSelected);
+    const __m128i biasedValue = biasValue((CompactPredicate)PRED, value);
+    const __m128i step = _mm_set1_epi32(4);
+    __m128i index = _mm_add_epi32(_mm_setr_epi32(0, 1, 2, 3),
+                                  _mm_set1_epi32((int)begin));
+    cl_uint i = begin;
+    cl_uint lanes[4];
+
+    for(; i + 4 <= end; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(input + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(compare<PRED>(x, biasedValue)));
+
+        _mm_storeu_si128((__m128i*)lanes, writeIndices ? index : x);
+        index = _mm_add_epi32(index, step);
+
+        if(mask != 0)
+        {
+            selectedOut += writeLanes(lanes, mask, selectedOut, selectedEnd);
+        }
+        if(rejectedOut != NULL && mask != 0xF)
+        {
+            rejectedOut += writeLanes(lanes, mask ^ 0xF, rejectedOut, rejectedEnd);
+        }
+    }
+
+    for(; i < end; i++)
+    {
+        cl_uint out = writeIndices ? i : input[i];
+        if(selected<PRED>(input[i], value))
+        {
+            *selectedOut++ = out;
+        }
+        else if(rejectedOut != NULL)
+        {
+            *rejectedOut++ = out;
+        }
+    }
+}
+
+/**
+ * Arguments of the compaction threads
+ */
+struct compactArgs
+{
+    CompactPredicate predicate;
+    cl_uint value;
+    const cl_uint *input;
+    cl_uint *output;
+    cl_uint totalSelected;
+    bool writeIndices;
+    bool writeRejected;
+    cl_uint *counts;
+    const cl_uint *offsets;
+};
+
+template<int PRED>
+static void countThread(void *data, unsigned int begin, unsigned int end,
+                        unsigned int threadId)
+{
+    compactArgs *args = (compactArgs*)data;
+    args->counts[threadId] = countRange<PRED>(args->input, begin, end,
+                             args->value);
+}
+
+template<int PRED>
+static void writeThread(void *data, unsigned int begin, unsigned int end,
+                        unsigned int threadId)
+{
+    compactArgs *args = (compactArgs*)data;
+    cl_uint selectedOffset = args->offsets[threadId];
+    cl_uint *rejectedOut = NULL;
+    if(args->writeRejected)
+    {
+        // Elements before this range that were not selected come first
+        cl_uint rejectedOffset = begin - selectedOffset;
+        rejectedOut = args->output + args->totalSelected + rejectedOffset;
+    }
+    writeRange<PRED>(args->input, begin, end, args->value, args->writeIndices,
+                     args->counts[threadId], args->output + selectedOffset,
+                     rejectedOut);
+}
+
+static const rangeFunc countThreads[4] =
+{
+    countThread<COMPACT_EQUAL>,
+    countThread<COMPACT_NOT_EQUAL>,
+    countThread<COMPACT_LESS>,
+    countThread<COMPACT_GREATER_EQUAL>
+};
+
+static const rangeFunc writeThreads[4] =
+{
+    writeThread<COMPACT_EQUAL>,
+    writeThread<COMPACT_NOT_EQUAL>,
+    writeThread<COMPACT_LESS>,
+    writeThread<COMPACT_GREATER_EQUAL>
+};
+
+cl_uint
+StreamCompact::compact(const cl_uint *input, cl_uint length, cl_uint *output,
+                       bool writeIndices, bool writeRejected)
+{
+    if(length == 0)
+    {
+        return 0;
+    }
+
+    unsigned int threads = numThreads ? numThreads : getNumCPUCores();
+    threads = std::min(threads, std::max(length / MIN_ELEMENTS_PER_THREAD, 1u));
+    threadCounts.resize(threads);
+    threadOffsets.resize(threads);
+
+    compactArgs args;
+    args.predicate = predicate;
+    args.value = value;
+    args.input = input;
+    args.output = output;
+    args.totalSelected = 0;
+    args.writeIndices = writeIndices;
+    args.writeRejected = writeRejected;
+    args.counts = &threadCounts[0];
+    args.offsets = &threadOffsets[0];
+
+    // parallelFor splits the same way for the same count and thread number
+    parallelFor(countThreads[predicate], &args, length, threads);
+
+    cl_uint total = 0;
+    for(unsigned int t = 0; t < threads; t++)
+    {
+        threadOffsets[t] = total;
+        total += threadCounts[t];
+    }
+    if(output == NULL)
+    {
+        return total;
+    }
+
+    args.totalSelected = total;
+    parallelFor(writeThreads[predicate], &args, length, threads);
+
+    return total;
+}
+
+cl_uint
+StreamCompact::count(const cl_uint *input, cl_uint length)
+{
+    return compact(input, length, NULL, false, false);
+}
+
+cl_uint
+StreamCompact::selectIndices(const cl_uint *input, cl_uint length,
+                             cl_uint *indices)
+{
+    return compact(input, length, indices, true, false);
+}
+
+cl_uint
+StreamCompact::selectValues(const cl_uint *input, cl_uint length,
+                            cl_uint *values)
+{
+    return compact(input, length, values, false, false);
+}
+
+cl_uint
+StreamCompact::partition(const cl_uint *input, cl_uint length,
+                         cl_uint *output)
+{
+    return compact(input, length, output, false, true);
+}
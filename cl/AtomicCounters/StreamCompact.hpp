@@ -0,0 +1,130 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef STREAMCOMPACT_H_
+#define STREAMCOMPACT_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * Predicates of the stream compaction, comparing each element with a value
+ */
+enum CompactPredicate
+{
+    COMPACT_EQUAL = 0,          /**< element == value */
+    COMPACT_NOT_EQUAL = 1,      /**< element != value */
+    COMPACT_LESS = 2,           /**< element <  value, unsigned */
+    COMPACT_GREATER_EQUAL = 3   /**< element >= value, unsigned */
+};
+
+/**
+ * StreamCompact
+ * Class implements a host filter over cl_uint arrays: predicate count,
+ * selection of the matching indices or values, and stable partition.
+ * Four elements are compared at a time with SSE2. The compare mask of each
+ * group indexes a table of the selected lanes, so a group is written out
+ * without a branch per element and groups without a selected lane are
+ * skipped. Threads first count their range, an exclusive prefix sum of the
+ * counts gives each thread its output offset, then every thread writes its
+ * part of the output independently.
+ */
+class StreamCompact
+{
+        CompactPredicate predicate;         /**< Predicate applied to the elements */
+        cl_uint value;                      /**< Value compared with the elements */
+        unsigned int numThreads;            /**< Host threads, 0 uses every core */
+
+        std::vector<cl_uint> threadCounts;  /**< Selected elements of every thread */
+        std::vector<cl_uint> threadOffsets; /**< Output offset of every thread */
+
+        /**
+         * Counts, then writes the selected (and for partitions the rejected)
+         * elements or indices of input[0...length)
+         * @return number of selected elements
+         */
+        cl_uint compact(const cl_uint *input, cl_uint length, cl_uint *output,
+                        bool writeIndices, bool writeRejected);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        StreamCompact()
+            : predicate(COMPACT_EQUAL),
+              value(0),
+              numThreads(0)
+        {
+        }
+
+        /**
+         * Sets the predicate used by the following calls
+         * @param pred comparison applied to each element
+         * @param val value compared with the elements
+         */
+        void setPredicate(CompactPredicate pred, cl_uint val)
+        {
+            predicate = pred;
+            value = val;
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * @return number of elements of input[0...length) matching the predicate
+         */
+        cl_uint count(const cl_uint *input, cl_uint length);
+
+        /**
+         * Writes the indices of the matching elements in increasing order
+         * @param indices output, room for length indices
+         * @return number of matching elements
+         */
+        cl_uint selectIndices(const cl_uint *input, cl_uint length,
+                              cl_uint *indices);
+
+        /**
+         * Writes the matching elements in input order
+         * @param values output, room for length elements
+         * @return number of matching elements
+         */
+        cl_uint selectValues(const cl_uint *input, cl_uint length,
+                             cl_uint *values);
+
+        /**
+         * Stable partition: the matching elements followed by the others,
+         * both in input order
+         * @param output output, room for length elements
+         * @return number of matching elements, the start of the second part
+         */
+        cl_uint partition(const cl_uint *input, cl_uint length,
+                          cl_uint *output);
+};
+
+#endif
@@ -0,0 +1,212 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "BatchSearch.hpp"
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+ * Returns the number of trailing zero bits of a non-zero value
+ */
+static inline cl_uint countTrailingZeros(cl_uint value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (cl_uint)index;
+#else
+    return (cl_uint)__builtin_ctz(value);
+#endif
+}
+
+EytzingerSearch::~EytzingerSearch()
+{
+#ifdef _WIN32
+    ALIGNED_FREE(tree);
+#else
+    FREE(tree);
+#endif
+    FREE(rank);
+}
+
+cl_uint
+EytzingerSearch::fill(const cl_uint *sorted, cl_uint i, cl_uint k)
+{
+    if(k <= length)
+    {
+        i = fill(sorted, i, 2 * k);
+        tree[k] = sorted[i];
+        rank[k] = i;
+        i = fill(sorted, i + 1, 2 * k + 1);
+    }
+    return i;
+}
+
+int
+EytzingerSearch::build(const cl_uint *sorted, cl_uint n)
+{
+    if(n >= (1u << 30))
+    {
+        error("EytzingerSearch supports at most 2^30 - 1 elements");
+        return SDK_FAILURE;
+    }
+
+#ifdef _WIN32
+    ALIGNED_FREE(tree);
+#else
+    FREE(tree);
+#endif
+    FREE(rank);
+
+    length = n;
+    levels = 0;
+    while((1u << levels) <= length)
+    {
+        levels++;
+    }
+
+    /*
+     * The last level of a complete tree of "levels" levels ends at
+     * 2^levels - 1. Padding the tree up to there lets the batched search run
+     * the same number of steps for every key without bounds checks on loads.
+     * The tree is cache line aligned so that node 16k starts a cache line.
+     */
+    size_t treeSize = (size_t)1 << levels;
+#if defined (_WIN32)
+    tree = (cl_uint*)_aligned_malloc(treeSize * sizeof(cl_uint), 64);
+#else
+    tree = (cl_uint*)memalign(64, treeSize * sizeof(cl_uint));
+#endif
+    CHECK_ALLOCATION(tree, "Failed to allocate host memory. (tree)");
+
+    rank = (cl_uint*)malloc((length + 1) * sizeof(cl_uint));
+    CHECK_ALLOCATION(rank, "Failed to allocate host memory. (rank)");
+
+    memset(tree, 0, treeSize * sizeof(cl_uint));
+    tree[0] = 0;
+    rank[0] = length;
+
+    fill(sorted, 0, 1);
+
+    return SDK_SUCCESS;
+}
+
+cl_uint
+EytzingerSearch::lowerBound(cl_uint key) const
+{
+    cl_uint k = 1;
+    while(k <= length)
+    {
+        k = 2 * k + (tree[k] < key);
+    }
+
+    /*
+     * The bits of k record the path taken, 1 for every right turn.
+     * Dropping the trailing right turns and the last left turn gives the
+     * last node whose key was not less than the searched key. With 30
+     * levels a key above the maximum leaves 31 ones, so the shift can
+     * reach 32 and is done in 64 bits.
+     */
+    k = (cl_uint)((cl_ulong)k >> (countTrailingZeros(~k) + 1));
+    return rank[k];
+}
+
+void
+EytzingerSearch::lowerBoundRange(const cl_uint *keys, cl_uint begin,
+                                 cl_uint end, cl_uint *results) const
+{
+    cl_uint i = begin;
+    cl_uint k[BATCH_SEARCH_GROUP];
+    cl_uint key[BATCH_SEARCH_GROUP];
+
+    for(; i + BATCH_SEARCH_GROUP <= end; i += BATCH_SEARCH_GROUP)
+    {
+        for(int j = 0; j < BATCH_SEARCH_GROUP; j++)
+        {
+            k[j] = 1;
+            key[j] = keys[i + j];
+        }
+
+        /*
+         * Every key walks exactly "levels" steps. Nodes past the end of the
+         * input behave as if they were smaller than every key, so they only
+         * append right turns that are dropped again below.
+         */
+        for(cl_uint level = 0; level < levels; level++)
+        {
+            for(int j = 0; j < BATCH_SEARCH_GROUP; j++)
+            {
+                _mm_prefetch((const char*)(tree + 16 * k[j]), _MM_HINT_T0);
+                k[j] = 2 * k[j] + ((k[j] > length) | (tree[k[j]] < key[j]));
+            }
+        }
+
+        for(int j = 0; j < BATCH_SEARCH_GROUP; j++)
+        {
+            results[i + j] = rank[(cl_ulong)k[j] >> (countTrailingZeros(~k[j]) + 1)];
+        }
+    }
+
+    for(; i < end; i++)
+    {
+        results[i] = lowerBound(keys[i]);
+    }
+}
+
+/**
+ * Arguments of the batched search threads
+ */
+struct batchSearchArgs
+{
+    const EytzingerSearch *search;
+    const cl_uint *keys;
+    cl_uint *results;
+};
+
+static void batchSearchThread(void *data, unsigned int begin,
+                              unsigned int end, unsigned int threadId)
+{
+    batchSearchArgs *args = (batchSearchArgs*)data;
+    args->search->lowerBoundRange(args->keys, begin, end, args->results);
+}
+
+int
+EytzingerSearch::lowerBound(const cl_uint *keys, cl_uint numKeys,
+                            cl_uint *results, unsigned int numThreads) const
+{
+    if(tree == NULL)
+    {
+        error("EytzingerSearch::build() must be called before searching");
+        return SDK_FAILURE;
+    }
+
+    batchSearchArgs args;
+    args.search = this;
+    args.keys = keys;
+    args.results = results;
+
+    if(!parallelFor(batchSearchThread, &args, numKeys, numThreads))
+    {
+        error("Failed to create host threads for the batched search");
+        return SDK_FAILURE;
+    }
+
+    return SDK_SUCCESS;
+}
@@ -0,0 +1,112 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef BATCHSEARCH_H_
+#define BATCHSEARCH_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+#include <CL/cl.h>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * Number of keys searched in lockstep by one thread.
+ * Interleaving independent searches keeps several cache misses in flight.
+ */
+#define BATCH_SEARCH_GROUP 8
+
+/**
+ * EytzingerSearch
+ * Class implements a batched, cache friendly lower_bound search on the host.
+ * The sorted input is stored in Eytzinger (breadth first) order, so the top
+ * levels of the implicit tree share a few cache lines and the 16 descendants
+ * four levels below node k are contiguous at [16k, 16k + 16). The search is
+ * branchless and prefetches those descendants while the current level is
+ * compared.
+ */
+class EytzingerSearch
+{
+        cl_uint *tree;      /**< Keys in Eytzinger order (1-based, padded) */
+        cl_uint *rank;      /**< Index in the sorted input of every tree node */
+        cl_uint length;     /**< Number of elements in the sorted input */
+        cl_uint levels;     /**< Number of levels of the complete tree */
+
+        /**
+         * Recursively stores sorted[i...] into the subtree rooted at node k
+         * @return index of the next sorted element to store
+         */
+        cl_uint fill(const cl_uint *sorted, cl_uint i, cl_uint k);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        EytzingerSearch()
+        {
+            tree = NULL;
+            rank = NULL;
+            length = 0;
+            levels = 0;
+        }
+
+        /**
+         * Destructor
+         * Release host memory
+         */
+        ~EytzingerSearch();
+
+        /**
+         * Builds the Eytzinger layout of a sorted array
+         * @param sorted input array sorted in ascending order
+         * @param n number of elements, must be below 2^30
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int build(const cl_uint *sorted, cl_uint n);
+
+        /**
+         * Searches a single key
+         * @return index of the first element not less than key,
+         *         or the input length if there is none
+         */
+        cl_uint lowerBound(cl_uint key) const;
+
+        /**
+         * Searches a batch of keys, see lowerBound(cl_uint)
+         * @param keys keys to look up
+         * @param numKeys number of keys
+         * @param results lower_bound index of every key
+         * @param numThreads number of host threads, 0 uses every core
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int lowerBound(const cl_uint *keys, cl_uint numKeys, cl_uint *results,
+                       unsigned int numThreads = 0) const;
+
+        /**
+         * Searches keys[begin...end) on the calling thread
+         */
+        void lowerBoundRange(const cl_uint *keys, cl_uint begin, cl_uint end,
+                             cl_uint *results) const;
+};
+
+#endif
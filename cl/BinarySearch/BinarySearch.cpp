@@ -17,6 +17,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "BinarySearch.hpp"
 #include <malloc.h>
+#include <algorithm>
 
 /*
  * \brief set up program input data
@@ -59,6 +60,54 @@ int BinarySearch::setupBinarySearch()
     return SDK_SUCCESS;
 }
 
+/*
+ * \brief set up the batched host search: build the Eytzinger tree of the
+ *        sorted input and generate random keys over its value range
+ */
+int BinarySearch::setupBatchSearch()
+{
+    cl_uint inputSizeBytes = length *  sizeof(cl_uint);
+
+    int status = mapBuffer( inputBuffer, input, inputSizeBytes, CL_MAP_READ);
+    CHECK_ERROR(status, SDK_SUCCESS,
+                "Failed to map device buffer.(inputBuffer in setupBatchSearch)");
+
+    status = batchSearch.build(input, length);
+    CHECK_ERROR(status, SDK_SUCCESS, "Failed to build the host search tree");
+
+    cl_uint maxInput = input[length - 1];
+    cl_uint maxKey = maxInput + 1;
+
+    status = unmapBuffer( inputBuffer, input);
+    CHECK_ERROR(status, SDK_SUCCESS,
+                "Failed to unmap device buffer.(inputBuffer in setupBatchSearch)");
+
+    keys = (cl_uint *) malloc(numKeys * sizeof(cl_uint));
+    CHECK_ALLOCATION(keys, "Failed to allocate host memory. (keys)");
+
+    keyResults = (cl_uint *) malloc(numKeys * sizeof(cl_uint));
+    CHECK_ALLOCATION(keyResults, "Failed to allocate host memory. (keyResults)");
+
+    // random keys, both present in the input and missing
+    for(cl_uint i = 0; i < numKeys; i++)
+    {
+        keys[i] = (cl_uint)(((cl_ulong)rand() * RAND_MAX + rand()) % maxKey);
+    }
+
+    // A key above the maximum only turns right, down to the deepest node
+    if(numKeys > 0 && maxInput < 0xFFFFFFFFu)
+    {
+        keys[numKeys - 1] = maxInput + 1;
+    }
+
+    return SDK_SUCCESS;
+}
+
+int BinarySearch::runBatchSearch()
+{
+    return batchSearch.lowerBound(keys, numKeys, keyResults, cpuThreads);
+}
+
 template<typename T>
 int BinarySearch::mapBuffer(cl_mem deviceBuffer, T* &hostPointer,
                             size_t sizeInBytes, cl_map_flags flags)
@@ -448,38 +497,42 @@ BinarySearch::runCLKernels(void)
 int
 BinarySearch::binarySearchCPUReference()
 {
-    cl_uint inputSizeBytes = length *  sizeof(cl_uint);
-
-    int status = mapBuffer( inputBuffer, input, inputSizeBytes, CL_MAP_WRITE);
-    CHECK_ERROR(status, SDK_SUCCESS,
-                "Failed to map device buffer.(inputBuffer in binarySearchCPUReference)");
-
+    int status = SDK_SUCCESS;
     if(isElementFound)
     {
-        if(input[globalLowerBound] == findMe)
+        if(verificationInput[globalLowerBound] != findMe)
         {
-            return SDK_SUCCESS;
+            status = SDK_FAILURE;
         }
-        else
+    }
+    else
+    {
+        // The element was reported missing, a lower_bound lookup confirms it
+        cl_uint *position = std::lower_bound(verificationInput,
+                                             verificationInput + length, findMe);
+        if(position != verificationInput + length && *position == findMe)
         {
-            return SDK_FAILURE;
+            status = SDK_FAILURE;
         }
     }
-    else
+
+    if(numKeys > 0)
     {
-        for(cl_uint i = 0; i < length; i++)
+        for(cl_uint i = 0; i < numKeys; i++)
         {
-            if(input[i] == findMe)
+            cl_uint expected = (cl_uint)(std::lower_bound(verificationInput,
+                                         verificationInput + length, keys[i]) - verificationInput);
+            if(keyResults[i] != expected)
             {
-                return SDK_FAILURE;
+                std::cout << "Batched search mismatch for key " << keys[i]
+                          << " : " << keyResults[i] << " != " << expected << std::endl;
+                status = SDK_FAILURE;
+                break;
             }
         }
-        return SDK_SUCCESS;
     }
 
-    status = unmapBuffer( inputBuffer, input);
-    CHECK_ERROR(status, SDK_SUCCESS,
-                "Failed to unmap device buffer.(inputBuffer in binarySearchCPUReference)");
+    return status;
 }
 
 int BinarySearch::initialize()
@@ -541,6 +594,32 @@ int BinarySearch::initialize()
 
     delete num_iterations;
 
+    Option* num_keys = new Option;
+    CHECK_ALLOCATION(num_keys, "Memory allocation error.\n");
+
+    num_keys->_sVersion = "k";
+    num_keys->_lVersion = "keys";
+    num_keys->_description =
+        "Number of keys for the batched host search (0 disables it)";
+    num_keys->_type = CA_ARG_INT;
+    num_keys->_value = &numKeys;
+    sampleArgs->AddOption(num_keys);
+
+    delete num_keys;
+
+    Option* num_threads = new Option;
+    CHECK_ALLOCATION(num_threads, "Memory allocation error.\n");
+
+    num_threads->_sVersion = "";
+    num_threads->_lVersion = "threads";
+    num_threads->_description =
+        "Host threads of the batched search (0 uses every core)";
+    num_threads->_type = CA_ARG_INT;
+    num_threads->_value = &cpuThreads;
+    sampleArgs->AddOption(num_threads);
+
+    delete num_threads;
+
     return SDK_SUCCESS;
 }
 
@@ -578,6 +657,16 @@ int BinarySearch::setup()
     }
 
     sampleTimer->stopTimer(timer);
+
+    if(numKeys > 0 && setupBatchSearch() != SDK_SUCCESS)
+    {
+        return SDK_FAILURE;
+    }
+
+    if(cpuThreads < 0)
+    {
+        cpuThreads = 0;
+    }
     setupTime = (cl_double)(sampleTimer->readTimer(timer));
 
     return SDK_SUCCESS;
@@ -616,6 +705,27 @@ int BinarySearch::run()
     sampleTimer->stopTimer(timer);
     totalKernelTime = (double)(sampleTimer->readTimer(timer));
 
+    if(numKeys > 0)
+    {
+        std::cout << "Executing batched host search of " << numKeys <<
+                  " keys for " << iterations << " iterations" << std::endl;
+        std::cout << "-------------------------------------------" << std::endl;
+
+        int batchTimer = sampleTimer->createTimer();
+        sampleTimer->resetTimer(batchTimer);
+        sampleTimer->startTimer(batchTimer);
+
+        for(int i = 0; i < iterations; i++)
+        {
+            if(runBatchSearch() != SDK_SUCCESS)
+            {
+                return SDK_FAILURE;
+            }
+        }
+
+        sampleTimer->stopTimer(batchTimer);
+        batchSearchTime = (double)(sampleTimer->readTimer(batchTimer));
+    }
 
     if(!sampleArgs->quiet)
     {
@@ -696,6 +806,27 @@ void BinarySearch::printStats()
         stats[3] = toString(length/sampleTimer->totalTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        if(numKeys > 0)
+        {
+            /*
+             * The device search answers one key per run, the host search
+             * answers numKeys keys per run.
+             */
+            std::string batchStrArray[4] = {"Keys", "Avg. Batch Time (sec)", "Host lookups/sec", "Device lookups/sec"};
+            std::string batchStats[4];
+
+            double avgBatchTime = batchSearchTime / iterations;
+
+            batchStats[0] = toString(numKeys, std::dec);
+            batchStats[1] = toString(avgBatchTime, std::dec);
+            batchStats[2] = toString(avgBatchTime > 0 ? numKeys / avgBatchTime : 0,
+                                     std::dec);
+            batchStats[3] = toString(sampleTimer->totalTime > 0 ?
+                                     1 / sampleTimer->totalTime : 0, std::dec);
+
+            printStatistics(batchStrArray, batchStats, 4);
+        }
     }
 }
 
@@ -727,6 +858,8 @@ int BinarySearch::cleanup()
     FREE(devices);
 
     FREE(verificationInput);
+    FREE(keys);
+    FREE(keyResults);
 
     return SDK_SUCCESS;
 }
@@ -24,6 +24,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <string.h>
 
 #include "CLUtil.hpp"
+#include "BatchSearch.hpp"
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -68,6 +69,12 @@ class BinarySearch
         KernelWorkGroupInfo
         kernelInfo;     /**< Structure to store kernel related info */
         cl_uint isElementFound;
+        cl_uint               numKeys;      /**< Number of keys for the batched host search */
+        cl_uint                 *keys;      /**< Keys for the batched host search */
+        cl_uint           *keyResults;      /**< lower_bound index of every key */
+        int                cpuThreads;      /**< Host threads of the batched search */
+        cl_double     batchSearchTime;      /**< Time for the batched host search */
+        EytzingerSearch   batchSearch;      /**< Batched host search engine */
         SDKTimer    *sampleTimer;           /**< SDKTimer object */
 
     public:
@@ -92,6 +99,11 @@ class BinarySearch
             globalLowerBound = 0;
             globalUpperBound = 0;
             isElementFound = 0;
+            numKeys = 0;
+            keys = NULL;
+            keyResults = NULL;
+            cpuThreads = 0;
+            batchSearchTime = 0;
             sampleArgs = new CLCommandArgs() ;
             sampleTimer = new SDKTimer();
             sampleArgs->sampleVerStr = SAMPLE_VERSION;
@@ -104,6 +116,19 @@ class BinarySearch
          */
         int setupBinarySearch();
 
+        /**
+         * Build the host search tree and generate the keys of the
+         * batched search
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int setupBatchSearch();
+
+        /**
+         * Run the batched host search over all keys
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int runBatchSearch();
+
         /**
          * clEnqueueMapBuffer
          * @return SDK_SUCCESS on success and SDK_FAILURE on failure
@@ -0,0 +1,285 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "BinomialEngine.hpp"
+#include <algorithm>
+#include <vector>
+#include <emmintrin.h>
+
+/*
+ * Nodes per chunk and time steps per band of the backward induction.
+ * A chunk touches CHUNK_NODES + CHUNK_STEPS nodes and as many powers of
+ * the up factor, 20KB of L1. CHUNK_STEPS must not exceed CHUNK_NODES.
+ */
+#define CHUNK_NODES 512
+#define CHUNK_STEPS 128
+
+/*
+ * Bounds of the node prices, their product stays a finite float. Nodes
+ * beyond them are more than 40 standard deviations away from the spot.
+ */
+#define PRICE_MIN 1e-19
+#define PRICE_MAX 1e19
+
+/*
+ * MXCSR flush to zero and denormals are zero bits
+ */
+#define MXCSR_FTZ_DAZ 0x8040
+
+/**
+ * Arguments of the pricing threads
+ */
+struct BinomialEngine::rangeArgs
+{
+    const BinomialBook *book;
+    cl_uint numSteps;
+    bool put;
+    bool american;
+    cl_float *value;
+};
+
+static inline cl_float clampPrice(cl_double p)
+{
+    return (cl_float)std::min(std::max(p, PRICE_MIN), PRICE_MAX);
+}
+
+/*
+ * One backward step over nodes [k0, k1) of four trees: each node becomes
+ * the expectation of its down (same index) and up (next index) children.
+ */
+static inline void holdNodes(cl_float *v, cl_uint k0, cl_uint k1, __m128 pu, __m128 pd)
+{
+    __m128 lo = _mm_loadu_ps(v + 4 * k0);
+    cl_uint n = k0;
+    for(; n + 2 <= k1; n += 2)
+    {
+        __m128 mid = _mm_loadu_ps(v + 4 * (n + 1));
+        __m128 hi = _mm_loadu_ps(v + 4 * (n + 2));
+        _mm_storeu_ps(v + 4 * n, _mm_add_ps(_mm_mul_ps(pd, lo), _mm_mul_ps(pu, mid)));
+        _mm_storeu_ps(v + 4 * n + 4, _mm_add_ps(_mm_mul_ps(pd, mid), _mm_mul_ps(pu, hi)));
+        lo = hi;
+    }
+    if(n < k1)
+    {
+        __m128 hi = _mm_loadu_ps(v + 4 * (n + 1));
+        _mm_storeu_ps(v + 4 * n, _mm_add_ps(_mm_mul_ps(pd, lo), _mm_mul_ps(pu, hi)));
+    }
+}
+
+/*
+ * holdNodes() with early exercise. Node n is worth sign * (s * powers[n - k0] - k)
+ * when exercised, sign is 1 for calls and -1 for puts.
+ */
+static inline void exerciseNodes(cl_float *v, cl_uint k0, cl_uint k1, __m128 pu, __m128 pd,
+                                 __m128 sign, __m128 s, __m128 k, const cl_float *powers)
+{
+    const cl_float *pw = powers - 4 * k0;
+    __m128 lo = _mm_loadu_ps(v + 4 * k0);
+    cl_uint n = k0;
+    for(; n + 2 <= k1; n += 2)
+    {
+        __m128 mid = _mm_loadu_ps(v + 4 * (n + 1));
+        __m128 hi = _mm_loadu_ps(v + 4 * (n + 2));
+        __m128 hold0 = _mm_add_ps(_mm_mul_ps(pd, lo), _mm_mul_ps(pu, mid));
+        __m128 hold1 = _mm_add_ps(_mm_mul_ps(pd, mid), _mm_mul_ps(pu, hi));
+        __m128 exercise0 = _mm_mul_ps(sign, _mm_sub_ps(_mm_mul_ps(s, _mm_loadu_ps(pw + 4 * n)), k));
+        __m128 exercise1 = _mm_mul_ps(sign, _mm_sub_ps(_mm_mul_ps(s, _mm_loadu_ps(pw + 4 * n + 4)), k));
+        _mm_storeu_ps(v + 4 * n, _mm_max_ps(hold0, exercise0));
+        _mm_storeu_ps(v + 4 * n + 4, _mm_max_ps(hold1, exercise1));
+        lo = hi;
+    }
+    if(n < k1)
+    {
+        __m128 hi = _mm_loadu_ps(v + 4 * (n + 1));
+        __m128 hold = _mm_add_ps(_mm_mul_ps(pd, lo), _mm_mul_ps(pu, hi));
+        __m128 exercise = _mm_mul_ps(sign, _mm_sub_ps(_mm_mul_ps(s, _mm_loadu_ps(pw + 4 * n)), k));
+        _mm_storeu_ps(v + 4 * n, _mm_max_ps(hold, exercise));
+    }
+}
+
+void
+BinomialEngine::priceThread(void *data, unsigned int begin, unsigned int end,
+                            unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const BinomialBook &book = *args->book;
+    const cl_uint N = args->numSteps;
+
+    // Tiny values far out of the money would otherwise run on microcode
+    unsigned int csr = _mm_getcsr();
+    _mm_setcsr(csr | MXCSR_FTZ_DAZ);
+
+    std::vector<cl_float> nodes(4 * (N + 1));
+    std::vector<cl_float> powers(4 * CHUNK_NODES);
+    cl_float *v = &nodes[0];
+    const __m128 sign = _mm_set1_ps(args->put ? -1.0f : 1.0f);
+
+    // begin and end count groups of four options
+    for(unsigned int g = begin; g < end; g++)
+    {
+        cl_double s[4], k[4], vsdt[4], up[4], growth[4], rdt[4], discount[4];
+        cl_float pu[4], pd[4];
+        for(unsigned int l = 0; l < 4; l++)
+        {
+            // Pad the last group with copies of its first option
+            unsigned int i = 4 * g + l < book.count ? 4 * g + l : 4 * g;
+            cl_double t = book.expiry[i];
+            cl_double dt = t / N;
+            s[l] = book.spot[i];
+            k[l] = book.strike[i];
+            vsdt[l] = book.volatility[i] * sqrt(dt);
+            rdt[l] = book.rate[i] * dt;
+            up[l] = exp(vsdt[l]);
+            growth[l] = exp(rdt[l]);
+            discount[l] = exp(-book.rate[i] * t);
+
+            // Round the larger probability, the other one is exact
+            cl_double p = (growth[l] - 1.0 / up[l]) / (up[l] - 1.0 / up[l]);
+            if(p >= 0.5)
+            {
+                pu[l] = (cl_float)p;
+                pd[l] = 1.0f - pu[l];
+            }
+            else
+            {
+                pd[l] = (cl_float)(1.0 - p);
+                pu[l] = 1.0f - pd[l];
+            }
+
+            // Leaves, the prices run in double across the whole range
+            cl_double price = s[l] * exp(-vsdt[l] * N);
+            cl_double up2 = up[l] * up[l];
+            for(cl_uint j = 0; j <= N; j++)
+            {
+                cl_double payoff = args->put ? k[l] - price : price - k[l];
+                v[4 * j + l] = (cl_float)std::min(std::max(payoff, 0.0), PRICE_MAX * PRICE_MAX);
+                price *= up2;
+            }
+
+            cl_double power = 1.0;
+            for(unsigned int m = 0; m < CHUNK_NODES; m++)
+            {
+                powers[4 * m + l] = clampPrice(power);
+                power *= up2;
+            }
+        }
+        const __m128 vpu = _mm_loadu_ps(pu);
+        const __m128 vpd = _mm_loadu_ps(pd);
+
+        /*
+         * Values are kept at expiry, so level t holds V(t) * exp(r (T - t))
+         * and the early exercise value grows by exp(r dt) per level.
+         * A band reduces level j to level jEnd chunk by chunk. Level j - l
+         * of the chunk starting at node a > 0 updates nodes [a - l, b - l):
+         * the chunk to its left stopped short of node a - l on that level and
+         * the chunk to its right has not started, so both children of every
+         * node still hold level j - l + 1.
+         */
+        for(cl_uint j = N; j > 0;)
+        {
+            cl_uint jEnd = j > CHUNK_STEPS ? j - CHUNK_STEPS : 0;
+            for(cl_uint a = 0; a <= j; a += CHUNK_NODES)
+            {
+                cl_uint b = std::min(a + CHUNK_NODES, j + 1);
+
+                // Exercise value of the chunk's first node at level j, held at expiry
+                cl_double sBase[4], kBase[4], shift[4];
+                if(args->american)
+                {
+                    int e = a == 0 ? -(int)j : 2 * (int)a - (int)j;
+                    for(unsigned int l = 0; l < 4; l++)
+                    {
+                        cl_double grown = exp(rdt[l] * (N - j));
+                        sBase[l] = s[l] * exp(vsdt[l] * e) * grown;
+                        kBase[l] = k[l] * grown;
+                        shift[l] = (a == 0 ? up[l] : 1.0 / up[l]) * growth[l];
+                    }
+                }
+
+                for(cl_uint lev = 1; lev <= j - jEnd; lev++)
+                {
+                    cl_uint k0 = a == 0 ? 0 : a - lev;
+                    cl_uint k1 = b - lev;
+                    if(!args->american)
+                    {
+                        holdNodes(v, k0, k1, vpu, vpd);
+                        continue;
+                    }
+
+                    cl_float sLane[4], kLane[4];
+                    for(unsigned int l = 0; l < 4; l++)
+                    {
+                        sBase[l] *= shift[l];
+                        kBase[l] *= growth[l];
+                        sLane[l] = clampPrice(sBase[l]);
+                        kLane[l] = (cl_float)kBase[l];
+                    }
+                    const __m128 vs = _mm_loadu_ps(sLane);
+                    const __m128 vk = _mm_loadu_ps(kLane);
+                    exerciseNodes(v, k0, k1, vpu, vpd, sign, vs, vk, &powers[0]);
+                }
+            }
+            j = jEnd;
+        }
+
+        for(unsigned int l = 0; l < 4 && 4 * g + l < book.count; l++)
+        {
+            args->value[4 * g + l] = (cl_float)(v[l] * discount[l]);
+        }
+    }
+
+    _mm_setcsr(csr);
+}
+
+int
+BinomialEngine::price(const BinomialBook &book, cl_uint numSteps, BinomialPayoff payoff,
+                      BinomialExercise exercise, cl_float *value)
+{
+    if(book.spot == NULL || book.strike == NULL || book.expiry == NULL ||
+            book.rate == NULL || book.volatility == NULL || value == NULL)
+    {
+        error("BinomialEngine::price() needs every input and the output array");
+        return SDK_FAILURE;
+    }
+    if(numSteps == 0)
+    {
+        error("BinomialEngine::price() needs at least one time step");
+        return SDK_FAILURE;
+    }
+    if(book.count == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    // Every group walks a full tree, one group per thread already pays off
+    unsigned int groups = (book.count + 3) / 4;
+    unsigned int threads = numThreads ? numThreads : getNumCPUCores();
+    threads = std::min(threads, groups);
+
+    rangeArgs args;
+    args.book = &book;
+    args.numSteps = numSteps;
+    args.put = (payoff == PAYOFF_PUT);
+    args.american = (exercise == EXERCISE_AMERICAN);
+    args.value = value;
+    if(!parallelFor(priceThread, &args, groups, threads))
+    {
+        error("BinomialEngine::price() could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
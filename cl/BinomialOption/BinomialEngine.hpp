@@ -0,0 +1,111 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef BINOMIALENGINE_H_
+#define BINOMIALENGINE_H_
+
+#include <CL/cl.h>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * BinomialPayoff
+ * Payoff of the options priced by BinomialEngine
+ */
+enum BinomialPayoff
+{
+    PAYOFF_CALL,
+    PAYOFF_PUT
+};
+
+/**
+ * BinomialExercise
+ * Exercise style of the options priced by BinomialEngine
+ */
+enum BinomialExercise
+{
+    EXERCISE_EUROPEAN,
+    EXERCISE_AMERICAN
+};
+
+/**
+ * BinomialBook
+ * Options without dividends, one array per parameter (SoA)
+ */
+struct BinomialBook
+{
+    cl_uint count;                  /**< Number of options */
+    const cl_float *spot;           /**< Price of the underlying */
+    const cl_float *strike;         /**< Strike price */
+    const cl_float *expiry;         /**< Time to expiry in years */
+    const cl_float *rate;           /**< Continuously compounded risk free rate */
+    const cl_float *volatility;     /**< Volatility of the underlying */
+};
+
+/**
+ * BinomialEngine
+ * Class implements a multi-threaded host Cox-Ross-Rubinstein tree pricer.
+ * Every SSE2 lane walks the tree of one option, so a group of four options
+ * shares one array of numSteps + 1 nodes. The backward induction sweeps
+ * that array in skewed chunks of several time steps each, which keeps the
+ * nodes being updated in L1 whatever the number of steps. Values are kept
+ * relative to the expiry date, so the discounting is a single multiply at
+ * the root and the branch probabilities sum to exactly one.
+ */
+class BinomialEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+
+        struct rangeArgs;
+        static void priceThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        BinomialEngine()
+            : numThreads(0)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Prices every option of the book on a tree of numSteps time steps
+         * @param book inputs, all positive
+         * @param numSteps number of time steps of the tree
+         * @param payoff call or put
+         * @param exercise European or American
+         * @param value output, room for book.count prices
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int price(const BinomialBook &book, cl_uint numSteps, BinomialPayoff payoff,
+                  BinomialExercise exercise, cl_float *value);
+};
+
+#endif
@@ -17,6 +17,16 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "BinomialOption.hpp"
 
+/*
+ * Black-Scholes price of a European call, the limit of the host trees
+ */
+static double blackScholesCall(double s, double k, double t, double r, double v)
+{
+    double sigmaSqrtT = v * sqrt(t);
+    double d1 = (log(s / k) + (r + 0.5 * v * v) * t) / sigmaSqrtT;
+    double d2 = d1 - sigmaSqrtT;
+    return 0.5 * s * erfc(-d1 / sqrt(2.0)) - 0.5 * k * exp(-r * t) * erfc(-d2 / sqrt(2.0));
+}
 
 int
 BinomialOption::setupBinomialOption()
@@ -50,6 +60,30 @@ BinomialOption::setupBinomialOption()
     CHECK_ALLOCATION(output, "Failed to allocate host memory. (output)");
     memset(output, 0, samplesPerVectorWidth * sizeof(cl_float4));
 
+    if(hostEngine)
+    {
+        // Same options as the kernel, stored as one array per input
+        bookInputs.resize(5 * numSamples);
+        for(int i = 0; i < numSamples; i++)
+        {
+            float inRand = randArray[i];
+            bookInputs[i] = (1.0f - inRand) * 5.0f + inRand * 30.f;
+            bookInputs[numSamples + i] = (1.0f - inRand) * 1.0f + inRand * 100.f;
+            bookInputs[2 * numSamples + i] = (1.0f - inRand) * 0.25f + inRand * 10.f;
+            bookInputs[3 * numSamples + i] = RISKFREE;
+            bookInputs[4 * numSamples + i] = VOLATILITY;
+        }
+        book.count = numSamples;
+        book.spot = &bookInputs[0];
+        book.strike = &bookInputs[numSamples];
+        book.expiry = &bookInputs[2 * numSamples];
+        book.rate = &bookInputs[3 * numSamples];
+        book.volatility = &bookInputs[4 * numSamples];
+
+        hostCall.assign(numSamples, 0.0f);
+        hostPut.assign(numSamples, 0.0f);
+    }
+
     return SDK_SUCCESS;
 }
 
@@ -484,6 +518,51 @@ int BinomialOption::initialize()
 
     delete num_iterations;
 
+    Option* host_engine = new Option;
+    CHECK_ALLOCATION(host_engine,
+                     "Error. Failed to allocate memory (host_engine)\n");
+
+    host_engine->_sVersion = "";
+    host_engine->_lVersion = "hostengine";
+    host_engine->_description =
+        "Also price European calls and American puts with the host SIMD tree engine";
+    host_engine->_type = CA_NO_ARGUMENT;
+    host_engine->_value = &hostEngine;
+
+    sampleArgs->AddOption(host_engine);
+
+    delete host_engine;
+
+    Option* host_steps = new Option;
+    CHECK_ALLOCATION(host_steps,
+                     "Error. Failed to allocate memory (host_steps)\n");
+
+    host_steps->_sVersion = "";
+    host_steps->_lVersion = "hoststeps";
+    host_steps->_description =
+        "Largest number of time steps timed with the host engine (default 10000)";
+    host_steps->_type = CA_ARG_INT;
+    host_steps->_value = &hostMaxSteps;
+
+    sampleArgs->AddOption(host_steps);
+
+    delete host_steps;
+
+    Option* num_threads = new Option;
+    CHECK_ALLOCATION(num_threads,
+                     "Error. Failed to allocate memory (num_threads)\n");
+
+    num_threads->_sVersion = "";
+    num_threads->_lVersion = "threads";
+    num_threads->_description =
+        "Number of host threads of the host engine (0 uses every core)";
+    num_threads->_type = CA_ARG_INT;
+    num_threads->_value = &cpuThreads;
+
+    sampleArgs->AddOption(num_threads);
+
+    delete num_threads;
+
     return SDK_SUCCESS;
 }
 
@@ -546,6 +625,66 @@ int BinomialOption::run()
         printArray<cl_float>("Output", output, numSamples, 1);
     }
 
+    if(hostEngine)
+    {
+        if(runHostEngine() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+    }
+
+    return SDK_SUCCESS;
+}
+
+int BinomialOption::runHostEngine()
+{
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+    // The kernel's tree first, then deeper trees the kernel cannot hold
+    const cl_uint ladder[] = {1000, 2000, 5000, 10000};
+    hostSteps.clear();
+    hostSteps.push_back(numSteps);
+    for(size_t i = 0; i < sizeof(ladder) / sizeof(ladder[0]); i++)
+    {
+        if(ladder[i] > (cl_uint)numSteps && ladder[i] <= (cl_uint)hostMaxSteps)
+        {
+            hostSteps.push_back(ladder[i]);
+        }
+    }
+    hostCallTimes.assign(hostSteps.size(), 0);
+    hostPutTimes.assign(hostSteps.size(), 0);
+
+    int timer = sampleTimer->createTimer();
+    for(size_t s = 0; s < hostSteps.size(); s++)
+    {
+        sampleTimer->resetTimer(timer);
+        sampleTimer->startTimer(timer);
+        for(int i = 0; i < iterations; i++)
+        {
+            int status = engine.price(book, hostSteps[s], PAYOFF_CALL, EXERCISE_EUROPEAN,
+                                      &hostCall[0]);
+            CHECK_ERROR(status, SDK_SUCCESS, "BinomialEngine::price() failed");
+        }
+        sampleTimer->stopTimer(timer);
+        hostCallTimes[s] = (double)(sampleTimer->readTimer(timer)) / iterations;
+
+        sampleTimer->resetTimer(timer);
+        sampleTimer->startTimer(timer);
+        for(int i = 0; i < iterations; i++)
+        {
+            int status = engine.price(book, hostSteps[s], PAYOFF_PUT, EXERCISE_AMERICAN,
+                                      &hostPut[0]);
+            CHECK_ERROR(status, SDK_SUCCESS, "BinomialEngine::price() failed");
+        }
+        sampleTimer->stopTimer(timer);
+        hostPutTimes[s] = (double)(sampleTimer->readTimer(timer)) / iterations;
+    }
+
+    if(!sampleArgs->quiet)
+    {
+        printArray<cl_float>("Host European call", &hostCall[0], numSamples, 1);
+        printArray<cl_float>("Host American put", &hostPut[0], numSamples, 1);
+    }
     return SDK_SUCCESS;
 }
 
@@ -561,8 +700,30 @@ int BinomialOption::verifyResults()
         result = binomialOptionCPUReference();
         CHECK_ERROR(result, SDK_SUCCESS, "OpenCL  verifyResults  failed");
 
+        bool hostPassed = true;
+        if(hostEngine)
+        {
+            // Trees of n steps are within about 3 / n of Black-Scholes here
+            double tolerance = 4.0 / hostSteps.back();
+            for(int i = 0; i < numSamples; ++i)
+            {
+                double s = book.spot[i];
+                double k = book.strike[i];
+                double t = book.expiry[i];
+                double call = blackScholesCall(s, k, t, RISKFREE, VOLATILITY);
+                double put = call - s + k * exp(-RISKFREE * t);
+                if(fabs(hostCall[i] - call) > tolerance * std::max(call, 1.0) + 1e-4 ||
+                        hostPut[i] < std::max(put, k - s) - 1e-4 * std::max(k, 1.0))
+                {
+                    printf(" [%d] host call %f (%f) American put %f (>= %f)\n", i,
+                           hostCall[i], call, hostPut[i], std::max(put, k - s));
+                    hostPassed = false;
+                }
+            }
+        }
+
         // compare the results and see if they match
-        if(compare(output, refOutput, numSamples, 0.001f))
+        if(compare(output, refOutput, numSamples, 0.001f) && hostPassed)
         {
             std::cout << "Passed!\n" << std::endl;
             return SDK_SUCCESS;
@@ -609,6 +770,24 @@ void BinomialOption::printStats()
         stats[3] = toString(numSamples / sampleTimer->totalTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        if(hostEngine)
+        {
+            std::vector<std::string> hostStrArray;
+            std::vector<std::string> hostStats;
+            for(size_t s = 0; s < hostSteps.size(); s++)
+            {
+                std::string steps = " (" + toString(hostSteps[s], std::dec) + " steps)";
+                hostStrArray.push_back("Host European call options/sec" + steps);
+                hostStats.push_back(toString(hostCallTimes[s] > 0 ?
+                                             numSamples / hostCallTimes[s] : 0, std::dec));
+                hostStrArray.push_back("Host American put options/sec" + steps);
+                hostStats.push_back(toString(hostPutTimes[s] > 0 ?
+                                             numSamples / hostPutTimes[s] : 0, std::dec));
+            }
+
+            printStatistics(&hostStrArray[0], &hostStats[0], (int)hostStats.size());
+        }
     }
 }
 
@@ -26,8 +26,11 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <assert.h>
 #include <string.h>
 #include <malloc.h>
+#include <vector>
+#include <algorithm>
 
 #include "CLUtil.hpp"
+#include "BinomialEngine.hpp"
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -73,6 +76,17 @@ class BinomialOption
         SDKDeviceInfo deviceInfo;       /**< Structure to store device information*/
         KernelWorkGroupInfo kernelInfo; /**< Structure to store kernel related info */
         SDKTimer    *sampleTimer;       /**< SDKTimer object */
+        bool hostEngine;                /**< Also price the options with the host tree engine */
+        int hostMaxSteps;               /**< Largest number of time steps of the host engine */
+        int cpuThreads;                 /**< Host threads, 0 uses every core */
+        BinomialEngine engine;          /**< Host SIMD tree engine */
+        std::vector<cl_float> bookInputs;   /**< Spot, strike, expiry, rate and volatility arrays */
+        BinomialBook book;              /**< Views of bookInputs */
+        std::vector<cl_uint> hostSteps; /**< Time steps timed on the host */
+        std::vector<cl_double> hostCallTimes;   /**< European call time per entry of hostSteps */
+        std::vector<cl_double> hostPutTimes;    /**< American put time per entry of hostSteps */
+        std::vector<cl_float> hostCall; /**< European calls on the largest host tree */
+        std::vector<cl_float> hostPut;  /**< American puts on the largest host tree */
 
     private:
 
@@ -91,7 +105,10 @@ class BinomialOption
               output(NULL),
               refOutput(NULL),
               devices(NULL),
-              iterations(1)
+              iterations(1),
+              hostEngine(false),
+              hostMaxSteps(10000),
+              cpuThreads(0)
         {
             numSamples = 256;
             numSteps = 254;
@@ -138,6 +155,13 @@ class BinomialOption
          */
         int binomialOptionCPUReference();
 
+        /**
+         * Prices the options with the host tree engine, European calls and
+         * American puts, for numSteps and 1000 to hostMaxSteps time steps
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int runHostEngine();
+
         /**
          * Override from SDKSample. Print sample stats.
          */
@@ -16,6 +16,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 
 #include "BinomialOptionMultiGPU.hpp"
+#include <emmintrin.h>
 
 
 int
@@ -295,10 +296,10 @@ BinomialOptionMultiGPU::setupCL()
             }
             */
 
-            // Create memory object for stock price
+            // Any device may end up with every option, size for all of them
             randBuffers[i] = clCreateBuffer(context,
                                             inMemFlags,
-                                            numSamplesPerGPU[i]/4 * sizeof(cl_float4),
+                                            samplesPerVectorWidth * sizeof(cl_float4),
                                             NULL,
                                             &status);
             CHECK_OPENCL_ERROR(status, "clCreateBuffer failed. (randBuffers[i])");
@@ -306,7 +307,7 @@ BinomialOptionMultiGPU::setupCL()
             // Create memory object for output array
             outputBuffers[i] = clCreateBuffer(context,
                                               CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR,
-                                              numSamplesPerGPU[i]/4 * sizeof(cl_float4),
+                                              samplesPerVectorWidth * sizeof(cl_float4),
                                               NULL,
                                               &status);
             CHECK_OPENCL_ERROR(status, "clCreateBuffer failed. (outputBuffers[i])");
@@ -638,91 +639,16 @@ int
 BinomialOptionMultiGPU::loadBalancing()
 {
     /**
-    * Calculating the peak GFlops of each device
+    * Every GPU and host worker takes groups of four options, one work-group
+    * each, from a shared queue. Chunk sizes follow the throughput each
+    * worker shows at run time, so no peak numbers are needed.
     **/
-
-    peakGflopsGPU = new cl_double[numGPUDevices];
-
-    CHECK_ALLOCATION(peakGflopsGPU, "Allocation failed(peakGflopGPU)");
-
-    cumulativeSumPerGPU = new cl_int[numGPUDevices];
-    CHECK_ALLOCATION(cumulativeSumPerGPU, "Allocation failed(cumulativeSumPerGPU)");
-
-    for (int i = 0; i < numGPUDevices; i++)
-    {
-        cl_int numComputeUnits = devicesInfo[i].maxComputeUnits;
-
-        cl_int maxClockFrequency = devicesInfo[i].maxClockFrequency;
-
-        char *deviceName = devicesInfo[i].name;
-
-        /**
-        * In cayman device we have four processing elements in a stream processor
-        **/
-        int numProcessingElts;
-        if (!strcmp(deviceName, "Cayman"))
-        {
-            numProcessingElts = 4;
-        }
-        else
-        {
-            numProcessingElts = 5;
-        }
-        /**
-        * We have 16 stream processors per compute unit and numProcessingelts number of
-        * processing elements in a stream processor. A processing elt can execute 2 floating point operations
-        * per cycle. So the peakGflops formula would be
-        *
-        *   peakGflops = numComputeUnits * numStreamProcessor per Compute Unit * numProcessingElt per stream processor
-        *                       * maxClockFrequency * num Floating Point operations per cycle per processing elt;
-        *                       We have to divide the result by 1000 to get the Gflops as freq is in MHz.
-        *
-        **/
-        peakGflopsGPU[i] = (numComputeUnits * 16 *
-                            numProcessingElts * maxClockFrequency * 2) / 1000;
-    }
-
-    //Work sharing
-    double totalPeakGflops = 0;//Sum of peakGflops of all the devices
-    for (int i = 0; i < numGPUDevices; i++)
-    {
-        totalPeakGflops += peakGflopsGPU[i];
-    }
-
-    /**
-    * ratios function will be used in load balancing statically
-    **/
-    double *ratios = new cl_double[numGPUDevices];
-    CHECK_ALLOCATION(ratios, "Allocation failed!!(ratios)");
-
-    numSamplesPerGPU = new cl_int[numGPUDevices];//Divison of input
-    CHECK_ALLOCATION(numSamplesPerGPU, "Allocation failed!!(numSamplesPerGPU)");
-
-    int cumulativeSumSamples = 0;
-
-    for (int i = 0; i < numGPUDevices; i++)
-    {
-        ratios[i] = peakGflopsGPU[i] / totalPeakGflops;
-        numSamplesPerGPU[i] = static_cast<cl_int>(numSamples * ratios[i]);
-        cumulativeSumSamples = cumulativeSumSamples + numSamplesPerGPU[i];
-        cumulativeSumPerGPU[i] = cumulativeSumSamples;
-
-        /**
-        * There can be possibility that some values are missed. To avoid, add the missing values to the last GPU
-        **/
-        if (i == numGPUDevices - 1 && cumulativeSumSamples < numSamples)
-        {
-            numSamplesPerGPU[i] = numSamplesPerGPU[i] +
-                                  (numSamples - cumulativeSumSamples);
-            cumulativeSumPerGPU[i] = numSamples;
-        }
-    }
-
-    if(ratios)
+    if(cpuWorkers < 0)
     {
-        delete []ratios;
-        ratios = NULL;
+        cpuWorkers = 0;
     }
+    scheduler.setWorkers(numGPUDevices + cpuWorkers);
+    scheduler.setChunking(chunkTime * 1e-3, 1);
 
     return SDK_SUCCESS;
 }
@@ -852,6 +778,36 @@ int BinomialOptionMultiGPU::initialize()
     delete num_iterations;
     num_iterations = NULL;
 
+    Option* cpu_workers = new Option;
+    CHECK_ALLOCATION(cpu_workers,
+                     "Error. Failed to allocate memory (cpu_workers)\n");
+
+    cpu_workers->_sVersion = "";
+    cpu_workers->_lVersion = "cpuworkers";
+    cpu_workers->_description =
+        "Number of host threads pricing options next to the GPUs (default 1)";
+    cpu_workers->_type = CA_ARG_INT;
+    cpu_workers->_value = &cpuWorkers;
+
+    sampleArgs->AddOption(cpu_workers);
+    delete cpu_workers;
+    cpu_workers = NULL;
+
+    Option* chunk_time = new Option;
+    CHECK_ALLOCATION(chunk_time,
+                     "Error. Failed to allocate memory (chunk_time)\n");
+
+    chunk_time->_sVersion = "";
+    chunk_time->_lVersion = "chunkms";
+    chunk_time->_description =
+        "Milliseconds a chunk of options should take on its worker (default 5)";
+    chunk_time->_type = CA_ARG_DOUBLE;
+    chunk_time->_value = &chunkTime;
+
+    sampleArgs->AddOption(chunk_time);
+    delete chunk_time;
+    chunk_time = NULL;
+
     return SDK_SUCCESS;
 }
 
@@ -876,279 +832,233 @@ int BinomialOptionMultiGPU::setup()
 /**
 * This structure is used in multi threading
 */
-struct dataPerGPU
+struct dataPerWorker
 {
     BinomialOptionMultiGPU *boObj;
-    int deviceNumber;
+    int workerNumber;
 };
 
-void* threadFuncPerGPU(void *data1)
+void* threadFuncPerWorker(void *data1)
 {
-    dataPerGPU *data = (dataPerGPU *)data1;
-    int deviceNumber = data->deviceNumber;
-    BinomialOptionMultiGPU *boObj = data->boObj;
-    cl_int status;
-    cl_event ndrEvt;
-    cl_int eventStatus = CL_QUEUED;
-
-    cl_event inMapEvt;
-    void* mapPtr = clEnqueueMapBuffer(boObj->commandQueues[deviceNumber],
-                                      boObj->randBuffers[deviceNumber],
-                                      CL_FALSE,
-                                      CL_MAP_WRITE,
-                                      0,
-                                      ((boObj->numSamplesPerGPU[deviceNumber])/4) * sizeof(cl_float4),
-                                      0,
-                                      NULL,
-                                      &inMapEvt,
-                                      &status);
-
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clEnqueueMapBuffer failed !!");
-
-    status = clFlush(boObj->commandQueues[deviceNumber]);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clFlush failed !!");
-
-    eventStatus = CL_QUEUED;
-    while(eventStatus != CL_COMPLETE)
+    dataPerWorker *data = (dataPerWorker *)data1;
+    if(data->boObj->runWorker(data->workerNumber) != SDK_SUCCESS)
     {
-        status = clGetEventInfo(
-                     inMapEvt,
-                     CL_EVENT_COMMAND_EXECUTION_STATUS,
-                     sizeof(cl_int),
-                     &eventStatus,
-                     NULL);
-        CHECK_OPENCL_ERROR_RETURN_NULL(status, "clGetEventInfo failed !!");
+        data->boObj->workerFailed = true;
     }
+    return NULL;
+}
 
-    status = clReleaseEvent(inMapEvt);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clReleaseEvent failed !!");
-
-    memcpy(mapPtr,
-           boObj->randArray + (boObj->cumulativeSumPerGPU[deviceNumber] -
-                               boObj->numSamplesPerGPU[deviceNumber]),
-           ((boObj->numSamplesPerGPU[deviceNumber])/4 * sizeof(cl_float4)));
-
-    cl_event inUnmapEvent;
-
-    status = clEnqueueUnmapMemObject(boObj->commandQueues[deviceNumber],
-                                     boObj->randBuffers[deviceNumber],
-                                     mapPtr,
-                                     0,
-                                     NULL,
-                                     &inUnmapEvent);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clEnqueueUnmapMemObject failed !!");
-
-    status = clFlush(boObj->commandQueues[deviceNumber]);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clFlush failed !!");
+int
+BinomialOptionMultiGPU::runWorker(int worker)
+{
+    cl_uint begin, count;
 
-    eventStatus = CL_QUEUED;
-    while(eventStatus != CL_COMPLETE)
+    if(worker >= numGPUDevices)
     {
-        status = clGetEventInfo(
-                     inUnmapEvent,
-                     CL_EVENT_COMMAND_EXECUTION_STATUS,
-                     sizeof(cl_int),
-                     &eventStatus,
-                     NULL);
-        CHECK_OPENCL_ERROR_RETURN_NULL(status, "clGetEventInfo failed !!");
+        std::vector<cl_float> scratch(4 * (numSteps + 1));
+        while(scheduler.acquire(worker, begin, count))
+        {
+            cl_double start = ChunkScheduler::now();
+            binomialOptionHost(begin, count, &scratch[0]);
+            scheduler.release(worker, count, ChunkScheduler::now() - start);
+        }
+        return SDK_SUCCESS;
     }
 
-    status = clReleaseEvent(inUnmapEvent);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clReleaseEvent failed !!");
+    cl_int status;
+    cl_kernel deviceKernel = kernels[worker];
 
     // Set appropriate arguments to the kernel
-    status = clSetKernelArg(boObj->kernels[deviceNumber],
-                            0,
-                            sizeof(int),
-                            (void*)&boObj->numSteps);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clSetKernelArg failed !!");
-
-    status = clSetKernelArg(boObj->kernels[deviceNumber],
-                            1,
-                            sizeof(cl_mem),
-                            (void*)&boObj->randBuffers[deviceNumber]);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clSetKernelArg failed !!");
+    status = clSetKernelArg(deviceKernel, 0, sizeof(int), (void*)&numSteps);
+    CHECK_OPENCL_ERROR(status, "clSetKernelArg(numSteps) failed.");
 
-    status = clSetKernelArg(boObj->kernels[deviceNumber],
-                            2,
-                            sizeof(cl_mem),
-                            (void*)&boObj->outputBuffers[deviceNumber]);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clSetKernelArg failed !!");
+    status = clSetKernelArg(deviceKernel, 1, sizeof(cl_mem), (void*)&randBuffers[worker]);
+    CHECK_OPENCL_ERROR(status, "clSetKernelArg(randBuffers) failed.");
 
-    status = clSetKernelArg(boObj->kernels[deviceNumber],
-                            3,
-                            (boObj->numSteps + 1) * sizeof(cl_float4),
-                            NULL);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clSetKernelArg failed !!");
+    status = clSetKernelArg(deviceKernel, 2, sizeof(cl_mem), (void*)&outputBuffers[worker]);
+    CHECK_OPENCL_ERROR(status, "clSetKernelArg(outputBuffers) failed.");
 
-    status = clSetKernelArg(boObj->kernels[deviceNumber],
-                            4,
-                            boObj->numSteps * sizeof(cl_float4),
-                            NULL);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clSetKernelArg failed !!");
+    status = clSetKernelArg(deviceKernel, 3, (numSteps + 1) * sizeof(cl_float4), NULL);
+    CHECK_OPENCL_ERROR(status, "clSetKernelArg(callA) failed.");
 
-    /**
-    * numsamples is divided amongst the available devices in loadBalancing function.
-    */
-    size_t globalThreads[] = {(boObj->numSamplesPerGPU[deviceNumber])/4 *
-                              (boObj->numSteps + 1)
-                             };
-    size_t localThreads[] = {boObj->numSteps + 1};
+    status = clSetKernelArg(deviceKernel, 4, numSteps * sizeof(cl_float4), NULL);
+    CHECK_OPENCL_ERROR(status, "clSetKernelArg(callB) failed.");
 
-    if(localThreads[0] > boObj->devicesInfo[deviceNumber].maxWorkItemSizes[0] ||
-            localThreads[0] > boObj->devicesInfo[deviceNumber].maxWorkGroupSize)
+    if((size_t)(numSteps + 1) > devicesInfo[worker].maxWorkItemSizes[0] ||
+            (size_t)(numSteps + 1) > devicesInfo[worker].maxWorkGroupSize)
     {
         std::cout << "Unsupported: Device does not support"
                   "requested number of work items.";
-        return NULL;
+        return SDK_FAILURE;
     }
 
-    status = clGetKernelWorkGroupInfo(boObj->kernels[deviceNumber],
-                                      boObj->gpuDeviceIDs[deviceNumber],
+    cl_ulong localMemory;
+    status = clGetKernelWorkGroupInfo(deviceKernel,
+                                      gpuDeviceIDs[worker],
                                       CL_KERNEL_LOCAL_MEM_SIZE,
                                       sizeof(cl_ulong),
-                                      &boObj->usedLocalMemory,
+                                      &localMemory,
                                       NULL);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clGetKernelWorkGroupInfo failed !!");
+    CHECK_OPENCL_ERROR(status, "clGetKernelWorkGroupInfo failed.");
 
-    if(boObj->usedLocalMemory > boObj->totalLocalMemory)
+    if(localMemory > devicesInfo[worker].localMemSize)
     {
         std::cout << "Unsupported: Insufficient local memory on device."
                   << std::endl;
-        return NULL;
+        return SDK_FAILURE;
     }
 
-
-    /**
-     * This algorithm reduces each group of work-items to a single value
-     * on OpenCL device
-     */
-    // Enqueue a kernel run call.
-    status = clEnqueueNDRangeKernel(
-                 boObj->commandQueues[deviceNumber],
-                 boObj->kernels[deviceNumber],
-                 1,
-                 NULL,
-                 globalThreads,
-                 localThreads,
-                 0,
-                 NULL,
-                 &ndrEvt);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clEnqueueNDRangeKernel failed !!");
-
-    status = clFlush(boObj->commandQueues[deviceNumber]);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clFlush failed !!");
-
-    eventStatus = CL_QUEUED;
-    while(eventStatus != CL_COMPLETE)
+    while(scheduler.acquire(worker, begin, count))
     {
-        status = clGetEventInfo(
-                     ndrEvt,
-                     CL_EVENT_COMMAND_EXECUTION_STATUS,
-                     sizeof(cl_int),
-                     &eventStatus,
-                     NULL);
-        CHECK_OPENCL_ERROR_RETURN_NULL(status, "clGetEventInfo failed !!");
+        cl_double start = ChunkScheduler::now();
+        status = runDeviceChunk(worker, begin, count);
+        scheduler.release(worker, count, ChunkScheduler::now() - start);
+        CHECK_ERROR(status, SDK_SUCCESS, "runDeviceChunk() failed");
     }
+    return SDK_SUCCESS;
+}
 
-    cl_event outMapEvt;
-    cl_uint* outMapPtr = (cl_uint*)clEnqueueMapBuffer(
-                             boObj->commandQueues[deviceNumber],
-                             boObj->outputBuffers[deviceNumber],
-                             CL_FALSE,
-                             CL_MAP_READ,
-                             0,
-                             ((boObj->numSamplesPerGPU[deviceNumber])/4) * sizeof(cl_float4),
-                             0,
-                             NULL,
-                             &outMapEvt,
-                             &status);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clEnqueueMapBuffer failed !!");
-
-    status = clFlush(boObj->commandQueues[deviceNumber]);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clFlush failed !!");
-
-    eventStatus = CL_QUEUED;
-    while(eventStatus != CL_COMPLETE)
-    {
-        status = clGetEventInfo(
-                     outMapEvt,
-                     CL_EVENT_COMMAND_EXECUTION_STATUS,
-                     sizeof(cl_int),
-                     &eventStatus,
-                     NULL);
-        CHECK_OPENCL_ERROR_RETURN_NULL(status, "clGetEventInfo failed !!");
-    }
+int
+BinomialOptionMultiGPU::runDeviceChunk(int device, cl_uint begin, cl_uint count)
+{
+    cl_int status;
 
-    status = clReleaseEvent(outMapEvt);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clReleaseEvent failed !!");
+    // In-order queue, the blocking read waits for the kernel
+    status = clEnqueueWriteBuffer(commandQueues[device],
+                                  randBuffers[device],
+                                  CL_FALSE,
+                                  0,
+                                  count * sizeof(cl_float4),
+                                  randArray + 4 * begin,
+                                  0,
+                                  NULL,
+                                  NULL);
+    CHECK_OPENCL_ERROR(status, "clEnqueueWriteBuffer(randBuffers) failed.");
+
+    size_t globalThreads[] = {(size_t)count * (numSteps + 1)};
+    size_t localThreads[] = {(size_t)(numSteps + 1)};
+
+    status = clEnqueueNDRangeKernel(commandQueues[device],
+                                    kernels[device],
+                                    1,
+                                    NULL,
+                                    globalThreads,
+                                    localThreads,
+                                    0,
+                                    NULL,
+                                    NULL);
+    CHECK_OPENCL_ERROR(status, "clEnqueueNDRangeKernel failed.");
+
+    status = clEnqueueReadBuffer(commandQueues[device],
+                                 outputBuffers[device],
+                                 CL_TRUE,
+                                 0,
+                                 count * sizeof(cl_float4),
+                                 output + 4 * begin,
+                                 0,
+                                 NULL,
+                                 NULL);
+    CHECK_OPENCL_ERROR(status, "clEnqueueReadBuffer(outputBuffers) failed.");
 
-    memcpy(boObj->output + ((boObj->cumulativeSumPerGPU[deviceNumber] -
-                             boObj->numSamplesPerGPU[deviceNumber])),
-           outMapPtr,
-           ((boObj->numSamplesPerGPU[deviceNumber])/4 * sizeof(cl_float4)));
+    return SDK_SUCCESS;
+}
 
-    cl_event outUnmapEvt;
-    status = clEnqueueUnmapMemObject(boObj->commandQueues[deviceNumber],
-                                     boObj->outputBuffers[deviceNumber],
-                                     (void*)outMapPtr,
-                                     0,
-                                     NULL,
-                                     &outUnmapEvt);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clEnqueueUnmapMemObject failed !!");
+void
+BinomialOptionMultiGPU::binomialOptionHost(cl_uint begin, cl_uint count,
+        cl_float *scratch)
+{
+    // Same arithmetic as binomial_options, the four lanes of a group at once
+    for(cl_uint bid = begin; bid < begin + count; bid++)
+    {
+        float s[4];
+        float x[4];
+        float vsdt[4];
+        float puByr[4];
+        float pdByr[4];
 
-    status = clFlush(boObj->commandQueues[deviceNumber]);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clFlush failed !!");
+        for(int i = 0; i < 4; ++i)
+        {
+            float inRand = randArray[4 * bid + i];
+            s[i] = (1.0f - inRand) * 5.0f + inRand * 30.f;
+            x[i] = (1.0f - inRand) * 1.0f + inRand * 100.f;
+            float optionYears = (1.0f - inRand) * 0.25f + inRand * 10.f;
+            float dt = optionYears * (1.0f / (float)numSteps);
+            vsdt[i] = VOLATILITY * sqrtf(dt);
+            float rdt = RISKFREE * dt;
+            float r = expf(rdt);
+            float rInv = 1.0f / r;
+            float u = expf(vsdt[i]);
+            float d = 1.0f / u;
+            float pu = (r - d)/(u - d);
+            float pd = 1.0f - pu;
+            puByr[i] = pu * rInv;
+            pdByr[i] = pd * rInv;
+        }
 
-    eventStatus = CL_QUEUED;
-    while(eventStatus != CL_COMPLETE)
-    {
-        status = clGetEventInfo(
-                     outUnmapEvt,
-                     CL_EVENT_COMMAND_EXECUTION_STATUS,
-                     sizeof(cl_int),
-                     &eventStatus,
-                     NULL);
-        CHECK_OPENCL_ERROR_RETURN_NULL(status, "clGetEventInfo failed !!");
-    }
+        for(int j = 0; j <= numSteps; j++)
+        {
+            for(int i = 0; i < 4; ++i)
+            {
+                float profit = s[i] * expf(vsdt[i] * (2.0f * j - numSteps)) - x[i];
+                scratch[j * 4 + i] = profit > 0.0f ? profit : 0.0f;
+            }
+        }
 
-    status = clReleaseEvent(outUnmapEvt);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clReleaseEvent failed !!");
+        __m128 pu = _mm_loadu_ps(puByr);
+        __m128 pd = _mm_loadu_ps(pdByr);
+        for(int j = numSteps; j > 0; --j)
+        {
+            __m128 lo = _mm_loadu_ps(scratch);
+            for(int k = 0; k < j; ++k)
+            {
+                __m128 hi = _mm_loadu_ps(scratch + 4 * (k + 1));
+                _mm_storeu_ps(scratch + 4 * k, _mm_add_ps(_mm_mul_ps(pu, lo), _mm_mul_ps(pd, hi)));
+                lo = hi;
+            }
+        }
 
-    // Release NDR event
-    status = clReleaseEvent(ndrEvt);
-    CHECK_OPENCL_ERROR_RETURN_NULL(status, "clReleaseEvent failed !!");
-    return NULL;
+        _mm_storeu_ps(output + 4 * bid, _mm_loadu_ps(scratch));
+    }
 }
 
 int
 BinomialOptionMultiGPU::runCLKernelsMultiGPU()
 {
-    SDKThread *threads = new SDKThread[numGPUDevices];
+    int numWorkers = numGPUDevices + cpuWorkers;
+    SDKThread *threads = new SDKThread[numWorkers];
     CHECK_ALLOCATION(threads, "Allocation failed!!");
 
     /**
-    * Creating one thread per GPU
+    * Creating one thread per GPU and per host worker, all of them pull
+    * groups of options from the scheduler
     */
-    dataPerGPU *data = new dataPerGPU[numGPUDevices];
-    for (int i = 0 ; i < numGPUDevices; i++)
+    workerFailed = false;
+    scheduler.start(samplesPerVectorWidth);
+    dataPerWorker *data = new dataPerWorker[numWorkers];
+    for (int i = 0 ; i < numWorkers; i++)
     {
-        data[i].deviceNumber = i;
+        data[i].workerNumber = i;
         data[i].boObj = this;
-        threads[i].create(threadFuncPerGPU,
+        threads[i].create(threadFuncPerWorker,
                           (void *) &data[i]);
     }
     /**
     * Call join() function for synchronization
     * Main thread will wait for each thread to get completed.
     */
-    for (int i = 0; i < numGPUDevices; i++)
+    for (int i = 0; i < numWorkers; i++)
     {
         threads[i].join();
     }
+    scheduler.stop();
 
     delete []data;
     delete []threads;
+
+    if(workerFailed)
+    {
+        return SDK_FAILURE;
+    }
     return SDK_SUCCESS;
 }
 
@@ -1173,6 +1083,9 @@ int BinomialOptionMultiGPU::run()
     std::cout << "-------------------------------------------"
               << std::endl;
 
+    // Throughputs measured in the warm up are kept, the statistics are not
+    scheduler.resetStats();
+
     int timer = sampleTimer->createTimer();
     sampleTimer->resetTimer(timer);
     sampleTimer->startTimer(timer);
@@ -1257,6 +1170,31 @@ void BinomialOptionMultiGPU::printStats()
         printStatistics(strArray,
                         stats,
                         4);
+
+        if(!noMultiGPUSupport)
+        {
+            // Per worker share of the timed iterations
+            std::vector<std::string> workerStrArray;
+            std::vector<std::string> workerStats;
+            cl_double wall = scheduler.getWallTime();
+            for(int i = 0; i < numGPUDevices + cpuWorkers; i++)
+            {
+                std::string name = i < numGPUDevices ?
+                                   std::string(devicesInfo[i].name) + " " + toString(i, std::dec) :
+                                   "Host worker " + toString(i - numGPUDevices, std::dec);
+                workerStrArray.push_back(name + " options");
+                workerStats.push_back(toString(4 * scheduler.getItems(i), std::dec));
+                workerStrArray.push_back(name + " chunks");
+                workerStats.push_back(toString(scheduler.getChunks(i), std::dec));
+                workerStrArray.push_back(name + " utilization(%)");
+                workerStats.push_back(toString(wall > 0 ?
+                                               100 * scheduler.getBusyTime(i) / wall : 0, std::dec));
+                workerStrArray.push_back(name + " idle(sec)");
+                workerStats.push_back(toString(scheduler.getIdleTime(i), std::dec));
+            }
+
+            printStatistics(&workerStrArray[0], &workerStats[0], (int)workerStats.size());
+        }
     }
 }
 
@@ -1349,24 +1287,6 @@ BinomialOptionMultiGPU::~BinomialOptionMultiGPU()
             commandQueues = NULL;
         }
 
-        if(peakGflopsGPU)
-        {
-            delete []peakGflopsGPU;
-            peakGflopsGPU = NULL;
-        }
-
-        if(cumulativeSumPerGPU)
-        {
-            delete []cumulativeSumPerGPU;
-            cumulativeSumPerGPU = NULL;
-        }
-
-        if(numSamplesPerGPU)
-        {
-            delete []numSamplesPerGPU;
-            numSamplesPerGPU = NULL;
-        }
-
         if(randBuffers)
         {
             delete []randBuffers;
@@ -30,6 +30,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "CLUtil.hpp"
 #include "SDKThread.hpp"
+#include "ChunkScheduler.hpp"
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -96,19 +97,19 @@ class BinomialOptionMultiGPU
         cl_command_queue *commandQueues;        /**< Array to store command queues*/
         cl_kernel *kernels;                     /**< Array of kernels**/
         cl_program *programs;                   /**< Array of programs**/
-        cl_double *peakGflopsGPU;               /**< Peak Gflops of a GPU device */
-        cl_int *numSamplesPerGPU;               /**< Array to store the input range for all the devices after
-                                            the work is divided amonst the gpuss*/
         cl_mem *randBuffers;                    /**< Array to store input mem buffers for all devices */
         cl_mem *outputBuffers;                  /**< Array to store mem buffers for all devices */
         SDKDeviceInfo
         *devicesInfo;                           /**< Array to store the device information */
-        cl_int *cumulativeSumPerGPU;            /**< Array to store sumulative sum*/
         SDKDeviceInfo
         deviceInfo;                             /**< Structure to store device information*/
         KernelWorkGroupInfo
         kernelWorkGroupInfo;                    /**< Structure to store kernel related info */
         SDKTimer    *sampleTimer;               /**< SDKTimer object */
+        int cpuWorkers;                         /**< Host threads pulling options next to the GPUs */
+        cl_double chunkTime;                    /**< Milliseconds a chunk of options should take */
+        ChunkScheduler scheduler;               /**< Queue of option groups shared by all workers */
+        bool workerFailed;                      /**< Set by a worker that hit an error */
     private:
 
         /**
@@ -143,12 +144,12 @@ class BinomialOptionMultiGPU
             programs = NULL;
             commandQueues = NULL;
             outputBuffers = NULL;
-            peakGflopsGPU = NULL;
-            numSamplesPerGPU = NULL;
             randBuffers = NULL;
             devicesInfo = NULL;
             gpuDeviceIDs = NULL;
-            cumulativeSumPerGPU = NULL;
+            cpuWorkers = 1;
+            chunkTime = 5.0;
+            workerFailed = false;
             sampleArgs = new CLCommandArgs() ;
             sampleTimer = new SDKTimer();
             sampleArgs->sampleVerStr = SAMPLE_VERSION;
@@ -238,11 +239,33 @@ class BinomialOptionMultiGPU
 
         /**
         * Function: loadBalancing()
-        * calculates the peak Gflops for each device and shares the work accordingly.
+        * sets up the queue the GPUs and the host workers take their options from.
          * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         **/
         int loadBalancing();
 
+        /**
+        * Function: runWorker
+        * takes chunks of option groups from the scheduler until none is left.
+        * Workers below numGPUDevices run on that GPU, the others on the host.
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        **/
+        int runWorker(int worker);
+
+        /**
+        * Function: runDeviceChunk
+        * prices option groups [begin, begin + count) on a GPU
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        **/
+        int runDeviceChunk(int device, cl_uint begin, cl_uint count);
+
+        /**
+        * Function: binomialOptionHost
+        * prices option groups [begin, begin + count) on the host like the kernel,
+        * scratch holds numSteps + 1 float4
+        **/
+        void binomialOptionHost(cl_uint begin, cl_uint count, cl_float *scratch);
+
         /**
         * Function: runCLKernelsMultiGPU
         * running kernels for MultiGPU
@@ -0,0 +1,155 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "ChunkScheduler.hpp"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/*
+ * Weight of the newest chunk in the throughput of a worker
+ */
+#define RATE_WEIGHT 0.5
+
+cl_double
+ChunkScheduler::now()
+{
+#ifdef _WIN32
+    long long freq, count;
+    QueryPerformanceFrequency((LARGE_INTEGER*)&freq);
+    QueryPerformanceCounter((LARGE_INTEGER*)&count);
+    return (cl_double)count / freq;
+#else
+    struct timespec s;
+    clock_gettime(CLOCK_MONOTONIC, &s);
+    return s.tv_sec + s.tv_nsec * 1e-9;
+#endif
+}
+
+void
+ChunkScheduler::setWorkers(cl_uint numWorkers)
+{
+    Worker w = {0, 0, 0, 0, 0, 0};
+    workers.assign(numWorkers, w);
+    wallTime = 0;
+}
+
+void
+ChunkScheduler::setChunking(cl_double seconds, cl_uint minItems)
+{
+    targetTime = seconds > 0 ? seconds : 0.005;
+    minChunk = std::max(minItems, 1u);
+}
+
+void
+ChunkScheduler::resetStats()
+{
+    for(size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].chunks = 0;
+        workers[i].items = 0;
+        workers[i].busy = 0;
+        workers[i].idle = 0;
+    }
+    wallTime = 0;
+}
+
+void
+ChunkScheduler::start(cl_uint numItems)
+{
+    total = numItems;
+    next = 0;
+    for(size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].runBusy = 0;
+    }
+    runStart = now();
+}
+
+bool
+ChunkScheduler::acquire(cl_uint worker, cl_uint &begin, cl_uint &count)
+{
+    lock.lock();
+    cl_uint remaining = total - next;
+    if(remaining == 0)
+    {
+        lock.unlock();
+        return false;
+    }
+
+    cl_uint numWorkers = (cl_uint)workers.size();
+    cl_double rate = workers[worker].rate;
+    cl_double size;
+    if(rate == 0)
+    {
+        // Probe with a small share until the worker is measured
+        size = (cl_double)total / (8 * numWorkers);
+    }
+    else
+    {
+        // Unmeasured workers count with the mean of the measured ones
+        cl_double sum = 0;
+        cl_uint measured = 0;
+        for(cl_uint i = 0; i < numWorkers; i++)
+        {
+            sum += workers[i].rate;
+            measured += workers[i].rate > 0;
+        }
+        sum += (numWorkers - measured) * sum / measured;
+
+        cl_double share = remaining * rate / sum;
+        size = std::min(rate * targetTime, share / 2);
+    }
+
+    count = (cl_uint)std::min((cl_double)remaining, std::max(size, (cl_double)minChunk));
+    begin = next;
+    next += count;
+    lock.unlock();
+    return true;
+}
+
+void
+ChunkScheduler::release(cl_uint worker, cl_uint count, cl_double seconds)
+{
+    lock.lock();
+    Worker &w = workers[worker];
+    if(seconds > 0)
+    {
+        cl_double rate = count / seconds;
+        w.rate = w.rate == 0 ? rate : (1 - RATE_WEIGHT) * w.rate + RATE_WEIGHT * rate;
+    }
+    w.chunks++;
+    w.items += count;
+    w.busy += seconds;
+    w.runBusy += seconds;
+    lock.unlock();
+}
+
+void
+ChunkScheduler::stop()
+{
+    cl_double wall = now() - runStart;
+    wallTime += wall;
+    for(size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].idle += std::max(wall - workers[i].runBusy, 0.0);
+    }
+}
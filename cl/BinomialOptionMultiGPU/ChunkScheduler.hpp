@@ -0,0 +1,150 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef CHUNKSCHEDULER_H_
+#define CHUNKSCHEDULER_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * ChunkScheduler
+ * Class implements a shared queue of work items that workers of different
+ * speed drain in chunks. Every worker's throughput is measured on each of
+ * its chunks and kept across runs. A worker is handed what it processes
+ * in the target time per chunk, capped at half of its throughput share of
+ * what is left, so chunks shrink towards the end and all workers finish
+ * together. Busy and idle time are recorded per worker.
+ */
+class ChunkScheduler
+{
+        /**
+         * Per worker measurements
+         */
+        struct Worker
+        {
+            cl_double rate;             /**< Items per second, 0 until measured */
+            cl_uint chunks;             /**< Chunks processed since resetStats() */
+            cl_uint items;              /**< Items processed since resetStats() */
+            cl_double busy;             /**< Seconds spent on chunks since resetStats() */
+            cl_double runBusy;          /**< Seconds spent on chunks in this run */
+            cl_double idle;             /**< Seconds without a chunk since resetStats() */
+        };
+
+        ThreadLock lock;                /**< Protects every member below */
+        std::vector<Worker> workers;    /**< Measurements of every worker */
+        cl_uint total;                  /**< Items of the current run */
+        cl_uint next;                   /**< First item not handed out yet */
+        cl_uint minChunk;               /**< Smallest chunk handed out */
+        cl_double targetTime;           /**< Seconds a chunk should take */
+        cl_double runStart;             /**< Start of the current run */
+        cl_double wallTime;             /**< Seconds of the runs since resetStats() */
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        ChunkScheduler()
+            : total(0),
+              next(0),
+              minChunk(1),
+              targetTime(0.005),
+              runStart(0),
+              wallTime(0)
+        {
+        }
+
+        /**
+         * Sets the number of workers, forgets every measurement
+         */
+        void setWorkers(cl_uint numWorkers);
+
+        /**
+         * Sets the time a chunk should take and the smallest chunk
+         */
+        void setChunking(cl_double seconds, cl_uint minItems);
+
+        /**
+         * Clears the per worker statistics, the throughputs are kept
+         */
+        void resetStats();
+
+        /**
+         * Starts a run over items [0, numItems)
+         */
+        void start(cl_uint numItems);
+
+        /**
+         * Hands out the next chunk to a worker
+         * @param worker index of the worker
+         * @param begin first item of the chunk
+         * @param count items in the chunk
+         * @return false once every item is handed out
+         */
+        bool acquire(cl_uint worker, cl_uint &begin, cl_uint &count);
+
+        /**
+         * Records that a worker processed count items in seconds
+         */
+        void release(cl_uint worker, cl_uint count, cl_double seconds);
+
+        /**
+         * Ends the run started by start(), after every worker returned
+         */
+        void stop();
+
+        /**
+         * Statistics of a worker since resetStats()
+         */
+        cl_uint getChunks(cl_uint worker) const
+        {
+            return workers[worker].chunks;
+        }
+        cl_uint getItems(cl_uint worker) const
+        {
+            return workers[worker].items;
+        }
+        cl_double getBusyTime(cl_uint worker) const
+        {
+            return workers[worker].busy;
+        }
+        cl_double getIdleTime(cl_uint worker) const
+        {
+            return workers[worker].idle;
+        }
+        cl_double getRate(cl_uint worker) const
+        {
+            return workers[worker].rate;
+        }
+        cl_double getWallTime() const
+        {
+            return wallTime;
+        }
+
+        /**
+         * Wall clock in seconds, with sub-microsecond resolution
+         */
+        static cl_double now();
+};
+
+#endif
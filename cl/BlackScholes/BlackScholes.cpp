@@ -59,6 +59,62 @@ BlackScholes::phi(float X)
     return (X < 0) ? (1.0f - y) : y;
 }
 
+/*
+ * Black-Scholes call price in double precision with the libm erfc(), the
+ * Greeks of the host pricer are checked against its finite differences
+ */
+static double
+callPriceDouble(double s, double k, double t, double r, double sigma)
+{
+    const double sqrt1_2 = 0.70710678118654752;
+    double sigmaSqrtT = sigma * sqrt(t);
+    double d1 = (log(s / k) + (r + 0.5 * sigma * sigma) * t) / sigmaSqrtT;
+    double d2 = d1 - sigmaSqrtT;
+    return 0.5 * (s * erfc(-d1 * sqrt1_2) - k * exp(-r * t) * erfc(-d2 * sqrt1_2));
+}
+
+bool
+BlackScholes::verifyGreeks()
+{
+    // A few options spread over the book, central differences in double
+    const cl_uint checks = 16;
+    for(cl_uint c = 0; c < checks; c++)
+    {
+        cl_uint j = (cl_uint)(((cl_ulong)book.count * c) / checks);
+        double s = book.spot[j];
+        double k = book.strike[j];
+        double t = book.expiry[j];
+        double r = book.rate[j];
+        double sigma = book.volatility[j];
+
+        double hs = 1e-4 * s;
+        double hv = 1e-4 * sigma;
+        double delta = (callPriceDouble(s + hs, k, t, r, sigma) -
+                        callPriceDouble(s - hs, k, t, r, sigma)) / (2.0 * hs);
+        double vega = (callPriceDouble(s, k, t, r, sigma + hv) -
+                       callPriceDouble(s, k, t, r, sigma - hv)) / (2.0 * hv);
+
+        // Put-call parity gives the put delta, vega is the same for both
+        double expected[3] = {delta, delta - 1.0, vega};
+        cl_float *actual[3] = {bookResults.callDelta, bookResults.putDelta,
+                               bookResults.vega
+                              };
+        const char *names[3] = {"call delta", "put delta", "vega"};
+        for(int g = 0; g < 3; g++)
+        {
+            double scale = fabs(expected[g]) > 1.0 ? fabs(expected[g]) : 1.0;
+            if(fabs(actual[g][j] - expected[g]) > 1e-3 * scale)
+            {
+                std::cout << "Host pricer " << names[g] << " of option " << j
+                          << " is " << actual[g][j] << ", finite difference gives "
+                          << expected[g] << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 void
 BlackScholes::blackScholesCPU()
 {
@@ -140,6 +196,43 @@ BlackScholes::setupBlackScholes()
                      "Failed to allocate host memory. (hostPutPrice)");
     memset(hostPutPrice, 0, width * height * sizeof(cl_float4));
 
+    if(hostBook)
+    {
+        // Same options as blackScholesCPU(), stored as one array per input
+        cl_uint count = width * height * 4;
+        bookInputs.resize(5 * count);
+        bookOutputs.assign(10 * count, 0.0f);
+        for(cl_uint j = 0; j < count; j++)
+        {
+            float u = randArray[j];
+            bookInputs[j] = S_LOWER_LIMIT * u + S_UPPER_LIMIT * (1.0f - u);
+            bookInputs[count + j] = K_LOWER_LIMIT * u + K_UPPER_LIMIT * (1.0f - u);
+            bookInputs[2 * count + j] = T_LOWER_LIMIT * u + T_UPPER_LIMIT * (1.0f - u);
+            bookInputs[3 * count + j] = R_LOWER_LIMIT * u + R_UPPER_LIMIT * (1.0f - u);
+            bookInputs[4 * count + j] = SIGMA_LOWER_LIMIT * u + SIGMA_UPPER_LIMIT * (1.0f - u);
+        }
+
+        book.count = count;
+        book.spot = &bookInputs[0];
+        book.strike = &bookInputs[count];
+        book.expiry = &bookInputs[2 * count];
+        book.rate = &bookInputs[3 * count];
+        book.volatility = &bookInputs[4 * count];
+
+        cl_float **results[10] =
+        {
+            &bookResults.callPrice, &bookResults.putPrice,
+            &bookResults.callDelta, &bookResults.putDelta,
+            &bookResults.gamma, &bookResults.vega,
+            &bookResults.callTheta, &bookResults.putTheta,
+            &bookResults.callRho, &bookResults.putRho
+        };
+        for(int r = 0; r < 10; r++)
+        {
+            *results[r] = &bookOutputs[r * count];
+        }
+    }
+
     return SDK_SUCCESS;
 }
 
@@ -498,6 +591,24 @@ BlackScholes::initialize()
 
     sampleArgs->AddOption(num_samples);
 
+    num_samples->_sVersion = "";
+    num_samples->_lVersion = "hostbook";
+    num_samples->_description =
+        "Also price the options and their Greeks with the host SIMD pricer";
+    num_samples->_type = CA_NO_ARGUMENT;
+    num_samples->_value = &hostBook;
+
+    sampleArgs->AddOption(num_samples);
+
+    num_samples->_sVersion = "";
+    num_samples->_lVersion = "threads";
+    num_samples->_description =
+        "Number of host threads of the host pricer (0 uses every core)";
+    num_samples->_type = CA_ARG_INT;
+    num_samples->_value = &cpuThreads;
+
+    sampleArgs->AddOption(num_samples);
+
     delete num_samples;
 
     return SDK_SUCCESS;
@@ -575,6 +686,59 @@ BlackScholes::run()
                              width,
                              1);
     }
+
+    if(hostBook)
+    {
+        if(runHostPricer() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+    }
+    return SDK_SUCCESS;
+}
+
+int
+BlackScholes::runHostPricer()
+{
+    hostPricer.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+    OptionResults prices = bookResults;
+    prices.callDelta = NULL;
+    prices.putDelta = NULL;
+    prices.gamma = NULL;
+    prices.vega = NULL;
+    prices.callTheta = NULL;
+    prices.putTheta = NULL;
+    prices.callRho = NULL;
+    prices.putRho = NULL;
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+    for(int i = 0; i < iterations; i++)
+    {
+        int status = hostPricer.price(book, prices);
+        CHECK_ERROR(status, SDK_SUCCESS, "OptionPricer::price() failed");
+    }
+    sampleTimer->stopTimer(timer);
+    hostPriceTime = (double)(sampleTimer->readTimer(timer)) / iterations;
+
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+    for(int i = 0; i < iterations; i++)
+    {
+        int status = hostPricer.price(book, bookResults);
+        CHECK_ERROR(status, SDK_SUCCESS, "OptionPricer::price() failed");
+    }
+    sampleTimer->stopTimer(timer);
+    hostGreeksTime = (double)(sampleTimer->readTimer(timer)) / iterations;
+
+    if(!sampleArgs->quiet)
+    {
+        printArray<cl_float>("hostBookCallPrice", bookResults.callPrice, width, 1);
+        printArray<cl_float>("hostBookCallDelta", bookResults.callDelta, width, 1);
+        printArray<cl_float>("hostBookVega", bookResults.vega, width, 1);
+    }
     return SDK_SUCCESS;
 }
 
@@ -608,6 +772,18 @@ BlackScholes::verifyResults()
         bool putPriceResult = compare(hostPutPrice, devicePutPrice, width * height * 4,
                                       1e-4f);
 
+        if(hostBook)
+        {
+            // The host pricer uses its own exp, log and normal distribution
+            callPriceResult = callPriceResult &&
+                              compare(hostCallPrice, bookResults.callPrice,
+                                      width * height * 4, 1e-4f);
+            putPriceResult = putPriceResult &&
+                             compare(hostPutPrice, bookResults.putPrice,
+                                     width * height * 4, 1e-4f);
+            callPriceResult = callPriceResult && verifyGreeks();
+        }
+
         if(!(callPriceResult ? (putPriceResult ? true : false) : false))
         {
             std::cout << "Failed\n" << std::endl;
@@ -648,6 +824,24 @@ BlackScholes::printStats()
 
         printStatistics(strArray, stats, 4);
 
+        if(hostBook)
+        {
+            std::string hostStrArray[4] =
+            {
+                "Host prices time(sec)",
+                "Host prices options/sec",
+                "Host prices+Greeks time(sec)",
+                "Host prices+Greeks options/sec"
+            };
+
+            std::string hostStats[4];
+            hostStats[0] = toString(hostPriceTime, std::dec);
+            hostStats[1] = toString(hostPriceTime > 0 ? actualSamples / hostPriceTime : 0, std::dec);
+            hostStats[2] = toString(hostGreeksTime, std::dec);
+            hostStats[3] = toString(hostGreeksTime > 0 ? actualSamples / hostGreeksTime : 0, std::dec);
+
+            printStatistics(hostStrArray, hostStats, 4);
+        }
     }
 }
 
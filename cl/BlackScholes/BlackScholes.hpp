@@ -23,7 +23,10 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <assert.h>
 #include <string.h>
 
+#include <vector>
+
 #include "CLUtil.hpp"
+#include "OptionPricer.hpp"
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -67,6 +70,16 @@ class BlackScholes
         KernelWorkGroupInfo kernelInfo; /**< Structure to store KernelworkGroupInfo */
         SDKTimer    *sampleTimer;       /**< SDKTimer object */
 
+        bool hostBook;                  /**< Also price the options with the host SIMD pricer */
+        int cpuThreads;                 /**< Host threads, 0 uses every core */
+        OptionPricer hostPricer;        /**< Multi-threaded SSE2 pricer with Greeks */
+        std::vector<cl_float> bookInputs;  /**< Spot, strike, expiry, rate and volatility arrays */
+        std::vector<cl_float> bookOutputs; /**< Prices and Greeks arrays of the host pricer */
+        OptionBook book;                /**< Views of bookInputs */
+        OptionResults bookResults;      /**< Views of bookOutputs */
+        cl_double hostPriceTime;        /**< time taken by the host pricer, prices only */
+        cl_double hostGreeksTime;       /**< time taken by the host pricer, prices and Greeks */
+
     public:
 
         CLCommandArgs   *sampleArgs;    /**< CLCommand argument class */
@@ -88,7 +101,11 @@ class BlackScholes
              devices(NULL),
              maxWorkItemSizes(NULL),
              iterations(1),
-             useScalarKernel(false)
+             useScalarKernel(false),
+             hostBook(false),
+             cpuThreads(0),
+             hostPriceTime(0),
+             hostGreeksTime(0)
         {
             width = 64;
             height = 64;
@@ -185,6 +202,13 @@ class BlackScholes
          */
         int verifyResults();
 
+        /**
+         * Prices the options with the host pricer, with and without
+         * the Greeks, and times both
+         * @return SDK_SUCCESS on success and nonzero on failure
+         */
+        int runHostPricer();
+
     private:
 
         //  Abromowitz Stegun approxmimation for PHI on the CPU(Cumulative Normal Distribution Function)
@@ -193,5 +217,8 @@ class BlackScholes
         //  CPU version of black scholes
         void blackScholesCPU();
 
+        //  Checks delta and vega of the host pricer against finite differences
+        bool verifyGreeks();
+
 };
 #endif
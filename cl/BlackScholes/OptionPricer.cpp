@@ -0,0 +1,272 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "OptionPricer.hpp"
+#include <algorithm>
+#include <emmintrin.h>
+
+/*
+ * Options below which another thread does not pay off
+ */
+#define MIN_OPTIONS_PER_THREAD 8192
+
+/**
+ * Arguments of the pricing threads
+ */
+struct OptionPricer::rangeArgs
+{
+    const OptionBook *book;
+    const OptionResults *results;
+};
+
+/*
+ * exp(x) of four floats, x is clamped to the normal float range
+ */
+static inline __m128 expPs(__m128 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.3f)), _mm_set1_ps(88.3f));
+
+    // x = n * ln2 + r with |r| <= ln2 / 2
+    __m128i n = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)));
+    __m128 fn = _mm_cvtepi32_ps(n);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(fn, _mm_set1_ps(0.693359375f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(fn, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 y = _mm_set1_ps(1.9875691500e-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.3981999507e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(8.3334519073e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(4.1665795894e-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.6666665459e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(5.0000001201e-1f));
+    y = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, r), r), _mm_add_ps(r, _mm_set1_ps(1.0f)));
+
+    // 2^n built in the exponent field
+    __m128i e = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(e));
+}
+
+/*
+ * log(x) of four positive normal floats
+ */
+static inline __m128 logPs(__m128 x)
+{
+    // x = 2^e * m with m in [sqrt(0.5), sqrt(2))
+    __m128i xi = _mm_castps_si128(x);
+    __m128i e = _mm_sub_epi32(_mm_srli_epi32(xi, 23), _mm_set1_epi32(126));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(xi, _mm_set1_epi32(0x007fffff)),
+                                             _mm_set1_epi32(0x3f000000)));
+    __m128 fe = _mm_cvtepi32_ps(e);
+
+    __m128 small = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+    fe = _mm_sub_ps(fe, _mm_and_ps(small, _mm_set1_ps(1.0f)));
+    m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(small, m)), _mm_set1_ps(1.0f));
+
+    __m128 z = _mm_mul_ps(m, m);
+    __m128 y = _mm_set1_ps(7.0376836292e-2f);
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+    y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+    y = _mm_add_ps(y, _mm_mul_ps(fe, _mm_set1_ps(-2.12194440e-4f)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    return _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(fe, _mm_set1_ps(0.693359375f)));
+}
+
+/*
+ * Standard normal distribution N(x) given the density pdf = exp(-x*x/2)/sqrt(2pi).
+ * N(-x) is written to mirrored without the cancellation of 1 - N(x).
+ */
+static inline __m128 cndPs(__m128 x, __m128 pdf, __m128 &mirrored)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 absX = _mm_andnot_ps(signMask, x);
+    __m128 t = _mm_div_ps(_mm_set1_ps(1.0f),
+                          _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.2316419f), absX)));
+
+    __m128 p = _mm_set1_ps(1.330274429f);
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(-1.821255978f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(1.781477937f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(-0.356563782f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(0.319381530f));
+    __m128 tail = _mm_mul_ps(pdf, _mm_mul_ps(p, t));
+
+    // tail is N(-|x|), mirror it for positive x
+    __m128 positive = _mm_cmpgt_ps(x, _mm_setzero_ps());
+    __m128 body = _mm_sub_ps(_mm_set1_ps(1.0f), tail);
+    mirrored = _mm_or_ps(_mm_and_ps(positive, tail), _mm_andnot_ps(positive, body));
+    return _mm_or_ps(_mm_and_ps(positive, body), _mm_andnot_ps(positive, tail));
+}
+
+/*
+ * Prices and Greeks of four options. in holds the spot, strike, expiry,
+ * rate and volatility vectors; out receives the ten results in the order
+ * of OptionResults.
+ */
+static inline void priceFour(const __m128 *in, __m128 *out, bool greeks)
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 invSqrt2Pi = _mm_set1_ps(0.398942280401432678f);
+
+    __m128 s = in[0];
+    __m128 k = in[1];
+    __m128 t = in[2];
+    __m128 r = in[3];
+    __m128 sigma = in[4];
+
+    __m128 sqrtT = _mm_sqrt_ps(t);
+    __m128 sigmaSqrtT = _mm_mul_ps(sigma, sqrtT);
+    __m128 drift = _mm_mul_ps(_mm_add_ps(r, _mm_mul_ps(half, _mm_mul_ps(sigma, sigma))), t);
+    __m128 d1 = _mm_div_ps(_mm_add_ps(logPs(_mm_div_ps(s, k)), drift), sigmaSqrtT);
+    __m128 d2 = _mm_sub_ps(d1, sigmaSqrtT);
+
+    __m128 pdf1 = _mm_mul_ps(invSqrt2Pi, expPs(_mm_mul_ps(_mm_set1_ps(-0.5f), _mm_mul_ps(d1, d1))));
+    __m128 pdf2 = _mm_mul_ps(invSqrt2Pi, expPs(_mm_mul_ps(_mm_set1_ps(-0.5f), _mm_mul_ps(d2, d2))));
+    __m128 nMinusD1, nMinusD2;
+    __m128 nd1 = cndPs(d1, pdf1, nMinusD1);
+    __m128 nd2 = cndPs(d2, pdf2, nMinusD2);
+
+    __m128 discount = expPs(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(r, t)));
+    __m128 kDisc = _mm_mul_ps(k, discount);
+
+    out[0] = _mm_sub_ps(_mm_mul_ps(s, nd1), _mm_mul_ps(kDisc, nd2));
+    out[1] = _mm_sub_ps(_mm_mul_ps(kDisc, nMinusD2), _mm_mul_ps(s, nMinusD1));
+    if(!greeks)
+    {
+        return;
+    }
+
+    __m128 sPdf1 = _mm_mul_ps(s, pdf1);
+    __m128 decay = _mm_div_ps(_mm_mul_ps(sPdf1, sigma), _mm_add_ps(sqrtT, sqrtT));
+    __m128 rkDisc = _mm_mul_ps(r, kDisc);
+    __m128 tkDisc = _mm_mul_ps(t, kDisc);
+
+    out[2] = nd1;
+    out[3] = _mm_sub_ps(_mm_setzero_ps(), nMinusD1);
+    out[4] = _mm_div_ps(pdf1, _mm_mul_ps(s, sigmaSqrtT));
+    out[5] = _mm_mul_ps(sPdf1, sqrtT);
+    out[6] = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(decay, _mm_mul_ps(rkDisc, nd2)));
+    out[7] = _mm_sub_ps(_mm_mul_ps(rkDisc, nMinusD2), decay);
+    out[8] = _mm_mul_ps(tkDisc, nd2);
+    out[9] = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(tkDisc, nMinusD2));
+}
+
+void
+OptionPricer::priceThread(void *data, unsigned int begin, unsigned int end,
+                          unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const OptionBook &book = *args->book;
+    const OptionResults &res = *args->results;
+
+    const cl_float *inputs[5] =
+    {
+        book.spot, book.strike, book.expiry, book.rate, book.volatility
+    };
+    cl_float *outputs[10] =
+    {
+        res.callPrice, res.putPrice, res.callDelta, res.putDelta, res.gamma,
+        res.vega, res.callTheta, res.putTheta, res.callRho, res.putRho
+    };
+    const bool greeks = res.callDelta != NULL;
+    const int numOutputs = greeks ? 10 : 2;
+
+    __m128 in[5];
+    __m128 out[10];
+
+    // begin and end count groups of four options
+    unsigned int i = 4 * begin;
+    unsigned int last = std::min(4 * end, book.count);
+    for(; i + 4 <= last; i += 4)
+    {
+        for(int p = 0; p < 5; p++)
+        {
+            in[p] = _mm_loadu_ps(inputs[p] + i);
+        }
+        priceFour(in, out, greeks);
+        for(int p = 0; p < numOutputs; p++)
+        {
+            _mm_storeu_ps(outputs[p] + i, out[p]);
+        }
+    }
+
+    if(i < last)
+    {
+        // Pad the last group with copies of its first option
+        cl_float lanes[10][4];
+        for(int p = 0; p < 5; p++)
+        {
+            for(unsigned int l = 0; l < 4; l++)
+            {
+                lanes[p][l] = inputs[p][i + l < last ? i + l : i];
+            }
+            in[p] = _mm_loadu_ps(lanes[p]);
+        }
+        priceFour(in, out, greeks);
+        for(int p = 0; p < numOutputs; p++)
+        {
+            _mm_storeu_ps(lanes[p], out[p]);
+            for(unsigned int l = 0; i + l < last; l++)
+            {
+                outputs[p][i + l] = lanes[p][l];
+            }
+        }
+    }
+}
+
+int
+OptionPricer::price(const OptionBook &book, const OptionResults &results)
+{
+    if(book.spot == NULL || book.strike == NULL || book.expiry == NULL ||
+            book.rate == NULL || book.volatility == NULL ||
+            results.callPrice == NULL || results.putPrice == NULL)
+    {
+        error("OptionPricer::price() needs every input and both price arrays");
+        return SDK_FAILURE;
+    }
+    if(results.callDelta != NULL &&
+            (results.putDelta == NULL || results.gamma == NULL || results.vega == NULL ||
+             results.callTheta == NULL || results.putTheta == NULL ||
+             results.callRho == NULL || results.putRho == NULL))
+    {
+        error("OptionPricer::price() needs every Greek array or none");
+        return SDK_FAILURE;
+    }
+    if(book.count == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    unsigned int groups = (book.count + 3) / 4;
+    unsigned int threads = numThreads ? numThreads : getNumCPUCores();
+    threads = std::min(threads, std::max(book.count / MIN_OPTIONS_PER_THREAD, 1u));
+
+    rangeArgs args;
+    args.book = &book;
+    args.results = &results;
+    if(!parallelFor(priceThread, &args, groups, threads))
+    {
+        error("OptionPricer::price() could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
@@ -0,0 +1,106 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef OPTIONPRICER_H_
+#define OPTIONPRICER_H_
+
+#include <CL/cl.h>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * OptionBook
+ * European options without dividends, one array per parameter (SoA)
+ */
+struct OptionBook
+{
+    cl_uint count;                  /**< Number of options */
+    const cl_float *spot;           /**< Price of the underlying */
+    const cl_float *strike;         /**< Strike price */
+    const cl_float *expiry;         /**< Time to expiry in years */
+    const cl_float *rate;           /**< Continuously compounded risk free rate */
+    const cl_float *volatility;     /**< Volatility of the underlying */
+};
+
+/**
+ * OptionResults
+ * Prices and Greeks of an OptionBook, one array per result. The Greek
+ * arrays may be NULL together, then only the prices are computed.
+ */
+struct OptionResults
+{
+    cl_float *callPrice;
+    cl_float *putPrice;
+    cl_float *callDelta;            /**< dC/dS */
+    cl_float *putDelta;             /**< dP/dS */
+    cl_float *gamma;                /**< d2C/dS2, same for puts */
+    cl_float *vega;                 /**< dC/dsigma, same for puts */
+    cl_float *callTheta;            /**< dC/dt per year */
+    cl_float *putTheta;             /**< dP/dt per year */
+    cl_float *callRho;              /**< dC/dr */
+    cl_float *putRho;               /**< dP/dr */
+};
+
+/**
+ * OptionPricer
+ * Class implements a multi-threaded host Black-Scholes pricer for books of
+ * European options. Four options are priced per SSE2 operation: exp() and
+ * log() use range reduction with minimax polynomials (relative error below
+ * 2e-7 over the float range), and the normal distribution uses the
+ * Abramowitz-Stegun polynomial of the sample's phi() (absolute error below
+ * 7.5e-8) on the density the Greeks need anyway, so the Greeks cost few
+ * operations on top of the prices.
+ */
+class OptionPricer
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+
+        struct rangeArgs;
+        static void priceThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        OptionPricer()
+            : numThreads(0)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Prices every option of the book
+         * @param book inputs, all positive
+         * @param results outputs, room for book.count options each
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int price(const OptionBook &book, const OptionResults &results);
+};
+
+#endif
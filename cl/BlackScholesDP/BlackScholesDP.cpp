@@ -144,6 +144,40 @@ BlackScholesDP::setupBlackScholesDP()
                      "Failed to allocate host memory. (hostPutPrice)");
     memset(hostPutPrice, 0, width * height * sizeof(cl_double4));
 
+    if(impliedVol)
+    {
+        // Market quotes of calls and puts around the money, priced with
+        // known volatilities the solvers have to recover
+        cl_uint count = width * height * 4;
+        quoteData.resize(6 * count);
+        quoteIsCall.resize(count);
+        hostVol.assign(count, 0.0);
+        deviceVol.assign(count, 0.0);
+        for(cl_uint j = 0; j < count; j++)
+        {
+            double s = 10.0 + 90.0 * rand() / RAND_MAX;
+            double k = s * (0.7 + 0.6 * rand() / RAND_MAX);
+            double t = 0.05 + 5.0 * rand() / RAND_MAX;
+            double r = 0.08 * rand() / RAND_MAX;
+            double sigma = 0.05 + 0.75 * rand() / RAND_MAX;
+            quoteIsCall[j] = j & 1;
+            quoteData[j] = ImpliedVolatility::price(quoteIsCall[j] != 0, s, k, t, r, sigma);
+            quoteData[count + j] = s;
+            quoteData[2 * count + j] = k;
+            quoteData[3 * count + j] = t;
+            quoteData[4 * count + j] = r;
+            quoteData[5 * count + j] = sigma;
+        }
+
+        quotes.count = count;
+        quotes.price = &quoteData[0];
+        quotes.spot = &quoteData[count];
+        quotes.strike = &quoteData[2 * count];
+        quotes.expiry = &quoteData[3 * count];
+        quotes.rate = &quoteData[4 * count];
+        quotes.isCall = &quoteIsCall[0];
+    }
+
     return SDK_SUCCESS;
 }
 
@@ -334,6 +368,37 @@ BlackScholesDP::setupCL(void)
              devices[sampleArgs->deviceId]);
     CHECK_OPENCL_ERROR(status, "kernelInfo.setKernelWorkGroupInfo failed");
 
+    if(impliedVol)
+    {
+        for(int b = 0; b < 6; b++)
+        {
+            size_t size = (b < 5 ? sizeof(cl_double) : sizeof(cl_int)) * quotes.count;
+            quoteBufs[b] = clCreateBuffer(context,
+                                          CL_MEM_READ_ONLY,
+                                          size,
+                                          NULL,
+                                          &status);
+            CHECK_OPENCL_ERROR(status, "clCreateBuffer failed.(quoteBufs)");
+        }
+
+        volBuf = clCreateBuffer(context,
+                                CL_MEM_WRITE_ONLY,
+                                sizeof(cl_double) * quotes.count,
+                                NULL,
+                                &status);
+        CHECK_OPENCL_ERROR(status, "clCreateBuffer failed.(volBuf)");
+
+        ivKernel = clCreateKernel(program, "impliedVolatility", &status);
+        CHECK_OPENCL_ERROR(status, "clCreateKernel failed.(ivKernel)");
+
+        KernelWorkGroupInfo ivKernelInfo;
+        status = ivKernelInfo.setKernelWorkGroupInfo(ivKernel,
+                 devices[sampleArgs->deviceId]);
+        CHECK_OPENCL_ERROR(status, "ivKernelInfo.setKernelWorkGroupInfo failed");
+        ivGroupSize = ivKernelInfo.kernelWorkGroupSize > GROUP_SIZE ?
+                      GROUP_SIZE : ivKernelInfo.kernelWorkGroupSize;
+    }
+
     // Calculte 2D block size according to required work-group size by kernel
     kernelInfo.kernelWorkGroupSize = kernelInfo.kernelWorkGroupSize > GROUP_SIZE ?
                                      GROUP_SIZE : kernelInfo.kernelWorkGroupSize;
@@ -544,6 +609,24 @@ BlackScholesDP::initialize()
 
     sampleArgs->AddOption(num_samples);
 
+    num_samples->_sVersion = "";
+    num_samples->_lVersion = "impliedvol";
+    num_samples->_description =
+        "Also solve implied volatilities of generated quotes on host and device";
+    num_samples->_type = CA_NO_ARGUMENT;
+    num_samples->_value = &impliedVol;
+
+    sampleArgs->AddOption(num_samples);
+
+    num_samples->_sVersion = "";
+    num_samples->_lVersion = "threads";
+    num_samples->_description =
+        "Number of host threads of the implied volatility solver (0 uses every core)";
+    num_samples->_type = CA_ARG_INT;
+    num_samples->_value = &cpuThreads;
+
+    sampleArgs->AddOption(num_samples);
+
     delete num_samples;
 
     return SDK_SUCCESS;
@@ -624,6 +707,154 @@ BlackScholesDP::run()
                               1);
     }
 
+    if(impliedVol)
+    {
+        if(runImpliedVolatility() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+    }
+
+    return SDK_SUCCESS;
+}
+
+int
+BlackScholesDP::runImpliedVolatility()
+{
+    cl_int status;
+    const cl_uint maxIter = 64;
+    const cl_double tolerance = 1e-10;
+
+    // Host solver
+    hostSolver.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+    hostSolver.setTolerance(tolerance, maxIter);
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+    for(int i = 0; i < iterations; i++)
+    {
+        status = hostSolver.solve(quotes, &hostVol[0]);
+        CHECK_ERROR(status, SDK_SUCCESS, "ImpliedVolatility::solve() failed");
+    }
+    sampleTimer->stopTimer(timer);
+    hostIvTime = (double)(sampleTimer->readTimer(timer)) / iterations;
+
+    // Device solver, transfers included as for blackScholes
+    size_t localThreads = ivGroupSize;
+    size_t globalThreads = ((quotes.count + localThreads - 1) / localThreads) * localThreads;
+    const void *hostArrays[6] =
+    {
+        quotes.price, quotes.spot, quotes.strike, quotes.expiry, quotes.rate, quotes.isCall
+    };
+
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+    for(int i = 0; i < iterations; i++)
+    {
+        for(int b = 0; b < 6; b++)
+        {
+            size_t size = (b < 5 ? sizeof(cl_double) : sizeof(cl_int)) * quotes.count;
+            status = clEnqueueWriteBuffer(commandQueue,
+                                          quoteBufs[b],
+                                          CL_FALSE,
+                                          0,
+                                          size,
+                                          hostArrays[b],
+                                          0,
+                                          NULL,
+                                          NULL);
+            CHECK_OPENCL_ERROR(status, "clEnqueueWriteBuffer failed.(quoteBufs)");
+        }
+
+        for(int b = 0; b < 6; b++)
+        {
+            status = clSetKernelArg(ivKernel, b, sizeof(cl_mem), (void *)&quoteBufs[b]);
+            CHECK_OPENCL_ERROR(status, "clSetKernelArg failed.(quoteBufs)");
+        }
+
+        status = clSetKernelArg(ivKernel, 6, sizeof(cl_mem), (void *)&volBuf);
+        CHECK_OPENCL_ERROR(status, "clSetKernelArg failed.(volBuf)");
+
+        status = clSetKernelArg(ivKernel, 7, sizeof(cl_uint), (void *)&quotes.count);
+        CHECK_OPENCL_ERROR(status, "clSetKernelArg failed.(count)");
+
+        status = clSetKernelArg(ivKernel, 8, sizeof(cl_uint), (void *)&maxIter);
+        CHECK_OPENCL_ERROR(status, "clSetKernelArg failed.(maxIter)");
+
+        status = clSetKernelArg(ivKernel, 9, sizeof(cl_double), (void *)&tolerance);
+        CHECK_OPENCL_ERROR(status, "clSetKernelArg failed.(tolerance)");
+
+        cl_event ndrEvt;
+        status = clEnqueueNDRangeKernel(commandQueue,
+                                        ivKernel,
+                                        1,
+                                        NULL,
+                                        &globalThreads,
+                                        &localThreads,
+                                        0,
+                                        NULL,
+                                        &ndrEvt);
+        CHECK_OPENCL_ERROR(status, "clEnqueueNDRangeKernel failed.(ivKernel)");
+
+        status = clFlush(commandQueue);
+        CHECK_OPENCL_ERROR(status, "clFlush failed.(commandQueue)");
+
+        status = waitForEventAndRelease(&ndrEvt);
+        CHECK_ERROR(status, SDK_SUCCESS, "WaitForEventAndRelease(ndrEvt) Failed");
+
+        status = clEnqueueReadBuffer(commandQueue,
+                                     volBuf,
+                                     CL_TRUE,
+                                     0,
+                                     sizeof(cl_double) * quotes.count,
+                                     &deviceVol[0],
+                                     0,
+                                     NULL,
+                                     NULL);
+        CHECK_OPENCL_ERROR(status, "clEnqueueReadBuffer failed.(volBuf)");
+    }
+    sampleTimer->stopTimer(timer);
+    deviceIvTime = (double)(sampleTimer->readTimer(timer)) / iterations;
+
+    /*
+     * Volatility errors. Quotes whose out of the money value is below a
+     * millionth of the spot price do not pin down the volatility in double
+     * precision and are counted separately.
+     */
+    const cl_double *trueVol = &quoteData[5 * quotes.count];
+    hostIvError = 0;
+    deviceIvError = 0;
+    illConditioned = 0;
+    for(cl_uint j = 0; j < quotes.count; j++)
+    {
+        double s = quotes.spot[j];
+        double kDisc = quotes.strike[j] * exp(-quotes.rate[j] * quotes.expiry[j]);
+        double intrinsic = quotes.isCall[j] ? s - kDisc : kDisc - s;
+        if(quotes.price[j] - (intrinsic > 0 ? intrinsic : 0) < 1e-6 * s)
+        {
+            illConditioned++;
+            continue;
+        }
+
+        // Unsolved quotes (NaN) count as a unit error
+        double hostErr = (hostVol[j] == hostVol[j]) ? fabs(hostVol[j] - trueVol[j]) : 1.0;
+        double deviceErr = (deviceVol[j] == deviceVol[j]) ? fabs(deviceVol[j] - trueVol[j]) : 1.0;
+        if(hostErr > hostIvError)
+        {
+            hostIvError = hostErr;
+        }
+        if(deviceErr > deviceIvError)
+        {
+            deviceIvError = deviceErr;
+        }
+    }
+
+    if(!sampleArgs->quiet)
+    {
+        printArray<cl_double>("hostImpliedVol", &hostVol[0], width, 1);
+        printArray<cl_double>("deviceImpliedVol", &deviceVol[0], width, 1);
+    }
     return SDK_SUCCESS;
 }
 
@@ -655,6 +886,12 @@ BlackScholesDP::verifyResults()
         bool putPriceResult = compare(hostPutPrice, devicePutPrice, width * height * 4,
                                       1e-4);
 
+        if(impliedVol)
+        {
+            // Both solvers stop on a 1e-10 step of the volatility
+            callPriceResult = callPriceResult && hostIvError < 1e-6 && deviceIvError < 1e-6;
+        }
+
         if(!(callPriceResult ? (putPriceResult ? true : false) : false))
         {
             std::cout << "Failed\n"  << std::endl;
@@ -693,6 +930,35 @@ BlackScholesDP::printStats()
         stats[3] = toString(actualSamples / sampleTimer->totalTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        if(impliedVol)
+        {
+            std::string ivStrArray[9] =
+            {
+                "Quotes",
+                "Ill-conditioned quotes",
+                "Host IV time(sec)",
+                "Host IV quotes/sec",
+                "Host IV steps/quote",
+                "Host IV max error",
+                "Device IV [Transfer+kernel]time(sec)",
+                "Device IV quotes/sec",
+                "Device IV max error"
+            };
+
+            std::string ivStats[9];
+            ivStats[0] = toString(quotes.count, std::dec);
+            ivStats[1] = toString(illConditioned, std::dec);
+            ivStats[2] = toString(hostIvTime, std::dec);
+            ivStats[3] = toString(hostIvTime > 0 ? quotes.count / hostIvTime : 0, std::dec);
+            ivStats[4] = toString((double)hostSolver.getIterations() / quotes.count, std::dec);
+            ivStats[5] = toString(hostIvError, std::dec);
+            ivStats[6] = toString(deviceIvTime, std::dec);
+            ivStats[7] = toString(deviceIvTime > 0 ? quotes.count / deviceIvTime : 0, std::dec);
+            ivStats[8] = toString(deviceIvError, std::dec);
+
+            printStatistics(ivStrArray, ivStats, 9);
+        }
     }
 }
 
@@ -712,6 +978,21 @@ int BlackScholesDP::cleanup()
     status = clReleaseKernel(kernel);
     CHECK_OPENCL_ERROR(status, "clReleaseKernel failed.(kernel)");
 
+    if(impliedVol)
+    {
+        for(int b = 0; b < 6; b++)
+        {
+            status = clReleaseMemObject(quoteBufs[b]);
+            CHECK_OPENCL_ERROR(status, "clReleaseMemObject failed.(quoteBufs)");
+        }
+
+        status = clReleaseMemObject(volBuf);
+        CHECK_OPENCL_ERROR(status, "clReleaseMemObject failed.(volBuf)");
+
+        status = clReleaseKernel(ivKernel);
+        CHECK_OPENCL_ERROR(status, "clReleaseKernel failed.(ivKernel)");
+    }
+
     status = clReleaseProgram(program);
     CHECK_OPENCL_ERROR(status, "clReleaseProgram failed.(program)");
 
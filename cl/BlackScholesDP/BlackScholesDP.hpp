@@ -23,7 +23,10 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <assert.h>
 #include <string.h>
 
+#include <vector>
+
 #include "CLUtil.hpp"
+#include "ImpliedVolatility.hpp"
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -63,6 +66,24 @@ class BlackScholesDP
         KernelWorkGroupInfo kernelInfo; /**< KernelWorkGroupInfo class Object */
         SDKTimer    *sampleTimer;      /**< SDKTimer object */
 
+        bool impliedVol;                /**< Also solve implied volatilities on host and device */
+        int cpuThreads;                 /**< Host threads, 0 uses every core */
+        ImpliedVolatility hostSolver;   /**< Multi-threaded SSE2 implied volatility solver */
+        std::vector<cl_double> quoteData; /**< Price, spot, strike, expiry, rate and true volatility arrays */
+        std::vector<cl_int> quoteIsCall; /**< Option type of every quote */
+        VolatilityQuotes quotes;        /**< Views of quoteData */
+        std::vector<cl_double> hostVol; /**< Volatilities solved on the host */
+        std::vector<cl_double> deviceVol; /**< Volatilities solved on the device */
+        cl_mem quoteBufs[6];            /**< CL memory buffers of the quote arrays and isCall */
+        cl_mem volBuf;                  /**< CL memory buffer of the device volatilities */
+        cl_kernel ivKernel;             /**< CL kernel impliedVolatility */
+        size_t ivGroupSize;             /**< Work-group size of ivKernel */
+        cl_double hostIvTime;           /**< time taken by the host solver */
+        cl_double deviceIvTime;         /**< time taken by ivKernel and its transfers */
+        cl_double hostIvError;          /**< Largest host volatility error */
+        cl_double deviceIvError;        /**< Largest device volatility error */
+        cl_uint illConditioned;         /**< Quotes left out of the errors */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -83,7 +104,15 @@ class BlackScholesDP
               hostCallPrice(NULL),
               hostPutPrice(NULL),
               devices(NULL),
-              iterations(1)
+              iterations(1),
+              impliedVol(false),
+              cpuThreads(0),
+              ivGroupSize(GROUP_SIZE),
+              hostIvTime(0),
+              deviceIvTime(0),
+              hostIvError(0),
+              deviceIvError(0),
+              illConditioned(0)
         {
             width = 64;
             height = 64;
@@ -180,6 +209,13 @@ class BlackScholesDP
          */
         int verifyResults();
 
+        /**
+         * Solves the quotes with the host solver and with ivKernel, times
+         * both and measures their volatility errors
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int runImpliedVolatility();
+
     private:
 
         /**
@@ -127,3 +127,112 @@ blackScholes(const __global double4 *randArray,
     put[yPos * width + xPos]  = KexpMinusRT * phiD2 - S * phiD1;
 }
 
+#define MAX_TOTAL_VOL 20.0
+
+/*
+ * @brief   Solves Black-Scholes implied volatilities, one quote per work item.
+ *          Same method as the host ImpliedVolatility solver: put-call parity
+ *          reduces a quote to its out of the money option, written as a
+ *          forward call, Corrado-Miller gives the first guess of the total
+ *          volatility v = sigma * sqrt(T) and Halley steps inside a shrinking
+ *          bracket refine it.
+ * @param   price       Array of option prices
+ * @param   spot        Array of prices of the underlying
+ * @param   strike      Array of strike prices
+ * @param   expiry      Array of times to expiration
+ * @param   rate        Array of risk free interest rates
+ * @param   isCall      Array of option types, nonzero for calls
+ * @param   volatility  Array of implied volatilities, NaN if not solved
+ * @param   count       Number of quotes
+ * @param   maxIter     Steps before a quote fails
+ * @param   tolerance   Convergence threshold of the volatility
+ */
+__kernel
+void
+impliedVolatility(const __global double *price,
+                  const __global double *spot,
+                  const __global double *strike,
+                  const __global double *expiry,
+                  const __global double *rate,
+                  const __global int *isCall,
+                  __global double *volatility,
+                  uint count,
+                  uint maxIter,
+                  double tolerance)
+{
+    size_t i = get_global_id(0);
+    if(i >= count)
+    {
+        return;
+    }
+
+    double s = spot[i];
+    double k = strike[i];
+    double t = expiry[i];
+    double discount = exp(-rate[i] * t);
+    double f = s / discount;
+    double target = price[i] / discount;
+
+    // Out of the money puts are solved as calls: P(F, K) = C(K, F)
+    int call = isCall[i] != 0;
+    if(call == (f > k))
+    {
+        target -= call ? f - k : k - f;
+        call = !call;
+    }
+    double fwd = call ? f : k;
+    double strk = call ? k : f;
+    double x = log(fwd / strk);
+    double sqrtT = sqrt(t);
+
+    if(!(s > 0.0 && k > 0.0 && t > 0.0 && target > 0.0 && target < fwd))
+    {
+        volatility[i] = NAN;
+        return;
+    }
+
+    // Corrado-Miller guess
+    double m = target - 0.5 * (fwd - strk);
+    double root = sqrt(fmax(m * m - (fwd - strk) * (fwd - strk) / M_PI, 0.0));
+    double v = sqrt(2.0 * M_PI) / (fwd + strk) * (m + root);
+    if(!(v > 1e-3 && v < MAX_TOTAL_VOL))
+    {
+        v = fmin(fmax(v, 1e-3), 0.5 * MAX_TOTAL_VOL);
+    }
+
+    double lo = 0.0;
+    double hi = MAX_TOTAL_VOL;
+    for(uint it = 0; it < maxIter; it++)
+    {
+        double d1 = x / v + 0.5 * v;
+        double d2 = d1 - v;
+        double diff = 0.5 * (fwd * erfc(-d1 * M_SQRT1_2) - strk * erfc(-d2 * M_SQRT1_2)) - target;
+        double vega = fwd * 0.39894228040143267794 * exp(-0.5 * d1 * d1);
+
+        if(diff > 0.0)
+        {
+            hi = v;
+        }
+        else
+        {
+            lo = v;
+        }
+
+        // Halley step, bisection when it leaves the bracket
+        double newton = diff / vega;
+        double corr = 1.0 - 0.5 * newton * d1 * d2 / v;
+        double next = v - ((corr > 0.5 && corr < 2.0) ? newton / corr : newton);
+        if(!(next >= lo && next <= hi))
+        {
+            next = 0.5 * (lo + hi);
+        }
+
+        if(fabs(next - v) < tolerance * sqrtT || diff == 0.0)
+        {
+            volatility[i] = next / sqrtT;
+            return;
+        }
+        v = next;
+    }
+    volatility[i] = NAN;
+}
@@ -0,0 +1,343 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "ImpliedVolatility.hpp"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <emmintrin.h>
+
+/*
+ * Quotes below which another thread does not pay off
+ */
+#define MIN_QUOTES_PER_THREAD 4096
+
+/*
+ * Largest total volatility sigma * sqrt(T) searched
+ */
+#define MAX_TOTAL_VOL 20.0
+
+/**
+ * Arguments of the solver threads
+ */
+struct ImpliedVolatility::rangeArgs
+{
+    ImpliedVolatility *solver;
+    const VolatilityQuotes *quotes;
+    cl_double *volatility;
+};
+
+/*
+ * exp(x) of two doubles, Cephes rational approximation after reducing x
+ * to n * ln2 + r, relative error about 2e-16
+ */
+static inline __m128d expPd(__m128d x)
+{
+    x = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(-708.0)), _mm_set1_pd(709.0));
+
+    __m128i n = _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(1.4426950408889634074)));
+    __m128d fn = _mm_cvtepi32_pd(n);
+    __m128d r = _mm_sub_pd(x, _mm_mul_pd(fn, _mm_set1_pd(6.93145751953125e-1)));
+    r = _mm_sub_pd(r, _mm_mul_pd(fn, _mm_set1_pd(1.42860682030941723212e-6)));
+
+    __m128d rr = _mm_mul_pd(r, r);
+    __m128d p = _mm_set1_pd(1.26177193074810590878e-4);
+    p = _mm_add_pd(_mm_mul_pd(p, rr), _mm_set1_pd(3.02994407707441961300e-2));
+    p = _mm_add_pd(_mm_mul_pd(p, rr), _mm_set1_pd(9.99999999999999999910e-1));
+    p = _mm_mul_pd(p, r);
+    __m128d q = _mm_set1_pd(3.00198505138664455042e-6);
+    q = _mm_add_pd(_mm_mul_pd(q, rr), _mm_set1_pd(2.52448340349684104192e-3));
+    q = _mm_add_pd(_mm_mul_pd(q, rr), _mm_set1_pd(2.27265548208155028766e-1));
+    q = _mm_add_pd(_mm_mul_pd(q, rr), _mm_set1_pd(2.00000000000000000009e0));
+    __m128d y = _mm_add_pd(_mm_set1_pd(1.0),
+                           _mm_div_pd(_mm_add_pd(p, p), _mm_sub_pd(q, p)));
+
+    // 2^n built in the exponent field of each 64-bit lane
+    __m128i biased = _mm_add_epi32(n, _mm_set1_epi32(1023));
+    __m128i e = _mm_slli_epi64(_mm_unpacklo_epi32(biased, _mm_setzero_si128()), 52);
+    return _mm_mul_pd(y, _mm_castsi128_pd(e));
+}
+
+/*
+ * Standard normal distribution of two doubles given their density
+ * pdf = exp(-x*x/2)/sqrt(2pi). Hart's algorithm as given by West, relative
+ * error near double precision in both tails.
+ */
+static inline __m128d cndPd(__m128d x, __m128d pdf)
+{
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d absX = _mm_andnot_pd(signMask, x);
+    __m128d e = _mm_mul_pd(pdf, _mm_set1_pd(2.50662827463100050242));
+
+    // Rational approximation for |x| < 10 / sqrt(2)
+    __m128d num = _mm_set1_pd(3.52624965998911e-2);
+    num = _mm_add_pd(_mm_mul_pd(num, absX), _mm_set1_pd(0.700383064443688));
+    num = _mm_add_pd(_mm_mul_pd(num, absX), _mm_set1_pd(6.37396220353165));
+    num = _mm_add_pd(_mm_mul_pd(num, absX), _mm_set1_pd(33.912866078383));
+    num = _mm_add_pd(_mm_mul_pd(num, absX), _mm_set1_pd(112.079291497871));
+    num = _mm_add_pd(_mm_mul_pd(num, absX), _mm_set1_pd(221.213596169931));
+    num = _mm_add_pd(_mm_mul_pd(num, absX), _mm_set1_pd(220.206867912376));
+    __m128d den = _mm_set1_pd(8.83883476483184e-2);
+    den = _mm_add_pd(_mm_mul_pd(den, absX), _mm_set1_pd(1.75566716318264));
+    den = _mm_add_pd(_mm_mul_pd(den, absX), _mm_set1_pd(16.064177579207));
+    den = _mm_add_pd(_mm_mul_pd(den, absX), _mm_set1_pd(86.7807322029461));
+    den = _mm_add_pd(_mm_mul_pd(den, absX), _mm_set1_pd(296.564248779674));
+    den = _mm_add_pd(_mm_mul_pd(den, absX), _mm_set1_pd(637.333633378831));
+    den = _mm_add_pd(_mm_mul_pd(den, absX), _mm_set1_pd(793.826512519948));
+    den = _mm_add_pd(_mm_mul_pd(den, absX), _mm_set1_pd(440.413735824752));
+    __m128d tail = _mm_div_pd(_mm_mul_pd(e, num), den);
+
+    // Continued fraction beyond, only evaluated when a lane needs it
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d useInner = _mm_cmplt_pd(absX, _mm_set1_pd(7.07106781186547));
+    if(_mm_movemask_pd(useInner) != 3)
+    {
+        __m128d cf = _mm_add_pd(absX, _mm_set1_pd(0.65));
+        cf = _mm_add_pd(absX, _mm_div_pd(_mm_set1_pd(4.0), cf));
+        cf = _mm_add_pd(absX, _mm_div_pd(_mm_set1_pd(3.0), cf));
+        cf = _mm_add_pd(absX, _mm_div_pd(_mm_set1_pd(2.0), cf));
+        cf = _mm_add_pd(absX, _mm_div_pd(one, cf));
+        __m128d outer = _mm_div_pd(pdf, cf);
+        tail = _mm_or_pd(_mm_and_pd(useInner, tail), _mm_andnot_pd(useInner, outer));
+        tail = _mm_and_pd(tail, _mm_cmple_pd(absX, _mm_set1_pd(37.0)));
+    }
+
+    // tail is N(-|x|), mirror it for positive x
+    __m128d positive = _mm_cmpgt_pd(x, _mm_setzero_pd());
+    return _mm_or_pd(_mm_and_pd(positive, _mm_sub_pd(one, tail)),
+                     _mm_andnot_pd(positive, tail));
+}
+
+/*
+ * Forward call price F N(d1) - K N(d2) of total volatility v, its derivative
+ * vega in v and the ratio volga / vega = d1 * d2 / v of the second derivative.
+ * moneyness is F / K, which turns the density of d1 into the one of d2.
+ */
+static inline __m128d forwardCall(__m128d v, __m128d fwd, __m128d strike,
+                                  __m128d logMoney, __m128d moneyness,
+                                  __m128d &vega, __m128d &curvature)
+{
+    const __m128d half = _mm_set1_pd(0.5);
+    __m128d a = _mm_div_pd(logMoney, v);
+    __m128d d1 = _mm_add_pd(a, _mm_mul_pd(half, v));
+    __m128d d2 = _mm_sub_pd(a, _mm_mul_pd(half, v));
+
+    __m128d pdf1 = _mm_mul_pd(_mm_set1_pd(0.39894228040143267794),
+                              expPd(_mm_mul_pd(_mm_set1_pd(-0.5), _mm_mul_pd(d1, d1))));
+    __m128d pdf2 = _mm_mul_pd(pdf1, moneyness);
+    __m128d n1 = cndPd(d1, pdf1);
+    __m128d n2 = cndPd(d2, pdf2);
+
+    vega = _mm_mul_pd(fwd, pdf1);
+    curvature = _mm_div_pd(_mm_mul_pd(d1, d2), v);
+    return _mm_sub_pd(_mm_mul_pd(fwd, n1), _mm_mul_pd(strike, n2));
+}
+
+void
+ImpliedVolatility::solveThread(void *data, unsigned int begin, unsigned int end,
+                               unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    ImpliedVolatility *solver = args->solver;
+    const VolatilityQuotes &q = *args->quotes;
+
+    cl_ulong steps = 0;
+    cl_uint failures = 0;
+
+    // begin and end count pairs of quotes
+    for(unsigned int pair = begin; pair < end; pair++)
+    {
+        unsigned int first = 2 * pair;
+        unsigned int lanes = std::min(2u, q.count - first);
+
+        // Forward terms of every lane, scalar libm for the one-off setup
+        cl_double fwd[2], strike[2], logMoney[2], moneyness[2];
+        cl_double target[2], sqrtT[2], guess[2];
+        bool valid[2];
+        for(unsigned int l = 0; l < 2; l++)
+        {
+            unsigned int i = first + (l < lanes ? l : 0);
+            cl_double s = q.spot[i];
+            cl_double k = q.strike[i];
+            cl_double t = q.expiry[i];
+            cl_double discount = exp(-q.rate[i] * t);
+
+            // Put-call parity turns an in the money quote into its out of
+            // the money counterpart, the part of the price that depends on
+            // the volatility. Out of the money puts are solved as calls with
+            // forward and strike swapped: P(F, K) = C(K, F).
+            cl_double f = s / discount;
+            cl_double undiscounted = q.price[i] / discount;
+            bool call = q.isCall[i] != 0;
+            if(call == (f > k))
+            {
+                undiscounted -= call ? f - k : k - f;
+                call = !call;
+            }
+            fwd[l] = call ? f : k;
+            strike[l] = call ? k : f;
+            moneyness[l] = fwd[l] / strike[l];
+            logMoney[l] = log(moneyness[l]);
+            target[l] = undiscounted;
+            sqrtT[l] = sqrt(t);
+
+            valid[l] = s > 0 && k > 0 && t > 0 &&
+                       target[l] > 0 && target[l] < fwd[l];
+
+            // Corrado-Miller guess of the total volatility
+            cl_double gap = fwd[l] - strike[l];
+            cl_double m = target[l] - 0.5 * gap;
+            cl_double root = sqrt(std::max(m * m - gap * gap / M_PI, 0.0));
+            guess[l] = sqrt(2.0 * M_PI) / (fwd[l] + strike[l]) * (m + root);
+            if(!(guess[l] > 1e-3 && guess[l] < MAX_TOTAL_VOL))
+            {
+                guess[l] = std::min(std::max(guess[l], 1e-3), 0.5 * MAX_TOTAL_VOL);
+            }
+        }
+
+        __m128d vF = _mm_loadu_pd(fwd);
+        __m128d vK = _mm_loadu_pd(strike);
+        __m128d vX = _mm_loadu_pd(logMoney);
+        __m128d vM = _mm_loadu_pd(moneyness);
+        __m128d vTarget = _mm_loadu_pd(target);
+        __m128d tol = _mm_mul_pd(_mm_set1_pd(solver->tolerance), _mm_loadu_pd(sqrtT));
+        __m128d v = _mm_loadu_pd(guess);
+        __m128d lo = _mm_setzero_pd();
+        __m128d hi = _mm_set1_pd(MAX_TOTAL_VOL);
+
+        // All ones in the lanes still iterating
+        cl_double activeInit[2];
+        for(unsigned int l = 0; l < 2; l++)
+        {
+            activeInit[l] = (valid[l] && l < lanes) ? -1.0 : 0.0;
+        }
+        __m128d active = _mm_cmplt_pd(_mm_loadu_pd(activeInit), _mm_setzero_pd());
+        __m128d converged = _mm_setzero_pd();
+
+        const __m128d half = _mm_set1_pd(0.5);
+        const __m128d one = _mm_set1_pd(1.0);
+        for(cl_uint it = 0; it < solver->maxIterations && _mm_movemask_pd(active); it++)
+        {
+            steps += (_mm_movemask_pd(active) & 1) + (_mm_movemask_pd(active) >> 1);
+
+            __m128d vega, curvature;
+            __m128d f = _mm_sub_pd(forwardCall(v, vF, vK, vX, vM, vega, curvature), vTarget);
+
+            // The price grows with v, so the sign of f moves one end of the bracket
+            __m128d above = _mm_cmpgt_pd(f, _mm_setzero_pd());
+            lo = _mm_or_pd(_mm_and_pd(above, lo), _mm_andnot_pd(above, v));
+            hi = _mm_or_pd(_mm_and_pd(above, v), _mm_andnot_pd(above, hi));
+
+            // Halley step, reduced to Newton when the curvature term is large
+            __m128d newton = _mm_div_pd(f, vega);
+            __m128d corr = _mm_sub_pd(one, _mm_mul_pd(half, _mm_mul_pd(newton, curvature)));
+            __m128d sane = _mm_and_pd(_mm_cmpgt_pd(corr, half), _mm_cmplt_pd(corr, _mm_set1_pd(2.0)));
+            __m128d step = _mm_or_pd(_mm_and_pd(sane, _mm_div_pd(newton, corr)),
+                                     _mm_andnot_pd(sane, newton));
+            __m128d next = _mm_sub_pd(v, step);
+
+            // Bisect when the step leaves the bracket or is not finite
+            __m128d inside = _mm_and_pd(_mm_cmpge_pd(next, lo), _mm_cmple_pd(next, hi));
+            next = _mm_or_pd(_mm_and_pd(inside, next),
+                             _mm_andnot_pd(inside, _mm_mul_pd(half, _mm_add_pd(lo, hi))));
+
+            __m128d delta = _mm_andnot_pd(_mm_set1_pd(-0.0), _mm_sub_pd(next, v));
+            __m128d done = _mm_and_pd(active, _mm_or_pd(_mm_cmplt_pd(delta, tol),
+                                                         _mm_cmpeq_pd(f, _mm_setzero_pd())));
+            v = _mm_or_pd(_mm_and_pd(active, next), _mm_andnot_pd(active, v));
+            converged = _mm_or_pd(converged, done);
+            active = _mm_andnot_pd(done, active);
+        }
+
+        cl_double vol[2];
+        _mm_storeu_pd(vol, v);
+        for(unsigned int l = 0; l < lanes; l++)
+        {
+            if(_mm_movemask_pd(converged) & (1 << l))
+            {
+                args->volatility[first + l] = vol[l] / sqrtT[l];
+            }
+            else
+            {
+                args->volatility[first + l] = std::numeric_limits<cl_double>::quiet_NaN();
+                failures++;
+            }
+        }
+    }
+
+    solver->threadIterations[threadId] = steps;
+    solver->threadFailures[threadId] = failures;
+}
+
+int
+ImpliedVolatility::solve(const VolatilityQuotes &quotes, cl_double *volatility)
+{
+    if(quotes.price == NULL || quotes.spot == NULL || quotes.strike == NULL ||
+            quotes.expiry == NULL || quotes.rate == NULL || quotes.isCall == NULL ||
+            volatility == NULL)
+    {
+        error("ImpliedVolatility::solve() needs every input and the output array");
+        return SDK_FAILURE;
+    }
+
+    iterationCount = 0;
+    failureCount = 0;
+    if(quotes.count == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    unsigned int pairs = (quotes.count + 1) / 2;
+    unsigned int threads = numThreads ? numThreads : getNumCPUCores();
+    threads = std::min(threads, std::max(quotes.count / MIN_QUOTES_PER_THREAD, 1u));
+    threadIterations.assign(threads, 0);
+    threadFailures.assign(threads, 0);
+
+    rangeArgs args;
+    args.solver = this;
+    args.quotes = &quotes;
+    args.volatility = volatility;
+    if(!parallelFor(solveThread, &args, pairs, threads))
+    {
+        error("ImpliedVolatility::solve() could not create its threads");
+        return SDK_FAILURE;
+    }
+
+    for(unsigned int t = 0; t < threads; t++)
+    {
+        iterationCount += threadIterations[t];
+        failureCount += threadFailures[t];
+    }
+    return SDK_SUCCESS;
+}
+
+cl_double
+ImpliedVolatility::price(bool isCall, cl_double spot, cl_double strike,
+                         cl_double expiry, cl_double rate, cl_double sigma)
+{
+    cl_double sigmaSqrtT = sigma * sqrt(expiry);
+    cl_double d1 = (log(spot / strike) + (rate + 0.5 * sigma * sigma) * expiry) / sigmaSqrtT;
+    cl_double d2 = d1 - sigmaSqrtT;
+    cl_double kDisc = strike * exp(-rate * expiry);
+
+    // N(x) = erfc(-x / sqrt(2)) / 2 keeps the tails accurate
+    if(isCall)
+    {
+        return 0.5 * (spot * erfc(-d1 * M_SQRT1_2) - kDisc * erfc(-d2 * M_SQRT1_2));
+    }
+    return 0.5 * (kDisc * erfc(d2 * M_SQRT1_2) - spot * erfc(d1 * M_SQRT1_2));
+}
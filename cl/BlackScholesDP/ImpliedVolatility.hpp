@@ -0,0 +1,136 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef IMPLIEDVOLATILITY_H_
+#define IMPLIEDVOLATILITY_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * VolatilityQuotes
+ * Market prices of European options without dividends, one array per
+ * parameter (SoA)
+ */
+struct VolatilityQuotes
+{
+    cl_uint count;                  /**< Number of quotes */
+    const cl_double *price;         /**< Option price */
+    const cl_double *spot;          /**< Price of the underlying */
+    const cl_double *strike;        /**< Strike price */
+    const cl_double *expiry;        /**< Time to expiry in years */
+    const cl_double *rate;          /**< Continuously compounded risk free rate */
+    const cl_int *isCall;           /**< Nonzero for calls, 0 for puts */
+};
+
+/**
+ * ImpliedVolatility
+ * Class implements a multi-threaded host solver of Black-Scholes implied
+ * volatilities in double precision. Every quote is reduced by put-call parity
+ * to its out of the money option, written as a forward call, and solved for
+ * the total volatility v = sigma * sqrt(T). The Corrado-Miller formula gives
+ * the first guess, then Halley steps use vega and volga; every evaluation
+ * shrinks a bracket around the root, and steps leaving the bracket fall back
+ * to bisection. Two quotes are solved per SSE2 operation with a vectorized
+ * exp() and Hart's double precision normal distribution.
+ */
+class ImpliedVolatility
+{
+        unsigned int numThreads;            /**< Host threads, 0 uses every core */
+        cl_uint maxIterations;              /**< Steps before a quote fails */
+        cl_double tolerance;                /**< Convergence threshold of the volatility */
+
+        std::vector<cl_ulong> threadIterations; /**< Steps taken by every thread */
+        std::vector<cl_uint> threadFailures;    /**< Quotes every thread could not solve */
+        cl_ulong iterationCount;            /**< Steps of the last solve() */
+        cl_uint failureCount;               /**< Quotes the last solve() could not solve */
+
+        struct rangeArgs;
+        static void solveThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        ImpliedVolatility()
+            : numThreads(0),
+              maxIterations(64),
+              tolerance(1e-10),
+              iterationCount(0),
+              failureCount(0)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Sets the stopping rule: a quote is solved when a step changes its
+         * volatility by less than tol, and fails after maxIter steps
+         */
+        void setTolerance(cl_double tol, cl_uint maxIter)
+        {
+            tolerance = tol;
+            maxIterations = maxIter;
+        }
+
+        /**
+         * Solves every quote
+         * @param quotes market prices and option parameters
+         * @param volatility output, room for quotes.count values. Quotes
+         *        outside the no-arbitrage bounds or not solved get NaN.
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int solve(const VolatilityQuotes &quotes, cl_double *volatility);
+
+        /**
+         * @return solver steps taken by the last solve(), all quotes together
+         */
+        cl_ulong getIterations() const
+        {
+            return iterationCount;
+        }
+
+        /**
+         * @return quotes the last solve() set to NaN
+         */
+        cl_uint getFailures() const
+        {
+            return failureCount;
+        }
+
+        /**
+         * Black-Scholes price with the libm erfc(), accurate to double precision
+         * @return price of the call or put
+         */
+        static cl_double price(bool isCall, cl_double spot, cl_double strike,
+                               cl_double expiry, cl_double rate, cl_double sigma);
+};
+
+#endif
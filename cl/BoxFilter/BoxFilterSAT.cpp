@@ -308,11 +308,11 @@ BoxFilterSAT::setupCL()
               devices[sampleArgs->deviceId]);
     CHECK_ERROR(status, SDK_SUCCESS, "setKErnelWorkGroupInfo() failed");
 
-    size_t minA = min(kernelInfoVSAT.kernelWorkGroupSize,
-                      kernelInfoHSAT.kernelWorkGroupSize);
-    size_t minB = min(kernelInfo.kernelWorkGroupSize,
-                      kernelInfoHSAT0.kernelWorkGroupSize);
-    kernelWorkGroupSize = min(minA, minB);
+    size_t minA = std::min(kernelInfoVSAT.kernelWorkGroupSize,
+                           kernelInfoHSAT.kernelWorkGroupSize);
+    size_t minB = std::min(kernelInfo.kernelWorkGroupSize,
+                           kernelInfoHSAT0.kernelWorkGroupSize);
+    kernelWorkGroupSize = std::min(minA, minB);
 
     if((blockSizeX * blockSizeY) > kernelWorkGroupSize)
     {
@@ -626,6 +626,19 @@ BoxFilterSAT::initialize()
 
     sampleArgs->AddOption(filter_width);
     delete filter_width;
+
+    Option* num_threads = new Option;
+    CHECK_ALLOCATION(num_threads, "Memory Allocation error.\n");
+
+    num_threads->_sVersion = "";
+    num_threads->_lVersion = "threads";
+    num_threads->_description =
+        "Number of host threads of the host filters (0 uses every core)";
+    num_threads->_type = CA_ARG_INT;
+    num_threads->_value = &cpuThreads;
+
+    sampleArgs->AddOption(num_threads);
+    delete num_threads;
     return SDK_SUCCESS;
 }
 
@@ -759,40 +772,27 @@ BoxFilterSAT::cleanup()
 }
 
 
-void
+int
 BoxFilterSAT::boxFilterCPUReference()
 {
     std::cout << "Verifying results...";
-    int t = (filterWidth - 1) / 2;
-    int filterSize = filterWidth * filterWidth;
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    int status = engine.build(inputImageData, width, height);
+    CHECK_ERROR(status, SDK_SUCCESS, "SATEngine::build() failed");
+
+    status = engine.filter(verificationOutput, filterWidth);
+    CHECK_ERROR(status, SDK_SUCCESS, "SATEngine::filter() failed");
+
+    sampleTimer->stopTimer(timer);
+    hostTime = (double)(sampleTimer->readTimer(timer));
 
-    for(int y = 0; y < (int)height; y++)
-    {
-        for(int x = 0; x < (int)width; x++)
-        {
-            // Only threads inside apron will calculate their pixel value
-            if(x >= t && x < (int)(width - t) && y >= t && y < (int)(height - t))
-            {
-                cl_int4 sum = {0, 0, 0, 0};
-                // For all pixels inside box
-                for(int y1 = -t; y1 <= t; y1++)
-                {
-                    for(int x1 = -t; x1 <= t; x1++)
-                    {
-                        sum.s[0] += inputImageData[x + x1 + (y + y1) * width].s[0];
-                        sum.s[1] += inputImageData[x + x1 + (y + y1) * width].s[1];
-                        sum.s[2] += inputImageData[x + x1 + (y + y1) * width].s[2];
-                        sum.s[3] += inputImageData[x + x1 + (y + y1) * width].s[3];
-                    }
-                }
-                verificationOutput[x + y * width].s[0] = sum.s[0] / filterSize;
-                verificationOutput[x + y * width].s[1] = sum.s[1] / filterSize;
-                verificationOutput[x + y * width].s[2] = sum.s[2] / filterSize;
-                verificationOutput[x + y * width].s[3] = sum.s[3] / filterSize;
-            }
-        }
-    }
     std::cout<<"done!" <<std::endl;
+    return SDK_SUCCESS;
 }
 
 int
@@ -806,7 +806,10 @@ BoxFilterSAT::verifyResults()
     if(sampleArgs->verify)
     {
         // reference implementation
-        boxFilterCPUReference();
+        if(boxFilterCPUReference() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
 
         // Compare between outputImageData and verificationOutput
         if(!memcmp(outputImageData,
@@ -846,6 +849,16 @@ BoxFilterSAT::printStats()
         stats[3] = toString(kernelTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        if(hostTime > 0)
+        {
+            std::string hostStrArray[3] = {"Host SAT+Filter Time(sec)", "Host MPixels/sec", "Host Accumulators"};
+            std::string hostStats[3];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(width * height / hostTime * 1e-6, std::dec);
+            hostStats[2] = engine.isWide() ? "64-bit" : "32-bit";
+            printStatistics(hostStrArray, hostStats, 3);
+        }
     }
 }
 
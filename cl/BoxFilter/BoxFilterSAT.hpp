@@ -24,9 +24,11 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <algorithm>
 
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
+#include "SATEngine.hpp"
 
 using namespace appsdk;
 
@@ -39,10 +41,6 @@ using namespace appsdk;
 #define FILTER 6          //Filter size : FILTER x FILTER
 #define SAT_FETCHES 16     //Number of fetches in computing SAT
 
-#ifndef min
-#define min(a,b) (((a) < (b)) ? (a) : (b))
-#endif
-
 /**
 * BoxFilter
 * Class implements OpenCL Box Filter sample
@@ -93,6 +91,10 @@ class BoxFilterSAT
 
         SDKTimer    *sampleTimer;           /**< SDKTimer object */
 
+        SATEngine engine;                   /**< Host summed-area table */
+        int cpuThreads;                     /**< Host threads, 0 uses every core */
+        cl_double hostTime;                 /**< Time of the host table and filter */
+
     public:
 
         CLCommandArgs   *sampleArgs;        /**< CLCommand argument class */
@@ -131,6 +133,8 @@ class BoxFilterSAT
             satHorizontalBuffer = NULL;
             satVerticalBuffer = NULL;
             filterWidth = FILTER;
+            cpuThreads = 0;
+            hostTime = 0;
             sampleArgs = new CLCommandArgs() ;
             sampleTimer = new SDKTimer();
             sampleArgs->sampleVerStr = SAMPLE_VERSION;
@@ -180,10 +184,11 @@ class BoxFilterSAT
         int runBoxFilterKernel();
 
         /**
-        * Reference CPU implementation of Binomial Option
-        * for performance comparison
+        * Reference CPU implementation of the SAT box filter, builds the
+        * host summed-area table and filters into verificationOutput
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
-        void boxFilterCPUReference();
+        int boxFilterCPUReference();
 
         /**
         * Override from SDKSample. Print sample stats.
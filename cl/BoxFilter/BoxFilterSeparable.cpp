@@ -464,6 +464,32 @@ BoxFilterSeparable::initialize()
     sampleArgs->AddOption(filter_width);
     delete filter_width;
 
+    Option* num_threads = new Option;
+    CHECK_ALLOCATION(num_threads, "Memory Allocation error.\n");
+
+    num_threads->_sVersion = "";
+    num_threads->_lVersion = "threads";
+    num_threads->_description =
+        "Number of host threads of the host filters (0 uses every core)";
+    num_threads->_type = CA_ARG_INT;
+    num_threads->_value = &cpuThreads;
+
+    sampleArgs->AddOption(num_threads);
+    delete num_threads;
+
+    Option* blur_sigma = new Option;
+    CHECK_ALLOCATION(blur_sigma, "Memory Allocation error.\n");
+
+    blur_sigma->_sVersion = "";
+    blur_sigma->_lVersion = "sigma";
+    blur_sigma->_description =
+        "Sigma of a host Gaussian blur written to " BLUR_IMAGE " (0 skips it)";
+    blur_sigma->_type = CA_ARG_FLOAT;
+    blur_sigma->_value = &sigma;
+
+    sampleArgs->AddOption(blur_sigma);
+    delete blur_sigma;
+
     return SDK_SUCCESS;
 }
 
@@ -590,67 +616,57 @@ int
 BoxFilterSeparable::boxFilterCPUReference()
 {
     std::cout << "Verifying results...";
-    int t = (filterWidth - 1) / 2;
-    int filterSize = filterWidth;
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
 
-    cl_uchar4 *tempData = (cl_uchar4*)malloc(width * height * 4);
-    if(tempData == NULL)
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    int status = engine.filter(inputImageData, verificationOutput, width, height,
+                               filterWidth);
+    CHECK_ERROR(status, SDK_SUCCESS, "SDKSeparableBox::filter() failed");
+
+    sampleTimer->stopTimer(timer);
+    hostTime = (double)(sampleTimer->readTimer(timer));
+    return SDK_SUCCESS;
+}
+
+
+int
+BoxFilterSeparable::runHostBlur()
+{
+    if(sigma <= 0)
     {
-        std::cout << "Memory Allocation error.\n";
-        return SDK_FAILURE;
+        return SDK_SUCCESS;
     }
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
 
-    memset(tempData, 0, width * height * sizeof(cl_uchar4));
+    cl_uchar4 *blurData = (cl_uchar4*)malloc(width * height * pixelSize);
+    CHECK_ALLOCATION(blurData, "Failed to allocate memory! (blurData)");
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
 
-    // Horizontal filter
-    for(int y = 0; y < (int)height; y++)
+    int status = engine.blur(inputImageData, blurData, width, height, sigma);
+    if(status != SDK_SUCCESS)
     {
-        for(int x = 0; x < (int)width; x++)
-        {
-            // Only threads inside horizontal apron will calculate output value
-            if(x >= t && x < (int)(width - t))
-            {
-                cl_int4 sum = {0, 0, 0, 0};
-                for(int x1 = -t; x1 <= t; x1++)
-                {
-                    sum.s[0] += inputImageData[x + x1 + y * width].s[0];
-                    sum.s[1] += inputImageData[x + x1 + y * width].s[1];
-                    sum.s[2] += inputImageData[x + x1 + y * width].s[2];
-                    sum.s[3] += inputImageData[x + x1 + y * width].s[3];
-                }
-                tempData[x + y * width].s[0] = sum.s[0] / filterSize;
-                tempData[x + y * width].s[1] = sum.s[1] / filterSize;
-                tempData[x + y * width].s[2] = sum.s[2] / filterSize;
-                tempData[x + y * width].s[3] = sum.s[3] / filterSize;
-            }
-        }
+        FREE(blurData);
+        error("SDKSeparableBox::blur() failed");
+        return SDK_FAILURE;
     }
 
-    // Vertical filter
-    for(int y = 0; y < (int)height; y++)
+    sampleTimer->stopTimer(timer);
+    blurTime = (double)(sampleTimer->readTimer(timer));
+
+    // write the blurred image through the input bitmap
+    memcpy(pixelData, blurData, width * height * pixelSize);
+    FREE(blurData);
+    if(!inputBitmap.write(BLUR_IMAGE))
     {
-        for(int x = 0; x < (int)width; x++)
-        {
-            // Only threads inside vertical apron will calculate output value
-            if(y >= t && y < (int)(height - t))
-            {
-                cl_int4 sum = {0, 0, 0, 0};
-                for(int y1 = -t; y1 <= t; y1++)
-                {
-                    sum.s[0] += tempData[x + (y + y1) * width].s[0];
-                    sum.s[1] += tempData[x + (y + y1) * width].s[1];
-                    sum.s[2] += tempData[x + (y + y1) * width].s[2];
-                    sum.s[3] += tempData[x + (y + y1) * width].s[3];
-                }
-                verificationOutput[x + y * width].s[0] = sum.s[0] / filterSize;
-                verificationOutput[x + y * width].s[1] = sum.s[1] / filterSize;
-                verificationOutput[x + y * width].s[2] = sum.s[2] / filterSize;
-                verificationOutput[x + y * width].s[3] = sum.s[3] / filterSize;
-            }
-        }
+        std::cout << "Failed to write blurred image!";
+        return SDK_FAILURE;
     }
-
-    FREE(tempData);
     return SDK_SUCCESS;
 }
 
@@ -666,9 +682,10 @@ BoxFilterSeparable::verifyResults()
     if(sampleArgs->verify)
     {
         // reference implementation
-        boxFilterCPUReference();
-
-        int j = 0;
+        if(boxFilterCPUReference() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
 
         // Compare between outputImageData and verificationOutput
         if(!memcmp(outputImageData,
@@ -708,6 +725,16 @@ BoxFilterSeparable::printStats()
         stats[3] = toString(kernelTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        if(hostTime > 0 || blurTime > 0)
+        {
+            std::string hostStrArray[3] = {"Host Time(sec)", "Host MPixels/sec", "Host Blur Time(sec)"};
+            std::string hostStats[3];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(hostTime > 0 ? width * height / hostTime * 1e-6 : 0, std::dec);
+            hostStats[2] = toString(blurTime, std::dec);
+            printStatistics(hostStrArray, hostStats, 3);
+        }
     }
 }
 
@@ -745,6 +772,11 @@ int BoxFilterSeparable::runSeparableVersion(int argc, char * argv[])
             return SDK_FAILURE;
         }
 
+        if(runHostBlur() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+
         if(cleanup() != SDK_SUCCESS)
         {
             return SDK_FAILURE;
@@ -25,11 +25,13 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
+#include "SDKSeparableBox.hpp"
 
 using namespace appsdk;
 
 #define INPUT_IMAGE "BoxFilter_Input.bmp"
 #define OUTPUT_IMAGE "BoxFilter_Output.bmp"
+#define BLUR_IMAGE "BoxFilter_Blur.bmp"
 
 #define GROUP_SIZE 256
 #define FILTER_WIDTH 8
@@ -74,6 +76,12 @@ class BoxFilterSeparable
                             kernelInfoV;    /**< Structure to store kernel related info */
         SDKTimer    *sampleTimer;           /**< SDKTimer object */
 
+        SDKSeparableBox engine;             /**< Host running-sum box filter */
+        int cpuThreads;                     /**< Host threads, 0 uses every core */
+        cl_float sigma;                     /**< Sigma of the host Gaussian blur, 0 skips it */
+        cl_double hostTime;                 /**< Time of the host box filter */
+        cl_double blurTime;                 /**< Time of the host Gaussian blur */
+
     public:
 
         CLCommandArgs   *sampleArgs;        /**< CLCommand argument class */
@@ -107,6 +115,10 @@ class BoxFilterSeparable
             blockSizeY = 1;
             iterations = 1;
             filterWidth = FILTER_WIDTH;
+            cpuThreads = 0;
+            sigma = 0;
+            hostTime = 0;
+            blurTime = 0;
             sampleArgs = new CLCommandArgs() ;
             sampleTimer = new SDKTimer();
         }
@@ -138,11 +150,19 @@ class BoxFilterSeparable
         int runCLKernels();
 
         /**
-        * Reference CPU implementation of Binomial Option
-        * for performance comparison
+        * Reference CPU implementation of the separable box filter, runs
+        * the host running-sum passes into verificationOutput
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
         int boxFilterCPUReference();
 
+        /**
+        * Blurs the input image with the host iterated box filters when
+        * --sigma is given and writes it to BLUR_IMAGE
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        */
+        int runHostBlur();
+
         /**
         * Override from SDKSample. Print sample stats.
         */
@@ -0,0 +1,354 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "SATEngine.hpp"
+#include <emmintrin.h>
+#include <string.h>
+#include <algorithm>
+
+/*
+ * Table entries per work item of the column pass
+ */
+#define COLUMN_CHUNK 256
+
+/**
+ * Arguments of the table and filter threads
+ */
+struct SATEngine::rangeArgs
+{
+    SATEngine *engine;
+    const cl_uchar4 *input;
+    cl_uchar4 *output;
+    cl_uint filterWidth;
+    cl_uint numChunks;          /**< Column pass items */
+};
+
+/*
+ * Prefix sums of the channels of one row, after a zero entry
+ */
+static void
+rowPrefix(const cl_uchar4 *input, cl_uint *output, cl_uint width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = zero;
+    _mm_storeu_si128((__m128i*)output, sum);
+
+    for(cl_uint x = 0; x < width; x++)
+    {
+        int pixel;
+        memcpy(&pixel, &input[x], sizeof(pixel));
+        __m128i channels = _mm_unpacklo_epi16(
+                               _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), zero), zero);
+        sum = _mm_add_epi32(sum, channels);
+        _mm_storeu_si128((__m128i*)(output + 4 * (x + 1)), sum);
+    }
+}
+
+static void
+rowPrefix(const cl_uchar4 *input, cl_ulong *output, cl_uint width)
+{
+    cl_ulong sum[4] = {0, 0, 0, 0};
+    memset(output, 0, 4 * sizeof(cl_ulong));
+
+    for(cl_uint x = 0; x < width; x++)
+    {
+        for(int c = 0; c < 4; c++)
+        {
+            sum[c] += input[x].s[c];
+            output[4 * (x + 1) + c] = sum[c];
+        }
+    }
+}
+
+/*
+ * row[i] += above[i] for count entries, count a multiple of 4
+ */
+static void
+addRow(const cl_uint *above, cl_uint *row, size_t count)
+{
+    for(size_t i = 0; i < count; i += 4)
+    {
+        __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(above + i)),
+                                    _mm_loadu_si128((const __m128i*)(row + i)));
+        _mm_storeu_si128((__m128i*)(row + i), sum);
+    }
+}
+
+static void
+addRow(const cl_ulong *above, cl_ulong *row, size_t count)
+{
+    for(size_t i = 0; i < count; i += 2)
+    {
+        __m128i sum = _mm_add_epi64(_mm_loadu_si128((const __m128i*)(above + i)),
+                                    _mm_loadu_si128((const __m128i*)(row + i)));
+        _mm_storeu_si128((__m128i*)(row + i), sum);
+    }
+}
+
+/*
+ * Box averages of the pixels [begin, end) of a row from the table rows
+ * above and below the box, with integer division as in the kernel
+ */
+template<typename T>
+static void
+filterRowScalar(const T *top, const T *bottom, cl_uint k, cl_uint filterSize,
+                cl_uint begin, cl_uint end, cl_uchar4 *output)
+{
+    for(cl_uint x = begin; x < end; x++)
+    {
+        size_t left = 4 * (x - k);
+        size_t right = 4 * (x + k + 1);
+        for(int c = 0; c < 4; c++)
+        {
+            T sum = bottom[right + c] - bottom[left + c] - top[right + c] + top[left + c];
+            output[x].s[c] = (cl_uchar)(sum / filterSize);
+        }
+    }
+}
+
+static void
+filterRow(const cl_uint *top, const cl_uint *bottom, cl_uint k, cl_uint filterSize,
+          cl_uint begin, cl_uint end, cl_uchar4 *output)
+{
+    // Below 2^24 the float quotient truncates to the integer quotient
+    if((2 * k + 1) > 256)
+    {
+        filterRowScalar(top, bottom, k, filterSize, begin, end, output);
+        return;
+    }
+
+    const __m128 divisor = _mm_set1_ps((cl_float)filterSize);
+    const cl_uint *topLeft = top + 4 * (begin - k);
+    const cl_uint *topRight = top + 4 * (begin + k + 1);
+    const cl_uint *bottomLeft = bottom + 4 * (begin - k);
+    const cl_uint *bottomRight = bottom + 4 * (begin + k + 1);
+
+    cl_uint x = begin;
+    for(; x + 4 <= end; x += 4)
+    {
+        __m128i average[4];
+        for(int i = 0; i < 4; i++)
+        {
+            size_t e = 4 * (x - begin + i);
+            __m128i sum = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(bottomRight + e)),
+                                        _mm_loadu_si128((const __m128i*)(bottomLeft + e)));
+            sum = _mm_sub_epi32(sum, _mm_loadu_si128((const __m128i*)(topRight + e)));
+            sum = _mm_add_epi32(sum, _mm_loadu_si128((const __m128i*)(topLeft + e)));
+            average[i] = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(sum), divisor));
+        }
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(average[0], average[1]),
+                                          _mm_packs_epi32(average[2], average[3]));
+        _mm_storeu_si128((__m128i*)(output + x), packed);
+    }
+
+    filterRowScalar(top, bottom, k, filterSize, x, end, output);
+}
+
+static void
+filterRow(const cl_ulong *top, const cl_ulong *bottom, cl_uint k, cl_uint filterSize,
+          cl_uint begin, cl_uint end, cl_uchar4 *output)
+{
+    filterRowScalar(top, bottom, k, filterSize, begin, end, output);
+}
+
+/*
+ * Rows of the image go to rows 1 to height of the table
+ */
+template<typename T>
+static void
+buildRows(const cl_uchar4 *input, T *table, cl_uint width, cl_uint begin, cl_uint end)
+{
+    const size_t rowEntries = 4 * ((size_t)width + 1);
+    for(cl_uint y = begin; y < end; y++)
+    {
+        rowPrefix(input + (size_t)y * width, table + (y + 1) * rowEntries, width);
+    }
+}
+
+/*
+ * Sums the entries [first, last) of every row into the row below
+ */
+template<typename T>
+static void
+buildColumns(T *table, cl_uint width, cl_uint height, size_t first, size_t last)
+{
+    const size_t rowEntries = 4 * ((size_t)width + 1);
+    for(cl_uint y = 2; y <= height; y++)
+    {
+        T *row = table + y * rowEntries;
+        addRow(row - rowEntries + first, row + first, last - first);
+    }
+}
+
+template<typename T>
+static void
+filterRows(const T *table, cl_uint width, cl_uint height, cl_uint filterWidth,
+           cl_uchar4 *output, cl_uint begin, cl_uint end)
+{
+    const size_t rowEntries = 4 * ((size_t)width + 1);
+    const cl_uint k = (filterWidth - 1) / 2;
+    const cl_uint filterSize = filterWidth * filterWidth;
+
+    // Pixels [k, width - k) of rows [k, height - k) have a whole box
+    const cl_uint xEnd = width > k ? width - k : 0;
+    const cl_uint yEnd = height > k ? height - k : 0;
+
+    for(cl_uint y = begin; y < end; y++)
+    {
+        cl_uchar4 *row = output + (size_t)y * width;
+        if(y < k || y >= yEnd || k >= xEnd)
+        {
+            memset(row, 0, width * sizeof(cl_uchar4));
+            continue;
+        }
+
+        memset(row, 0, k * sizeof(cl_uchar4));
+        filterRow(table + (y - k) * rowEntries, table + (y + k + 1) * rowEntries,
+                  k, filterSize, k, xEnd, row);
+        memset(row + xEnd, 0, (width - xEnd) * sizeof(cl_uchar4));
+    }
+}
+
+void
+SATEngine::rowThread(void *data, unsigned int begin, unsigned int end,
+                     unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    SATEngine *engine = args->engine;
+    if(engine->wide)
+    {
+        buildRows(args->input, &engine->wideTable[0], engine->width, begin, end);
+    }
+    else
+    {
+        buildRows(args->input, &engine->table[0], engine->width, begin, end);
+    }
+}
+
+void
+SATEngine::columnThread(void *data, unsigned int begin, unsigned int end,
+                        unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    SATEngine *engine = args->engine;
+
+    // The chunks of a thread are contiguous, so each row is one span
+    size_t rowEntries = 4 * ((size_t)engine->width + 1);
+    size_t first = (size_t)begin * COLUMN_CHUNK;
+    size_t last = std::min((size_t)end * COLUMN_CHUNK, rowEntries);
+    if(engine->wide)
+    {
+        buildColumns(&engine->wideTable[0], engine->width, engine->height, first, last);
+    }
+    else
+    {
+        buildColumns(&engine->table[0], engine->width, engine->height, first, last);
+    }
+}
+
+void
+SATEngine::filterThread(void *data, unsigned int begin, unsigned int end,
+                        unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const SATEngine *engine = args->engine;
+    if(engine->wide)
+    {
+        filterRows(&engine->wideTable[0], engine->width, engine->height,
+                   args->filterWidth, args->output, begin, end);
+    }
+    else
+    {
+        filterRows(&engine->table[0], engine->width, engine->height,
+                   args->filterWidth, args->output, begin, end);
+    }
+}
+
+int
+SATEngine::build(const cl_uchar4 *input, cl_uint width, cl_uint height)
+{
+    if(input == NULL || width == 0 || height == 0)
+    {
+        error("SATEngine::build() needs a non-empty image");
+        return SDK_FAILURE;
+    }
+
+    this->width = width;
+    this->height = height;
+    size_t rowEntries = 4 * ((size_t)width + 1);
+    size_t entries = rowEntries * ((size_t)height + 1);
+
+    // 32-bit entries hold the sum of the whole image
+    wide = 255.0 * width * height > 4294967295.0;
+    if(wide)
+    {
+        table.clear();
+        wideTable.resize(entries);
+        memset(&wideTable[0], 0, rowEntries * sizeof(cl_ulong));
+    }
+    else
+    {
+        wideTable.clear();
+        table.resize(entries);
+        memset(&table[0], 0, rowEntries * sizeof(cl_uint));
+    }
+
+    rangeArgs args;
+    args.engine = this;
+    args.input = input;
+    args.output = NULL;
+    args.filterWidth = 0;
+    args.numChunks = (cl_uint)((rowEntries + COLUMN_CHUNK - 1) / COLUMN_CHUNK);
+
+    bool created = parallelFor(rowThread, &args, height, numThreads);
+    created = parallelFor(columnThread, &args, args.numChunks, numThreads) && created;
+    if(!created)
+    {
+        error("SATEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+int
+SATEngine::filter(cl_uchar4 *output, cl_uint filterWidth)
+{
+    if(output == NULL || filterWidth == 0)
+    {
+        error("SATEngine::filter() needs an output and a filter width");
+        return SDK_FAILURE;
+    }
+    if(width == 0)
+    {
+        error("SATEngine::filter() needs a table from build()");
+        return SDK_FAILURE;
+    }
+
+    rangeArgs args;
+    args.engine = this;
+    args.input = NULL;
+    args.output = output;
+    args.filterWidth = filterWidth;
+    args.numChunks = 0;
+
+    if(!parallelFor(filterThread, &args, height, numThreads))
+    {
+        error("SATEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
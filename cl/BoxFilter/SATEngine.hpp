@@ -0,0 +1,105 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef SATENGINE_H_
+#define SATENGINE_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * SATEngine
+ * Class implements a multi-threaded host summed-area table of a uchar4
+ * image and the box filter of the box_filter kernel over it.
+ *
+ * The table has a leading row and column of zeros, so every box sum is
+ * four lookups without bound tests and costs the same for any filter
+ * width. Rows are prefix summed in parallel, then column ranges are summed
+ * down the rows in parallel. Accumulators are 32-bit per channel while the
+ * sum of the whole image fits, and 64-bit beyond.
+ */
+class SATEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+        cl_uint width;                  /**< Width of the image of the table */
+        cl_uint height;                 /**< Height of the image of the table */
+        bool wide;                      /**< 64-bit accumulators */
+        std::vector<cl_uint> table;     /**< 32-bit table, 4 channels per entry */
+        std::vector<cl_ulong> wideTable;    /**< 64-bit table, 4 channels per entry */
+
+        struct rangeArgs;
+        static void rowThread(void *data, unsigned int begin, unsigned int end,
+                              unsigned int threadId);
+        static void columnThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId);
+        static void filterThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        SATEngine()
+            : numThreads(0),
+              width(0),
+              height(0),
+              wide(false)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Builds the summed-area table of an image
+         * @param input pixels, width * height
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int build(const cl_uchar4 *input, cl_uint width, cl_uint height);
+
+        /**
+         * True if build() chose 64-bit accumulators
+         */
+        bool isWide() const
+        {
+            return wide;
+        }
+
+        /**
+         * Box filters the image of build() like the box_filter kernel: pixel
+         * (x, y) is the sum of the (2k + 1)^2 pixels around it divided by
+         * filterWidth^2, k = (filterWidth - 1) / 2. Pixels closer than k to a
+         * border are 0.
+         * @param output output pixels, width * height
+         * @param filterWidth width of the filter, at least 1
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int filter(cl_uchar4 *output, cl_uint filterWidth);
+};
+
+#endif
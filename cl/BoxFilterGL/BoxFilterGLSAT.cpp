@@ -438,11 +438,11 @@ BoxFilterGLSAT::setupCL()
     status =  kernelInfoVSAT.setKernelWorkGroupInfo(verticalSAT, interopDeviceId);
     CHECK_ERROR(status, SDK_SUCCESS, "setKErnelWorkGroupInfo() failed");
 
-    size_t minA = min(kernelInfoVSAT.kernelWorkGroupSize,
-                      kernelInfoHSAT.kernelWorkGroupSize);
-    size_t minB = min(kernelInfo.kernelWorkGroupSize,
-                      kernelInfoHSAT0.kernelWorkGroupSize);
-    kernelWorkGroupSize = min(minA, minB);
+    size_t minA = std::min(kernelInfoVSAT.kernelWorkGroupSize,
+                           kernelInfoHSAT.kernelWorkGroupSize);
+    size_t minB = std::min(kernelInfo.kernelWorkGroupSize,
+                           kernelInfoHSAT0.kernelWorkGroupSize);
+    kernelWorkGroupSize = std::min(minA, minB);
 
     if((blockSizeX * blockSizeY) > kernelWorkGroupSize)
     {
@@ -29,10 +29,6 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #define FILTER 9          //Filter size : FILTER x FILTER
 #define SAT_FETCHES 16     //Number of fetches in computing SAT
 
-#ifndef min
-#define min(a,b) (((a) < (b)) ? (a) : (b))
-#endif
-
 
 #define screenWidth  512
 #define screenHeight 512
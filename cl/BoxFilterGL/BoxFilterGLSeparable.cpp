@@ -1548,70 +1548,14 @@ BoxFilterGLSeparable::cleanup()
 
 
 
-void
+int
 BoxFilterGLSeparable::boxFilterCPUReference()
 {
     std::cout << "verifying results...";
-    int t = (filterWidthSeperable - 1) / 2;
-    int filterSize = filterWidthSeperable;
-
-    cl_uchar4 *tempData = (cl_uchar4*)malloc(width * height * 4);
-    if(tempData == NULL)
-    {
-        std::cout << "Memory Allocation error.\n";
-        exit(1);
-    }
-    memset(tempData, 0, width * height * sizeof(cl_uchar4));
-
-    // Horizontal filter
-    for(int y = 0; y < (int)height; y++)
-    {
-        for(int x = 0; x < (int)width; x++)
-        {
-            // Only threads inside horizontal apron will calculate output value
-            if(x >= t && x < (int)(width - t))
-            {
-                cl_int4 sum = {0, 0, 0, 0};
-                for(int x1 = -t; x1 <= t; x1++)
-                {
-                    sum.s[0] += inputImageData[x + x1 + y * width].s[0];
-                    sum.s[1] += inputImageData[x + x1 + y * width].s[1];
-                    sum.s[2] += inputImageData[x + x1 + y * width].s[2];
-                    sum.s[3] += inputImageData[x + x1 + y * width].s[3];
-                }
-                tempData[x + y * width].s[0] = sum.s[0] / filterSize;
-                tempData[x + y * width].s[1] = sum.s[1] / filterSize;
-                tempData[x + y * width].s[2] = sum.s[2] / filterSize;
-                tempData[x + y * width].s[3] = sum.s[3] / filterSize;
-            }
-        }
-    }
-
-    // Vertical filter
-    for(int y = 0; y < (int)height; y++)
-    {
-        for(int x = 0; x < (int)width; x++)
-        {
-            // Only threads inside vertical apron will calculate output value
-            if(y >= t && y < (int)(height - t))
-            {
-                cl_int4 sum = {0, 0, 0, 0};
-                for(int y1 = -t; y1 <= t; y1++)
-                {
-                    sum.s[0] += tempData[x + (y + y1) * width].s[0];
-                    sum.s[1] += tempData[x + (y + y1) * width].s[1];
-                    sum.s[2] += tempData[x + (y + y1) * width].s[2];
-                    sum.s[3] += tempData[x + (y + y1) * width].s[3];
-                }
-                verificationOutput[x + y * width].s[0] = sum.s[0] / filterSize;
-                verificationOutput[x + y * width].s[1] = sum.s[1] / filterSize;
-                verificationOutput[x + y * width].s[2] = sum.s[2] / filterSize;
-                verificationOutput[x + y * width].s[3] = sum.s[3] / filterSize;
-            }
-        }
-    }
-
-    FREE(tempData);
+    int status = engine.filter(inputImageData, verificationOutput, width, height,
+                               filterWidthSeperable);
+    CHECK_ERROR(status, SDK_SUCCESS, "SDKSeparableBox::filter() failed");
+    return SDK_SUCCESS;
 }
 
 
@@ -1626,9 +1570,10 @@ BoxFilterGLSeparable::verifyResults()
     if(sampleArgs->verify)
     {
         // reference implementation
-        boxFilterCPUReference();
-
-        int j = 0;
+        if(boxFilterCPUReference() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
 
         // Compare between outputImageData and verificationOutput
         if(!memcmp(outputImageData,
@@ -17,6 +17,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #ifndef BOX_FILTER_GL_SEPARABLE_H_
 #define BOX_FILTER_GL_SEPARABLE_H_
 #include "CommonDeclare.hpp"
+#include "SDKSeparableBox.hpp"
 #ifndef INPUT_IMAGE
 #define INPUT_IMAGE "BoxFilterGL_Input.bmp"
 #endif
@@ -73,6 +74,7 @@ class BoxFilterGLSeparable
 		bool dummy_sep_variable;
 		bool dummy_sat_variable;
         SDKTimer    *sampleTimer;            /**< SDKTimer object */
+        SDKSeparableBox engine;              /**< Host running-sum box filter */
 
     public:
 
@@ -185,10 +187,11 @@ class BoxFilterGLSeparable
         int runCLKernels();
 
         /**
-        * Reference CPU implementation of Binomial Option
-        * for performance comparison
+        * Reference CPU implementation of the separable box filter, runs
+        * the host running-sum passes into verificationOutput
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
-        void boxFilterCPUReference();
+        int boxFilterCPUReference();
 
         /**
         * Override from SDKSample. Print sample stats.
@@ -27,6 +27,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <algorithm>
 
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
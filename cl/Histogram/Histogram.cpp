@@ -27,12 +27,23 @@ Histogram::calculateHostBin()
     CHECK_ERROR(status, SDK_SUCCESS,
                 "Failed to map device buffer.(dataBuf in calcHostBin)");
 
-    for(int i = 0; i < height; ++i)
+    // Privatized multi-threaded histogram, values are already bin indices
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    hostHistogram.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+    bool computed = hostHistogram.computeUint(data, width * height, binSize,
+                    hostBin);
+
+    sampleTimer->stopTimer(timer);
+    hostTime = (double)(sampleTimer->readTimer(timer));
+
+    if(!computed)
     {
-        for(int j = 0; j < width; ++j)
-        {
-            hostBin[data[i * width + j]]++;
-        }
+        unmapBuffer( dataBuf, data );
+        std::cout << "Failed to compute the host histogram" << std::endl;
+        return SDK_FAILURE;
     }
 
     status = unmapBuffer( dataBuf, data );
@@ -451,6 +462,19 @@ Histogram::initialize()
     sampleArgs->AddOption(vector_option);
     delete vector_option;
 
+    Option* thread_option = new Option;
+    CHECK_ALLOCATION(thread_option, "Memory allocation error.\n");
+
+    thread_option->_sVersion = "";
+    thread_option->_lVersion = "threads";
+    thread_option->_description =
+        "Number of host threads of the reference histogram (0 uses every core)";
+    thread_option->_type = CA_ARG_INT;
+    thread_option->_value = &cpuThreads;
+
+    sampleArgs->AddOption(thread_option);
+    delete thread_option;
+
 
 
     return SDK_SUCCESS;
@@ -554,7 +578,10 @@ Histogram::verifyResults()
          * Reference implementation on host device
          * calculates the histogram bin on host
          */
-        calculateHostBin();
+        if(calculateHostBin() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
 
         // compare the results and see if they match
         bool result = true;
@@ -611,6 +638,22 @@ void Histogram::printStats()
         stats[4] = toString(((width*height)/avgKernelTime), std::dec);
 
         printStatistics(strArray, stats, 5);
+
+        // Host reference, timed when verification ran
+        if(hostTime > 0)
+        {
+            std::string hostStrArray[2] =
+            {
+                "Host Histogram Time (sec)",
+                "Host Elements/sec"
+            };
+            std::string hostStats[2];
+
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(((width*height)/hostTime), std::dec);
+
+            printStatistics(hostStrArray, hostStats, 2);
+        }
     }
 }
 
@@ -27,6 +27,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 
 #include "CLUtil.hpp"
+#include "SDKHistogram.hpp"
 
 using namespace appsdk;
 
@@ -77,6 +78,9 @@ class Histogram
         bool scalar;                        /**< scalar kernel */
         bool vector;                        /**< vector kernel */
         int vectorWidth;                    /**< vector width used by the kernel*/
+        SDKHistogram hostHistogram;         /**< Multi-threaded host histogram */
+        int cpuThreads;                     /**< Host threads, 0 uses every core */
+        cl_double hostTime;                 /**< time taken by the host histogram */
         size_t globalThreads;
         size_t localThreads ;
         int groupIterations;
@@ -115,7 +119,9 @@ class Histogram
             iterations(1),
             scalar(false),
             vector(false),
-            vectorWidth(0)
+            vectorWidth(0),
+            cpuThreads(0),
+            hostTime(0)
         {
             /* Set default values for width and height */
             width = WIDTH;
@@ -0,0 +1,881 @@
+/**********************************************************************
+Copyright ©2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+.   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+.   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "KMeansEngine.hpp"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <emmintrin.h>
+
+/*
+ * Coordinate of the padding centroids, far from every point
+ */
+#define FAR_COORD 1e18f
+
+/*
+ * Points below which another thread does not pay off
+ */
+#define MIN_POINTS_PER_THREAD 4096
+
+/*
+ * Four-point blocks summed in float before the sums move to double
+ */
+#define SILHOUETTE_FLUSH 256
+
+/*
+ * Two-sided 95% normal quantile of the silhouette error bounds
+ */
+#define Z_95 1.96
+
+/**
+ * Arguments of the engine threads
+ */
+struct KMeansEngine::rangeArgs
+{
+    KMeansEngine *engine;
+    cl_uint centroid;       /**< Seeding: centroid lowering the distances */
+    bool full;              /**< Assignment: assign every point from scratch */
+    const cl_uint *queries; /**< Silhouette: sorted indices of the scored points */
+    cl_uint numQueries;     /**< Silhouette: number of scored points */
+    bool simplified;        /**< Silhouette: centroid based scores */
+};
+
+unsigned int
+KMeansEngine::passThreads(cl_uint items)
+{
+    unsigned int threads = numThreads ? numThreads : getNumCPUCores();
+    threads = std::min(threads, std::max(items / MIN_POINTS_PER_THREAD, 1u));
+    threadSlots = threads;
+    threadTotals.resize(threads);
+    threadDistances.resize(threads);
+    return threads;
+}
+
+void
+KMeansEngine::packCentroids()
+{
+    paddedClusters = (numClusters + 3) & ~3u;
+    centroids.assign(dims * paddedClusters, FAR_COORD);
+    for(cl_uint j = 0; j < numClusters; j++)
+    {
+        for(cl_uint d = 0; d < dims; d++)
+        {
+            centroids[d * paddedClusters + j] = centroidPos[j * dims + d];
+        }
+    }
+}
+
+cl_double
+KMeansEngine::nextRandom()
+{
+    // xorshift32, the top 24 bits give a uniform float grid
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return (randomState >> 8) * (1.0 / 16777216.0);
+}
+
+int
+KMeansEngine::setPoints(const cl_float *points, cl_uint count, cl_uint pointDims)
+{
+    if(points == NULL || count == 0 || pointDims == 0)
+    {
+        error("KMeansEngine::setPoints() needs at least one point");
+        return SDK_FAILURE;
+    }
+
+    numPoints = count;
+    paddedPoints = (count + 3) & ~3u;
+    dims = pointDims;
+
+    // Padding points repeat the first point so their distances stay finite
+    coords.resize(dims * paddedPoints);
+    for(cl_uint d = 0; d < dims; d++)
+    {
+        cl_float *dst = &coords[d * paddedPoints];
+        for(cl_uint i = 0; i < numPoints; i++)
+        {
+            dst[i] = points[i * dims + d];
+        }
+        for(cl_uint i = numPoints; i < paddedPoints; i++)
+        {
+            dst[i] = points[d];
+        }
+    }
+
+    assignment.assign(numPoints, 0);
+    upper.assign(numPoints, 0.0f);
+    lower.assign(numPoints, 0.0f);
+    numClusters = 0;
+    centroidPos.clear();
+    packCentroids();
+    return SDK_SUCCESS;
+}
+
+void
+KMeansEngine::appendCentroid(const cl_float *pos)
+{
+    centroidPos.insert(centroidPos.end(), pos, pos + dims);
+    numClusters++;
+    packCentroids();
+}
+
+void
+KMeansEngine::seedThread(void *data, unsigned int begin, unsigned int end,
+                         unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    KMeansEngine *eng = args->engine;
+    const cl_uint pP = eng->paddedPoints;
+    const cl_uint pC = eng->paddedClusters;
+    const cl_float *coords = &eng->coords[0];
+    const cl_float *centroid = &eng->centroids[args->centroid];
+    cl_float *minDist = &eng->minDistSqr[0];
+
+    // Four points per step, begin and end count groups of four
+    __m128d total = _mm_setzero_pd();
+    for(cl_uint b = begin; b < end; b++)
+    {
+        cl_uint i = 4 * b;
+        __m128 acc = _mm_setzero_ps();
+        for(cl_uint d = 0; d < eng->dims; d++)
+        {
+            __m128 diff = _mm_sub_ps(_mm_loadu_ps(coords + d * pP + i),
+                                     _mm_set1_ps(centroid[d * pC]));
+            acc = _mm_add_ps(acc, _mm_mul_ps(diff, diff));
+        }
+        __m128 m = _mm_min_ps(_mm_loadu_ps(minDist + i), acc);
+        _mm_storeu_ps(minDist + i, m);
+        total = _mm_add_pd(total, _mm_cvtps_pd(m));
+        total = _mm_add_pd(total, _mm_cvtps_pd(_mm_movehl_ps(m, m)));
+    }
+
+    cl_double sum[2];
+    _mm_storeu_pd(sum, total);
+    eng->threadTotals[threadId] = sum[0] + sum[1];
+}
+
+cl_double
+KMeansEngine::updateMinDistances(cl_uint c)
+{
+    cl_uint groups = paddedPoints / 4;
+    unsigned int threads = passThreads(groups * 4);
+
+    rangeArgs args;
+    args.engine = this;
+    args.centroid = c;
+    args.full = false;
+    parallelFor(seedThread, &args, groups, threads);
+
+    cl_double total = 0;
+    for(unsigned int t = 0; t < threads; t++)
+    {
+        total += threadTotals[t];
+    }
+    return total;
+}
+
+void
+KMeansEngine::addSampledCentroid(cl_double total)
+{
+    cl_uint pick = numPoints;
+    if(total > 0)
+    {
+        // Find the thread range holding the sample, then scan only that range
+        cl_double r = nextRandom() * total;
+        cl_uint groups = paddedPoints / 4;
+        for(unsigned int t = 0; t < threadSlots && pick == numPoints; t++)
+        {
+            if(r >= threadTotals[t] && t + 1 < threadSlots)
+            {
+                r -= threadTotals[t];
+                continue;
+            }
+            cl_uint begin = (cl_uint)(((cl_ulong)groups * t) / threadSlots) * 4;
+            cl_uint end = (cl_uint)(((cl_ulong)groups * (t + 1)) / threadSlots) * 4;
+            end = std::min(end, numPoints);
+            for(cl_uint i = begin; i < end; i++)
+            {
+                if(minDistSqr[i] > 0)
+                {
+                    pick = i;
+                    if(r < minDistSqr[i])
+                    {
+                        break;
+                    }
+                    r -= minDistSqr[i];
+                }
+            }
+        }
+    }
+
+    if(pick == numPoints)
+    {
+        // Every point sits on a centroid, any point will do
+        pick = std::min((cl_uint)(nextRandom() * numPoints), numPoints - 1);
+    }
+
+    std::vector<cl_float> pos(dims);
+    for(cl_uint d = 0; d < dims; d++)
+    {
+        pos[d] = coords[d * paddedPoints + pick];
+    }
+    appendCentroid(&pos[0]);
+}
+
+int
+KMeansEngine::seedPlusPlus(cl_uint K)
+{
+    if(numPoints == 0 || K == 0 || K > numPoints)
+    {
+        error("KMeansEngine::seedPlusPlus() needs 1 <= K <= number of points");
+        return SDK_FAILURE;
+    }
+
+    numClusters = 0;
+    centroidPos.clear();
+
+    // Padding points start at distance 0 so they are never sampled
+    minDistSqr.assign(paddedPoints, 0.0f);
+    std::fill(minDistSqr.begin(), minDistSqr.begin() + numPoints, FLT_MAX);
+
+    cl_uint first = std::min((cl_uint)(nextRandom() * numPoints), numPoints - 1);
+    std::vector<cl_float> pos(dims);
+    for(cl_uint d = 0; d < dims; d++)
+    {
+        pos[d] = coords[d * paddedPoints + first];
+    }
+    appendCentroid(&pos[0]);
+
+    cl_double total = updateMinDistances(0);
+    while(numClusters < K)
+    {
+        addSampledCentroid(total);
+        total = updateMinDistances(numClusters - 1);
+    }
+    return SDK_SUCCESS;
+}
+
+int
+KMeansEngine::addCluster()
+{
+    if(numClusters == 0)
+    {
+        return seedPlusPlus(1);
+    }
+    if(numClusters >= numPoints)
+    {
+        error("KMeansEngine::addCluster() needs more points than centroids");
+        return SDK_FAILURE;
+    }
+
+    minDistSqr.assign(paddedPoints, 0.0f);
+    std::fill(minDistSqr.begin(), minDistSqr.begin() + numPoints, FLT_MAX);
+    cl_double total = 0;
+    for(cl_uint c = 0; c < numClusters; c++)
+    {
+        total = updateMinDistances(c);
+    }
+    addSampledCentroid(total);
+    return SDK_SUCCESS;
+}
+
+int
+KMeansEngine::setCentroids(const cl_float *pos, cl_uint K)
+{
+    if(numPoints == 0 || pos == NULL || K == 0)
+    {
+        error("KMeansEngine::setCentroids() needs points and centroids");
+        return SDK_FAILURE;
+    }
+    numClusters = K;
+    centroidPos.assign(pos, pos + K * dims);
+    packCentroids();
+    return SDK_SUCCESS;
+}
+
+void
+KMeansEngine::getCentroids(cl_float *pos) const
+{
+    std::copy(centroidPos.begin(), centroidPos.end(), pos);
+}
+
+void
+KMeansEngine::pointDistances(cl_uint i, cl_float *distSqr) const
+{
+    // Four centroids per step
+    for(cl_uint j = 0; j < paddedClusters; j += 4)
+    {
+        __m128 acc = _mm_setzero_ps();
+        for(cl_uint d = 0; d < dims; d++)
+        {
+            __m128 diff = _mm_sub_ps(_mm_set1_ps(coords[d * paddedPoints + i]),
+                                     _mm_loadu_ps(&centroids[d * paddedClusters + j]));
+            acc = _mm_add_ps(acc, _mm_mul_ps(diff, diff));
+        }
+        _mm_storeu_ps(distSqr + j, acc);
+    }
+}
+
+void
+KMeansEngine::assignThread(void *data, unsigned int begin, unsigned int end,
+                           unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    KMeansEngine *eng = args->engine;
+    const cl_uint K = eng->numClusters;
+    const cl_uint dims = eng->dims;
+    const cl_uint pP = eng->paddedPoints;
+    const cl_float *coords = &eng->coords[0];
+
+    cl_double *tSums = &eng->threadSums[threadId * K * dims];
+    cl_int *tCounts = &eng->threadCounts[threadId * K];
+    std::fill(tSums, tSums + K * dims, 0.0);
+    std::fill(tCounts, tCounts + K, 0);
+
+    std::vector<cl_float> distSqr(eng->paddedClusters);
+    cl_uint changed = 0;
+    cl_ulong evaluated = 0;
+
+    for(cl_uint i = begin; i < end; i++)
+    {
+        cl_uint a = eng->assignment[i];
+        if(!args->full)
+        {
+            // Account for the centroid moves of the last update
+            cl_float u = eng->upper[i] + eng->moved[a];
+            cl_float l = eng->lower[i] -
+                         (a == eng->maxMovedId ? eng->secondMaxMoved : eng->maxMoved);
+            eng->lower[i] = l;
+
+            cl_float m = std::max(eng->halfSeparation[a], l);
+            if(u <= m)
+            {
+                eng->upper[i] = u;
+                continue;
+            }
+
+            // Tighten the upper bound to the exact distance
+            cl_float dSqr = 0;
+            for(cl_uint d = 0; d < dims; d++)
+            {
+                cl_float diff = coords[d * pP + i] - eng->centroidPos[a * dims + d];
+                dSqr += diff * diff;
+            }
+            evaluated++;
+            u = sqrtf(dSqr);
+            eng->upper[i] = u;
+            if(u <= m)
+            {
+                continue;
+            }
+        }
+
+        eng->pointDistances(i, &distSqr[0]);
+        evaluated += K;
+
+        cl_uint best = 0;
+        cl_float d1 = FLT_MAX;
+        cl_float d2 = FLT_MAX;
+        for(cl_uint j = 0; j < K; j++)
+        {
+            cl_float dj = distSqr[j];
+            if(dj < d1)
+            {
+                d2 = d1;
+                d1 = dj;
+                best = j;
+            }
+            else if(dj < d2)
+            {
+                d2 = dj;
+            }
+        }
+        eng->upper[i] = sqrtf(d1);
+        eng->lower[i] = (d2 == FLT_MAX) ? FLT_MAX : sqrtf(d2);
+
+        if(args->full || best != a)
+        {
+            if(!args->full)
+            {
+                for(cl_uint d = 0; d < dims; d++)
+                {
+                    tSums[a * dims + d] -= coords[d * pP + i];
+                }
+                tCounts[a]--;
+            }
+            for(cl_uint d = 0; d < dims; d++)
+            {
+                tSums[best * dims + d] += coords[d * pP + i];
+            }
+            tCounts[best]++;
+            eng->assignment[i] = best;
+            changed++;
+        }
+    }
+
+    eng->threadTotals[threadId] = changed;
+    eng->threadDistances[threadId] = evaluated;
+}
+
+cl_uint
+KMeansEngine::assignPoints(bool full)
+{
+    unsigned int threads = passThreads(numPoints);
+    threadSums.resize(threads * numClusters * dims);
+    threadCounts.resize(threads * numClusters);
+
+    rangeArgs args;
+    args.engine = this;
+    args.centroid = 0;
+    args.full = full;
+    parallelFor(assignThread, &args, numPoints, threads);
+
+    if(full)
+    {
+        sums.assign(numClusters * dims, 0.0);
+        counts.assign(numClusters, 0);
+    }
+
+    // Merge the per-thread deltas
+    cl_uint changed = 0;
+    for(unsigned int t = 0; t < threads; t++)
+    {
+        const cl_double *tSums = &threadSums[t * numClusters * dims];
+        const cl_int *tCounts = &threadCounts[t * numClusters];
+        for(cl_uint k = 0; k < numClusters * dims; k++)
+        {
+            sums[k] += tSums[k];
+        }
+        for(cl_uint j = 0; j < numClusters; j++)
+        {
+            counts[j] += tCounts[j];
+        }
+        changed += (cl_uint)threadTotals[t];
+        distanceCount += threadDistances[t];
+    }
+    return changed;
+}
+
+cl_float
+KMeansEngine::updateCentroids()
+{
+    maxMoved = 0;
+    secondMaxMoved = 0;
+    maxMovedId = 0;
+
+    for(cl_uint j = 0; j < numClusters; j++)
+    {
+        cl_float distSqr = 0;
+        if(counts[j] != 0)
+        {
+            for(cl_uint d = 0; d < dims; d++)
+            {
+                cl_float pos = (cl_float)(sums[j * dims + d] / counts[j]);
+                cl_float diff = pos - centroidPos[j * dims + d];
+                distSqr += diff * diff;
+                centroidPos[j * dims + d] = pos;
+            }
+        }
+        moved[j] = sqrtf(distSqr);
+
+        if(moved[j] > maxMoved)
+        {
+            secondMaxMoved = maxMoved;
+            maxMoved = moved[j];
+            maxMovedId = j;
+        }
+        else if(moved[j] > secondMaxMoved)
+        {
+            secondMaxMoved = moved[j];
+        }
+    }
+    packCentroids();
+    return maxMoved;
+}
+
+void
+KMeansEngine::updateSeparation()
+{
+    halfSeparation.assign(numClusters, FLT_MAX);
+    for(cl_uint j = 0; j < numClusters; j++)
+    {
+        for(cl_uint k = j + 1; k < numClusters; k++)
+        {
+            cl_float distSqr = 0;
+            for(cl_uint d = 0; d < dims; d++)
+            {
+                cl_float diff = centroidPos[j * dims + d] - centroidPos[k * dims + d];
+                distSqr += diff * diff;
+            }
+            cl_float half = 0.5f * sqrtf(distSqr);
+            halfSeparation[j] = std::min(halfSeparation[j], half);
+            halfSeparation[k] = std::min(halfSeparation[k], half);
+        }
+    }
+}
+
+int
+KMeansEngine::run(cl_uint maxIter, cl_float tolerance)
+{
+    if(numPoints == 0 || numClusters == 0)
+    {
+        error("KMeansEngine::run() needs points and centroids");
+        return SDK_FAILURE;
+    }
+
+    iterationCount = 0;
+    distanceCount = 0;
+    moved.assign(numClusters, 0.0f);
+
+    assignPoints(true);
+    while(iterationCount < maxIter)
+    {
+        cl_float maxMove = updateCentroids();
+        iterationCount++;
+        if(maxMove <= tolerance)
+        {
+            break;
+        }
+
+        updateSeparation();
+        if(assignPoints(false) == 0)
+        {
+            // Same assignment, the centroids cannot move any more
+            break;
+        }
+    }
+    return SDK_SUCCESS;
+}
+
+void
+KMeansEngine::sortByCluster()
+{
+    const cl_uint K = numClusters;
+    clusterStart.assign(K + 1, 0);
+    for(cl_uint j = 0; j < K; j++)
+    {
+        clusterStart[j + 1] = clusterStart[j] + counts[j];
+    }
+
+    std::vector<cl_uint> next(clusterStart.begin(), clusterStart.end() - 1);
+    sortedCoords.resize(dims * numPoints);
+    sortedCluster.resize(numPoints);
+    for(cl_uint i = 0; i < numPoints; i++)
+    {
+        cl_uint a = assignment[i];
+        cl_uint s = next[a]++;
+        sortedCluster[s] = a;
+        for(cl_uint d = 0; d < dims; d++)
+        {
+            sortedCoords[d * numPoints + s] = coords[d * paddedPoints + i];
+        }
+    }
+}
+
+void
+KMeansEngine::tileSilhouette(const cl_uint *queries, cl_uint numQueries,
+                             cl_double *scores) const
+{
+    const cl_uint K = numClusters;
+    const cl_uint N = numPoints;
+    const cl_float *sorted = &sortedCoords[0];
+
+    // Broadcast coordinates of the tile, unused slots repeat the first query
+    std::vector<cl_float> query(dims * 16);
+    for(cl_uint t = 0; t < 4; t++)
+    {
+        cl_uint q = queries[t < numQueries ? t : 0];
+        for(cl_uint d = 0; d < dims; d++)
+        {
+            for(cl_uint lane = 0; lane < 4; lane++)
+            {
+                query[(d * 4 + t) * 4 + lane] = sorted[d * N + q];
+            }
+        }
+    }
+
+    // Sum of the distances from every query to every cluster
+    std::vector<cl_double> total(4 * K, 0.0);
+    for(cl_uint c = 0; c < K; c++)
+    {
+        cl_uint j = clusterStart[c];
+        const cl_uint end = clusterStart[c + 1];
+
+        while(j + 4 <= end)
+        {
+            __m128 acc[4];
+            for(cl_uint t = 0; t < 4; t++)
+            {
+                acc[t] = _mm_setzero_ps();
+            }
+
+            cl_uint blockEnd = std::min(end, j + 4 * SILHOUETTE_FLUSH);
+            for(; j + 4 <= blockEnd; j += 4)
+            {
+                __m128 distSqr[4];
+                for(cl_uint t = 0; t < 4; t++)
+                {
+                    distSqr[t] = _mm_setzero_ps();
+                }
+                for(cl_uint d = 0; d < dims; d++)
+                {
+                    __m128 p = _mm_loadu_ps(sorted + d * N + j);
+                    const cl_float *q = &query[d * 16];
+                    for(cl_uint t = 0; t < 4; t++)
+                    {
+                        __m128 diff = _mm_sub_ps(p, _mm_loadu_ps(q + 4 * t));
+                        distSqr[t] = _mm_add_ps(distSqr[t], _mm_mul_ps(diff, diff));
+                    }
+                }
+                for(cl_uint t = 0; t < 4; t++)
+                {
+                    acc[t] = _mm_add_ps(acc[t], _mm_sqrt_ps(distSqr[t]));
+                }
+            }
+
+            for(cl_uint t = 0; t < 4; t++)
+            {
+                cl_double sum[2];
+                __m128d s = _mm_add_pd(_mm_cvtps_pd(acc[t]),
+                                       _mm_cvtps_pd(_mm_movehl_ps(acc[t], acc[t])));
+                _mm_storeu_pd(sum, s);
+                total[t * K + c] += sum[0] + sum[1];
+            }
+        }
+
+        for(; j < end; j++)
+        {
+            for(cl_uint t = 0; t < 4; t++)
+            {
+                cl_float distSqr = 0;
+                for(cl_uint d = 0; d < dims; d++)
+                {
+                    cl_float diff = sorted[d * N + j] - query[(d * 4 + t) * 4];
+                    distSqr += diff * diff;
+                }
+                total[t * K + c] += sqrtf(distSqr);
+            }
+        }
+    }
+
+    for(cl_uint t = 0; t < numQueries; t++)
+    {
+        cl_uint own = sortedCluster[queries[t]];
+        cl_double a = total[t * K + own] / counts[own];
+        cl_double b = DBL_MAX;
+        for(cl_uint c = 0; c < K; c++)
+        {
+            if(c != own && counts[c] != 0)
+            {
+                b = std::min(b, total[t * K + c] / counts[c]);
+            }
+        }
+
+        // A single cluster or coincident points score 0
+        cl_double m = std::max(a, b);
+        scores[t] = (b == DBL_MAX || m == 0) ? 0.0 : (b - a) / m;
+    }
+}
+
+cl_double
+KMeansEngine::simplifiedSilhouette(cl_uint i) const
+{
+    cl_uint own = sortedCluster[i];
+    cl_double a = 0;
+    cl_double b = DBL_MAX;
+    for(cl_uint c = 0; c < numClusters; c++)
+    {
+        if(c != own && counts[c] == 0)
+        {
+            continue;
+        }
+        cl_float distSqr = 0;
+        for(cl_uint d = 0; d < dims; d++)
+        {
+            cl_float diff = sortedCoords[d * numPoints + i] - centroidPos[c * dims + d];
+            distSqr += diff * diff;
+        }
+        if(c == own)
+        {
+            a = sqrtf(distSqr);
+        }
+        else
+        {
+            b = std::min(b, (cl_double)sqrtf(distSqr));
+        }
+    }
+
+    cl_double m = std::max(a, b);
+    return (b == DBL_MAX || m == 0) ? 0.0 : (b - a) / m;
+}
+
+void
+KMeansEngine::silhouetteThread(void *data, unsigned int begin, unsigned int end,
+                               unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    KMeansEngine *eng = args->engine;
+    cl_double *scores = &eng->pointScores[0];
+
+    if(args->simplified)
+    {
+        for(cl_uint i = begin; i < end; i++)
+        {
+            scores[i] = eng->simplifiedSilhouette(args->queries[i]);
+        }
+        return;
+    }
+
+    // begin and end count tiles of four queries
+    for(cl_uint b = begin; b < end; b++)
+    {
+        cl_uint first = 4 * b;
+        cl_uint n = std::min(4u, args->numQueries - first);
+        eng->tileSilhouette(args->queries + first, n, scores + first);
+    }
+}
+
+void
+KMeansEngine::drawSamples(cl_uint numSamples, std::vector<cl_uint> &samples)
+{
+    // Partial Fisher-Yates shuffle of the sorted indices
+    std::vector<cl_uint> pool(numPoints);
+    for(cl_uint i = 0; i < numPoints; i++)
+    {
+        pool[i] = i;
+    }
+    for(cl_uint i = 0; i < numSamples; i++)
+    {
+        cl_uint r = i + std::min((cl_uint)(nextRandom() * (numPoints - i)),
+                                 numPoints - i - 1);
+        std::swap(pool[i], pool[r]);
+    }
+    samples.assign(pool.begin(), pool.begin() + numSamples);
+    std::sort(samples.begin(), samples.end());
+}
+
+int
+KMeansEngine::silhouette(SilhouetteMode mode, cl_uint numSamples,
+                         SilhouetteResult &result)
+{
+    if(numPoints == 0 || numClusters == 0 || counts.size() != numClusters)
+    {
+        error("KMeansEngine::silhouette() needs a clustering from run()");
+        return SDK_FAILURE;
+    }
+
+    sortByCluster();
+    result.value = 0;
+    result.errorBound = 0;
+
+    // A sample of every point is the exact silhouette
+    if(mode == SILHOUETTE_SAMPLED && numSamples >= numPoints)
+    {
+        mode = SILHOUETTE_EXACT;
+    }
+    numSamples = std::min(numSamples, numPoints);
+
+    std::vector<cl_uint> queries;
+    if(mode == SILHOUETTE_EXACT || mode == SILHOUETTE_SIMPLIFIED)
+    {
+        queries.resize(numPoints);
+        for(cl_uint i = 0; i < numPoints; i++)
+        {
+            queries[i] = i;
+        }
+    }
+    else
+    {
+        drawSamples(numSamples, queries);
+    }
+
+    rangeArgs args;
+    args.engine = this;
+    args.centroid = 0;
+    args.full = false;
+    args.queries = &queries[0];
+    args.numQueries = (cl_uint)queries.size();
+    args.simplified = (mode == SILHOUETTE_SIMPLIFIED);
+    pointScores.resize(queries.size());
+
+    if(args.simplified)
+    {
+        parallelFor(silhouetteThread, &args, args.numQueries,
+                    passThreads(args.numQueries));
+    }
+    else
+    {
+        // A tile costs numPoints distances per query
+        cl_uint tiles = (args.numQueries + 3) / 4;
+        cl_ulong work = (cl_ulong)tiles * numPoints;
+        parallelFor(silhouetteThread, &args, tiles,
+                    passThreads((cl_uint)std::min(work, (cl_ulong)0xffffffffu)));
+    }
+
+    cl_double sum = 0;
+    cl_double sumSqr = 0;
+    for(size_t i = 0; i < pointScores.size(); i++)
+    {
+        sum += pointScores[i];
+        sumSqr += pointScores[i] * pointScores[i];
+    }
+    cl_double mean = sum / pointScores.size();
+    result.value = (cl_float)mean;
+
+    if(mode == SILHOUETTE_SAMPLED && numSamples > 1)
+    {
+        // Standard error of the mean, with the finite population correction
+        cl_double var = (sumSqr - sum * mean) / (numSamples - 1);
+        cl_double fpc = 1.0 - (cl_double)numSamples / numPoints;
+        result.errorBound = (cl_float)(Z_95 * sqrt(std::max(var, 0.0) * fpc / numSamples));
+    }
+    else if(mode == SILHOUETTE_SIMPLIFIED && numSamples > 1)
+    {
+        // Estimate the bias on a sample scored both ways
+        std::vector<cl_uint> samples;
+        drawSamples(numSamples, samples);
+        std::vector<cl_double> simplified(numSamples);
+        for(cl_uint i = 0; i < numSamples; i++)
+        {
+            simplified[i] = pointScores[samples[i]];
+        }
+
+        args.queries = &samples[0];
+        args.numQueries = numSamples;
+        args.simplified = false;
+        pointScores.resize(numSamples);
+        cl_uint tiles = (numSamples + 3) / 4;
+        cl_ulong work = (cl_ulong)tiles * numPoints;
+        parallelFor(silhouetteThread, &args, tiles,
+                    passThreads((cl_uint)std::min(work, (cl_ulong)0xffffffffu)));
+
+        cl_double diff = 0;
+        cl_double diffSqr = 0;
+        for(cl_uint i = 0; i < numSamples; i++)
+        {
+            cl_double e = pointScores[i] - simplified[i];
+            diff += e;
+            diffSqr += e * e;
+        }
+        cl_double bias = diff / numSamples;
+        cl_double var = (diffSqr - diff * bias) / (numSamples - 1);
+        result.errorBound = (cl_float)(fabs(bias) +
+                                       Z_95 * sqrt(std::max(var, 0.0) / numSamples));
+    }
+    return SDK_SUCCESS;
+}
@@ -0,0 +1,332 @@
+/**********************************************************************
+Copyright ©2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+.   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+.   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef KMEANSENGINE_H_
+#define KMEANSENGINE_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * Ways to score a clustering with the silhouette
+ */
+enum SilhouetteMode
+{
+    SILHOUETTE_EXACT = 0,       /**< All pairs of points */
+    SILHOUETTE_SAMPLED = 1,     /**< Exact silhouette of a random sample of points */
+    SILHOUETTE_SIMPLIFIED = 2   /**< Distances to centroids instead of to points */
+};
+
+/**
+ * SilhouetteResult
+ * Silhouette of a clustering and the half width of its 95% confidence
+ * interval around the exact value, 0 for SILHOUETTE_EXACT
+ */
+struct SilhouetteResult
+{
+    cl_float value;
+    cl_float errorBound;
+};
+
+/**
+ * KMeansEngine
+ * Class implements a multi-threaded host k-means for points of any dimension.
+ * Points are stored as one padded array per coordinate (SoA) so distances to
+ * a centroid are evaluated for four points per SSE2 operation, and centroids
+ * are stored the same way so one point is compared with four centroids at
+ * once.
+ * Lloyd iterations follow Hamerly's algorithm: every point keeps an upper
+ * bound on the distance to its centroid and a lower bound on the distance to
+ * any other one. Points whose bounds prove the assignment cannot change skip
+ * all distance evaluations. Each thread accumulates the moves of its points
+ * into private per-centroid sums that are merged after the pass.
+ * Centroids are seeded with k-means++, and addCluster() grows a converged
+ * solution by one k-means++ centroid so a sweep over K is warm started.
+ * Clusterings are scored with an exact silhouette over points sorted by
+ * centroid, a silhouette of a random sample with its confidence interval, or
+ * the O(N*K) centroid based silhouette with a sampled estimate of its bias.
+ */
+class KMeansEngine
+{
+        cl_uint numPoints;                  /**< Number of points */
+        cl_uint paddedPoints;               /**< numPoints rounded up to 4 */
+        cl_uint dims;                       /**< Coordinates per point */
+        std::vector<cl_float> coords;       /**< dims x paddedPoints coordinates */
+
+        cl_uint numClusters;                /**< Current number of centroids */
+        cl_uint paddedClusters;             /**< numClusters rounded up to 4 */
+        std::vector<cl_float> centroidPos;  /**< numClusters x dims coordinates */
+        std::vector<cl_float> centroids;    /**< dims x paddedClusters coordinates */
+        std::vector<cl_double> sums;        /**< numClusters x dims coordinate sums */
+        std::vector<cl_uint> counts;        /**< Points of every centroid */
+        std::vector<cl_float> halfSeparation; /**< Half distance to the nearest other centroid */
+        std::vector<cl_float> moved;        /**< Distance every centroid moved */
+        cl_float maxMoved;                  /**< Largest entry of moved */
+        cl_float secondMaxMoved;            /**< Largest entry of moved but maxMovedId */
+        cl_uint maxMovedId;                 /**< Centroid that moved the most */
+
+        std::vector<cl_uint> assignment;    /**< Centroid of every point */
+        std::vector<cl_float> upper;        /**< Upper bound of the assigned distance */
+        std::vector<cl_float> lower;        /**< Lower bound of the other distances */
+        std::vector<cl_float> minDistSqr;   /**< Seeding: squared distance to the nearest centroid */
+
+        unsigned int numThreads;            /**< Host threads, 0 uses every core */
+        unsigned int threadSlots;           /**< Threads of the current pass */
+        std::vector<cl_double> threadSums;  /**< Per-thread sum deltas */
+        std::vector<cl_int> threadCounts;   /**< Per-thread count deltas */
+        std::vector<cl_double> threadTotals; /**< Per-thread scalar results */
+        std::vector<cl_ulong> threadDistances; /**< Per-thread distance evaluations */
+
+        std::vector<cl_float> sortedCoords; /**< dims x numPoints coordinates ordered by centroid */
+        std::vector<cl_uint> sortedCluster; /**< Centroid of every sorted point */
+        std::vector<cl_uint> clusterStart;  /**< First sorted point of every centroid */
+        std::vector<cl_double> pointScores; /**< Silhouette of every scored point */
+
+        cl_uint randomState;                /**< xorshift state of the seeding */
+        cl_uint iterationCount;             /**< Lloyd iterations of the last run */
+        cl_ulong distanceCount;             /**< Distances evaluated by the last run */
+
+        struct rangeArgs;
+
+        static void seedThread(void *data, unsigned int begin, unsigned int end,
+                               unsigned int threadId);
+        static void assignThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId);
+        static void silhouetteThread(void *data, unsigned int begin, unsigned int end,
+                                     unsigned int threadId);
+
+        /**
+         * Sizes the per-thread state of a pass over items
+         * @return number of threads of the pass
+         */
+        unsigned int passThreads(cl_uint items);
+
+        /**
+         * Rebuilds the SoA centroids from centroidPos
+         */
+        void packCentroids();
+
+        /**
+         * @return uniform random number in [0, 1)
+         */
+        cl_double nextRandom();
+
+        /**
+         * Lowers minDistSqr with the distances to centroid c
+         * @return sum of minDistSqr over all points
+         */
+        cl_double updateMinDistances(cl_uint c);
+
+        /**
+         * Picks a point with probability proportional to minDistSqr
+         * and appends it as a centroid
+         */
+        void addSampledCentroid(cl_double total);
+
+        /**
+         * Appends the centroid at position pos
+         */
+        void appendCentroid(const cl_float *pos);
+
+        /**
+         * Computes the squared distances of point i to all centroids
+         */
+        void pointDistances(cl_uint i, cl_float *distSqr) const;
+
+        /**
+         * Runs one assignment pass over all points
+         * @param full true to assign every point from scratch
+         * @return number of points that changed centroid
+         */
+        cl_uint assignPoints(bool full);
+
+        /**
+         * Recomputes the centroids from the sums
+         * @return the largest distance a centroid moved
+         */
+        cl_float updateCentroids();
+
+        /**
+         * Recomputes halfSeparation from the centroids
+         */
+        void updateSeparation();
+
+        /**
+         * Copies the points ordered by centroid, so the points of a
+         * centroid are one contiguous SoA range
+         */
+        void sortByCluster();
+
+        /**
+         * Exact silhouettes of up to four sorted points. The points are
+         * compared with four other points per SSE2 operation, and the tile
+         * of queries reuses every loaded point four times.
+         * @param queries sorted indices of the points
+         * @param numQueries number of points, 1 to 4
+         * @param scores silhouette of every point
+         */
+        void tileSilhouette(const cl_uint *queries, cl_uint numQueries,
+                            cl_double *scores) const;
+
+        /**
+         * Centroid based silhouette of point i
+         */
+        cl_double simplifiedSilhouette(cl_uint i) const;
+
+        /**
+         * Draws numSamples distinct sorted point indices
+         */
+        void drawSamples(cl_uint numSamples, std::vector<cl_uint> &samples);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        KMeansEngine()
+            : numPoints(0),
+              paddedPoints(0),
+              dims(0),
+              numClusters(0),
+              paddedClusters(0),
+              maxMoved(0),
+              secondMaxMoved(0),
+              maxMovedId(0),
+              numThreads(0),
+              threadSlots(0),
+              randomState(2463534242u),
+              iterationCount(0),
+              distanceCount(0)
+        {
+        }
+
+        /**
+         * Copies the points
+         * @param points numPoints x pointDims coordinates, point after point
+         * @param count number of points
+         * @param pointDims coordinates per point
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int setPoints(const cl_float *points, cl_uint count, cl_uint pointDims);
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Sets the seed of the k-means++ sampling
+         */
+        void setRandomSeed(cl_uint seed)
+        {
+            randomState = seed ? seed : 2463534242u;
+        }
+
+        /**
+         * Replaces the centroids by K k-means++ seeds
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int seedPlusPlus(cl_uint K);
+
+        /**
+         * Adds one k-means++ centroid to the current ones
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int addCluster();
+
+        /**
+         * Replaces the centroids
+         * @param pos K x dims coordinates, centroid after centroid
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int setCentroids(const cl_float *pos, cl_uint K);
+
+        /**
+         * Runs Lloyd iterations until no point changes centroid, no
+         * centroid moves more than tolerance, or maxIter iterations
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int run(cl_uint maxIter, cl_float tolerance);
+
+        /**
+         * Scores the clustering of the last run. The mean dissimilarity of a
+         * point to its own cluster is divided by the cluster size, as in the
+         * sample's reference.
+         * @param mode exact, sampled or simplified silhouette
+         * @param numSamples points used to estimate the sampled silhouette
+         *        and the error of the simplified one
+         * @param result silhouette and error bound
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int silhouette(SilhouetteMode mode, cl_uint numSamples,
+                       SilhouetteResult &result);
+
+        /**
+         * Writes the centroids, centroid after centroid
+         */
+        void getCentroids(cl_float *pos) const;
+
+        /**
+         * @return centroid of every point
+         */
+        const cl_uint* getAssignments() const
+        {
+            return assignment.empty() ? NULL : &assignment[0];
+        }
+
+        /**
+         * @return points of every centroid
+         */
+        const cl_uint* getCounts() const
+        {
+            return counts.empty() ? NULL : &counts[0];
+        }
+
+        /**
+         * @return number of centroids
+         */
+        cl_uint getNumClusters() const
+        {
+            return numClusters;
+        }
+
+        /**
+         * @return Lloyd iterations of the last run
+         */
+        cl_uint getIterations() const
+        {
+            return iterationCount;
+        }
+
+        /**
+         * @return point to centroid distances evaluated by the last run
+         */
+        cl_ulong getDistanceCount() const
+        {
+            return distanceCount;
+        }
+};
+
+#endif
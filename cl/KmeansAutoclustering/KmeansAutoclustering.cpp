@@ -1031,6 +1031,101 @@ int KMeans::computeRefSilhouette(int K, float& val)
     return CL_SUCCESS;
 }
 
+/*
+ * Host autoclustering with the accelerated engine. The sweep seeds the
+ * lower bound with k-means++ and starts every following K from the
+ * converged solution of K-1 plus one k-means++ centroid. Every K is scored
+ * with the exact, sampled or simplified silhouette picked by --silhouette.
+ */
+int
+KMeans::runHostKMeans()
+{
+    int status = hostEngine.setPoints((cl_float*)refPointPos, numPoints, 2);
+    CHECK_ERROR(status, SDK_SUCCESS, "KMeansEngine::setPoints() failed");
+    hostEngine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+    if(silhouetteOption.compare("exact") == 0)
+    {
+        silhouetteMode = SILHOUETTE_EXACT;
+    }
+    else if(silhouetteOption.compare("sampled") == 0)
+    {
+        silhouetteMode = SILHOUETTE_SAMPLED;
+    }
+    else if(silhouetteOption.compare("simplified") == 0)
+    {
+        silhouetteMode = SILHOUETTE_SIMPLIFIED;
+    }
+    else
+    {
+        std::cout << "Please input exact, sampled or simplified, "
+                  << "the default silhouette is exact!" << std::endl;
+        silhouetteOption = "exact";
+        silhouetteMode = SILHOUETTE_EXACT;
+    }
+    cl_uint samples = silhouetteSamples > 1 ? silhouetteSamples : 2;
+
+    int firstK = isNumClustersSpecified ? numClusters : lowerBoundForClustering;
+    int lastK = isNumClustersSpecified ? numClusters : upperBoundForClustering;
+
+    hostClusterTime = 0;
+    hostSilhouetteTime = 0;
+    hostDistances = 0;
+    hostIterations = 0;
+    hostBestSilhouetteValue = -1;
+
+    int timer = sampleTimer->createTimer();
+    for(int K = firstK; K <= lastK; K++)
+    {
+        sampleTimer->resetTimer(timer);
+        sampleTimer->startTimer(timer);
+
+        status = (K == firstK) ? hostEngine.seedPlusPlus(K) : hostEngine.addCluster();
+        CHECK_ERROR(status, SDK_SUCCESS, "Host k-means seeding failed");
+        status = hostEngine.run(maxIter, erfc);
+        CHECK_ERROR(status, SDK_SUCCESS, "Host k-means failed");
+
+        sampleTimer->stopTimer(timer);
+        hostKTimes[K] = sampleTimer->readTimer(timer);
+        hostClusterTime += hostKTimes[K];
+        hostDistances += hostEngine.getDistanceCount();
+        hostIterations += hostEngine.getIterations();
+
+        sampleTimer->resetTimer(timer);
+        sampleTimer->startTimer(timer);
+
+        SilhouetteResult result;
+        status = hostEngine.silhouette(silhouetteMode, samples, result);
+        CHECK_ERROR(status, SDK_SUCCESS, "Host silhouette failed");
+        float val = result.value;
+
+        sampleTimer->stopTimer(timer);
+        hostKSilhouetteTimes[K] = sampleTimer->readTimer(timer);
+        hostSilhouetteTime += hostKSilhouetteTimes[K];
+
+        hostSilhouettesMap[K] = val;
+        hostSilhouetteErrors[K] = result.errorBound;
+        if(val > hostBestSilhouetteValue)
+        {
+            hostBestClusterNums = K;
+            hostBestSilhouetteValue = val;
+        }
+    }
+
+    if(!sampleArgs->quiet)
+    {
+        for(int K = firstK; K <= lastK; K++)
+        {
+            std::cout << "Host K:" << K << ", Silhouette Output:" << hostSilhouettesMap[K]
+                      << " +/- " << hostSilhouetteErrors[K]
+                      << ", kmeans(sec):" << hostKTimes[K]
+                      << ", silhouette(sec):" << hostKSilhouetteTimes[K] << std::endl;
+        }
+        std::cout << "Host best K:" << hostBestClusterNums << std::endl;
+    }
+    return SDK_SUCCESS;
+}
+
 int
 KMeans::initialize()
 {
@@ -1111,6 +1206,54 @@ KMeans::initialize()
     sampleArgs->AddOption(num_iterations);
     delete num_iterations;
 
+    Option *host_kmeans = new Option;
+    CHECK_ALLOCATION(host_kmeans, "error. Failed to allocate memory (host_kmeans)\n");
+
+    host_kmeans->_sVersion = "";
+    host_kmeans->_lVersion = "hostkmeans";
+    host_kmeans->_description = "Also run the accelerated host k-means++ sweep";
+    host_kmeans->_type = CA_NO_ARGUMENT;
+    host_kmeans->_value = &hostKMeans;
+
+    sampleArgs->AddOption(host_kmeans);
+    delete host_kmeans;
+
+    Option *num_threads = new Option;
+    CHECK_ALLOCATION(num_threads, "error. Failed to allocate memory (num_threads)\n");
+
+    num_threads->_sVersion = "";
+    num_threads->_lVersion = "threads";
+    num_threads->_description = "Number of host threads of the host k-means (0 uses every core)";
+    num_threads->_type = CA_ARG_INT;
+    num_threads->_value = &cpuThreads;
+
+    sampleArgs->AddOption(num_threads);
+    delete num_threads;
+
+    Option *silhouette_mode = new Option;
+    CHECK_ALLOCATION(silhouette_mode, "error. Failed to allocate memory (silhouette_mode)\n");
+
+    silhouette_mode->_sVersion = "";
+    silhouette_mode->_lVersion = "silhouette";
+    silhouette_mode->_description = "Silhouette of the host sweep [exact/sampled/simplified]";
+    silhouette_mode->_type = CA_ARG_STRING;
+    silhouette_mode->_value = &silhouetteOption;
+
+    sampleArgs->AddOption(silhouette_mode);
+    delete silhouette_mode;
+
+    Option *silhouette_samples = new Option;
+    CHECK_ALLOCATION(silhouette_samples, "error. Failed to allocate memory (silhouette_samples)\n");
+
+    silhouette_samples->_sVersion = "";
+    silhouette_samples->_lVersion = "samples";
+    silhouette_samples->_description = "Points of the sampled silhouette and of the simplified silhouette error";
+    silhouette_samples->_type = CA_ARG_INT;
+    silhouette_samples->_value = &silhouetteSamples;
+
+    sampleArgs->AddOption(silhouette_samples);
+    delete silhouette_samples;
+
     return SDK_SUCCESS;
 }
 
@@ -1305,6 +1448,13 @@ KMeans::run()
         }
     }
 
+    if(hostKMeans)
+    {
+        status = runHostKMeans();
+        if(status != SDK_SUCCESS)
+            return status;
+    }
+
     return SDK_SUCCESS;
 }
 
@@ -1387,6 +1537,42 @@ KMeans::printStats()
     {
         printStatistics(strArray, stats, 5);
     }
+
+    if(hostKMeans)
+    {
+        std::string hostStrArray[7] = 
+        {
+            "Host best K",
+            "Host kmeans time(sec)",
+            "Host Lloyd iterations",
+            "Host distances evaluated(%)",
+            "Host silhouette",
+            "Host silhouette time(sec)",
+            "Host selection time/point/K(nsec)"
+        };
+
+        // Share of the distances a plain Lloyd iteration would evaluate
+        int firstK = isNumClustersSpecified ? numClusters : lowerBoundForClustering;
+        int lastK = isNumClustersSpecified ? numClusters : upperBoundForClustering;
+        double naiveDistances = (double)numPoints * (firstK + lastK) / 2 *
+                                (double)hostIterations;
+
+        // Selection cost normalized by the problem size, to compare runs
+        // over different numbers of points and clusters
+        double pointK = (double)numPoints * (lastK - firstK + 1) * (firstK + lastK) / 2;
+        double selectionTime = hostClusterTime + hostSilhouetteTime;
+
+        std::string hostStats[7];
+        hostStats[0] = toString(hostBestClusterNums, std::dec);
+        hostStats[1] = toString(hostClusterTime, std::dec);
+        hostStats[2] = toString(hostIterations, std::dec);
+        hostStats[3] = toString(naiveDistances > 0 ? 100.0 * hostDistances / naiveDistances : 0, std::dec);
+        hostStats[4] = silhouetteOption;
+        hostStats[5] = toString(hostSilhouetteTime, std::dec);
+        hostStats[6] = toString(pointK > 0 ? 1e9 * selectionTime / pointK : 0, std::dec);
+
+        printStatistics(hostStrArray, hostStats, 7);
+    }
 }
 
 int
@@ -19,6 +19,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #define KMEANS_H_
 #include <GL/glut.h>
 #include "CLUtil.hpp"
+#include "KMeansEngine.hpp"
 #include <map>
 
 using namespace appsdk;
@@ -94,6 +95,23 @@ private:
                                         create customNumClusters numbers of clusters, and then try to 
                                         cluster them into numClusters number of clusters using K-Means*/
     
+    bool hostKMeans;                /**< Run the accelerated host k-means sweep */
+    int cpuThreads;                 /**< Host threads, 0 uses every core */
+    KMeansEngine hostEngine;        /**< Multi-threaded Hamerly k-means with k-means++ seeding */
+    std::string silhouetteOption;   /**< Host silhouette: exact, sampled or simplified */
+    int silhouetteSamples;          /**< Points of the sampled silhouette and error estimates */
+    SilhouetteMode silhouetteMode;  /**< Parsed silhouetteOption */
+    std::map<int,float> hostSilhouettesMap; /**< Silhouettes of the host sweep */
+    std::map<int,float> hostSilhouetteErrors; /**< 95% error bounds of hostSilhouettesMap */
+    std::map<int,double> hostKTimes; /**< Host k-means time of every K */
+    std::map<int,double> hostKSilhouetteTimes; /**< Host silhouette time of every K */
+    int hostBestClusterNums;        /**< Best number of clusters of the host sweep */
+    float hostBestSilhouetteValue;  /**< Silhouette of hostBestClusterNums */
+    cl_double hostClusterTime;      /**< time taken by the host k-means runs */
+    cl_double hostSilhouetteTime;   /**< time taken by the host silhouettes */
+    cl_ulong hostDistances;         /**< Distances evaluated by the host sweep */
+    cl_ulong hostIterations;        /**< Lloyd iterations of the host sweep */
+
     SDKDeviceInfo         deviceInfo;            /**< Structure to store device information*/
     KernelWorkGroupInfo        kernelInfo;      /**< Structure to store kernel related info */
     SDKTimer    *sampleTimer;                   /**< SDKTimer object */
@@ -106,6 +124,7 @@ public:
     int computeSilhouette(int, float&);
     int computeRefKMeans(int);
     int computeRefSilhouette(int, float&);
+    int runHostKMeans();
     void setInitialCentroidPos(int);
     void initializeCentroidPos(void *, int);
     void initializeCentroidPos(cl_mem, int);
@@ -171,6 +190,17 @@ public:
         // Customized creation of inputs, based on numClusters value
         // creating numCluster number of random points
         randClusterNums = 0;// 0 means random input creation
+        hostKMeans = false;
+        cpuThreads = 0;
+        silhouetteOption = "exact";
+        silhouetteSamples = 1000;
+        silhouetteMode = SILHOUETTE_EXACT;
+        hostBestClusterNums = 0;
+        hostBestSilhouetteValue = -1;
+        hostClusterTime = 0;
+        hostSilhouetteTime = 0;
+        hostDistances = 0;
+        hostIterations = 0;
         sampleArgs = new CLCommandArgs();
         sampleTimer = new SDKTimer();
     }
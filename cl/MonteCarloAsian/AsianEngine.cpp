@@ -0,0 +1,773 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "AsianEngine.hpp"
+#include <algorithm>
+#include <math.h>
+#include <emmintrin.h>
+
+/*
+ * Seeds per block of partial sums. Blocks do not depend on the number of
+ * threads, which keeps the summation order and so the results fixed.
+ */
+#define BLOCK_SEEDS 256
+
+/*
+ * MXCSR flush to zero and denormals are zero bits
+ */
+#define MXCSR_FTZ_DAZ 0x8040
+
+/*
+ * Sobol points per block, each replicate has its own blocks
+ */
+#define BLOCK_POINTS 2048
+
+/*
+ * Digital shifts of the Sobol points, each gives an independent estimate
+ */
+#define SOBOL_REPLICATES 8
+
+/*
+ * Sums kept per block of paths
+ */
+enum
+{
+    SUM_PAYOFF,
+    SUM_PAYOFF_SQR,
+    SUM_CONTROL,
+    SUM_CONTROL_SQR,
+    SUM_CROSS,
+    SUM_DERIV,
+    NUM_SUMS
+};
+
+struct PathConstants;
+
+/**
+ * Arguments of the path threads
+ */
+struct AsianEngine::rangeArgs
+{
+    const AsianEngine *engine;
+    const AsianBook *book;
+    AsianPaths paths;
+    const cl_uint *seeds;
+    cl_uint numSeeds;
+    cl_uint numBlocks;
+    cl_double *partials;
+
+    void constants(cl_uint k, PathConstants &c) const;
+};
+
+/*
+ * exp(x) of four floats, x is clamped to the normal float range
+ */
+static inline __m128 expPs(__m128 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.3f)), _mm_set1_ps(88.3f));
+
+    // x = n * ln2 + r with |r| <= ln2 / 2
+    __m128i n = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)));
+    __m128 fn = _mm_cvtepi32_ps(n);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(fn, _mm_set1_ps(0.693359375f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(fn, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 y = _mm_set1_ps(1.9875691500e-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.3981999507e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(8.3334519073e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(4.1665795894e-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.6666665459e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(5.0000001201e-1f));
+    y = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, r), r), _mm_add_ps(r, _mm_set1_ps(1.0f)));
+
+    // 2^n built in the exponent field
+    __m128i e = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(e));
+}
+
+/*
+ * log(x) of four positive normal floats
+ */
+static inline __m128 logPs(__m128 x)
+{
+    // x = 2^e * m with m in [sqrt(0.5), sqrt(2))
+    __m128i xi = _mm_castps_si128(x);
+    __m128i e = _mm_sub_epi32(_mm_srli_epi32(xi, 23), _mm_set1_epi32(126));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(xi, _mm_set1_epi32(0x007fffff)),
+                                             _mm_set1_epi32(0x3f000000)));
+    __m128 fe = _mm_cvtepi32_ps(e);
+
+    __m128 small = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+    fe = _mm_sub_ps(fe, _mm_and_ps(small, _mm_set1_ps(1.0f)));
+    m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(small, m)), _mm_set1_ps(1.0f));
+
+    __m128 z = _mm_mul_ps(m, m);
+    __m128 y = _mm_set1_ps(7.0376836292e-2f);
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+    y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+    y = _mm_add_ps(y, _mm_mul_ps(fe, _mm_set1_ps(-2.12194440e-4f)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    return _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(fe, _mm_set1_ps(0.693359375f)));
+}
+
+/*
+ * sin(2 pi u) and cos(2 pi u) of four floats in [0, 1]
+ */
+static inline void sinCos2PiPs(__m128 u, __m128 &s, __m128 &c)
+{
+    // u = q / 4 + f with |f| <= 1 / 8, the subtraction is exact
+    __m128i q = _mm_cvtps_epi32(_mm_mul_ps(u, _mm_set1_ps(4.0f)));
+    __m128 f = _mm_sub_ps(u, _mm_mul_ps(_mm_cvtepi32_ps(q), _mm_set1_ps(0.25f)));
+    __m128 x = _mm_mul_ps(f, _mm_set1_ps(6.28318530717958648f));
+    __m128 x2 = _mm_mul_ps(x, x);
+
+    __m128 sy = _mm_set1_ps(-1.9515295891e-4f);
+    sy = _mm_add_ps(_mm_mul_ps(sy, x2), _mm_set1_ps(8.3321608736e-3f));
+    sy = _mm_add_ps(_mm_mul_ps(sy, x2), _mm_set1_ps(-1.6666654611e-1f));
+    sy = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sy, x2), x), x);
+
+    __m128 cy = _mm_set1_ps(2.443315711809948e-5f);
+    cy = _mm_add_ps(_mm_mul_ps(cy, x2), _mm_set1_ps(-1.388731625493765e-3f));
+    cy = _mm_add_ps(_mm_mul_ps(cy, x2), _mm_set1_ps(4.166664568298827e-2f));
+    cy = _mm_mul_ps(_mm_mul_ps(cy, x2), x2);
+    cy = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, _mm_set1_ps(0.5f))), cy);
+
+    // Odd quadrants swap sine and cosine, the signs follow the quadrant
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)),
+                                                   _mm_set1_epi32(1)));
+    __m128 sinBase = _mm_or_ps(_mm_and_ps(swap, cy), _mm_andnot_ps(swap, sy));
+    __m128 cosBase = _mm_or_ps(_mm_and_ps(swap, sy), _mm_andnot_ps(swap, cy));
+    __m128i sinSign = _mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30);
+    __m128i cosSign = _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)),
+                                                   _mm_set1_epi32(2)), 30);
+    s = _mm_xor_ps(sinBase, _mm_castsi128_ps(sinSign));
+    c = _mm_xor_ps(cosBase, _mm_castsi128_ps(cosSign));
+}
+
+/*
+ * Low 32 bits of the lane products, SSE2 only multiplies even lanes
+ */
+static inline __m128i mulLoEpi32(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/*
+ * Unsigned ints to the nearest floats, the sum of the halves rounds once
+ */
+static inline __m128 uintToFloatPs(__m128i u)
+{
+    __m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(u, 16));
+    __m128 lo = _mm_cvtepi32_ps(_mm_and_si128(u, _mm_set1_epi32(0xffff)));
+    return _mm_add_ps(_mm_mul_ps(hi, _mm_set1_ps(65536.0f)), lo);
+}
+
+/*
+ * One step of the kernel's recurrence. lshift128 and rshift128 shift the
+ * whole uint4 by 24 bits, which are byte shifts of the register.
+ */
+static inline __m128i recursion(__m128i a, __m128i b, __m128i r1, __m128i r2,
+                                __m128i mask)
+{
+    __m128i t = _mm_xor_si128(a, _mm_slli_si128(a, 3));
+    t = _mm_xor_si128(t, _mm_and_si128(_mm_srli_epi32(b, 13), mask));
+    t = _mm_xor_si128(t, _mm_srli_si128(r1, 3));
+    return _mm_xor_si128(t, _mm_slli_epi32(r2, 15));
+}
+
+/*
+ * generateRand of the kernel: two gaussians per lane from a uint4 seed,
+ * returns the seed of the next call
+ */
+static inline __m128i generateRandPs(__m128i seed, __m128 &gaussian1, __m128 &gaussian2)
+{
+    const __m128i stateMask = _mm_set1_epi32(1812433253);
+    const __m128i mask = _mm_setr_epi32(0xfdff37ff, 0xef7f3f7d, 0xff777b7d, 0x7ff7fb2f);
+
+    __m128i state1 = seed;
+    __m128i state2 = _mm_add_epi32(mulLoEpi32(stateMask,
+                                              _mm_xor_si128(state1, _mm_srli_epi32(state1, 30))),
+                                   _mm_set1_epi32(1));
+    __m128i state3 = _mm_add_epi32(mulLoEpi32(stateMask,
+                                              _mm_xor_si128(state2, _mm_srli_epi32(state2, 30))),
+                                   _mm_set1_epi32(2));
+    __m128i state4 = _mm_add_epi32(mulLoEpi32(stateMask,
+                                              _mm_xor_si128(state3, _mm_srli_epi32(state3, 30))),
+                                   _mm_set1_epi32(3));
+    __m128i state5 = _mm_add_epi32(mulLoEpi32(stateMask,
+                                              _mm_xor_si128(state4, _mm_srli_epi32(state4, 30))),
+                                   _mm_set1_epi32(4));
+
+    // The fourth output of the kernel is never used
+    __m128i temp0 = recursion(state1, state3, state4, state5, mask);
+    __m128i temp1 = recursion(state2, state4, state5, temp0, mask);
+    __m128i temp2 = recursion(state3, state5, temp0, temp1, mask);
+
+    // A zero draw would take the log of 0, it is moved to the smallest draw
+    const __m128 scale = _mm_set1_ps(1.0f / 4294967296.0f);
+    __m128 u1 = _mm_max_ps(_mm_mul_ps(uintToFloatPs(temp0), scale), scale);
+    __m128 u2 = _mm_mul_ps(uintToFloatPs(temp1), scale);
+
+    // Box Muller transformation
+    __m128 r = _mm_sqrt_ps(_mm_mul_ps(_mm_set1_ps(-2.0f), logPs(u1)));
+    __m128 sinPhi, cosPhi;
+    sinCos2PiPs(u2, sinPhi, cosPhi);
+    gaussian1 = _mm_mul_ps(r, cosPhi);
+    gaussian2 = _mm_mul_ps(r, sinPhi);
+    return temp2;
+}
+
+/*
+ * Running sums of four paths
+ */
+struct PathState
+{
+    __m128 trajPrice;
+    __m128 sumPrice;
+    __m128 logReturn;
+    __m128 sumLog;
+    __m128 sumDeriv;
+};
+
+/*
+ * Coefficients of the paths of one volatility
+ */
+struct PathConstants
+{
+    __m128 c1;
+    __m128 c2;
+    __m128 drift;
+    __m128 initPrice;
+    __m128 strikePrice;
+    __m128 numSum;
+};
+
+static inline void startPaths(PathState &p, const PathConstants &c)
+{
+    p.trajPrice = c.initPrice;
+    p.sumPrice = c.initPrice;
+    p.logReturn = _mm_setzero_ps();
+    p.sumLog = _mm_setzero_ps();
+    p.sumDeriv = _mm_setzero_ps();
+}
+
+/*
+ * Time step i of the paths, as in the kernel
+ */
+static inline void advancePaths(PathState &p, const PathConstants &c, __m128 gaussian,
+                                cl_int i)
+{
+    __m128 x = _mm_add_ps(c.c1, _mm_mul_ps(c.c2, gaussian));
+    p.logReturn = _mm_add_ps(p.logReturn, x);
+    p.sumLog = _mm_add_ps(p.sumLog, p.logReturn);
+    p.trajPrice = _mm_mul_ps(p.trajPrice, expPs(x));
+    p.sumPrice = _mm_add_ps(p.sumPrice, p.trajPrice);
+
+    // Path derivative, the division by sigma is left to the end
+    __m128 t = _mm_mul_ps(c.drift, _mm_set1_ps((cl_float)i));
+    p.sumDeriv = _mm_add_ps(p.sumDeriv, _mm_mul_ps(p.trajPrice, _mm_sub_ps(p.logReturn, t)));
+}
+
+/*
+ * Payoffs of the arithmetic and geometric averages and the path derivative
+ */
+static inline void finishPaths(const PathState &p, const PathConstants &c,
+                               __m128 &payoff, __m128 &control, __m128 &deriv)
+{
+    const __m128 zero = _mm_setzero_ps();
+    __m128 diff = _mm_sub_ps(_mm_div_ps(p.sumPrice, c.numSum), c.strikePrice);
+    __m128 inMoney = _mm_cmpgt_ps(diff, zero);
+    payoff = _mm_and_ps(inMoney, diff);
+    deriv = _mm_and_ps(inMoney, _mm_div_ps(p.sumDeriv, c.numSum));
+
+    __m128 geometric = _mm_mul_ps(c.initPrice, expPs(_mm_div_ps(p.sumLog, c.numSum)));
+    __m128 geometricDiff = _mm_sub_ps(geometric, c.strikePrice);
+    control = _mm_and_ps(_mm_cmpgt_ps(geometricDiff, zero), geometricDiff);
+}
+
+/*
+ * Adds the first lanes of four paths to the sums of a block
+ */
+static inline void addPaths(cl_double *sums, __m128 payoff, __m128 control, __m128 deriv,
+                            cl_uint lanes)
+{
+    cl_float y[4], x[4], v[4];
+    _mm_storeu_ps(y, payoff);
+    _mm_storeu_ps(x, control);
+    _mm_storeu_ps(v, deriv);
+    for(cl_uint l = 0; l < lanes; l++)
+    {
+        sums[SUM_PAYOFF] += y[l];
+        sums[SUM_PAYOFF_SQR] += (cl_double)y[l] * y[l];
+        sums[SUM_CONTROL] += x[l];
+        sums[SUM_CONTROL_SQR] += (cl_double)x[l] * x[l];
+        sums[SUM_CROSS] += (cl_double)x[l] * y[l];
+        sums[SUM_DERIV] += v[l];
+    }
+}
+
+/*
+ * Inverse of the standard normal distribution, P. J. Acklam's rational
+ * approximation (relative error below 1.2e-9)
+ */
+static cl_double inverseNormal(cl_double u)
+{
+    static const cl_double a[6] =
+    {
+        -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+        1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00
+    };
+    static const cl_double b[5] =
+    {
+        -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+        6.680131188771972e+01, -1.328068155288572e+01
+    };
+    static const cl_double c[6] =
+    {
+        -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+        -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00
+    };
+    static const cl_double d[4] =
+    {
+        7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+        3.754408661907416e+00
+    };
+    const cl_double low = 0.02425;
+
+    if(u < low || u > 1 - low)
+    {
+        // Tails
+        cl_double q = sqrt(-2 * log(u < low ? u : 1 - u));
+        cl_double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                      ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+        return u < low ? x : -x;
+    }
+
+    cl_double q = u - 0.5;
+    cl_double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+/*
+ * Index of the lowest set bit of n > 0
+ */
+static inline cl_uint lowestBit(cl_uint n)
+{
+    cl_uint bit = 0;
+    while(!(n & 1))
+    {
+        n >>= 1;
+        bit++;
+    }
+    return bit;
+}
+
+/*
+ * Finalizer of MurmurHash3, spreads seeds from rand() over all 32 bits
+ */
+static inline cl_uint mixBits(cl_uint h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    return h ^ (h >> 16);
+}
+
+int
+AsianEngine::setupSobol(const AsianBook &book, const cl_uint *seeds, cl_uint numSeeds)
+{
+    const cl_uint dims = book.noOfSum - 1;
+
+    // Direction numbers in Q0.32 of the QuasiRandomSequence sample
+    if(sobol.setDimensions(dims) != SDK_SUCCESS)
+    {
+        return SDK_FAILURE;
+    }
+
+    shifts.resize(SOBOL_REPLICATES * dims);
+    for(cl_uint i = 0; i < shifts.size(); i++)
+    {
+        shifts[i] = mixBits(seeds[i % (4 * numSeeds)] + i);
+    }
+
+    // Brownian bridge in units of the time step: the first dimension sets
+    // the last point, the next ones fill the midpoints level by level
+    bridgeIndex.resize(dims);
+    bridgeLeft.resize(dims);
+    bridgeRight.resize(dims);
+    bridgeWeights.resize(3 * dims);
+    bridgeIndex[0] = dims;
+    bridgeLeft[0] = 0;
+    bridgeRight[0] = 0;
+    bridgeWeights[0] = 0;
+    bridgeWeights[1] = 0;
+    bridgeWeights[2] = sqrt((cl_double)dims);
+
+    std::vector<cl_uint> intervals;
+    intervals.push_back(0);
+    intervals.push_back(dims);
+    cl_uint pos = 1;
+    for(size_t i = 0; i < intervals.size(); i += 2)
+    {
+        cl_uint left = intervals[i];
+        cl_uint right = intervals[i + 1];
+        if(right - left < 2)
+        {
+            continue;
+        }
+        cl_uint mid = (left + right) / 2;
+        cl_double span = right - left;
+        bridgeIndex[pos] = mid;
+        bridgeLeft[pos] = left;
+        bridgeRight[pos] = right;
+        bridgeWeights[3 * pos] = (right - mid) / span;
+        bridgeWeights[3 * pos + 1] = (mid - left) / span;
+        bridgeWeights[3 * pos + 2] = sqrt((mid - left) * (right - mid) / span);
+        pos++;
+
+        intervals.push_back(left);
+        intervals.push_back(mid);
+        intervals.push_back(mid);
+        intervals.push_back(right);
+    }
+    return SDK_SUCCESS;
+}
+
+void
+AsianEngine::sobolBlock(const rangeArgs &args, cl_uint k, cl_uint block,
+                        cl_double *sums) const
+{
+    const AsianBook &book = *args.book;
+    const cl_uint dims = book.noOfSum - 1;
+    const cl_uint blocksPerReplicate = args.numBlocks / SOBOL_REPLICATES;
+    const cl_uint *shift = &shifts[(block / blocksPerReplicate) * dims];
+
+    // Points 1 to numSeeds of the sequence in Gray code order, 0 is skipped
+    cl_uint first = 1 + (block % blocksPerReplicate) * BLOCK_POINTS;
+    cl_uint last = std::min(first + BLOCK_POINTS, args.numSeeds + 1);
+
+    const cl_uint *directions = sobol.getDirections();
+    std::vector<cl_uint> point(dims);
+    cl_uint gray = first ^ (first >> 1);
+    for(cl_uint d = 0; d < dims; d++)
+    {
+        point[d] = 0;
+        for(int bit = 0; bit < N_DIRECTIONS; bit++)
+        {
+            if((gray >> bit) & 1)
+            {
+                point[d] ^= directions[d * N_DIRECTIONS + bit];
+            }
+        }
+    }
+
+    PathConstants c;
+    args.constants(k, c);
+
+    // Gaussian increments of the four lanes, time step major
+    std::vector<cl_double> z(dims);
+    std::vector<cl_double> w(dims + 1);
+    std::vector<cl_float> gaussian(dims * 4);
+    for(cl_uint i = first; i < last; i += 4)
+    {
+        cl_uint lanes = std::min(4u, last - i);
+        for(cl_uint l = 0; l < 4; l++)
+        {
+            if(l >= lanes)
+            {
+                for(cl_uint s = 0; s < dims; s++)
+                {
+                    gaussian[s * 4 + l] = 0;
+                }
+                continue;
+            }
+
+            // Gray code: the next point flips the direction of the lowest bit
+            if(i + l != first)
+            {
+                cl_uint bit = lowestBit(i + l);
+                for(cl_uint d = 0; d < dims; d++)
+                {
+                    point[d] ^= directions[d * N_DIRECTIONS + bit];
+                }
+            }
+            for(cl_uint d = 0; d < dims; d++)
+            {
+                z[d] = inverseNormal(((point[d] ^ shift[d]) + 0.5) * (1.0 / 4294967296.0));
+            }
+
+            w[0] = 0;
+            for(cl_uint d = 0; d < dims; d++)
+            {
+                const cl_double *weight = &bridgeWeights[3 * d];
+                w[bridgeIndex[d]] = weight[0] * w[bridgeLeft[d]] +
+                                    weight[1] * w[bridgeRight[d]] + weight[2] * z[d];
+            }
+            for(cl_uint s = 0; s < dims; s++)
+            {
+                gaussian[s * 4 + l] = (cl_float)(w[s + 1] - w[s]);
+            }
+        }
+
+        PathState p;
+        startPaths(p, c);
+        for(cl_uint s = 0; s < dims; s++)
+        {
+            advancePaths(p, c, _mm_loadu_ps(&gaussian[s * 4]), s + 1);
+        }
+
+        __m128 payoff, control, deriv;
+        finishPaths(p, c, payoff, control, deriv);
+        addPaths(sums, payoff, control, deriv, lanes);
+    }
+}
+
+void
+AsianEngine::rangeArgs::constants(cl_uint k, PathConstants &c) const
+{
+    // Same coefficients as the sample passes to the kernel
+    const cl_float sigma = book->sigma[k];
+    const cl_float timeStep = book->maturity / (book->noOfSum - 1);
+    c.c1 = _mm_set1_ps((book->interest - 0.5f * sigma * sigma) * timeStep);
+    c.c2 = _mm_set1_ps(sigma * sqrtf(timeStep));
+    c.drift = _mm_set1_ps((book->interest + 0.5f * sigma * sigma) * timeStep);
+    c.initPrice = _mm_set1_ps(book->initPrice);
+    c.strikePrice = _mm_set1_ps(book->strikePrice);
+    c.numSum = _mm_set1_ps((cl_float)book->noOfSum);
+}
+
+void
+AsianEngine::pathThread(void *data, unsigned int begin, unsigned int end,
+                        unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const AsianEngine *engine = args->engine;
+
+    // The same rounding mode on every thread keeps the results reproducible
+    unsigned int csr = _mm_getcsr();
+    _mm_setcsr(csr | MXCSR_FTZ_DAZ);
+
+    // begin and end count blocks of paths of every volatility
+    for(unsigned int w = begin; w < end; w++)
+    {
+        cl_uint k = w / args->numBlocks;
+        cl_uint block = w % args->numBlocks;
+        cl_double *sums = &args->partials[w * NUM_SUMS];
+        for(int i = 0; i < NUM_SUMS; i++)
+        {
+            sums[i] = 0;
+        }
+
+        if(args->paths == PATHS_SOBOL)
+        {
+            engine->sobolBlock(*args, k, block, sums);
+            continue;
+        }
+
+        PathConstants c;
+        args->constants(k, c);
+
+        const cl_uint *seeds = args->seeds + 4 * ((size_t)k * args->numSeeds);
+        cl_uint first = block * BLOCK_SEEDS;
+        cl_uint last = std::min(first + BLOCK_SEEDS, args->numSeeds);
+        for(cl_uint s = first; s < last; s++)
+        {
+            __m128i state = _mm_loadu_si128((const __m128i*)(seeds + 4 * s));
+
+            PathState p1, p2;
+            startPaths(p1, c);
+            startPaths(p2, c);
+            for(cl_int i = 1; i < args->book->noOfSum; i++)
+            {
+                __m128 gaussian1, gaussian2;
+                state = generateRandPs(state, gaussian1, gaussian2);
+                advancePaths(p1, c, gaussian1, i);
+                advancePaths(p2, c, gaussian2, i);
+            }
+
+            __m128 payoff, control, deriv;
+            finishPaths(p1, c, payoff, control, deriv);
+            addPaths(sums, payoff, control, deriv, 4);
+            finishPaths(p2, c, payoff, control, deriv);
+            addPaths(sums, payoff, control, deriv, 4);
+        }
+    }
+
+    _mm_setcsr(csr);
+}
+
+int
+AsianEngine::price(const AsianBook &book, const cl_uint *seeds, cl_uint numSeeds,
+                   cl_float *price, cl_float *vega, cl_float *stdError)
+{
+    if(book.sigma == NULL || seeds == NULL || price == NULL || vega == NULL)
+    {
+        error("AsianEngine::price() needs sigma, seeds, price and vega arrays");
+        return SDK_FAILURE;
+    }
+    if(book.noOfSum < 2)
+    {
+        error("AsianEngine::price() needs at least two averaging points");
+        return SDK_FAILURE;
+    }
+    if(book.count == 0 || numSeeds == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    // Longer books than the Sobol dimensions use pseudo-random paths
+    const AsianPaths source = supportsSobol(book) ? paths : PATHS_PSEUDO_RANDOM;
+
+    cl_uint numBlocks;
+    if(source == PATHS_SOBOL)
+    {
+        if(setupSobol(book, seeds, numSeeds) != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+        numBlocks = SOBOL_REPLICATES * ((numSeeds + BLOCK_POINTS - 1) / BLOCK_POINTS);
+    }
+    else
+    {
+        numBlocks = (numSeeds + BLOCK_SEEDS - 1) / BLOCK_SEEDS;
+    }
+    cl_uint numItems = book.count * numBlocks;
+    partials.resize(numItems * NUM_SUMS);
+
+    unsigned int threads = numThreads ? numThreads : getNumCPUCores();
+    threads = std::min(threads, numItems);
+
+    rangeArgs args;
+    args.engine = this;
+    args.paths = source;
+    args.book = &book;
+    args.seeds = seeds;
+    args.numSeeds = numSeeds;
+    args.numBlocks = numBlocks;
+    args.partials = &partials[0];
+    if(!parallelFor(pathThread, &args, numItems, threads))
+    {
+        error("AsianEngine::price() could not create its threads");
+        return SDK_FAILURE;
+    }
+
+    // Blocks are added in order, whichever thread computed them. Pseudo-random
+    // paths give one estimate whose error follows from the sample variance,
+    // Sobol paths give one estimate per digital shift.
+    const cl_uint numEstimates = (source == PATHS_SOBOL) ? SOBOL_REPLICATES : 1;
+    const cl_uint blocksPerEstimate = numBlocks / numEstimates;
+    const cl_double pathsPerEstimate = (source == PATHS_SOBOL) ? numSeeds : 8.0 * numSeeds;
+    const cl_double discount = exp(-(cl_double)book.interest * book.maturity);
+
+    std::vector<cl_double> estimateSums(numEstimates * NUM_SUMS);
+    for(cl_uint k = 0; k < book.count; k++)
+    {
+        cl_double total[NUM_SUMS] = {0, 0, 0, 0, 0, 0};
+        for(cl_uint e = 0; e < numEstimates; e++)
+        {
+            cl_double *sums = &estimateSums[e * NUM_SUMS];
+            for(int i = 0; i < NUM_SUMS; i++)
+            {
+                sums[i] = 0;
+            }
+            for(cl_uint b = 0; b < blocksPerEstimate; b++)
+            {
+                cl_uint w = k * numBlocks + e * blocksPerEstimate + b;
+                const cl_double *block = &partials[w * NUM_SUMS];
+                for(int i = 0; i < NUM_SUMS; i++)
+                {
+                    sums[i] += block[i];
+                }
+            }
+            for(int i = 0; i < NUM_SUMS; i++)
+            {
+                total[i] += sums[i];
+            }
+        }
+
+        // Sample moments over all paths
+        cl_double n = pathsPerEstimate * numEstimates;
+        cl_double meanY = total[SUM_PAYOFF] / n;
+        cl_double meanX = total[SUM_CONTROL] / n;
+        cl_double varY = (total[SUM_PAYOFF_SQR] - n * meanY * meanY) / (n - 1);
+        cl_double varX = (total[SUM_CONTROL_SQR] - n * meanX * meanX) / (n - 1);
+        cl_double covXY = (total[SUM_CROSS] - n * meanX * meanY) / (n - 1);
+
+        // Coefficient of the control variate that minimizes the variance
+        cl_double beta = 0;
+        cl_double expectedX = 0;
+        if(controlVariate && varX > 0)
+        {
+            beta = covXY / varX;
+            expectedX = SDKControlVariate::geometricAsianCall(book.initPrice,
+                                                              book.strikePrice,
+                                                              book.interest,
+                                                              book.maturity,
+                                                              book.sigma[k],
+                                                              book.noOfSum);
+        }
+
+        cl_double estimate;
+        cl_double error;
+        if(numEstimates == 1)
+        {
+            estimate = meanY - beta * (meanX - expectedX);
+            cl_double var = varY - 2 * beta * covXY + beta * beta * varX;
+            error = sqrt(std::max(var, 0.0) / n);
+        }
+        else
+        {
+            std::vector<cl_double> estimates(numEstimates);
+            estimate = 0;
+            for(cl_uint e = 0; e < numEstimates; e++)
+            {
+                const cl_double *sums = &estimateSums[e * NUM_SUMS];
+                estimates[e] = (sums[SUM_PAYOFF] - beta * (sums[SUM_CONTROL] - pathsPerEstimate *
+                                                           expectedX)) / pathsPerEstimate;
+                estimate += estimates[e];
+            }
+            estimate /= numEstimates;
+            cl_double var = 0;
+            for(cl_uint e = 0; e < numEstimates; e++)
+            {
+                var += (estimates[e] - estimate) * (estimates[e] - estimate);
+            }
+            error = sqrt(var / (numEstimates * (numEstimates - 1.0)));
+        }
+
+        price[k] = (cl_float)(discount * estimate);
+        vega[k] = (cl_float)(discount * total[SUM_DERIV] / (n * book.sigma[k]));
+        if(stdError != NULL)
+        {
+            stdError[k] = (cl_float)(discount * error);
+        }
+    }
+    return SDK_SUCCESS;
+}
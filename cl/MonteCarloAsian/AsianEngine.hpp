@@ -0,0 +1,155 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef ASIANENGINE_H_
+#define ASIANENGINE_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+#include "SDKControlVariate.hpp"
+#include "SobolEngine.hpp"
+
+using namespace appsdk;
+
+/**
+ * AsianBook
+ * Arithmetic average Asian call sampled at noOfSum points, priced for
+ * several volatilities
+ */
+struct AsianBook
+{
+    cl_uint count;                  /**< Number of volatilities */
+    const cl_float *sigma;          /**< Volatilities */
+    cl_float initPrice;             /**< Initial price */
+    cl_float strikePrice;           /**< Strike price */
+    cl_float interest;              /**< Interest rate */
+    cl_float maturity;              /**< Maturity in years */
+    cl_int noOfSum;                 /**< Number of averaging points, at least 2 */
+};
+
+/**
+ * AsianPaths
+ * Source of the paths of AsianEngine
+ */
+enum AsianPaths
+{
+    PATHS_PSEUDO_RANDOM,            /**< The kernel's generator on the given seeds */
+    PATHS_SOBOL                     /**< Digitally shifted Sobol points through a Brownian bridge */
+};
+
+/**
+ * AsianEngine
+ * Class implements a multi-threaded host Monte Carlo pricer for AsianBook.
+ *
+ * With pseudo-random paths every seed is a uint4 of the kernel's random
+ * array and drives eight paths: its four lanes run the kernel's
+ * generateRand recurrence, one per SSE2 lane, and both outputs of the
+ * Box-Muller transform are used. Sobol paths use one point per path, with
+ * the direction numbers of the QuasiRandomSequence sample's SobolEngine,
+ * and build the path with a Brownian bridge, so the first dimensions carry
+ * most of the variance. Books of more time steps than SobolEngine has
+ * dimensions fall back to pseudo-random paths. Eight digital shifts of the points make eight
+ * independent estimates whose spread gives the standard error.
+ *
+ * The control variate is the geometric average call on the same path,
+ * whose price has a closed form. Its coefficient is estimated from the
+ * paths themselves.
+ *
+ * Paths are split in fixed blocks whose partial sums are added in block
+ * order, so results are bit-identical whatever the number of threads.
+ */
+class AsianEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+        AsianPaths paths;               /**< Source of the paths */
+        bool controlVariate;            /**< Use the geometric average as control */
+        std::vector<cl_double> partials;        /**< Sums over the paths of each block */
+        SobolEngine sobol;                      /**< Sobol direction numbers, N_DIRECTIONS per dimension */
+        std::vector<cl_uint> shifts;            /**< Digital shift per estimate and dimension */
+        std::vector<cl_uint> bridgeIndex;       /**< Time point built by each dimension */
+        std::vector<cl_uint> bridgeLeft;        /**< Left neighbour of the point */
+        std::vector<cl_uint> bridgeRight;       /**< Right neighbour of the point */
+        std::vector<cl_double> bridgeWeights;   /**< Left weight, right weight and deviation */
+
+        struct rangeArgs;
+        static void pathThread(void *data, unsigned int begin, unsigned int end,
+                               unsigned int threadId);
+        void sobolBlock(const rangeArgs &args, cl_uint k, cl_uint block,
+                        cl_double *sums) const;
+        int setupSobol(const AsianBook &book, const cl_uint *seeds, cl_uint numSeeds);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        AsianEngine()
+            : numThreads(0),
+              paths(PATHS_PSEUDO_RANDOM),
+              controlVariate(false)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Selects the paths and the estimator of the next calls to price()
+         * @param source pseudo-random or Sobol paths
+         * @param control use the geometric average as control variate
+         */
+        void setMethod(AsianPaths source, bool control)
+        {
+            paths = source;
+            controlVariate = control;
+        }
+
+        /**
+         * @return true if Sobol paths can price the book, that is it has at
+         *         most MAX_DIMENSIONS time steps
+         */
+        static bool supportsSobol(const AsianBook &book)
+        {
+            return book.noOfSum - 1 <= MAX_DIMENSIONS;
+        }
+
+        /**
+         * Prices the option of the book for each of its volatilities
+         * @param book inputs. Books supportsSobol() rejects are priced with
+         *        pseudo-random paths even if Sobol paths are selected.
+         * @param seeds numSeeds uint4 seeds per volatility, volatility major.
+         *        Sobol paths only take their digital shifts from them.
+         * @param numSeeds seeds per volatility, each stands for eight paths
+         * @param price output, room for book.count prices
+         * @param vega output, room for book.count vegas
+         * @param stdError output, room for book.count standard errors of
+         *        the prices, may be NULL
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int price(const AsianBook &book, const cl_uint *seeds, cl_uint numSeeds,
+                  cl_float *price, cl_float *vega, cl_float *stdError = NULL);
+};
+
+#endif
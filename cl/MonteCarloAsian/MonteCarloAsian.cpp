@@ -19,6 +19,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include <math.h>
 #include <malloc.h>
+#include <algorithm>
 
 
 int
@@ -1306,6 +1307,51 @@ MonteCarloAsian::initialize()
 
     delete disableAsync_option;
 
+    Option* hostEngine_option = new Option;
+    CHECK_ALLOCATION(hostEngine_option,
+                     "Failed to allocate memory (hostEngine_option)\n");
+
+    hostEngine_option->_sVersion = "";
+    hostEngine_option->_lVersion = "hostengine";
+    hostEngine_option->_description =
+        "Also price the kernel's paths with the host SIMD engine";
+    hostEngine_option->_type = CA_NO_ARGUMENT;
+    hostEngine_option->_value = &hostEngine;
+
+    sampleArgs->AddOption(hostEngine_option);
+
+    delete hostEngine_option;
+
+    Option* threads_option = new Option;
+    CHECK_ALLOCATION(threads_option,
+                     "Failed to allocate memory (threads_option)\n");
+
+    threads_option->_sVersion = "";
+    threads_option->_lVersion = "threads";
+    threads_option->_description =
+        "Number of host threads of the host engine (0 uses every core)";
+    threads_option->_type = CA_ARG_INT;
+    threads_option->_value = &cpuThreads;
+
+    sampleArgs->AddOption(threads_option);
+
+    delete threads_option;
+
+    Option* target_option = new Option;
+    CHECK_ALLOCATION(target_option,
+                     "Failed to allocate memory (target_option)\n");
+
+    target_option->_sVersion = "";
+    target_option->_lVersion = "targeterror";
+    target_option->_description =
+        "Standard error the host engine timings are scaled to";
+    target_option->_type = CA_ARG_DOUBLE;
+    target_option->_value = &targetError;
+
+    sampleArgs->AddOption(target_option);
+
+    delete target_option;
+
     return SDK_SUCCESS;
 }
 
@@ -1316,6 +1362,11 @@ int MonteCarloAsian::setup()
         std::cout<<"Error, iterations cannot be 0 or negative. Exiting..\n";
         exit(0);
     }
+    if(hostEngine && targetError <= 0)
+    {
+        std::cout<<"Error, targeterror must be positive. Exiting..\n";
+        exit(0);
+    }
     if(setupMonteCarloAsian() != SDK_SUCCESS)
     {
         return SDK_FAILURE;
@@ -1380,6 +1431,88 @@ int MonteCarloAsian::run()
         printArray<cl_float>("vega", vega, steps, 1);
     }
 
+    if(hostEngine)
+    {
+        if(runHostEngine() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+    }
+
+    return SDK_SUCCESS;
+}
+
+/*
+ * Paths and estimator of each host method
+ */
+static const char *hostMethodNames[HOST_METHODS] =
+{
+    "Plain", "Control Variate", "Sobol", "Sobol + Control Variate"
+};
+
+int MonteCarloAsian::runHostEngine()
+{
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+    // Same options and seeds as the kernel, one seed per work-item
+    AsianBook book;
+    book.count = steps;
+    book.sigma = sigma;
+    book.initPrice = initPrice;
+    book.strikePrice = strikePrice;
+    book.interest = interest;
+    book.maturity = maturity;
+    book.noOfSum = noOfSum;
+
+    if(!AsianEngine::supportsSobol(book))
+    {
+        std::cout << "Note : Sobol paths support up to " << MAX_DIMENSIONS
+                  << " time steps, the Sobol methods fall back to pseudo-random paths"
+                  << std::endl;
+    }
+
+    hostPrice.assign(steps, 0.0f);
+    hostVega.assign(steps, 0.0f);
+    methodPrice.assign(HOST_METHODS * steps, 0.0f);
+    methodError.assign(HOST_METHODS * steps, 0.0f);
+
+    // The plain estimator follows the kernel and is checked against it,
+    // the vegas of the other methods are not kept
+    std::vector<cl_float> methodVega(steps);
+    for(int m = 0; m < HOST_METHODS; m++)
+    {
+        engine.setMethod(m < 2 ? PATHS_PSEUDO_RANDOM : PATHS_SOBOL, (m & 1) != 0);
+        cl_float *vegaOut = (m == 0) ? &hostVega[0] : &methodVega[0];
+
+        int timer = sampleTimer->createTimer();
+        sampleTimer->resetTimer(timer);
+        sampleTimer->startTimer(timer);
+        for(int i = 0; i < iterations; i++)
+        {
+            int status = engine.price(book, randNum, width * height, &methodPrice[m * steps],
+                                      vegaOut, &methodError[m * steps]);
+            CHECK_ERROR(status, SDK_SUCCESS, "AsianEngine::price() failed");
+        }
+        sampleTimer->stopTimer(timer);
+        methodTime[m] = (double)(sampleTimer->readTimer(timer)) / iterations;
+
+        if(m == 0)
+        {
+            hostTime = methodTime[0];
+            std::copy(&methodPrice[0], &methodPrice[0] + steps, hostPrice.begin());
+        }
+    }
+
+    if(!sampleArgs->quiet)
+    {
+        printArray<cl_float>("host price", &hostPrice[0], steps, 1);
+        printArray<cl_float>("host vega", &hostVega[0], steps, 1);
+        for(int m = 1; m < HOST_METHODS; m++)
+        {
+            printArray<cl_float>(std::string("host price, ") + hostMethodNames[m],
+                                 &methodPrice[m * steps], steps, 1);
+        }
+    }
     return SDK_SUCCESS;
 }
 
@@ -1405,6 +1538,42 @@ MonteCarloAsian::printStats()
                             avgKernelTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        if(hostEngine)
+        {
+            std::string hostStrArray[2] =
+            {
+                "Host Time (sec)",
+                "Host Samples used /sec"
+            };
+            std::string hostStats[2];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(hostTime > 0 ?
+                                    (noOfTraj * (noOfSum - 1) * steps) / hostTime : 0,
+                                    std::dec);
+
+            printStatistics(hostStrArray, hostStats, 2);
+
+            // Time to reach the target error, the error falls as the square
+            // root of the number of paths
+            std::vector<std::string> methodStrArray;
+            std::vector<std::string> methodStats;
+            for(int m = 0; m < HOST_METHODS; m++)
+            {
+                cl_float maxError = *std::max_element(&methodError[m * steps],
+                                                      &methodError[m * steps] + steps);
+                cl_double scale = maxError / targetError;
+                methodStrArray.push_back(std::string(hostMethodNames[m]) + " Time (sec)");
+                methodStats.push_back(toString(methodTime[m], std::dec));
+                methodStrArray.push_back(std::string(hostMethodNames[m]) + " Std. Error");
+                methodStats.push_back(toString(maxError, std::dec));
+                methodStrArray.push_back(std::string(hostMethodNames[m]) + " Time to " +
+                                         toString(targetError, std::dec) + " (sec)");
+                methodStats.push_back(toString(methodTime[m] * scale * scale, std::dec));
+            }
+
+            printStatistics(&methodStrArray[0], &methodStats[0], (int)methodStats.size());
+        }
     }
 }
 
@@ -1771,6 +1940,56 @@ int MonteCarloAsian::verifyResults()
                 return SDK_FAILURE;
             }
         }
+
+        if(hostEngine)
+        {
+            // The host engine follows the kernel's paths, so only the
+            // rounding of the two differs
+            for(int i = 0; i < steps; ++i)
+            {
+                if(fabs(hostPrice[i] - price[i]) > 5e-3f * std::max(fabs(price[i]), 1.0f) ||
+                        fabs(hostVega[i] - vega[i]) > 5e-3f * std::max(fabs(vega[i]), 1.0f))
+                {
+                    std::cout << "Failed (host engine)\n" << std::endl;
+                    return SDK_FAILURE;
+                }
+            }
+
+            // A single thread must give the same bits
+            std::vector<cl_float> singlePrice(steps);
+            std::vector<cl_float> singleVega(steps);
+            AsianBook book = {(cl_uint)steps, sigma, initPrice, strikePrice,
+                              interest, maturity, noOfSum
+                             };
+            AsianEngine single;
+            single.setThreads(1);
+            int status = single.price(book, randNum, width * height, &singlePrice[0],
+                                      &singleVega[0]);
+            CHECK_ERROR(status, SDK_SUCCESS, "AsianEngine::price() failed");
+            if(memcmp(&singlePrice[0], &hostPrice[0], steps * sizeof(cl_float)) ||
+                    memcmp(&singleVega[0], &hostVega[0], steps * sizeof(cl_float)))
+            {
+                std::cout << "Failed (host engine depends on the thread count)\n" << std::endl;
+                return SDK_FAILURE;
+            }
+
+            // Every method estimates the same price, within its errors
+            for(int m = 1; m < HOST_METHODS; m++)
+            {
+                for(int i = 0; i < steps; ++i)
+                {
+                    cl_float a = methodError[m * steps + i];
+                    cl_float b = methodError[i];
+                    if(fabs(methodPrice[m * steps + i] - hostPrice[i]) >
+                            4.0f * sqrtf(a * a + b * b) + 1e-4f)
+                    {
+                        std::cout << "Failed (host engine, " << hostMethodNames[m] << ")\n"
+                                  << std::endl;
+                        return SDK_FAILURE;
+                    }
+                }
+            }
+        }
         std::cout << "Passed!\n" << std::endl;
     }
 
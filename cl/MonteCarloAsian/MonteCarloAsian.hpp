@@ -20,6 +20,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #define GROUP_SIZE 64
 #define VECTOR_SIZE 4
+#define HOST_METHODS 4
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -27,7 +28,9 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <vector>
 #include "CLUtil.hpp"
+#include "AsianEngine.hpp"
 
 using namespace appsdk;
 
@@ -129,6 +132,17 @@ class MonteCarloAsian
         size_t globalThreads[2];
         size_t localThreads[2];
 
+        bool hostEngine;                    /**< Also price the options with the host engine */
+        int cpuThreads;                     /**< Host threads, 0 uses every core */
+        AsianEngine engine;                 /**< Host SIMD Monte Carlo engine */
+        cl_double hostTime;                 /**< Average time of the host engine */
+        std::vector<cl_float> hostPrice;    /**< Prices of the host engine */
+        std::vector<cl_float> hostVega;     /**< Vegas of the host engine */
+        cl_double targetError;              /**< Standard error the timings are scaled to */
+        cl_double methodTime[HOST_METHODS]; /**< Average time of each host method */
+        std::vector<cl_float> methodPrice;  /**< Prices of each host method */
+        std::vector<cl_float> methodError;  /**< Standard errors of each host method */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -140,7 +154,11 @@ class MonteCarloAsian
         MonteCarloAsian()
             : useScalarKernel(false),
               useVectorKernel(false),
-              vectorWidth(0)
+              vectorWidth(0),
+              hostEngine(false),
+              cpuThreads(0),
+              hostTime(0),
+              targetError(1e-3)
         {
             sampleArgs = new CLCommandArgs();
             sampleTimer = new SDKTimer();
@@ -318,6 +336,14 @@ class MonteCarloAsian
          */
         void cpuReferenceImpl();
 
+        /**
+         * @brief Prices the kernel's paths with the host engine, from the
+         *        same seeds, then with the control variate and Sobol paths,
+         *        and times each method
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int runHostEngine();
+
         /**
          * @brief Accepts rand, price & priceDeriv cl_mem objects and sets it to kernel object
          */
@@ -19,6 +19,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include <math.h>
 #include <malloc.h>
+#include <algorithm>
 
 
 /*
@@ -77,6 +78,14 @@ MonteCarloAsianDP::setupMonteCarloAsianDP()
     CHECK_ALLOCATION(refVega, "Failed to allocate host memory. (refVega)");
     memset((void*)refVega, 0, steps * sizeof(cl_double));
 
+    stdError = (cl_double*) malloc(steps * sizeof(cl_double));
+    CHECK_ALLOCATION(stdError, "Failed to allocate host memory. (stdError)");
+    memset((void*)stdError, 0, steps * sizeof(cl_double));
+
+    plainError = (cl_double*) malloc(steps * sizeof(cl_double));
+    CHECK_ALLOCATION(plainError, "Failed to allocate host memory. (plainError)");
+    memset((void*)plainError, 0, steps * sizeof(cl_double));
+
     // Set samples and exercize points
     noOfSum = 12;
     noOfTraj = 1024;
@@ -92,9 +101,10 @@ MonteCarloAsianDP::setupMonteCarloAsianDP()
 
     CHECK_ALLOCATION(randNum, "Failed to allocate host memory. (randNum)");
 
-    priceVals = (cl_double*)malloc(width * height * 2 * sizeof(cl_double4));
+    // Payoffs of the arithmetic averages, then of the geometric averages
+    priceVals = (cl_double*)malloc(width * height * 4 * sizeof(cl_double4));
     CHECK_ALLOCATION(priceVals, "Failed to allocate host memory. (priceVals)");
-    memset((void*)priceVals, 0, width * height * 2 * sizeof(cl_double4));
+    memset((void*)priceVals, 0, width * height * 4 * sizeof(cl_double4));
 
     priceDeriv = (cl_double*)malloc(width * height * 2 * sizeof(cl_double4));
     CHECK_ALLOCATION(priceDeriv, "Failed to allocate host memory. (priceDeriv)");
@@ -267,7 +277,7 @@ MonteCarloAsianDP::setupCL(void)
 
     priceBuf = clCreateBuffer(context,
                               CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR,
-                              sizeof(cl_double4) * width * height * 2,
+                              sizeof(cl_double4) * width * height * 4,
                               NULL,
                               &status);
     CHECK_OPENCL_ERROR(status,"clCreateBuffer failed.(priceBuf)");
@@ -281,7 +291,7 @@ MonteCarloAsianDP::setupCL(void)
 
     priceBufAsync = clCreateBuffer(context,
                                    CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR,
-                                   sizeof(cl_double4) * width * height * 2,
+                                   sizeof(cl_double4) * width * height * 4,
                                    NULL,
                                    &status);
     CHECK_OPENCL_ERROR(status,"clCreateBuffer failed.(priceBufAsync)");
@@ -461,7 +471,7 @@ MonteCarloAsianDP::runCLKernels(void)
                               CL_FALSE,
                               CL_MAP_READ,
                               0,
-                              outSize * 2,
+                              outSize * 4,
                               0,
                               NULL,
                               &outMapEvt21,
@@ -604,17 +614,7 @@ MonteCarloAsianDP::runCLKernels(void)
             // Calculate the results from output of kernel 2
             ptr21 = (cl_double*)outMapPtr21;
             ptr22 = (cl_double*)outMapPtr22;
-            for(int i = 0; i < noOfTraj * noOfTraj; i++)
-            {
-                price[k * 2 - 1] += ptr21[i];
-                vega[k * 2 - 1] += ptr22[i];
-            }
-
-            price[k * 2 - 1] /= (noOfTraj * noOfTraj);
-            vega[k * 2 - 1] /= (noOfTraj * noOfTraj);
-
-            price[k * 2 - 1] = exp(-interest * maturity) * price[k * 2 - 1];
-            vega[k * 2 - 1] = exp(-interest * maturity) * vega[k * 2 - 1];
+            reducePaths(ptr21, ptr22, k * 2 - 1, price, vega, stdError, plainError);
 
             // Unmap of output buffers of kernel 2
             status = clEnqueueUnmapMemObject(
@@ -659,7 +659,7 @@ MonteCarloAsianDP::runCLKernels(void)
                           CL_FALSE,
                           CL_MAP_READ,
                           0,
-                          outSize * 2,
+                          outSize * 4,
                           0,
                           NULL,
                           &outMapEvt11,
@@ -751,17 +751,7 @@ MonteCarloAsianDP::runCLKernels(void)
         // Calculate the results from output of kernel 2
         ptr21 = (cl_double*)outMapPtr11;
         ptr22 = (cl_double*)outMapPtr12;
-        for(int i = 0; i < noOfTraj * noOfTraj; i++)
-        {
-            price[k * 2] += ptr21[i];
-            vega[k * 2] += ptr22[i];
-        }
-
-        price[k * 2] /= (noOfTraj * noOfTraj);
-        vega[k * 2] /= (noOfTraj * noOfTraj);
-
-        price[k * 2] = exp(-interest * maturity) * price[k * 2];
-        vega[k * 2] = exp(-interest * maturity) * vega[k * 2];
+        reducePaths(ptr21, ptr22, k * 2, price, vega, stdError, plainError);
 
         // Unmap of output buffers of kernel 2
         status = clEnqueueUnmapMemObject(
@@ -805,7 +795,7 @@ MonteCarloAsianDP::runCLKernels(void)
                       CL_FALSE,
                       CL_MAP_READ,
                       0,
-                      outSize * 2,
+                      outSize * 4,
                       0,
                       NULL,
                       &outMapEvt21,
@@ -837,17 +827,7 @@ MonteCarloAsianDP::runCLKernels(void)
     // Calculate the results from output of kernel 2
     ptr21 = (cl_double*)outMapPtr21;
     ptr22 = (cl_double*)outMapPtr22;
-    for(int i = 0; i < noOfTraj * noOfTraj; i++)
-    {
-        price[steps - 1] += ptr21[i];
-        vega[steps - 1] += ptr22[i];
-    }
-
-    price[steps - 1] /= (noOfTraj * noOfTraj);
-    vega[steps - 1] /= (noOfTraj * noOfTraj);
-
-    price[steps - 1] = exp(-interest * maturity) * price[steps - 1];
-    vega[steps - 1] = exp(-interest * maturity) * vega[steps - 1];
+    reducePaths(ptr21, ptr22, steps - 1, price, vega, stdError, plainError);
 
     return SDK_SUCCESS;
 }
@@ -917,11 +897,47 @@ MonteCarloAsianDP::initialize()
 
     delete iteration_option;
 
+    Option* control_option = new Option;
+    CHECK_ALLOCATION(control_option,
+                     "Failed to allocate host memory. (control_option)");
+
+    control_option->_sVersion = "";
+    control_option->_lVersion = "controlvariate";
+    control_option->_description =
+        "Correct the prices with the geometric average call as control variate";
+    control_option->_type = CA_NO_ARGUMENT;
+    control_option->_value = &controlVariate;
+
+    sampleArgs->AddOption(control_option);
+
+    delete control_option;
+
+    Option* target_option = new Option;
+    CHECK_ALLOCATION(target_option,
+                     "Failed to allocate host memory. (target_option)");
+
+    target_option->_sVersion = "";
+    target_option->_lVersion = "targeterror";
+    target_option->_description =
+        "Standard error the kernel time is scaled to";
+    target_option->_type = CA_ARG_DOUBLE;
+    target_option->_value = &targetError;
+
+    sampleArgs->AddOption(target_option);
+
+    delete target_option;
+
     return SDK_SUCCESS;
 }
 
 int MonteCarloAsianDP::setup()
 {
+    if(targetError <= 0)
+    {
+        std::cout<<"Error, targeterror must be positive. Exiting..\n";
+        exit(0);
+    }
+
     int status=setupMonteCarloAsianDP();
     CHECK_ERROR(status, SDK_SUCCESS, "MonteCarloAsianDP::setup) failed");
 
@@ -1011,6 +1027,69 @@ MonteCarloAsianDP::printStats()
                             kernelTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        // Time to reach the target error, the error falls as the square
+        // root of the number of paths
+        cl_double maxError = 0;
+        cl_double maxPlainError = 0;
+        for(int i = 0; i < steps; i++)
+        {
+            maxError = std::max(maxError, stdError[i]);
+            maxPlainError = std::max(maxPlainError, plainError[i]);
+        }
+        cl_double scale = maxError / targetError;
+
+        std::string errorStrArray[3] =
+        {
+            controlVariate ? "Control Variate Std. Error" : "Std. Error",
+            "Plain Std. Error",
+            "Time to " + toString(targetError, std::dec) + " (sec)"
+        };
+        std::string errorStats[3];
+        errorStats[0] = toString(maxError, std::dec);
+        errorStats[1] = toString(maxPlainError, std::dec);
+        errorStats[2] = toString(kernelTime * scale * scale, std::dec);
+
+        printStatistics(errorStrArray, errorStats, 3);
+    }
+}
+
+void
+MonteCarloAsianDP::reducePaths(const cl_double *samples, const cl_double *derivs,
+                               int k, cl_double *outPrice, cl_double *outVega,
+                               cl_double *outError, cl_double *outPlainError)
+{
+    const int numPaths = noOfTraj * noOfTraj;
+    const cl_double *controls = samples + numPaths;
+
+    SDKControlVariate estimator;
+    cl_double sumDeriv = 0;
+    for(int i = 0; i < numPaths; i++)
+    {
+        estimator.add(samples[i], controls[i]);
+        sumDeriv += derivs[i];
+    }
+
+    cl_double discount = exp(-interest * maturity);
+    cl_double estimate = estimator.getMean();
+    cl_double error = estimator.getError();
+    if(controlVariate)
+    {
+        estimate = estimator.getEstimate(SDKControlVariate::geometricAsianCall(
+                                             initPrice, strikePrice, interest, maturity,
+                                             sigma[k], noOfSum));
+        error = estimator.getControlledError();
+    }
+
+    outPrice[k] = discount * estimate;
+    outVega[k] = discount * sumDeriv / numPaths;
+    if(outError != NULL)
+    {
+        outError[k] = discount * error;
+    }
+    if(outPlainError != NULL)
+    {
+        outPlainError[k] = discount * estimator.getError();
     }
 }
 
@@ -1268,6 +1347,9 @@ void MonteCarloAsianDP::cpuReferenceImpl()
         double c2 = sigma[k] * sqrt(timeStep);
         double c3 = (interest + 0.5 * sigma[k] * sigma[k]);
 
+        // Payoffs of the geometric averages, after the arithmetic ones
+        double *controlVals = priceVals + noOfTraj * noOfTraj;
+
         for(int j = 0; j < (width * height); j++)
         {
             unsigned int nextRand[4] = {0u, 0u, 0u, 0u};
@@ -1292,6 +1374,11 @@ void MonteCarloAsianDP::cpuReferenceImpl()
             double price2[4] = {0.0, 0.0, 0.0, 0.0};
             double pathDeriv2[4] = {0.0, 0.0, 0.0, 0.0};
 
+            double logReturn1[4] = {0.0, 0.0, 0.0, 0.0};
+            double logReturn2[4] = {0.0, 0.0, 0.0, 0.0};
+            double sumLog1[4] = {0.0, 0.0, 0.0, 0.0};
+            double sumLog2[4] = {0.0, 0.0, 0.0, 0.0};
+
             //Run the Monte Carlo simulation a total of Num_Sum - 1 times
             for(int i = 1; i < noOfSum; i++)
             {
@@ -1313,6 +1400,12 @@ void MonteCarloAsianDP::cpuReferenceImpl()
                     sumPrice1[c] = sumPrice1[c] + trajPrice1[c];
                     sumPrice2[c] = sumPrice2[c] + trajPrice2[c];
 
+                    // Log of the geometric average of the path
+                    logReturn1[c] = logReturn1[c] + c1 + c2 * gaussian1[c];
+                    logReturn2[c] = logReturn2[c] + c1 + c2 * gaussian2[c];
+                    sumLog1[c] = sumLog1[c] + logReturn1[c];
+                    sumLog2[c] = sumLog2[c] + logReturn2[c];
+
                     double temp = c3 * timeStep * i;
 
                     // Calculate the derivative price for all trajectories
@@ -1342,21 +1435,15 @@ void MonteCarloAsianDP::cpuReferenceImpl()
                 priceVals[j * 8 + 1 * 4 + c] = price2[c];
                 priceDeriv[j * 8 + c] = pathDeriv1[c];
                 priceDeriv[j * 8 + 1 * 4 + c] = pathDeriv2[c];
-            }
-        }
 
-        // Replace Following "for" loop with reduction kernel
-        for(int i = 0; i < noOfTraj * noOfTraj; i++)
-        {
-            refPrice[k] += priceVals[i];
-            refVega[k] += priceDeriv[i];
+                controlVals[j * 8 + c] = std::max(initPrice * exp(sumLog1[c] / noOfSum) -
+                                                  strikePrice, 0.0);
+                controlVals[j * 8 + 1 * 4 + c] = std::max(initPrice * exp(sumLog2[c] / noOfSum) -
+                                                          strikePrice, 0.0);
+            }
         }
 
-        refPrice[k] /= (noOfTraj * noOfTraj);
-        refVega[k] /= (noOfTraj * noOfTraj);
-
-        refPrice[k] = exp(-interest * maturity) * refPrice[k];
-        refVega[k] = exp(-interest * maturity) * refVega[k];
+        reducePaths(priceVals, priceDeriv, k, refPrice, refVega, NULL, NULL);
     }
 }
 
@@ -1433,6 +1520,8 @@ int MonteCarloAsianDP::cleanup()
     FREE(vega);
     FREE(refPrice);
     FREE(refVega);
+    FREE(stdError);
+    FREE(plainError);
 
 
     if(randNum)
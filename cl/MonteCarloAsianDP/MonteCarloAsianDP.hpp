@@ -27,6 +27,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <assert.h>
 #include <string.h>
 #include "CLUtil.hpp"
+#include "SDKControlVariate.hpp"
 
 using namespace appsdk;
 
@@ -56,6 +57,11 @@ class MonteCarloAsianDP
 
         cl_double *refPrice;                 /**< Array of reference price values */
         cl_double *refVega;                  /**< Array of reference vega values */
+        cl_double *stdError;                 /**< Standard errors of the prices */
+        cl_double *plainError;               /**< Standard errors without the control variate */
+
+        bool controlVariate;                /**< Correct the prices with the geometric average call */
+        cl_double targetError;              /**< Standard error the kernel time is scaled to */
 
         cl_uint *randNum;                   /**< Array of random numbers */
 
@@ -117,6 +123,10 @@ class MonteCarloAsianDP
             vega = NULL;
             refPrice = NULL;
             refVega = NULL;
+            stdError = NULL;
+            plainError = NULL;
+            controlVariate = false;
+            targetError = 1e-3;
             randNum = NULL;
             priceVals = NULL;
             priceDeriv = NULL;
@@ -137,6 +147,8 @@ class MonteCarloAsianDP
             FREE(vega);
             FREE(refPrice);
             FREE(refVega);
+            FREE(stdError);
+            FREE(plainError);
 #ifdef _WIN32
             ALIGNED_FREE(randNum);
 #else
@@ -266,6 +278,22 @@ class MonteCarloAsianDP
          *          Asian Option pricing
          */
         void cpuReferenceImpl();
+
+        /**
+         * @brief   Price and vega of one volatility from the outputs of the paths
+         * @param   samples payoffs of the arithmetic averages, then of the
+         *          geometric averages
+         * @param   derivs path derivatives
+         * @param   k index of the volatility
+         * @param   outPrice prices, with the control variate if it is enabled
+         * @param   outVega vegas
+         * @param   outError standard errors of the prices, may be NULL
+         * @param   outPlainError standard errors without the control variate,
+         *          may be NULL
+         */
+        void reducePaths(const cl_double *samples, const cl_double *derivs, int k,
+                         cl_double *outPrice, cl_double *outVega,
+                         cl_double *outError, cl_double *outPlainError);
 };
 
 #endif
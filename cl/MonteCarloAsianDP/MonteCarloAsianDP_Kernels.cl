@@ -279,7 +279,9 @@ calOutputs(double4 strikePrice,
  * @brief   Calculates the  price and vega for all trajectories for given random numbers
  * @param   attrib  structure of inputs for simulation
  * @param   width   width of random array
- * @param   priceSamples    array of calculated price samples
+ * @param   priceSamples    array of calculated price samples, followed by the
+ *                          payoffs of the geometric averages of the same paths
+ *                          which the host uses as control variate
  * @param   pathDeriv   array calculated path derivatives 
  */
 __kernel 
@@ -329,6 +331,11 @@ calPriceVega(MonteCarloAttrib attrib,
         double4 finalRandf1 = temp;
 		double4 finalRandf2 = temp;
 		
+		double4 logReturn1 = temp;
+		double4 logReturn2 = temp;
+		double4 sumLog1 = temp;
+		double4 sumLog2 = temp;
+		
 		uint4 nextRand = randArray[yPos * width + xPos];
 	    
 		//Run the Monte Carlo simulation a total of Num_Sum - 1 times
@@ -344,6 +351,12 @@ calPriceVega(MonteCarloAttrib attrib,
             sumPrice1 = sumPrice1 + trajPrice1;
             sumPrice2 = sumPrice2 + trajPrice2;
             
+            // Log of the geometric average of the path
+            logReturn1 = logReturn1 + c1 + c2 * finalRandf1;
+            logReturn2 = logReturn2 + c1 + c2 * finalRandf2;
+            sumLog1 = sumLog1 + logReturn1;
+            sumLog2 = sumLog2 + logReturn2;
+            
 			temp = c3 * timeStep * i;
 			
 			// Calculate the derivative price for all trajectories
@@ -369,5 +382,12 @@ calPriceVega(MonteCarloAttrib attrib,
 		pathDeriv[(yPos * width + xPos) * 2] = pathDeriv1; 
 		pathDeriv[(yPos * width + xPos) * 2 + 1] = pathDeriv2;				
 		
+		// Payoffs of the geometric averages, after the arithmetic ones
+		size_t controlOffset = get_global_size(0) * get_global_size(1) * 2;
+		priceSamples[controlOffset + (yPos * width + xPos) * 2] =
+		    fmax(initPrice * exp(sumLog1 / noOfSum) - strikePrice, 0.0);
+		priceSamples[controlOffset + (yPos * width + xPos) * 2 + 1] =
+		    fmax(initPrice * exp(sumLog2 / noOfSum) - strikePrice, 0.0);
+		
 }
 
@@ -18,7 +18,12 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "MonteCarloAsianMultiGPU.hpp"
 
 #include <math.h>
+#include <algorithm>
 #include <malloc.h>
+#include <time.h>
+#include <map>
+#include <vector>
+#include <fstream>
 
 
 /*
@@ -37,6 +42,18 @@ typedef struct _MonteCalroAttrib
     cl_float4 timeStep;
 } MonteCarloAttrib;
 
+/**
+* This structure is used in multiing
+*/
+
+struct dataPerGPU
+{
+    MonteCarloAsianMultiGPU *mcaObj;
+    int deviceNumber;
+};
+
+void* timedThreadFuncPerGPU(void *data1);
+
 
 int
 MonteCarloAsianMultiGPU::setupMonteCarloAsianMultiGPU()
@@ -82,6 +99,18 @@ MonteCarloAsianMultiGPU::setupMonteCarloAsianMultiGPU()
            0,
            steps * sizeof(cl_float));
 
+    stdError = (cl_double*) malloc(steps * sizeof(cl_double));
+    CHECK_ALLOCATION(stdError, "Failed to allocate host memory. (stdError)");
+    memset((void*)stdError,
+           0,
+           steps * sizeof(cl_double));
+
+    plainError = (cl_double*) malloc(steps * sizeof(cl_double));
+    CHECK_ALLOCATION(plainError, "Failed to allocate host memory. (plainError)");
+    memset((void*)plainError,
+           0,
+           steps * sizeof(cl_double));
+
     // Set samples and exercize points
     noOfSum = 12;
     noOfTraj = 1024;
@@ -98,12 +127,13 @@ MonteCarloAsianMultiGPU::setupMonteCarloAsianMultiGPU()
 #endif
     CHECK_ALLOCATION(randNum, "Failed to allocate host memory. (randNum)");
 
-    priceVals = (cl_float*)malloc(width * height * 2 * sizeof(cl_float4));
+    // Payoffs of the arithmetic averages, then of the geometric averages
+    priceVals = (cl_float*)malloc(width * height * 4 * sizeof(cl_float4));
     CHECK_ALLOCATION(priceVals, "Failed to allocate host memory. (priceVals)");
 
     memset((void*)priceVals,
            0,
-           width * height * 2 * sizeof(cl_float4));
+           width * height * 4 * sizeof(cl_float4));
 
     priceDeriv = (cl_float*)malloc(width * height * 2 * sizeof(cl_float4));
     CHECK_ALLOCATION(priceDeriv, "Failed to allocate host memory. (priceDeriv)");
@@ -159,59 +189,112 @@ MonteCarloAsianMultiGPU::genBinaryImage()
     return status;
 }
 
-int
-MonteCarloAsianMultiGPU::loadBalancing()
+/**
+* Thread-safe wall clock in seconds, used to time each device on its share
+*/
+static double wallClock()
 {
-    /**
-    * Calculating the peak GFlops of each device
-    **/
-
-    peakGflopsGPU = new cl_double[numGPUDevices];
+#ifdef _WIN32
+    long long freq, count;
+    QueryPerformanceFrequency((LARGE_INTEGER*)&freq);
+    QueryPerformanceCounter((LARGE_INTEGER*)&count);
+    return (double)count / freq;
+#else
+    struct timespec s;
+    clock_gettime(CLOCK_MONOTONIC, &s);
+    return s.tv_sec + s.tv_nsec * 1e-9;
+#endif
+}
 
-    CHECK_ALLOCATION(peakGflopsGPU, "Allocation failed(peakGflopGPU)");
-    double toatalPeakGflops = 0;//Sum of peakGflops of all the devices
-    for (int i = 0; i < numGPUDevices; i++)
+/**
+* Profile entries are keyed by device name, driver version and problem size,
+* one "key|stepsPerSec" entry per line
+*/
+static void readProfile(const std::string &fileName,
+                        std::map<std::string, cl_double> &profile)
+{
+    std::ifstream file(fileName.c_str());
+    std::string line;
+    while(std::getline(file, line))
     {
-        cl_int numComputeUnits = devicesInfo[i].maxComputeUnits;
+        size_t split = line.rfind('|');
+        if(split == std::string::npos)
+        {
+            continue;
+        }
+        cl_double rate = atof(line.c_str() + split + 1);
+        if(rate > 0)
+        {
+            profile[line.substr(0, split)] = rate;
+        }
+    }
+}
 
-        cl_int maxClockFrequency = devicesInfo[i].maxClockFrequency;
+static bool writeProfile(const std::string &fileName,
+                         const std::map<std::string, cl_double> &profile)
+{
+    std::ofstream file(fileName.c_str());
+    if(!file)
+    {
+        return false;
+    }
+    file.precision(10);
+    std::map<std::string, cl_double>::const_iterator it;
+    for(it = profile.begin(); it != profile.end(); ++it)
+    {
+        file << it->first << "|" << it->second << std::endl;
+    }
+    return file.good();
+}
 
-        char * deviceName = devicesInfo[i].name;
+int
+MonteCarloAsianMultiGPU::calibrateDevice(int deviceNumber,
+        cl_double &stepsPerSec)
+{
+    dataPerGPU data;
+    data.deviceNumber = deviceNumber;
+    data.mcaObj = this;
 
-        /**
-        * In cayman device we have four processing elements in a stream processor
-        **/
-        int numProcessingElts;
+    /**
+    * Run the device alone on the leading steps. The first pass only warms up
+    * the device, after that the run doubles until it is long enough to time.
+    **/
+    int pairs = 1;
+    for(int pass = 0; ; pass++)
+    {
+        numStepsPerGPU[deviceNumber] = 2 * pairs;
+        cumulativeStepsPerGPU[deviceNumber] = 2 * pairs;
+        timedThreadFuncPerGPU(&data);
 
-        if (!strcmp(deviceName,
-                    "Cayman"))
+        if(pass == 0)
         {
-            numProcessingElts = 4;
+            continue;
         }
-        else
+        if(deviceTimes[deviceNumber] >= CALIBRATION_TIME || 4 * pairs > steps)
         {
-            numProcessingElts = 5;
+            break;
         }
-        /**
-        * We have 16 stream processors per compute unit and numProcessingelts number of
-        * processing elements in a stream processor. A processing elt can execute 2 floating point operations
-        * per cycle. So the peakGflops formula would be
-        *
-        *   peakGflops = numComputeUnits * numStreamProcessor per Compute Unit * numProcessingElt per stream processor
-        *                       * maxClockFrequency * num Floating Point operations per cycle per processing elt;
-        *                       We have to divide the result by 1000 to get the Gflops as freq is in MHz.
-        *
-        **/
-        peakGflopsGPU[i] = (numComputeUnits * 16 * numProcessingElts * maxClockFrequency
-                            * 2) / 1000;
-        toatalPeakGflops = peakGflopsGPU[i] + toatalPeakGflops;
+        pairs *= 2;
     }
 
-    /**
-    * ratios function will be used in load balancing statically
-    **/
-    double *ratios = new cl_double[numGPUDevices];
-    CHECK_ALLOCATION(ratios, "Allocation failed!!(ratios)");
+    if(deviceTimes[deviceNumber] <= 0)
+    {
+        std::cout << "Calibration of device " << deviceNumber << " failed" << std::endl;
+        return SDK_FAILURE;
+    }
+
+    stepsPerSec = 2 * pairs / deviceTimes[deviceNumber];
+    return SDK_SUCCESS;
+}
+
+int
+MonteCarloAsianMultiGPU::loadBalancing()
+{
+    stepsPerSecGPU = new cl_double[numGPUDevices];
+    CHECK_ALLOCATION(stepsPerSecGPU, "Allocation failed(stepsPerSecGPU)");
+
+    deviceTimes = new cl_double[numGPUDevices];
+    CHECK_ALLOCATION(deviceTimes, "Allocation failed(deviceTimes)");
 
     numStepsPerGPU = new cl_int[numGPUDevices];
     CHECK_ALLOCATION(numStepsPerGPU, "Allocation failed(numStepsPerGPU)!!");
@@ -223,30 +306,98 @@ MonteCarloAsianMultiGPU::loadBalancing()
     CHECK_ALLOCATION(cumulativeStepsPerGPU,
                      "Allocation failed(cumulativeStepsPerGPU)!!");
 
-    int cumulativeSumSteps = 0;
+    /**
+    * Peak Gflops from the device query does not predict the throughput of
+    * this sample, so each device is timed on a short run instead. The rates
+    * are cached in the profile file and only measured for new devices,
+    * drivers or problem sizes.
+    **/
+    std::map<std::string, cl_double> profile;
+    if(!recalibrate)
+    {
+        readProfile(profileFile, profile);
+    }
 
+    bool profileChanged = false;
+    double totalStepsPerSec = 0;
     for (int i = 0; i < numGPUDevices; i++)
     {
-        ratios[i] = peakGflopsGPU[i] / toatalPeakGflops;
-        numStepsPerGPU[i] = static_cast<cl_int>(steps * ratios[i]);
+        std::string key = std::string(devicesInfo[i].name) + "|" +
+                          devicesInfo[i].driverVersion + "|" +
+                          toString(width, std::dec) + "x" +
+                          toString(height, std::dec) + "x" +
+                          toString(noOfSum, std::dec);
 
-        cumulativeSumSteps += numStepsPerGPU[i];
-        cumulativeStepsPerGPU[i] = cumulativeSumSteps;
+        std::map<std::string, cl_double>::iterator it = profile.find(key);
+        bool cached = (it != profile.end());
+        if(cached)
+        {
+            stepsPerSecGPU[i] = it->second;
+        }
+        else
+        {
+            int status = calibrateDevice(i, stepsPerSecGPU[i]);
+            CHECK_ERROR(status, SDK_SUCCESS, "calibrateDevice failed!!");
+            profile[key] = stepsPerSecGPU[i];
+            profileChanged = true;
+        }
+        totalStepsPerSec += stepsPerSecGPU[i];
+
+        if(!sampleArgs->quiet)
+        {
+            std::cout << "Device " << i << " (" << devicesInfo[i].name << ") : "
+                      << stepsPerSecGPU[i] << " steps/sec"
+                      << (cached ? " from " + profileFile : " calibrated")
+                      << std::endl;
+        }
+    }
+
+    if(profileChanged && !writeProfile(profileFile, profile))
+    {
+        std::cout << "Failed to write the device profile to "
+                  << profileFile << std::endl;
+    }
+
+    // Calibration runs leave partial sums behind
+    memset((void*)price, 0, steps * sizeof(cl_float));
+    memset((void*)vega, 0, steps * sizeof(cl_float));
 
-        /**
-        * There can be a possibility that some values are missed. To avoid, add the missing values to the last GPU
-        **/
-        if (i == numGPUDevices - 1 && cumulativeSumSteps < steps)
+    /**
+    * Steps are processed in pairs, so pairs are shared in proportion to the
+    * measured rates and the pairs lost to rounding go to the devices with the
+    * largest remainders. A device whose share rounds to zero is left idle.
+    **/
+    int numPairs = steps / 2;
+    int assignedPairs = 0;
+    std::vector<double> remainders(numGPUDevices);
+    for (int i = 0; i < numGPUDevices; i++)
+    {
+        double idealPairs = numPairs * stepsPerSecGPU[i] / totalStepsPerSec;
+        int share = static_cast<cl_int>(idealPairs);
+        numStepsPerGPU[i] = 2 * share;
+        remainders[i] = idealPairs - share;
+        assignedPairs += share;
+    }
+
+    for (; assignedPairs < numPairs; assignedPairs++)
+    {
+        int largest = 0;
+        for (int i = 1; i < numGPUDevices; i++)
         {
-            numStepsPerGPU[i] = numStepsPerGPU[i] + (steps - cumulativeSumSteps);
-            cumulativeStepsPerGPU[i] += (steps - cumulativeSumSteps);
+            if (remainders[i] > remainders[largest])
+            {
+                largest = i;
+            }
         }
+        numStepsPerGPU[largest] += 2;
+        remainders[largest] = -1;
     }
 
-    if (ratios)
+    int cumulativeSumSteps = 0;
+    for (int i = 0; i < numGPUDevices; i++)
     {
-        delete []ratios;
-        ratios = NULL;
+        cumulativeSumSteps += numStepsPerGPU[i];
+        cumulativeStepsPerGPU[i] = cumulativeSumSteps;
     }
 
     return SDK_SUCCESS;
@@ -432,15 +583,6 @@ MonteCarloAsianMultiGPU::setupCL(void)
 
     totalLocalMemory = currentDeviceInfo.localMemSize;
 
-    /**
-    * Call load balancing for work division
-    **/
-    if (!noMultiGPUSupport)
-    {
-        status = loadBalancing();
-        CHECK_ERROR(status, SDK_SUCCESS, "loadBalancing failed!!");
-    }
-
     if (!noMultiGPUSupport)
     {
         for (int i = 0; i < numGPUDevices; i++)
@@ -463,7 +605,7 @@ MonteCarloAsianMultiGPU::setupCL(void)
 
             priceBufs[i] = clCreateBuffer(context,
                                           CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR,
-                                          sizeof(cl_float4) * width * height * 2,
+                                          sizeof(cl_float4) * width * height * 4,
                                           NULL,
                                           &status);
             CHECK_OPENCL_ERROR(status, "clCreateBuffer(priceBufs[i]) failed.");
@@ -477,7 +619,7 @@ MonteCarloAsianMultiGPU::setupCL(void)
 
             priceBufsAsync[i] = clCreateBuffer(context,
                                                CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR,
-                                               sizeof(cl_float4) * width * height * 2,
+                                               sizeof(cl_float4) * width * height * 4,
                                                NULL,
                                                &status);
             CHECK_OPENCL_ERROR(status, "clCreateBuffer(priceBufsAsync[i]) failed.");
@@ -512,7 +654,7 @@ MonteCarloAsianMultiGPU::setupCL(void)
 
         priceBuf = clCreateBuffer(context,
                                   CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR,
-                                  sizeof(cl_float4) * width * height * 2,
+                                  sizeof(cl_float4) * width * height * 4,
                                   NULL,
                                   &status);
         CHECK_OPENCL_ERROR(status, "clCreateBuffer(priceBuf) failed.");
@@ -527,7 +669,7 @@ MonteCarloAsianMultiGPU::setupCL(void)
 
         priceBufAsync = clCreateBuffer(context,
                                        CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR,
-                                       sizeof(cl_float4) * width * height * 2,
+                                       sizeof(cl_float4) * width * height * 4,
                                        NULL,
                                        &status);
         CHECK_OPENCL_ERROR(status, "clCreateBuffer(priceBufAsync) failed.");
@@ -707,18 +849,18 @@ MonteCarloAsianMultiGPU::setupCL(void)
         }
     }
 
-    return SDK_SUCCESS;
-}
 
-/**
-* This structure is used in multiing
-*/
+    /**
+    * Call load balancing for work division, it runs the kernels to calibrate
+    **/
+    if (!noMultiGPUSupport)
+    {
+        status = loadBalancing();
+        CHECK_ERROR(status, SDK_SUCCESS, "loadBalancing failed!!");
+    }
 
-struct dataPerGPU
-{
-    MonteCarloAsianMultiGPU *mcaObj;
-    int deviceNumber;
-};
+    return SDK_SUCCESS;
+}
 
 /**
 * Thread run function per GPU
@@ -874,7 +1016,7 @@ void* threadFuncPerGPU(void *data1)
                               CL_FALSE,
                               CL_MAP_READ,
                               0,
-                              size * 2,
+                              size * 4,
                               0,
                               NULL,
                               &outMapEvt21,
@@ -1108,19 +1250,8 @@ void* threadFuncPerGPU(void *data1)
             ptr21 = (cl_float*)outMapPtr21;
             ptr22 = (cl_float*)outMapPtr22;
 
-            for(int i = 0; i < mcaObj->noOfTraj * mcaObj->noOfTraj; i++)
-            {
-                mcaObj->price[k - 1] += ptr21[i];
-                mcaObj->vega[k - 1] += ptr22[i];
-            }
-
-            mcaObj->price[k - 1] /= (mcaObj->noOfTraj * mcaObj->noOfTraj);
-            mcaObj->vega[k - 1] /= (mcaObj->noOfTraj * mcaObj->noOfTraj);
-
-            mcaObj->price[k - 1] = exp(-mcaObj->interest * mcaObj->maturity) *
-                                   mcaObj->price[k - 1];
-            mcaObj->vega[k  - 1] = exp(-mcaObj->interest * mcaObj->maturity) *
-                                   mcaObj->vega[k - 1];
+            mcaObj->reducePaths(ptr21, ptr22, k - 1, mcaObj->price, mcaObj->vega,
+                                mcaObj->stdError, mcaObj->plainError);
 
             // Unmap of output buffers of kernel 2
             status = clEnqueueUnmapMemObject(
@@ -1192,7 +1323,7 @@ void* threadFuncPerGPU(void *data1)
                           CL_FALSE,
                           CL_MAP_READ,
                           0,
-                          size * 2,
+                          size * 4,
                           0,
                           NULL,
                           &outMapEvt11,
@@ -1352,17 +1483,8 @@ void* threadFuncPerGPU(void *data1)
         ptr21 = (cl_float*)outMapPtr11;
         ptr22 = (cl_float*)outMapPtr12;
 
-        for(int i = 0; i < mcaObj->noOfTraj * mcaObj->noOfTraj; i++)
-        {
-            mcaObj->price[k] += ptr21[i];
-            mcaObj->vega[k] += ptr22[i];
-        }
-
-        mcaObj->price[k] /= (mcaObj->noOfTraj * mcaObj->noOfTraj);
-        mcaObj->vega[k] /= (mcaObj->noOfTraj * mcaObj->noOfTraj);
-
-        mcaObj->price[k] = exp(-mcaObj->interest * mcaObj->maturity) * mcaObj->price[k];
-        mcaObj->vega[k] = exp(-mcaObj->interest * mcaObj->maturity) * mcaObj->vega[k];
+        mcaObj->reducePaths(ptr21, ptr22, k, mcaObj->price, mcaObj->vega,
+                            mcaObj->stdError, mcaObj->plainError);
 
 
         // Unmap of output buffers of kernel 1
@@ -1437,7 +1559,7 @@ void* threadFuncPerGPU(void *data1)
                           CL_FALSE,
                           CL_MAP_READ,
                           0,
-                          size * 2,
+                          size * 4,
                           0,
                           NULL,
                           &outMapEvt21,
@@ -1493,23 +1615,24 @@ void* threadFuncPerGPU(void *data1)
         // Calculate the results from output of kernel 2
         ptr21 = (cl_float*)outMapPtr21;
         ptr22 = (cl_float*)outMapPtr22;
-        for(int i = 0; i < mcaObj->noOfTraj * mcaObj->noOfTraj; i++)
-        {
-            mcaObj->price[endIndex - 1] += ptr21[i];
-            mcaObj->vega[endIndex - 1] += ptr22[i];
-        }
-
-        mcaObj->price[endIndex - 1] /= (mcaObj->noOfTraj * mcaObj->noOfTraj);
-        mcaObj->vega[endIndex - 1] /= (mcaObj->noOfTraj * mcaObj->noOfTraj);
-
-        mcaObj->price[endIndex - 1] = exp(-mcaObj->interest * mcaObj->maturity) *
-                                      mcaObj->price[endIndex - 1];
-        mcaObj->vega[endIndex - 1] = exp(-mcaObj->interest * mcaObj->maturity) *
-                                     mcaObj->vega[endIndex - 1];
+        mcaObj->reducePaths(ptr21, ptr22, endIndex - 1, mcaObj->price, mcaObj->vega,
+                            mcaObj->stdError, mcaObj->plainError);
     }
     return NULL;
 }
 
+/**
+* Runs the share of one GPU and records how long it took
+*/
+void* timedThreadFuncPerGPU(void *data1)
+{
+    dataPerGPU *data = (dataPerGPU *)data1;
+    double start = wallClock();
+    threadFuncPerGPU(data1);
+    data->mcaObj->deviceTimes[data->deviceNumber] = wallClock() - start;
+    return NULL;
+}
+
 int
 MonteCarloAsianMultiGPU::runCLKernelsMultiGPU(void)
 {
@@ -1523,13 +1646,22 @@ MonteCarloAsianMultiGPU::runCLKernelsMultiGPU(void)
     {
         data[i].deviceNumber = i;
         data[i].mcaObj = this;
-        threads[i].create(threadFuncPerGPU,
-                          (void *) &data[i]);
+        deviceTimes[i] = 0;
+
+        // Devices too slow to get a pair of steps stay idle
+        if (numStepsPerGPU[i] > 0)
+        {
+            threads[i].create(timedThreadFuncPerGPU,
+                              (void *) &data[i]);
+        }
     }
 
     for (int i = 0; i < numGPUDevices; i++)
     {
-        threads[i].join();
+        if (numStepsPerGPU[i] > 0)
+        {
+            threads[i].join();
+        }
     }
 
     delete []threads;
@@ -1661,7 +1793,7 @@ MonteCarloAsianMultiGPU::runCLKernels(void)
                               CL_FALSE,
                               CL_MAP_READ,
                               0,
-                              size * 2,
+                              size * 4,
                               0,
                               NULL,
                               &outMapEvt21,
@@ -1830,17 +1962,7 @@ MonteCarloAsianMultiGPU::runCLKernels(void)
             // Calculate the results from output of kernel 2
             ptr21 = (cl_float*)outMapPtr21;
             ptr22 = (cl_float*)outMapPtr22;
-            for(int i = 0; i < noOfTraj * noOfTraj; i++)
-            {
-                price[k * 2 - 1] += ptr21[i];
-                vega[k * 2 - 1] += ptr22[i];
-            }
-
-            price[k * 2 - 1] /= (noOfTraj * noOfTraj);
-            vega[k * 2 - 1] /= (noOfTraj * noOfTraj);
-
-            price[k * 2 - 1] = exp(-interest * maturity) * price[k * 2 - 1];
-            vega[k * 2 - 1] = exp(-interest * maturity) * vega[k * 2 - 1];
+            reducePaths(ptr21, ptr22, k * 2 - 1, price, vega, stdError, plainError);
 
             // Unmap of output buffers of kernel 2
             status = clEnqueueUnmapMemObject(
@@ -1885,7 +2007,7 @@ MonteCarloAsianMultiGPU::runCLKernels(void)
                           CL_FALSE,
                           CL_MAP_READ,
                           0,
-                          size * 2,
+                          size * 4,
                           0,
                           NULL,
                           &outMapEvt11,
@@ -2005,17 +2127,7 @@ MonteCarloAsianMultiGPU::runCLKernels(void)
         // Calculate the results from output of kernel 2
         ptr21 = (cl_float*)outMapPtr11;
         ptr22 = (cl_float*)outMapPtr12;
-        for(int i = 0; i < noOfTraj * noOfTraj; i++)
-        {
-            price[k * 2] += ptr21[i];
-            vega[k * 2] += ptr22[i];
-        }
-
-        price[k * 2] /= (noOfTraj * noOfTraj);
-        vega[k * 2] /= (noOfTraj * noOfTraj);
-
-        price[k * 2] = exp(-interest * maturity) * price[k * 2];
-        vega[k * 2] = exp(-interest * maturity) * vega[k * 2];
+        reducePaths(ptr21, ptr22, k * 2, price, vega, stdError, plainError);
 
         // Unmap of output buffers of kernel 2
         status = clEnqueueUnmapMemObject(
@@ -2059,7 +2171,7 @@ MonteCarloAsianMultiGPU::runCLKernels(void)
                       CL_FALSE,
                       CL_MAP_READ,
                       0,
-                      size * 2,
+                      size * 4,
                       0,
                       NULL,
                       &outMapEvt21,
@@ -2091,17 +2203,7 @@ MonteCarloAsianMultiGPU::runCLKernels(void)
     // Calculate the results from output of kernel 2
     ptr21 = (cl_float*)outMapPtr21;
     ptr22 = (cl_float*)outMapPtr22;
-    for(int i = 0; i < noOfTraj * noOfTraj; i++)
-    {
-        price[steps - 1] += ptr21[i];
-        vega[steps - 1] += ptr22[i];
-    }
-
-    price[steps - 1] /= (noOfTraj * noOfTraj);
-    vega[steps - 1] /= (noOfTraj * noOfTraj);
-
-    price[steps - 1] = exp(-interest * maturity) * price[steps - 1];
-    vega[steps - 1] = exp(-interest * maturity) * vega[steps - 1];
+    reducePaths(ptr21, ptr22, steps - 1, price, vega, stdError, plainError);
 
     return SDK_SUCCESS;
 }
@@ -2170,11 +2272,77 @@ MonteCarloAsianMultiGPU::initialize()
 
     delete iteration_option;
 
+    Option* profile_option = new Option;
+    CHECK_ALLOCATION(profile_option,
+                     "Failed to allocate memory (profile_option)\n");
+
+    profile_option->_sVersion = "";
+    profile_option->_lVersion = "profile";
+    profile_option->_description =
+        "File caching the measured steps/sec of each device (Default MonteCarloAsianMultiGPU.profile)";
+    profile_option->_type = CA_ARG_STRING;
+    profile_option->_value = &profileFile;
+
+    sampleArgs->AddOption(profile_option);
+
+    delete profile_option;
+
+    Option* recalibrate_option = new Option;
+    CHECK_ALLOCATION(recalibrate_option,
+                     "Failed to allocate memory (recalibrate_option)\n");
+
+    recalibrate_option->_sVersion = "";
+    recalibrate_option->_lVersion = "recalibrate";
+    recalibrate_option->_description =
+        "Measure the steps/sec of each device even if the profile has them";
+    recalibrate_option->_type = CA_NO_ARGUMENT;
+    recalibrate_option->_value = &recalibrate;
+
+    sampleArgs->AddOption(recalibrate_option);
+
+    delete recalibrate_option;
+
+    Option* control_option = new Option;
+    CHECK_ALLOCATION(control_option,
+                     "Failed to allocate memory (control_option)\n");
+
+    control_option->_sVersion = "";
+    control_option->_lVersion = "controlvariate";
+    control_option->_description =
+        "Correct the prices with the geometric average call as control variate";
+    control_option->_type = CA_NO_ARGUMENT;
+    control_option->_value = &controlVariate;
+
+    sampleArgs->AddOption(control_option);
+
+    delete control_option;
+
+    Option* target_option = new Option;
+    CHECK_ALLOCATION(target_option,
+                     "Failed to allocate memory (target_option)\n");
+
+    target_option->_sVersion = "";
+    target_option->_lVersion = "targeterror";
+    target_option->_description =
+        "Standard error the kernel time is scaled to";
+    target_option->_type = CA_ARG_DOUBLE;
+    target_option->_value = &targetError;
+
+    sampleArgs->AddOption(target_option);
+
+    delete target_option;
+
     return SDK_SUCCESS;
 }
 
 int MonteCarloAsianMultiGPU::setup()
 {
+    if(targetError <= 0)
+    {
+        std::cout<<"Error, targeterror must be positive. Exiting..\n";
+        exit(0);
+    }
+
     if (setupMonteCarloAsianMultiGPU() != SDK_SUCCESS)
     {
         return SDK_FAILURE;
@@ -2283,6 +2451,90 @@ MonteCarloAsianMultiGPU::printStats()
         stats[3] = toString((noOfTraj * (noOfSum - 1) * steps) /
                             kernelTime, std::dec);
         printStatistics(strArray, stats, 4);
+
+        // Time to reach the target error, the error falls as the square
+        // root of the number of paths
+        cl_double maxError = 0;
+        cl_double maxPlainError = 0;
+        for(int i = 0; i < steps; i++)
+        {
+            maxError = std::max(maxError, stdError[i]);
+            maxPlainError = std::max(maxPlainError, plainError[i]);
+        }
+        cl_double scale = maxError / targetError;
+
+        std::string errorStrArray[3] =
+        {
+            controlVariate ? "Control Variate Std. Error" : "Std. Error",
+            "Plain Std. Error",
+            "Time to " + toString(targetError, std::dec) + " (sec)"
+        };
+        std::string errorStats[3];
+        errorStats[0] = toString(maxError, std::dec);
+        errorStats[1] = toString(maxPlainError, std::dec);
+        errorStats[2] = toString(kernelTime * scale * scale, std::dec);
+        printStatistics(errorStrArray, errorStats, 3);
+
+        if(!noMultiGPUSupport)
+        {
+            // Devices should finish their shares of the last run together
+            std::vector<std::string> deviceStrArray;
+            std::vector<std::string> deviceStats;
+            for(int i = 0; i < numGPUDevices; i++)
+            {
+                std::string name = std::string(devicesInfo[i].name) + " " +
+                                   toString(i, std::dec);
+                deviceStrArray.push_back(name + " steps/sec");
+                deviceStats.push_back(toString(stepsPerSecGPU[i], std::dec));
+                deviceStrArray.push_back(name + " steps");
+                deviceStats.push_back(toString(numStepsPerGPU[i], std::dec));
+                deviceStrArray.push_back(name + " time(sec)");
+                deviceStats.push_back(toString(deviceTimes[i], std::dec));
+            }
+
+            printStatistics(&deviceStrArray[0], &deviceStats[0],
+                            (int)deviceStats.size());
+        }
+    }
+}
+
+void
+MonteCarloAsianMultiGPU::reducePaths(const cl_float *samples, const cl_float *derivs,
+                                     int k, cl_float *outPrice, cl_float *outVega,
+                                     cl_double *outError, cl_double *outPlainError)
+{
+    const int numPaths = noOfTraj * noOfTraj;
+    const cl_float *controls = samples + numPaths;
+
+    // Sums in double, a float sum of a million paths loses digits
+    SDKControlVariate estimator;
+    cl_double sumDeriv = 0;
+    for(int i = 0; i < numPaths; i++)
+    {
+        estimator.add(samples[i], controls[i]);
+        sumDeriv += derivs[i];
+    }
+
+    cl_double discount = exp(-(cl_double)interest * maturity);
+    cl_double estimate = estimator.getMean();
+    cl_double error = estimator.getError();
+    if(controlVariate)
+    {
+        estimate = estimator.getEstimate(SDKControlVariate::geometricAsianCall(
+                                             initPrice, strikePrice, interest, maturity,
+                                             sigma[k], noOfSum));
+        error = estimator.getControlledError();
+    }
+
+    outPrice[k] = (cl_float)(discount * estimate);
+    outVega[k] = (cl_float)(discount * sumDeriv / numPaths);
+    if(outError != NULL)
+    {
+        outError[k] = discount * error;
+    }
+    if(outPlainError != NULL)
+    {
+        outPlainError[k] = discount * estimator.getError();
     }
 }
 
@@ -2540,6 +2792,9 @@ void MonteCarloAsianMultiGPU::cpuReferenceImpl()
         float c2 = sigma[k] * sqrt(timeStep);
         float c3 = (interest + 0.5f * sigma[k] * sigma[k]);
 
+        // Payoffs of the geometric averages, after the arithmetic ones
+        float *controlVals = priceVals + noOfTraj * noOfTraj;
+
         for(int j = 0; j < (width * height); j++)
         {
             unsigned int nextRand[4] = {0u, 0u, 0u, 0u};
@@ -2564,6 +2819,11 @@ void MonteCarloAsianMultiGPU::cpuReferenceImpl()
             float price2[4] = {0.0f, 0.0f, 0.0f, 0.0f};
             float pathDeriv2[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 
+            float logReturn1[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            float logReturn2[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            float sumLog1[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            float sumLog2[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
             //Run the Monte Carlo simulation a total of Num_Sum - 1 times
             for(int i = 1; i < noOfSum; i++)
             {
@@ -2586,6 +2846,12 @@ void MonteCarloAsianMultiGPU::cpuReferenceImpl()
                     sumPrice1[c] = sumPrice1[c] + trajPrice1[c];
                     sumPrice2[c] = sumPrice2[c] + trajPrice2[c];
 
+                    // Log of the geometric average of the path
+                    logReturn1[c] = logReturn1[c] + c1 + c2 * gaussian1[c];
+                    logReturn2[c] = logReturn2[c] + c1 + c2 * gaussian2[c];
+                    sumLog1[c] = sumLog1[c] + logReturn1[c];
+                    sumLog2[c] = sumLog2[c] + logReturn2[c];
+
                     float temp = c3 * timeStep * i;
 
                     // Calculate the derivative price for all trajectories
@@ -2616,21 +2882,14 @@ void MonteCarloAsianMultiGPU::cpuReferenceImpl()
                 priceVals[j * 8 + 1 * 4 + c] = price2[c];
                 priceDeriv[j * 8 + c] = pathDeriv1[c];
                 priceDeriv[j * 8 + 1 * 4 + c] = pathDeriv2[c];
+                controlVals[j * 8 + c] = std::max<float>(initPrice * exp(sumLog1[c] / noOfSum) -
+                                                         strikePrice, 0.0f);
+                controlVals[j * 8 + 1 * 4 + c] = std::max<float>(initPrice * exp(sumLog2[c] / noOfSum) -
+                                                                 strikePrice, 0.0f);
             }
         }
 
-        // Replace Following "for" loop with reduction kernel
-        for(int i = 0; i < noOfTraj * noOfTraj; i++)
-        {
-            refPrice[k] += priceVals[i];
-            refVega[k] += priceDeriv[i];
-        }
-
-        refPrice[k] /= (noOfTraj * noOfTraj);
-        refVega[k] /= (noOfTraj * noOfTraj);
-
-        refPrice[k] = exp(-interest * maturity) * refPrice[k];
-        refVega[k] = exp(-interest * maturity) * refVega[k];
+        reducePaths(priceVals, priceDeriv, k, refPrice, refVega, NULL, NULL);
     }
 }
 
@@ -2819,6 +3078,8 @@ int MonteCarloAsianMultiGPU::cleanup()
 
     FREE(priceVals);
     FREE(priceDeriv);
+    FREE(stdError);
+    FREE(plainError);
     FREE(priceValsAsync);
     FREE(priceDerivAsync);
     FREE(devices);
@@ -2841,10 +3102,16 @@ int MonteCarloAsianMultiGPU::cleanup()
         cumulativeStepsPerGPU = NULL;
     }
 
-    if(peakGflopsGPU)
+    if(stepsPerSecGPU)
+    {
+        delete []stepsPerSecGPU;
+        stepsPerSecGPU = NULL;
+    }
+
+    if(deviceTimes)
     {
-        delete []peakGflopsGPU;
-        peakGflopsGPU = NULL;
+        delete []deviceTimes;
+        deviceTimes = NULL;
     }
 
     if(devicesInfo)
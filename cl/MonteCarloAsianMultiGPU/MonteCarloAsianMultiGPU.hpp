@@ -19,6 +19,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #define MONTECARLOASIAN_H_
 
 #define GROUP_SIZE 256
+#define CALIBRATION_TIME 0.05    /**< Shortest calibration run per device in seconds */
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -31,8 +32,10 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <string>
 #include "CLUtil.hpp"
 #include "SDKThread.hpp"
+#include "SDKControlVariate.hpp"
 
 using namespace appsdk;
 
@@ -74,6 +77,11 @@ class MonteCarloAsianMultiGPU
 
         cl_float *refPrice;                     /**< Array of reference price values */
         cl_float *refVega;                      /**< Array of reference vega values */
+        cl_double *stdError;                    /**< Standard errors of the prices */
+        cl_double *plainError;                  /**< Standard errors without the control variate */
+
+        bool controlVariate;                    /**< Correct the prices with the geometric average call */
+        cl_double targetError;                  /**< Standard error the kernel time is scaled to */
 
         cl_uint *randNum;                       /**< Array of random numbers */
 
@@ -116,7 +124,10 @@ class MonteCarloAsianMultiGPU
         cl_command_queue *commandQueues;         /**< Array to store command queues*/
         cl_kernel *kernels;                      /**< Array of kernels**/
         cl_program *programs;                    /**< Array of programs**/
-        cl_double *peakGflopsGPU;                /**< Peak Gflops of a GPU device */
+        cl_double *stepsPerSecGPU;               /**< Measured steps per second of a GPU device */
+        cl_double *deviceTimes;                  /**< Time taken by each GPU on its share in seconds */
+        std::string profileFile;                 /**< File caching the measured device rates */
+        bool recalibrate;                        /**< Measure device rates even if they are cached */
         SDKDeviceInfo
         *devicesInfo;              /**< Array to store the device information */
         cl_int *numStepsPerGPU;                  /**< Array to store the number of steps per GPU*/
@@ -162,6 +173,10 @@ class MonteCarloAsianMultiGPU
             vega = NULL;
             refPrice = NULL;
             refVega = NULL;
+            stdError = NULL;
+            plainError = NULL;
+            controlVariate = false;
+            targetError = 1e-3;
             randNum = NULL;
             priceVals = NULL;
             priceDeriv = NULL;
@@ -173,7 +188,10 @@ class MonteCarloAsianMultiGPU
             kernels = NULL;
             programs = NULL;
             commandQueues = NULL;
-            peakGflopsGPU = NULL;
+            stepsPerSecGPU = NULL;
+            deviceTimes = NULL;
+            profileFile = "MonteCarloAsianMultiGPU.profile";
+            recalibrate = false;
             devicesInfo = NULL;
             numStepsPerGPU = NULL;
             randBufs = NULL;
@@ -196,6 +214,8 @@ class MonteCarloAsianMultiGPU
             FREE(vega);
             FREE(refPrice);
             FREE(refVega);
+            FREE(stdError);
+            FREE(plainError);
 
 #ifdef _WIN32
             ALIGNED_FREE(randNum);
@@ -277,6 +297,24 @@ class MonteCarloAsianMultiGPU
          */
         int verifyResults();
 
+        /**
+         * @brief   Price and vega of one volatility from the outputs of the
+         *          paths. The device threads call it at once, each for its
+         *          own k.
+         * @param   samples payoffs of the arithmetic averages, then of the
+         *          geometric averages
+         * @param   derivs path derivatives
+         * @param   k index of the volatility
+         * @param   outPrice prices, with the control variate if it is enabled
+         * @param   outVega vegas
+         * @param   outError standard errors of the prices, may be NULL
+         * @param   outPlainError standard errors without the control
+         *          variate, may be NULL
+         */
+        void reducePaths(const cl_float *samples, const cl_float *derivs, int k,
+                         cl_float *outPrice, cl_float *outVega,
+                         cl_double *outError, cl_double *outPlainError);
+
     private:
 
         /**
@@ -322,12 +360,23 @@ class MonteCarloAsianMultiGPU
          *          Asian Option pricing
          */
         void cpuReferenceImpl();
+
         /**
         * Function: loadBalancing()
-        * calculates the peak Gflops for each device and shares the work accordingly.
+        * measures the steps per second of each device, or reads them from the
+        * profile file, and shares the steps in proportion to the rates.
         **/
         int loadBalancing();
 
+        /**
+        * Function: calibrateDevice()
+        * times a short run of the leading steps on one device.
+        * @param deviceNumber index of the GPU device
+        * @param stepsPerSec measured steps per second
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        **/
+        int calibrateDevice(int deviceNumber, cl_double &stepsPerSec);
+
         int runCLKernelsMultiGPU(void);
 };
 
@@ -16,56 +16,30 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "QuasiRandomSequence.hpp"
 #include <malloc.h>
+#include <algorithm>
 
 
-/* Generate direction numbers
-   v[j][32] : j dimensions each having 32 direction numbers
-*/
-void
-QuasiRandomSequence::generateDirectionNumbers(cl_uint nDimensions,
-        cl_uint* directionNumbers)
+/*
+ * Marks the interval of 1 / nVectors of each coordinate of a streamed block
+ */
+struct StratumCheck
 {
-    cl_uint *v = directionNumbers;
+    cl_uint numVectors;
+    std::vector<cl_uint> owner;
+};
 
-    for (int dim = 0 ; dim < (int)(nDimensions); dim++)
+static void markStrata(void *data, cl_uint first, cl_uint count,
+                       const cl_double *points, cl_uint dims)
+{
+    StratumCheck *check = (StratumCheck*)data;
+    for(cl_uint i = 0; i < count; i++)
     {
-        // First dimension is a special case
-        if (dim == 0)
+        for(cl_uint d = 0; d < dims; d++)
         {
-            for (int i = 0 ; i < N_DIRECTIONS ; i++)
-            {
-                // All m's are 1
-                v[i] = 1 << (31 - i);
-            }
+            cl_uint stratum = (cl_uint)(points[i * dims + d] * check->numVectors);
+            stratum = std::min(stratum, check->numVectors - 1);
+            check->owner[d * check->numVectors + stratum] = first + i + 1;
         }
-        else
-        {
-            int d = sobolPrimitives[dim].degree;
-            /* The first direction numbers (up to the degree of the polynomial)
-             are simply   v[i] = m[i] / 2^i  (stored in Q0.32 format) */
-            for (int i = 0 ; i < d ; i++)
-            {
-                v[i] = sobolPrimitives[dim].m[i] << (31 - i);
-            }
-
-            for (int i = d ; i < N_DIRECTIONS ; i++)
-            {
-
-                v[i] = v[i - d] ^ (v[i - d] >> d);
-                /*
-                Note that the coefficients a[] are zero or one and for compactness in
-                 the input tables they are stored as bits of a single integer. To extract
-                 the relevant bit we use right shift and mask with 1.
-                 For example, for a 10 degree polynomial there are ten useful bits in a,
-                 so to get a[2] we need to right shift 7 times (to get the 8th bit into
-                 the LSB) and then mask with 1.*/
-                for (int j = 1 ; j < d ; j++)
-                {
-                    v[i] ^= (((sobolPrimitives[dim].a >> (d - 1 - j)) & 1) * v[i - j]);
-                }
-            }
-        }
-        v += N_DIRECTIONS;
     }
 }
 
@@ -98,7 +72,9 @@ QuasiRandomSequence::setupQuasiRandomSequence()
     CHECK_ERROR(status, SDK_SUCCESS, "Failed to map device buffer.(inputBuffer)");
 
     // initialize sobol direction numbers
-    generateDirectionNumbers(nDimensions, input);
+    status = engine.setDimensions(nDimensions);
+    CHECK_ERROR(status, SDK_SUCCESS, "SobolEngine::setDimensions() failed");
+    memcpy(input, engine.getDirections(), nDimensions * N_DIRECTIONS * sizeof(cl_uint));
 
     if(!sampleArgs->quiet)
     {
@@ -491,6 +467,39 @@ QuasiRandomSequence::initialize()
 
     delete vs;
 
+    Option* threads_option = new Option;
+    CHECK_ALLOCATION(threads_option, "Memory Allocation error.\n");
+
+    threads_option->_sVersion = "";
+    threads_option->_lVersion = "threads";
+    threads_option->_description =
+        "Number of host threads of the reference (0 uses every core)";
+    threads_option->_type = CA_ARG_INT;
+    threads_option->_value = &cpuThreads;
+    sampleArgs->AddOption(threads_option);
+
+    delete threads_option;
+
+    Option* scramble_option = new Option;
+    CHECK_ALLOCATION(scramble_option, "Memory Allocation error.\n");
+
+    scramble_option->_sVersion = "";
+    scramble_option->_lVersion = "scramble";
+    scramble_option->_description =
+        "Also stream Owen scrambled points on the host and check their strata";
+    scramble_option->_type = CA_NO_ARGUMENT;
+    scramble_option->_value = &scramble;
+    sampleArgs->AddOption(scramble_option);
+
+    scramble_option->_sVersion = "";
+    scramble_option->_lVersion = "scrambleseed";
+    scramble_option->_description = "Seed of the Owen scrambling";
+    scramble_option->_type = CA_ARG_INT;
+    scramble_option->_value = &scrambleSeed;
+    sampleArgs->AddOption(scramble_option);
+
+    delete scramble_option;
+
     return SDK_SUCCESS;
 }
 
@@ -564,32 +573,60 @@ int QuasiRandomSequence::run()
 }
 
 
-void
+int
 QuasiRandomSequence::quasiRandomSequenceCPUReference()
 {
+    // Natural order without scrambling, as the kernels
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+    engine.setOrder(SOBOL_NATURAL);
+    engine.setScrambling(false, 0);
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
 
-    for(int j=0; j < (int)nDimensions; j++)
+    int status = engine.generate(0, nVectors, verificationOutput, nVectors);
+    CHECK_ERROR(status, SDK_SUCCESS, "SobolEngine::generate() failed");
+
+    sampleTimer->stopTimer(timer);
+    hostTime = (double)(sampleTimer->readTimer(timer));
+    return SDK_SUCCESS;
+}
+
+int
+QuasiRandomSequence::verifyScrambled()
+{
+    if(nVectors & (nVectors - 1))
     {
-        for(int i=0; i < (int)nVectors; i++)
-        {
-            unsigned int temp = 0;
-            for(int k=0; k < 32; k++)
-            {
-                int mask = (int)(pow(2, (double)k));
-                temp ^= ((i & mask) >> k) * input[j * 32 + k];
-            }
+        std::cout << "Scrambled points are only checked for a power of two "
+                  "number of vectors\n";
+        return SDK_SUCCESS;
+    }
 
-            if(i==0 && j==0)
-            {
-                verificationOutput[j * nVectors + i] = 0;
-            }
-            else
-            {
-                verificationOutput[j * nVectors + i] =
-                    (cl_float)(temp / pow(2, (double)32));
-            }
-        }
+    engine.setScrambling(true, (cl_uint)scrambleSeed);
+
+    StratumCheck check;
+    check.numVectors = nVectors;
+    check.owner.assign(nDimensions * nVectors, 0);
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    int status = engine.stream(0, nVectors, markStrata, &check);
+    CHECK_ERROR(status, SDK_SUCCESS, "SobolEngine::stream() failed");
+
+    sampleTimer->stopTimer(timer);
+    scrambleTime = (double)(sampleTimer->readTimer(timer));
+    engine.setScrambling(false, 0);
+
+    // nVectors points fill nVectors strata only if each holds exactly one
+    if(std::find(check.owner.begin(), check.owner.end(), 0u) != check.owner.end())
+    {
+        std::cout << "Failed (scrambled points)\n" << std::endl;
+        return SDK_FAILURE;
     }
+    return SDK_SUCCESS;
 }
 
 
@@ -599,24 +636,9 @@ QuasiRandomSequence::verifyResults()
 
     if(sampleArgs->verify)
     {
-        /*
-         * Map cl_mem inputBuffer to host for reading
-         * device->host transfer happens if device exists in different address-space
-         */
-        int status = mapBuffer( inputBuffer, input,
-                                (nDimensions * N_DIRECTIONS * sizeof(cl_uint)),
-                                CL_MAP_READ );
-        CHECK_ERROR(status, SDK_SUCCESS, "Failed to map device buffer.(inputBuffer)");
-
-        // Reference implementation
-        quasiRandomSequenceCPUReference();
-
-        /*
-         * Unmap cl_mem inputBuffer from host
-         * there will be no data-transfers since cl_mem inputBuffer was mapped for reading
-         */
-        status = unmapBuffer(inputBuffer, input);
-        CHECK_ERROR(status, SDK_SUCCESS, "Failed to unmap device buffer.(inputBuffer)");
+        // Reference implementation, from the engine's own direction numbers
+        int status = quasiRandomSequenceCPUReference();
+        CHECK_ERROR(status, SDK_SUCCESS, "Reference implementation failed");
 
         /*
          * Map cl_mem outputBuffer to host for reading
@@ -645,6 +667,11 @@ QuasiRandomSequence::verifyResults()
         CHECK_ERROR(status, SDK_SUCCESS,
                     "Failed to unmap device buffer.(outputBuffer)");
 
+        if(pass && scramble && verifyScrambled() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+
         if(pass)
         {
             std::cout<<"Passed!\n" << std::endl;
@@ -677,6 +704,28 @@ QuasiRandomSequence::printStats()
         stats[3]  = toString((length / avgTime), std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        if(sampleArgs->verify)
+        {
+            std::string hostStrArray[2] = {"Host time (sec)", "Host Elements/sec"};
+            std::string hostStats[2];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(hostTime > 0 ? length / hostTime : 0, std::dec);
+            printStatistics(hostStrArray, hostStats, 2);
+
+            if(scramble && scrambleTime > 0)
+            {
+                std::string scrambleStrArray[2] =
+                {
+                    "Scrambled stream time (sec)",
+                    "Scrambled Elements/sec"
+                };
+                std::string scrambleStats[2];
+                scrambleStats[0] = toString(scrambleTime, std::dec);
+                scrambleStats[1] = toString(length / scrambleTime, std::dec);
+                printStatistics(scrambleStrArray, scrambleStats, 2);
+            }
+        }
     }
 
 }
@@ -119,18 +119,12 @@ jurisdiction and venue of these courts.
 #include <string>
 #include <fstream>
 #include "CLUtil.hpp"
-#include "SobolPrimitives.hpp"
+#include "SobolEngine.hpp"
 
 using namespace appsdk;
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
-/* direction numbers */
-
-#define N_DIRECTIONS 32       ///< Number of direction numbers
-
-#define MAX_DIMENSIONS 10200  ///< Maximum number of dimensions
-
 #define GROUP_SIZE 256        ///< Number of workgroups 
 /**
 * CL specific parameters used by SDK
@@ -172,6 +166,13 @@ class QuasiRandomSequence
 
         SDKTimer *sampleTimer;      /**< SDKTimer object */
 
+        SobolEngine engine;                 /**< Host Sobol generator */
+        int cpuThreads;                     /**< Host threads, 0 uses every core */
+        bool scramble;                      /**< Also check Owen scrambled points on the host */
+        int scrambleSeed;                   /**< Seed of the Owen scrambling */
+        cl_double hostTime;                 /**< Time of the host reference */
+        cl_double scrambleTime;             /**< Time of the scrambled host stream */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -182,7 +183,12 @@ class QuasiRandomSequence
         */
         QuasiRandomSequence()
             : useScalarKernel(false),
-              useVectorKernel(false)
+              useVectorKernel(false),
+              cpuThreads(0),
+              scramble(false),
+              scrambleSeed(1),
+              hostTime(0),
+              scrambleTime(0)
         {
             sampleArgs = new CLCommandArgs();
             sampleTimer = new SDKTimer();
@@ -196,14 +202,6 @@ class QuasiRandomSequence
             vectorWidth = 0;            // Will be queried later for the device
         }
 
-        /**
-        * Generate Direction numbers (input to device)
-        * @param n_dimensions number of dimensions
-        * @param directionNumbers array of direction numbers
-        */
-        void generateDirectionNumbers(cl_uint n_dimensions,
-                                      cl_uint* directionNumbers);
-
         /**
         * Allocate and initialize device memory buffers
         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
@@ -242,8 +240,16 @@ class QuasiRandomSequence
 
         /**
         * Reference CPU implementation of QuasiRandomSequence
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        */
+        int quasiRandomSequenceCPUReference();
+
+        /**
+        * Streams Owen scrambled points of the host engine and checks that
+        * every dimension keeps one point per interval of 1 / nVectors
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
-        void quasiRandomSequenceCPUReference();
+        int verifyScrambled();
         /**
         * Override from SDKSample. Print sample stats.
         */
@@ -0,0 +1,376 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "SobolEngine.hpp"
+#include "SobolPrimitives.hpp"
+#include <algorithm>
+
+/*
+ * Points per work item of generate(). Items do not depend on the number of
+ * threads.
+ */
+#define GENERATE_POINTS 4096
+
+/*
+ * Values per block handed to the consumer of stream()
+ */
+#define STREAM_VALUES 16384
+
+/**
+ * Arguments of the generator threads
+ */
+struct SobolEngine::rangeArgs
+{
+    const SobolEngine *engine;
+    cl_uint first;
+    cl_uint count;
+    cl_uint chunk;
+    cl_uint numChunks;
+    cl_float *floatOutput;
+    cl_double *doubleOutput;
+    cl_uint stride;
+    SobolConsumer consumer;
+    void *data;
+};
+
+/*
+ * Index of the lowest set bit of n > 0
+ */
+static inline cl_uint lowestBit(cl_uint n)
+{
+    cl_uint bit = 0;
+    while(!(n & 1))
+    {
+        n >>= 1;
+        bit++;
+    }
+    return bit;
+}
+
+/*
+ * Reverses the 32 bits of x
+ */
+static inline cl_uint reverseBits(cl_uint x)
+{
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+    x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+/*
+ * Finalizer of MurmurHash3, spreads the seeds over all 32 bits
+ */
+static inline cl_uint mixBits(cl_uint h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    return h ^ (h >> 16);
+}
+
+/*
+ * Nested uniform scramble of x. On reversed bits the Laine-Karras hash only
+ * lets each bit depend on the bits below it, that is on the higher bits of x.
+ */
+static inline cl_uint owenScramble(cl_uint x, cl_uint seed)
+{
+    x = reverseBits(x);
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return reverseBits(x);
+}
+
+int
+SobolEngine::setDimensions(cl_uint dims)
+{
+    if(dims == 0 || dims > MAX_DIMENSIONS)
+    {
+        error("SobolEngine::setDimensions() supports 1 to 10200 dimensions");
+        return SDK_FAILURE;
+    }
+
+    numDimensions = dims;
+    directions.resize(dims * N_DIRECTIONS);
+    for(cl_uint dim = 0; dim < dims; dim++)
+    {
+        cl_uint *v = &directions[dim * N_DIRECTIONS];
+
+        // First dimension is a special case
+        if(dim == 0)
+        {
+            for(int i = 0; i < N_DIRECTIONS; i++)
+            {
+                v[i] = 1u << (31 - i);
+            }
+            continue;
+        }
+
+        // v[i] = m[i] / 2^i in Q0.32 up to the degree, then the recurrence
+        // of the primitive polynomial
+        int d = sobolPrimitives[dim].degree;
+        for(int i = 0; i < d; i++)
+        {
+            v[i] = sobolPrimitives[dim].m[i] << (31 - i);
+        }
+        for(int i = d; i < N_DIRECTIONS; i++)
+        {
+            v[i] = v[i - d] ^ (v[i - d] >> d);
+            for(int j = 1; j < d; j++)
+            {
+                v[i] ^= ((sobolPrimitives[dim].a >> (d - 1 - j)) & 1) * v[i - j];
+            }
+        }
+    }
+
+    setOrder(order);
+    setScrambling(scramble, scrambleSeed);
+    return SDK_SUCCESS;
+}
+
+void
+SobolEngine::setOrder(SobolOrder newOrder)
+{
+    order = newOrder;
+
+    /**
+     * steps[c * dims + d] is the XOR taking dimension d from point i - 1
+     * to point i when bit c is the lowest set bit of i. In natural order
+     * bits 0 to c of the index flip, in Gray code order only bit c does.
+     */
+    steps.resize(numDimensions * N_DIRECTIONS);
+    for(cl_uint d = 0; d < numDimensions; d++)
+    {
+        const cl_uint *v = &directions[d * N_DIRECTIONS];
+        cl_uint prefix = 0;
+        for(int c = 0; c < N_DIRECTIONS; c++)
+        {
+            prefix ^= v[c];
+            steps[c * numDimensions + d] = (order == SOBOL_GRAY) ? v[c] : prefix;
+        }
+    }
+}
+
+void
+SobolEngine::setScrambling(bool enable, cl_uint seed)
+{
+    scramble = enable;
+    scrambleSeed = seed;
+    seeds.resize(numDimensions);
+    for(cl_uint d = 0; d < numDimensions; d++)
+    {
+        seeds[d] = mixBits(seed + mixBits(d));
+    }
+}
+
+inline cl_uint
+SobolEngine::seek(cl_uint dim, cl_uint index) const
+{
+    cl_uint bits = (order == SOBOL_GRAY) ? index ^ (index >> 1) : index;
+    const cl_uint *v = &directions[dim * N_DIRECTIONS];
+    cl_uint x = 0;
+    for(int c = 0; bits != 0; c++, bits >>= 1)
+    {
+        x ^= (bits & 1) * v[c];
+    }
+    return x;
+}
+
+inline cl_uint
+SobolEngine::output(cl_uint dim, cl_uint x) const
+{
+    return scramble ? owenScramble(x, seeds[dim]) : x;
+}
+
+void
+SobolEngine::generateThread(void *data, unsigned int begin, unsigned int end,
+                            unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const SobolEngine *engine = args->engine;
+    const cl_uint dims = engine->numDimensions;
+    const cl_uint *steps = &engine->steps[0];
+
+    // begin and end count chunks of one dimension, dimension major
+    for(unsigned int w = begin; w < end; w++)
+    {
+        cl_uint d = w / args->numChunks;
+        cl_uint offset = (w % args->numChunks) * args->chunk;
+        cl_uint n = std::min(args->chunk, args->count - offset);
+        cl_uint index = args->first + offset;
+        size_t out = (size_t)d * args->stride + offset;
+
+        cl_uint x = engine->seek(d, index);
+        for(cl_uint i = 0; i < n; i++)
+        {
+            cl_uint y = engine->output(d, x);
+            if(args->floatOutput != NULL)
+            {
+                args->floatOutput[out + i] = (cl_float)(y / 4294967296.0);
+            }
+            else
+            {
+                args->doubleOutput[out + i] = y / 4294967296.0;
+            }
+
+            // The last index of the sequence has no successor
+            if(i + 1 < n)
+            {
+                x ^= steps[lowestBit(index + i + 1) * dims + d];
+            }
+        }
+    }
+}
+
+void
+SobolEngine::streamThread(void *data, unsigned int begin, unsigned int end,
+                          unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const SobolEngine *engine = args->engine;
+    const cl_uint dims = engine->numDimensions;
+
+    std::vector<cl_uint> state(dims);
+    std::vector<cl_double> points(args->chunk * dims);
+    for(unsigned int w = begin; w < end; w++)
+    {
+        cl_uint offset = w * args->chunk;
+        cl_uint n = std::min(args->chunk, args->count - offset);
+        cl_uint index = args->first + offset;
+
+        for(cl_uint d = 0; d < dims; d++)
+        {
+            state[d] = engine->seek(d, index);
+        }
+        for(cl_uint i = 0; i < n; i++)
+        {
+            cl_double *point = &points[i * dims];
+            for(cl_uint d = 0; d < dims; d++)
+            {
+                point[d] = engine->output(d, state[d]) / 4294967296.0;
+            }
+            if(i + 1 < n)
+            {
+                const cl_uint *step = &engine->steps[lowestBit(index + i + 1) * dims];
+                for(cl_uint d = 0; d < dims; d++)
+                {
+                    state[d] ^= step[d];
+                }
+            }
+        }
+        args->consumer(args->data, index, n, &points[0], dims);
+    }
+}
+
+int
+SobolEngine::run(rangeArgs &args, cl_ulong count, bool streaming)
+{
+    if(numDimensions == 0)
+    {
+        error("SobolEngine needs setDimensions() before generating points");
+        return SDK_FAILURE;
+    }
+    if(args.count != 0 && args.first + (args.count - 1) < args.first)
+    {
+        error("SobolEngine supports indices up to 2^32 - 1");
+        return SDK_FAILURE;
+    }
+    if(count > 0xffffffffu)
+    {
+        error("SobolEngine: too many points for one call");
+        return SDK_FAILURE;
+    }
+    if(count == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    unsigned int threads = numThreads ? numThreads : getNumCPUCores();
+    threads = (unsigned int)std::min((cl_ulong)threads, count);
+    args.engine = this;
+    if(!parallelFor(streaming ? streamThread : generateThread, &args, (unsigned int)count,
+                    threads))
+    {
+        error("SobolEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+int
+SobolEngine::generate(cl_uint first, cl_uint count, cl_float *output, cl_uint stride)
+{
+    if(output == NULL || stride < count)
+    {
+        error("SobolEngine::generate() needs an output of stride at least count");
+        return SDK_FAILURE;
+    }
+
+    rangeArgs args;
+    args.first = first;
+    args.count = count;
+    args.chunk = GENERATE_POINTS;
+    args.numChunks = (count + GENERATE_POINTS - 1) / GENERATE_POINTS;
+    args.floatOutput = output;
+    args.doubleOutput = NULL;
+    args.stride = stride;
+    return run(args, (cl_ulong)numDimensions * args.numChunks, false);
+}
+
+int
+SobolEngine::generate(cl_uint first, cl_uint count, cl_double *output, cl_uint stride)
+{
+    if(output == NULL || stride < count)
+    {
+        error("SobolEngine::generate() needs an output of stride at least count");
+        return SDK_FAILURE;
+    }
+
+    rangeArgs args;
+    args.first = first;
+    args.count = count;
+    args.chunk = GENERATE_POINTS;
+    args.numChunks = (count + GENERATE_POINTS - 1) / GENERATE_POINTS;
+    args.floatOutput = NULL;
+    args.doubleOutput = output;
+    args.stride = stride;
+    return run(args, (cl_ulong)numDimensions * args.numChunks, false);
+}
+
+int
+SobolEngine::stream(cl_uint first, cl_uint count, SobolConsumer consumer, void *data)
+{
+    if(consumer == NULL)
+    {
+        error("SobolEngine::stream() needs a consumer");
+        return SDK_FAILURE;
+    }
+
+    rangeArgs args;
+    args.first = first;
+    args.count = count;
+    args.chunk = std::max(STREAM_VALUES / std::max(numDimensions, 1u), 1u);
+    args.numChunks = (count + args.chunk - 1) / args.chunk;
+    args.consumer = consumer;
+    args.data = data;
+    return run(args, args.numChunks, true);
+}
@@ -0,0 +1,161 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef SOBOLENGINE_H_
+#define SOBOLENGINE_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+#define N_DIRECTIONS 32       ///< Number of direction numbers
+
+#define MAX_DIMENSIONS 10200  ///< Maximum number of dimensions
+
+/**
+ * SobolOrder
+ * Order in which SobolEngine enumerates the points
+ */
+enum SobolOrder
+{
+    SOBOL_NATURAL,          /**< Point i is the XOR of the directions of the bits of i, as the kernel */
+    SOBOL_GRAY              /**< Point i is the natural point gray(i) = i ^ (i >> 1) */
+};
+
+/**
+ * Receives a block of points from SobolEngine::stream().
+ * Blocks are delivered from several threads at once and in no given order.
+ * @param data user data passed to stream()
+ * @param first index of the first point of the block
+ * @param count number of points of the block
+ * @param points count points of dims coordinates each, point major
+ * @param dims number of coordinates per point
+ */
+typedef void (*SobolConsumer)(void *data, cl_uint first, cl_uint count,
+                              const cl_double *points, cl_uint dims);
+
+/**
+ * SobolEngine
+ * Class implements a multi-threaded host Sobol generator for up to
+ * MAX_DIMENSIONS dimensions, built on the direction numbers of
+ * sobolPrimitives.
+ *
+ * Moving from point i - 1 to point i flips the bits 0 to c of i, c being
+ * the number of trailing ones of i - 1. Each coordinate is updated with a
+ * single XOR of a precomputed direction, so every value costs O(1) in both
+ * orders. Any index can be reached with at most 32 XORs per dimension,
+ * which lets threads start their chunks anywhere.
+ *
+ * Owen scrambling uses the hash based nested uniform scramble of Laine and
+ * Karras with one seed per dimension. It keeps every (t, m, s)-net
+ * property of the points.
+ */
+class SobolEngine
+{
+        cl_uint numDimensions;          /**< Dimensions of the points */
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+        SobolOrder order;               /**< Enumeration order */
+        bool scramble;                  /**< Apply Owen scrambling */
+        cl_uint scrambleSeed;           /**< Seed of the scrambling seeds */
+        std::vector<cl_uint> directions;    /**< Direction numbers, N_DIRECTIONS per dimension */
+        std::vector<cl_uint> steps;         /**< XOR applied when moving past each bit */
+        std::vector<cl_uint> seeds;         /**< Scrambling seed of each dimension */
+
+        struct rangeArgs;
+        static void generateThread(void *data, unsigned int begin, unsigned int end,
+                                   unsigned int threadId);
+        static void streamThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId);
+        inline cl_uint seek(cl_uint dim, cl_uint index) const;
+        inline cl_uint output(cl_uint dim, cl_uint x) const;
+        int run(rangeArgs &args, cl_ulong count, bool streaming);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        SobolEngine()
+            : numDimensions(0),
+              numThreads(0),
+              order(SOBOL_NATURAL),
+              scramble(false),
+              scrambleSeed(0)
+        {
+        }
+
+        /**
+         * Builds the direction numbers of the first dimensions of sobolPrimitives
+         * @param dims number of dimensions, 1 to MAX_DIMENSIONS
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int setDimensions(cl_uint dims);
+
+        /**
+         * Direction numbers of setDimensions(), N_DIRECTIONS per dimension
+         */
+        const cl_uint *getDirections() const
+        {
+            return directions.empty() ? NULL : &directions[0];
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Sets the enumeration order of the points
+         */
+        void setOrder(SobolOrder newOrder);
+
+        /**
+         * Enables Owen scrambling of the points
+         * @param enable scramble the points
+         * @param seed seed the seeds of the dimensions are derived from
+         */
+        void setScrambling(bool enable, cl_uint seed);
+
+        /**
+         * Writes the points first to first + count - 1, dimension major:
+         * coordinate d of point first + i goes to output[d * stride + i]
+         * @param stride distance between dimensions, at least count
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int generate(cl_uint first, cl_uint count, cl_float *output, cl_uint stride);
+
+        /**
+         * Double precision version of generate()
+         */
+        int generate(cl_uint first, cl_uint count, cl_double *output, cl_uint stride);
+
+        /**
+         * Hands the points first to first + count - 1 to consumer in blocks,
+         * without storing the whole sequence
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int stream(cl_uint first, cl_uint count, SobolConsumer consumer, void *data);
+};
+
+#endif
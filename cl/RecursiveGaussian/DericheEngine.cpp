@@ -0,0 +1,310 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "DericheEngine.hpp"
+#include <emmintrin.h>
+#include <string.h>
+#include <algorithm>
+
+/*
+ * Columns of a strip of the vertical pass
+ */
+#define STRIP_PIXELS 64
+
+/*
+ * Rows filtered together by the horizontal pass
+ */
+#define ROW_BLOCK 4
+
+/**
+ * Arguments of the strip and row threads
+ */
+struct DericheEngine::rangeArgs
+{
+    const DericheEngine *engine;
+    const void *input;
+    void *output;
+    cl_uint width;
+    cl_uint height;
+};
+
+/**
+ * Coefficients broadcast to the four channels
+ */
+struct Coefficients
+{
+    __m128 a0, a1, a2, a3, b1, b2;
+
+    Coefficients(cl_float c0, cl_float c1, cl_float c2, cl_float c3,
+                 cl_float d1, cl_float d2)
+        : a0(_mm_set1_ps(c0)), a1(_mm_set1_ps(c1)),
+          a2(_mm_set1_ps(c2)), a3(_mm_set1_ps(c3)),
+          b1(_mm_set1_ps(d1)), b2(_mm_set1_ps(d2))
+    {
+    }
+};
+
+static inline __m128
+loadPixel(const cl_uchar4 *pixel)
+{
+    int value;
+    memcpy(&value, pixel, sizeof(value));
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(
+                               _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero));
+}
+
+static inline __m128
+loadPixel(const cl_float4 *pixel)
+{
+    return _mm_loadu_ps(pixel->s);
+}
+
+static inline void
+storePixel(__m128 channels, cl_uchar4 *pixel)
+{
+    __m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(channels),
+                                     _mm_cvttps_epi32(channels));
+    int value = _mm_cvtsi128_si32(_mm_packus_epi16(packed, packed));
+    memcpy(pixel, &value, sizeof(value));
+}
+
+static inline void
+storePixel(__m128 channels, cl_float4 *pixel)
+{
+    _mm_storeu_ps(pixel->s, channels);
+}
+
+/*
+ * (c0 x0 + c1 x1 - d1 y1) - d2 y2, in the order of the kernel
+ */
+static inline __m128
+recurse(__m128 c0, __m128 x0, __m128 c1, __m128 x1, const Coefficients &c,
+        __m128 y1, __m128 y2)
+{
+    __m128 sum = _mm_add_ps(_mm_mul_ps(c0, x0), _mm_mul_ps(c1, x1));
+    return _mm_sub_ps(_mm_sub_ps(sum, _mm_mul_ps(c.b1, y1)), _mm_mul_ps(c.b2, y2));
+}
+
+/*
+ * Forward and reverse passes along ROWS rows of width pixels
+ */
+template<int ROWS, typename TIn, typename TOut>
+static void
+filterRows(const TIn *input, TOut *output, cl_uint width, const Coefficients &c)
+{
+    __m128 xp[ROWS], yp[ROWS], yb[ROWS];
+    for(int r = 0; r < ROWS; r++)
+    {
+        xp[r] = yp[r] = yb[r] = _mm_setzero_ps();
+    }
+    for(cl_uint x = 0; x < width; x++)
+    {
+        for(int r = 0; r < ROWS; r++)
+        {
+            __m128 xc = loadPixel(&input[r * width + x]);
+            __m128 yc = recurse(c.a0, xc, c.a1, xp[r], c, yp[r], yb[r]);
+            storePixel(yc, &output[r * width + x]);
+            xp[r] = xc;
+            yb[r] = yp[r];
+            yp[r] = yc;
+        }
+    }
+
+    __m128 xn[ROWS], xa[ROWS], yn[ROWS], ya[ROWS];
+    for(int r = 0; r < ROWS; r++)
+    {
+        xn[r] = xa[r] = yn[r] = ya[r] = _mm_setzero_ps();
+    }
+    for(cl_uint x = width; x-- > 0; )
+    {
+        for(int r = 0; r < ROWS; r++)
+        {
+            __m128 xc = loadPixel(&input[r * width + x]);
+            __m128 yc = recurse(c.a2, xn[r], c.a3, xa[r], c, yn[r], ya[r]);
+            xa[r] = xn[r];
+            xn[r] = xc;
+            ya[r] = yn[r];
+            yn[r] = yc;
+            TOut *pixel = &output[r * width + x];
+            storePixel(_mm_add_ps(loadPixel(pixel), yc), pixel);
+        }
+    }
+}
+
+template<typename TIn, typename TOut>
+void
+DericheEngine::stripThread(void *data, unsigned int begin, unsigned int end,
+                           unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const DericheEngine *eng = args->engine;
+    const Coefficients c(eng->a0, eng->a1, eng->a2, eng->a3, eng->b1, eng->b2);
+    const cl_uint width = args->width;
+    const cl_uint height = args->height;
+
+    // Filter state of every column of the strip
+    __m128 s0[STRIP_PIXELS], s1[STRIP_PIXELS], s2[STRIP_PIXELS], s3[STRIP_PIXELS];
+
+    for(cl_uint s = begin; s < end; s++)
+    {
+        const cl_uint x0 = s * STRIP_PIXELS;
+        const cl_uint n = std::min((cl_uint)STRIP_PIXELS, width - x0);
+        const TIn *input = (const TIn*)args->input + x0;
+        TOut *output = (TOut*)args->output + x0;
+
+        // Forward pass down the rows, s0..s2 are x[n-1], y[n-1], y[n-2]
+        for(cl_uint x = 0; x < n; x++)
+        {
+            s0[x] = s1[x] = s2[x] = _mm_setzero_ps();
+        }
+        for(cl_uint y = 0; y < height; y++)
+        {
+            const TIn *in = input + (size_t)y * width;
+            TOut *out = output + (size_t)y * width;
+            for(cl_uint x = 0; x < n; x++)
+            {
+                __m128 xc = loadPixel(&in[x]);
+                __m128 yc = recurse(c.a0, xc, c.a1, s0[x], c, s1[x], s2[x]);
+                storePixel(yc, &out[x]);
+                s0[x] = xc;
+                s2[x] = s1[x];
+                s1[x] = yc;
+            }
+        }
+
+        // Reverse pass up the rows, s0..s3 are x[n+1], x[n+2], y[n+1], y[n+2]
+        for(cl_uint x = 0; x < n; x++)
+        {
+            s0[x] = s1[x] = s2[x] = s3[x] = _mm_setzero_ps();
+        }
+        for(cl_uint y = height; y-- > 0; )
+        {
+            const TIn *in = input + (size_t)y * width;
+            TOut *out = output + (size_t)y * width;
+            for(cl_uint x = 0; x < n; x++)
+            {
+                __m128 xc = loadPixel(&in[x]);
+                __m128 yc = recurse(c.a2, s0[x], c.a3, s1[x], c, s2[x], s3[x]);
+                s1[x] = s0[x];
+                s0[x] = xc;
+                s3[x] = s2[x];
+                s2[x] = yc;
+                storePixel(_mm_add_ps(loadPixel(&out[x]), yc), &out[x]);
+            }
+        }
+    }
+}
+
+template<typename TIn, typename TOut>
+void
+DericheEngine::rowThread(void *data, unsigned int begin, unsigned int end,
+                         unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const DericheEngine *eng = args->engine;
+    const Coefficients c(eng->a0, eng->a1, eng->a2, eng->a3, eng->b1, eng->b2);
+    const cl_uint width = args->width;
+
+    // begin and end count blocks of ROW_BLOCK rows
+    for(cl_uint b = begin; b < end; b++)
+    {
+        cl_uint y0 = b * ROW_BLOCK;
+        cl_uint rows = std::min((cl_uint)ROW_BLOCK, args->height - y0);
+        const TIn *input = (const TIn*)args->input + (size_t)y0 * width;
+        TOut *output = (TOut*)args->output + (size_t)y0 * width;
+
+        if(rows == ROW_BLOCK)
+        {
+            filterRows<ROW_BLOCK>(input, output, width, c);
+            continue;
+        }
+        for(cl_uint r = 0; r < rows; r++)
+        {
+            filterRows<1>(input + (size_t)r * width, output + (size_t)r * width,
+                          width, c);
+        }
+    }
+}
+
+template<typename TIn, typename TOut>
+int
+DericheEngine::run(const TIn *input, TOut *temp, TOut *output, cl_uint width,
+                   cl_uint height)
+{
+    rangeArgs args;
+    args.engine = this;
+    args.input = input;
+    args.output = temp;
+    args.width = width;
+    args.height = height;
+
+    cl_uint numStrips = (width + STRIP_PIXELS - 1) / STRIP_PIXELS;
+    if(!parallelFor(stripThread<TIn, TOut>, &args, numStrips, numThreads))
+    {
+        error("DericheEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+
+    args.input = temp;
+    args.output = output;
+    cl_uint numBlocks = (height + ROW_BLOCK - 1) / ROW_BLOCK;
+    if(!parallelFor(rowThread<TOut, TOut>, &args, numBlocks, numThreads))
+    {
+        error("DericheEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+void
+DericheEngine::setCoefficients(cl_float a0, cl_float a1, cl_float a2, cl_float a3,
+                               cl_float b1, cl_float b2)
+{
+    this->a0 = a0;
+    this->a1 = a1;
+    this->a2 = a2;
+    this->a3 = a3;
+    this->b1 = b1;
+    this->b2 = b2;
+}
+
+int
+DericheEngine::filter(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                      cl_uint height)
+{
+    if(input == NULL || output == NULL || width == 0 || height == 0)
+    {
+        error("DericheEngine::filter() needs an input and an output image");
+        return SDK_FAILURE;
+    }
+    temp.resize((size_t)width * height);
+    return run(input, &temp[0], output, width, height);
+}
+
+int
+DericheEngine::filterFloat(const cl_uchar4 *input, cl_float4 *output, cl_uint width,
+                           cl_uint height)
+{
+    if(input == NULL || output == NULL || width == 0 || height == 0)
+    {
+        error("DericheEngine::filterFloat() needs an input and an output image");
+        return SDK_FAILURE;
+    }
+    floatTemp.resize((size_t)width * height);
+    return run(input, &floatTemp[0], output, width, height);
+}
@@ -0,0 +1,110 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef DERICHEENGINE_H_
+#define DERICHEENGINE_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * DericheEngine
+ * Class implements a multi-threaded host recursive (IIR) Gaussian filter
+ * of a uchar4 image with the coefficients of RecursiveGaussian_kernel.
+ *
+ * The vertical pass walks the rows of a strip of columns, keeping the
+ * filter state of every column of the strip, so the recursion of each
+ * column runs in its own SSE2 lanes while memory is read row by row. The
+ * horizontal pass filters four rows at once, which hides the latency of
+ * the recursion. Neither pass transposes the image.
+ */
+class DericheEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+        cl_float a0, a1, a2, a3;        /**< Feed-forward coefficients */
+        cl_float b1, b2;                /**< Feedback coefficients */
+        std::vector<cl_uchar4> temp;    /**< Vertical pass of filter() */
+        std::vector<cl_float4> floatTemp;   /**< Vertical pass of filterFloat() */
+
+        struct rangeArgs;
+        template<typename TIn, typename TOut>
+        static void stripThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId);
+        template<typename TIn, typename TOut>
+        static void rowThread(void *data, unsigned int begin, unsigned int end,
+                              unsigned int threadId);
+        template<typename TIn, typename TOut>
+        int run(const TIn *input, TOut *temp, TOut *output, cl_uint width,
+                cl_uint height);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        DericheEngine()
+            : numThreads(0),
+              a0(0), a1(0), a2(0), a3(0),
+              b1(0), b2(0)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Sets the coefficients of the forward pass
+         * y[n] = a0 x[n] + a1 x[n-1] - b1 y[n-1] - b2 y[n-2] and of the
+         * reverse pass y[n] = a2 x[n+1] + a3 x[n+2] - b1 y[n+1] - b2 y[n+2]
+         */
+        void setCoefficients(cl_float a0, cl_float a1, cl_float a2, cl_float a3,
+                             cl_float b1, cl_float b2);
+
+        /**
+         * Filters the columns then the rows of an image like the
+         * RecursiveGaussian_kernel and transpose_kernel sequence: every
+         * pass converts to uchar with truncation, saturating outside
+         * [0, 255]
+         * @param input input pixels, width * height
+         * @param output output pixels, width * height
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int filter(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                   cl_uint height);
+
+        /**
+         * Filters the columns then the rows of an image in float without
+         * rounding, so derivative orders keep their sign
+         * @param input input pixels, width * height
+         * @param output output pixels, width * height
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int filterFloat(const cl_uchar4 *input, cl_float4 *output, cl_uint width,
+                        cl_uint height);
+};
+
+#endif
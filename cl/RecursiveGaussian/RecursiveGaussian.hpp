@@ -24,6 +24,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <string.h>
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
+#include "DericheEngine.hpp"
 
 using namespace appsdk;
 
@@ -98,6 +99,13 @@ class RecursiveGaussian
 
         SDKTimer *sampleTimer;      /**< SDKTimer object */
 
+        cl_float sigma;                     /**< Sigma of the filter */
+        int order;                          /**< Order of the filter, 0 to 2 */
+        DericheEngine engine;               /**< Host recursive Gaussian */
+        std::vector<cl_float4> hostFloatOutput; /**< Float output of the host filter */
+        int cpuThreads;                     /**< Host threads, 0 uses every core */
+        cl_double hostTime;                 /**< Time of the host filter */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -124,31 +132,6 @@ class RecursiveGaussian
         */
         void computeGaussParms(float fSigma, int iOrder, GaussParms* pGP);
 
-        /**
-        * RecursiveGaussian on CPU (for verification)
-        * @param input input image
-        * @param output output image
-        * @param width width of image
-        * @param height height of image
-        * @param a0..a3, b1, b2, coefp, coefn gaussian parameters
-        */
-        void recursiveGaussianCPU(cl_uchar4* input, cl_uchar4* output,
-                                  const int width, const int height,
-                                  const float a0, const float a1,
-                                  const float a2, const float a3,
-                                  const float b1, const float b2,
-                                  const float coefp, const float coefn);
-
-        /**
-        * Transpose on CPU (for verification)
-        * @param input input image
-        * @param output output image
-        * @param width width of input image
-        * @param height height of input image
-        */
-        void transposeCPU(cl_uchar4* input, cl_uchar4* output,
-                          const int width, const int height);
-
         /**
         * Constructor
         * Initialize member variables
@@ -167,6 +150,10 @@ class RecursiveGaussian
             blockSizeY = 1;
             blockSize = 1;
             iterations = 1;
+            sigma = 10.0f;
+            order = 0;
+            cpuThreads = 0;
+            hostTime = 0;
         }
 
         ~RecursiveGaussian()
@@ -203,11 +190,14 @@ class RecursiveGaussian
         int runCLKernels();
 
         /**
-        * Reference CPU implementation of Binomial Option
-        * for performance comparison
+        * Reference CPU implementation of the recursive Gaussian, runs the
+        * host filter into verificationOutput and the float filter into
+        * hostFloatOutput. Only the host filter, which the kernels are
+        * checked against, is timed. Order 0 checks the float filter
+        * against it.
         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
-        void recursiveGaussianCPUReference();
+        int recursiveGaussianCPUReference();
 
         /**
         * Override from SDKSample. Print sample stats.
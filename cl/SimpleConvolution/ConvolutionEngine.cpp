@@ -0,0 +1,425 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "ConvolutionEngine.hpp"
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+/*
+ * Output columns of a strip. The input rows a strip reads for maskHeight
+ * consecutive output rows stay in the L2 cache.
+ */
+#define STRIP_WIDTH 1024
+
+/*
+ * Largest error of the rank-1 factorization, relative to the largest weight
+ */
+#define SEPARABLE_TOLERANCE 1e-5f
+
+/**
+ * Arguments of the convolution threads
+ */
+struct ConvolutionEngine::rangeArgs
+{
+    ConvolutionEngine *engine;
+    const cl_uint *inputUint;       /**< Input of convolve(cl_uint), or NULL */
+    const cl_float *inputFloat;     /**< Input of convolve(cl_float), or NULL */
+    cl_uint *outputUint;
+    cl_float *outputFloat;
+    cl_uint width;
+    cl_uint height;
+    cl_uint paddedWidth;            /**< width + 2 * vstep */
+};
+
+/*
+ * dst[x] = sum of src[t][x] * weight[t] over the taps, in tap order, for
+ * x in [begin, end)
+ */
+static void
+convolveTaps(const cl_float *const *src, const cl_float *weight, size_t numTaps,
+             cl_uint begin, cl_uint end, cl_float *dst)
+{
+    cl_uint x = begin;
+    for(; x + 16 <= end; x += 16)
+    {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        __m128 acc2 = _mm_setzero_ps();
+        __m128 acc3 = _mm_setzero_ps();
+        for(size_t t = 0; t < numTaps; t++)
+        {
+            const cl_float *p = src[t] + x;
+            __m128 w = _mm_set1_ps(weight[t]);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(p), w));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(p + 4), w));
+            acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(p + 8), w));
+            acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(p + 12), w));
+        }
+        _mm_storeu_ps(dst + x, acc0);
+        _mm_storeu_ps(dst + x + 4, acc1);
+        _mm_storeu_ps(dst + x + 8, acc2);
+        _mm_storeu_ps(dst + x + 12, acc3);
+    }
+
+    for(; x + 4 <= end; x += 4)
+    {
+        __m128 acc = _mm_setzero_ps();
+        for(size_t t = 0; t < numTaps; t++)
+        {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(src[t] + x),
+                                             _mm_set1_ps(weight[t])));
+        }
+        _mm_storeu_ps(dst + x, acc);
+    }
+
+    for(; x < end; x++)
+    {
+        cl_float sum = 0;
+        for(size_t t = 0; t < numTaps; t++)
+        {
+            sum += src[t][x] * weight[t];
+        }
+        dst[x] = sum;
+    }
+}
+
+/*
+ * Rounds like the kernel, sumFX + 0.5f converted to uint
+ */
+static void
+roundRow(const cl_float *row, cl_uint begin, cl_uint end, cl_uint *output)
+{
+    for(cl_uint x = begin; x < end; x++)
+    {
+        cl_float v = row[x] + 0.5f;
+        output[x] = v > 0 ? (cl_uint)v : 0;
+    }
+}
+
+int
+ConvolutionEngine::setMask(const cl_float *mask, cl_uint maskWidth,
+                           cl_uint maskHeight)
+{
+    hasMask = false;
+    if(mask == NULL || maskWidth == 0 || maskHeight == 0 ||
+            maskWidth > MAX_MASK_SIZE || maskHeight > MAX_MASK_SIZE)
+    {
+        error("ConvolutionEngine::setMask() needs a mask of 1 to 31 by 1 to 31");
+        return SDK_FAILURE;
+    }
+
+    vstep = (maskWidth - 1) / 2;
+    hstep = (maskHeight - 1) / 2;
+    const cl_uint columns = 2 * vstep + 1;
+    const cl_uint rows = 2 * hstep + 1;
+
+    // Nonzero taps in the order the kernel sums them
+    tapColumn.clear();
+    tapRow.clear();
+    tapWeight.clear();
+    cl_uint pivotRow = 0;
+    cl_uint pivotColumn = 0;
+    cl_float maxWeight = 0;
+    for(cl_uint i = 0; i < columns; i++)
+    {
+        for(cl_uint j = 0; j < rows; j++)
+        {
+            cl_float w = mask[j * maskWidth + i];
+            if(w != 0)
+            {
+                tapColumn.push_back(i);
+                tapRow.push_back(j);
+                tapWeight.push_back(w);
+            }
+            if(fabs(w) > maxWeight)
+            {
+                maxWeight = fabs(w);
+                pivotRow = j;
+                pivotColumn = i;
+            }
+        }
+    }
+
+    // Rank-1 test against the row and column through the largest weight
+    separable = maxWeight > 0;
+    rowFilter.resize(columns);
+    columnFilter.resize(rows);
+    cl_float pivot = mask[pivotRow * maskWidth + pivotColumn];
+    for(cl_uint i = 0; i < columns && separable; i++)
+    {
+        rowFilter[i] = mask[pivotRow * maskWidth + i] / pivot;
+    }
+    for(cl_uint j = 0; j < rows && separable; j++)
+    {
+        columnFilter[j] = mask[j * maskWidth + pivotColumn];
+        for(cl_uint i = 0; i < columns && separable; i++)
+        {
+            cl_float product = columnFilter[j] * rowFilter[i];
+            separable = fabs(mask[j * maskWidth + i] - product) <=
+                        SEPARABLE_TOLERANCE * maxWeight;
+        }
+    }
+
+    // Two passes only pay when they need fewer taps
+    if(separable)
+    {
+        size_t passTaps = 0;
+        for(cl_uint i = 0; i < columns; i++)
+        {
+            passTaps += rowFilter[i] != 0;
+        }
+        for(cl_uint j = 0; j < rows; j++)
+        {
+            passTaps += columnFilter[j] != 0;
+        }
+        separable = passTaps < tapWeight.size();
+    }
+
+    hasMask = true;
+    return SDK_SUCCESS;
+}
+
+void
+ConvolutionEngine::padThread(void *data, unsigned int begin, unsigned int end,
+                             unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    ConvolutionEngine *engine = args->engine;
+    const cl_uint width = args->width;
+    const cl_uint vstep = engine->vstep;
+
+    for(cl_uint y = begin; y < end; y++)
+    {
+        cl_float *dst = &engine->padded[0] + (size_t)y * args->paddedWidth;
+        std::fill(dst, dst + vstep, 0.0f);
+        if(args->inputUint)
+        {
+            const cl_uint *src = args->inputUint + (size_t)y * width;
+            for(cl_uint x = 0; x < width; x++)
+            {
+                dst[vstep + x] = (cl_float)src[x];
+            }
+        }
+        else
+        {
+            const cl_float *src = args->inputFloat + (size_t)y * width;
+            std::copy(src, src + width, dst + vstep);
+        }
+        std::fill(dst + vstep + width, dst + args->paddedWidth, 0.0f);
+    }
+}
+
+void
+ConvolutionEngine::convolveThread(void *data, unsigned int begin, unsigned int end,
+                                  unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const ConvolutionEngine *engine = args->engine;
+    const cl_uint width = args->width;
+    const cl_uint hstep = engine->hstep;
+    const size_t numTaps = engine->tapWeight.size();
+
+    std::vector<const cl_float*> src(numTaps + 1);
+    std::vector<cl_float> weight(numTaps + 1);
+    std::vector<cl_float> row(args->outputFloat ? 0 : width);
+
+    for(cl_uint xs = 0; xs < width; xs += STRIP_WIDTH)
+    {
+        cl_uint xe = std::min(width, xs + STRIP_WIDTH);
+        for(cl_uint y = begin; y < end; y++)
+        {
+            // Taps on rows outside the image are dropped, as in the kernel
+            size_t count = 0;
+            for(size_t t = 0; t < numTaps; t++)
+            {
+                cl_uint j = engine->tapRow[t];
+                if(y + j >= hstep && y + j - hstep < args->height)
+                {
+                    src[count] = &engine->padded[0] +
+                                 (size_t)(y + j - hstep) * args->paddedWidth +
+                                 engine->tapColumn[t];
+                    weight[count] = engine->tapWeight[t];
+                    count++;
+                }
+            }
+
+            if(args->outputFloat)
+            {
+                convolveTaps(&src[0], &weight[0], count, xs, xe,
+                             args->outputFloat + (size_t)y * width);
+            }
+            else
+            {
+                convolveTaps(&src[0], &weight[0], count, xs, xe, &row[0]);
+                roundRow(&row[0], xs, xe, args->outputUint + (size_t)y * width);
+            }
+        }
+    }
+}
+
+void
+ConvolutionEngine::rowThread(void *data, unsigned int begin, unsigned int end,
+                             unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    ConvolutionEngine *engine = args->engine;
+    const cl_uint width = args->width;
+    const cl_uint columns = (cl_uint)engine->rowFilter.size();
+
+    std::vector<const cl_float*> src(columns);
+    std::vector<cl_float> weight(columns);
+
+    for(cl_uint y = begin; y < end; y++)
+    {
+        const cl_float *in = &engine->padded[0] + (size_t)y * args->paddedWidth;
+        size_t count = 0;
+        for(cl_uint i = 0; i < columns; i++)
+        {
+            if(engine->rowFilter[i] != 0)
+            {
+                src[count] = in + i;
+                weight[count] = engine->rowFilter[i];
+                count++;
+            }
+        }
+        convolveTaps(&src[0], &weight[0], count, 0, width,
+                     &engine->rowPass[0] + (size_t)y * width);
+    }
+}
+
+void
+ConvolutionEngine::columnThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const ConvolutionEngine *engine = args->engine;
+    const cl_uint width = args->width;
+    const cl_uint hstep = engine->hstep;
+    const cl_uint rows = (cl_uint)engine->columnFilter.size();
+
+    std::vector<const cl_float*> src(rows);
+    std::vector<cl_float> weight(rows);
+    std::vector<cl_float> row(args->outputFloat ? 0 : width);
+
+    for(cl_uint xs = 0; xs < width; xs += STRIP_WIDTH)
+    {
+        cl_uint xe = std::min(width, xs + STRIP_WIDTH);
+        for(cl_uint y = begin; y < end; y++)
+        {
+            size_t count = 0;
+            for(cl_uint j = 0; j < rows; j++)
+            {
+                if(engine->columnFilter[j] != 0 && y + j >= hstep &&
+                        y + j - hstep < args->height)
+                {
+                    src[count] = &engine->rowPass[0] + (size_t)(y + j - hstep) * width;
+                    weight[count] = engine->columnFilter[j];
+                    count++;
+                }
+            }
+
+            if(args->outputFloat)
+            {
+                convolveTaps(&src[0], &weight[0], count, xs, xe,
+                             args->outputFloat + (size_t)y * width);
+            }
+            else
+            {
+                convolveTaps(&src[0], &weight[0], count, xs, xe, &row[0]);
+                roundRow(&row[0], xs, xe, args->outputUint + (size_t)y * width);
+            }
+        }
+    }
+}
+
+int
+ConvolutionEngine::run(rangeArgs &args)
+{
+    if(!hasMask)
+    {
+        error("ConvolutionEngine::convolve() needs a mask from setMask()");
+        return SDK_FAILURE;
+    }
+    if(args.width == 0 || args.height == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    args.engine = this;
+    args.paddedWidth = args.width + 2 * vstep;
+    padded.resize((size_t)args.paddedWidth * args.height);
+
+    bool created = parallelFor(padThread, &args, args.height, numThreads);
+    if(separable && allowSeparable)
+    {
+        rowPass.resize((size_t)args.width * args.height);
+        created = parallelFor(rowThread, &args, args.height, numThreads) && created;
+        created = parallelFor(columnThread, &args, args.height, numThreads) && created;
+    }
+    else
+    {
+        created = parallelFor(convolveThread, &args, args.height, numThreads) && created;
+    }
+
+    if(!created)
+    {
+        error("ConvolutionEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+int
+ConvolutionEngine::convolve(const cl_uint *input, cl_uint *output, cl_uint width,
+                            cl_uint height)
+{
+    if(input == NULL || output == NULL)
+    {
+        error("ConvolutionEngine::convolve() needs input and output pixels");
+        return SDK_FAILURE;
+    }
+
+    rangeArgs args;
+    args.inputUint = input;
+    args.inputFloat = NULL;
+    args.outputUint = output;
+    args.outputFloat = NULL;
+    args.width = width;
+    args.height = height;
+    return run(args);
+}
+
+int
+ConvolutionEngine::convolve(const cl_float *input, cl_float *output, cl_uint width,
+                            cl_uint height)
+{
+    if(input == NULL || output == NULL)
+    {
+        error("ConvolutionEngine::convolve() needs input and output pixels");
+        return SDK_FAILURE;
+    }
+
+    rangeArgs args;
+    args.inputUint = NULL;
+    args.inputFloat = input;
+    args.outputUint = NULL;
+    args.outputFloat = output;
+    args.width = width;
+    args.height = height;
+    return run(args);
+}
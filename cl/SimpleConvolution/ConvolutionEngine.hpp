@@ -0,0 +1,141 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef CONVOLUTIONENGINE_H_
+#define CONVOLUTIONENGINE_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+#define MAX_MASK_SIZE 31      ///< Largest mask width and height
+
+/**
+ * ConvolutionEngine
+ * Class implements a multi-threaded SSE host version of the
+ * simpleConvolution kernel.
+ *
+ * Input rows are copied once into a float image with zero borders, so the
+ * inner loops never test the image bounds. Each output row is computed in
+ * column strips that keep the input rows it reads in cache, sixteen
+ * pixels at a time with one broadcast weight per nonzero tap. The taps are
+ * summed column by column like the kernel, which makes the result of a
+ * full mask bit-exact with the device.
+ *
+ * A rank-1 mask is split into a row and a column filter and applied in two
+ * 1D passes, width + height taps per pixel instead of width * height. The
+ * split changes the rounding, so outputs may differ from the kernel by
+ * one.
+ */
+class ConvolutionEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+        bool hasMask;                   /**< setMask() succeeded */
+        bool allowSeparable;            /**< Use the two pass path of rank-1 masks */
+        bool separable;                 /**< The mask is rank-1 */
+        cl_uint vstep;                  /**< Taps left and right of a pixel */
+        cl_uint hstep;                  /**< Taps above and below a pixel */
+        std::vector<cl_uint> tapColumn;     /**< Column of each nonzero tap, column major */
+        std::vector<cl_uint> tapRow;        /**< Row of each nonzero tap */
+        std::vector<cl_float> tapWeight;    /**< Weight of each nonzero tap */
+        std::vector<cl_float> rowFilter;    /**< Horizontal factor of a rank-1 mask */
+        std::vector<cl_float> columnFilter; /**< Vertical factor of a rank-1 mask */
+        std::vector<cl_float> padded;       /**< Input with vstep zeros on both sides */
+        std::vector<cl_float> rowPass;      /**< Output of the horizontal pass */
+
+        struct rangeArgs;
+        static void padThread(void *data, unsigned int begin, unsigned int end,
+                              unsigned int threadId);
+        static void convolveThread(void *data, unsigned int begin, unsigned int end,
+                                   unsigned int threadId);
+        static void rowThread(void *data, unsigned int begin, unsigned int end,
+                              unsigned int threadId);
+        static void columnThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId);
+        int run(rangeArgs &args);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        ConvolutionEngine()
+            : numThreads(0),
+              hasMask(false),
+              allowSeparable(true),
+              separable(false),
+              vstep(0),
+              hstep(0)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Enables the two pass path of rank-1 masks
+         */
+        void setSeparable(bool enable)
+        {
+            allowSeparable = enable;
+        }
+
+        /**
+         * Sets the mask. As in the kernel, a mask of even size ignores its
+         * last column or row.
+         * @param mask weights, row major
+         * @param maskWidth width of the mask, 1 to MAX_MASK_SIZE
+         * @param maskHeight height of the mask, 1 to MAX_MASK_SIZE
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int setMask(const cl_float *mask, cl_uint maskWidth, cl_uint maskHeight);
+
+        /**
+         * True if the mask of setMask() was found to be rank-1
+         */
+        bool isSeparable() const
+        {
+            return separable;
+        }
+
+        /**
+         * Convolves an image like the kernel, rounding to the nearest integer
+         * @param input input pixels, width * height
+         * @param output output pixels, width * height
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int convolve(const cl_uint *input, cl_uint *output, cl_uint width,
+                     cl_uint height);
+
+        /**
+         * Convolves a float image, without rounding
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int convolve(const cl_float *input, cl_float *output, cl_uint width,
+                     cl_uint height);
+};
+
+#endif
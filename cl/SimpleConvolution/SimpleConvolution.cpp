@@ -49,18 +49,47 @@ int SimpleConvolution::setupSimpleConvolution()
         mask[i] = 0;
     }
 
-    cl_float val = 1.0f / (maskWidth * 2.0f - 1.0f);
-
-    for(cl_uint i = 0; i < maskWidth; i++)
+    if(separableMask)
     {
-        cl_uint y = maskHeight / 2;
-        mask[y * maskWidth + i] = val;
+        // Binomial approximation of a Gaussian, the product of two 1D filters
+        std::vector<cl_float> rowFilter(maskWidth, 1.0f);
+        std::vector<cl_float> columnFilter(maskHeight, 1.0f);
+        cl_float rowSum = 1.0f;
+        cl_float columnSum = 1.0f;
+        for(cl_uint i = 1; i < maskWidth; i++)
+        {
+            rowFilter[i] = rowFilter[i - 1] * (maskWidth - i) / i;
+            rowSum += rowFilter[i];
+        }
+        for(cl_uint j = 1; j < maskHeight; j++)
+        {
+            columnFilter[j] = columnFilter[j - 1] * (maskHeight - j) / j;
+            columnSum += columnFilter[j];
+        }
+        for(cl_uint j = 0; j < maskHeight; j++)
+        {
+            for(cl_uint i = 0; i < maskWidth; i++)
+            {
+                mask[j * maskWidth + i] = (columnFilter[j] / columnSum) *
+                                          (rowFilter[i] / rowSum);
+            }
+        }
     }
-
-    for(cl_uint i = 0; i < maskHeight; i++)
+    else
     {
-        cl_uint x = maskWidth / 2;
-        mask[i * maskWidth + x] = val;
+        cl_float val = 1.0f / (maskWidth * 2.0f - 1.0f);
+
+        for(cl_uint i = 0; i < maskWidth; i++)
+        {
+            cl_uint y = maskHeight / 2;
+            mask[y * maskWidth + i] = val;
+        }
+
+        for(cl_uint i = 0; i < maskHeight; i++)
+        {
+            cl_uint x = maskWidth / 2;
+            mask[i * maskWidth + x] = val;
+        }
     }
 
     // Unless quiet mode has been enabled, print the INPUT array.
@@ -336,7 +365,7 @@ SimpleConvolution::runCLKernels(void)
  * Reference CPU implementation of Simple Convolution
  * for performance comparison
  */
-void
+int
 SimpleConvolution::simpleConvolutionCPUReference(cl_uint  *output,
         const cl_uint  *input,
         const cl_float *mask,
@@ -345,44 +374,22 @@ SimpleConvolution::simpleConvolutionCPUReference(cl_uint  *output,
         const cl_uint maskWidth,
         const cl_uint maskHeight)
 {
-    cl_uint vstep = (maskWidth  - 1) / 2;
-    cl_uint hstep = (maskHeight - 1) / 2;
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
 
-    // for each pixel in the input
-    for(cl_uint x = 0; x < width; x++)
-        for(cl_uint y = 0; y < height; y++)
-        {
-            /*
-             * find the left, right, top and bottom indices such that
-             * the indices do not go beyond image boundaires
-             */
-            cl_uint left    = (x           <  vstep) ? 0         : (x - vstep);
-            cl_uint right   = ((x + vstep) >= width) ? width - 1 : (x + vstep);
-            cl_uint top     = (y           <  hstep) ? 0         : (y - hstep);
-            cl_uint bottom  = ((y + hstep) >= height)? height - 1: (y + hstep);
-
-            /*
-             * initializing wighted sum value
-             */
-            cl_float sumFX = 0;
-
-            for(cl_uint i = left; i <= right; ++i)
-                for(cl_uint j = top ; j <= bottom; ++j)
-                {
-                    /*
-                     * performing wighted sum within the mask boundaries
-                     */
-                    cl_uint maskIndex = (j - (y - hstep)) * maskWidth  + (i - (x - vstep));
-                    cl_uint index     = j                 * width      + i;
-
-                    /*
-                     * to round to the nearest integer
-                     */
-                    sumFX += ((float)input[index] * mask[maskIndex]);
-                }
-            sumFX += 0.5f;
-            output[y*width + x] = cl_uint(sumFX);
-        }
+    int status = engine.setMask(mask, maskWidth, maskHeight);
+    CHECK_ERROR(status, SDK_SUCCESS, "ConvolutionEngine::setMask() failed");
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    status = engine.convolve(input, output, width, height);
+    CHECK_ERROR(status, SDK_SUCCESS, "ConvolutionEngine::convolve() failed");
+
+    sampleTimer->stopTimer(timer);
+    hostTime = (double)(sampleTimer->readTimer(timer));
+
+    return SDK_SUCCESS;
 }
 
 int SimpleConvolution::initialize()
@@ -442,6 +449,32 @@ int SimpleConvolution::initialize()
     sampleArgs->AddOption(num_iterations);
     delete num_iterations;
 
+    Option* num_threads = new Option;
+    CHECK_ALLOCATION(num_threads, "Memory allocation error.\n");
+
+    num_threads->_sVersion = "";
+    num_threads->_lVersion = "threads";
+    num_threads->_description =
+        "Number of host threads of the host engine (0 uses every core)";
+    num_threads->_type = CA_ARG_INT;
+    num_threads->_value = &cpuThreads;
+
+    sampleArgs->AddOption(num_threads);
+    delete num_threads;
+
+    Option* separable_option = new Option;
+    CHECK_ALLOCATION(separable_option, "Memory allocation error.\n");
+
+    separable_option->_sVersion = "";
+    separable_option->_lVersion = "separable";
+    separable_option->_description =
+        "Use a separable Gaussian mask instead of the cross";
+    separable_option->_type = CA_NO_ARGUMENT;
+    separable_option->_value = &separableMask;
+
+    sampleArgs->AddOption(separable_option);
+    delete separable_option;
+
     return SDK_SUCCESS;
 }
 
@@ -467,6 +500,12 @@ int SimpleConvolution::setup()
         maskHeight++;
     }
 
+    if(maskWidth > MAX_MASK_SIZE)
+    {
+        std::cout << "Mask size should be at most " << MAX_MASK_SIZE << std::endl;
+        return SDK_FAILURE;
+    }
+
     if (setupSimpleConvolution() != SDK_SUCCESS)
     {
         return SDK_FAILURE;
@@ -533,11 +572,29 @@ int SimpleConvolution::verifyResults()
         cl_uint2 inputDimensions = {width    , height};
         cl_uint2 maskDimensions  = {maskWidth, maskHeight};
 
-        simpleConvolutionCPUReference(verificationOutput, input, mask, width, height,
-                                      maskWidth, maskHeight);
+        if(simpleConvolutionCPUReference(verificationOutput, input, mask, width, height,
+                                         maskWidth, maskHeight) != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+
+        // The two passes of a rank-1 mask round differently than the kernel
+        bool match = true;
+        if(engine.isSeparable())
+        {
+            for(cl_int i = 0; i < width * height && match; i++)
+            {
+                match = output[i] + 1 >= verificationOutput[i] &&
+                        verificationOutput[i] + 1 >= output[i];
+            }
+        }
+        else
+        {
+            match = memcmp(output, verificationOutput, height*width*sizeof(cl_uint )) == 0;
+        }
 
         // compare the results and see if they match
-        if(memcmp(output, verificationOutput, height*width*sizeof(cl_uint )) == 0)
+        if(match)
         {
             std::cout<<"Passed!\n" << std::endl;
             return SDK_SUCCESS;
@@ -568,6 +625,16 @@ void SimpleConvolution::printStats()
         stats[4]  = toString(totalKernelTime, std::dec);
 
         printStatistics(strArray, stats, 5);
+
+        if(hostTime > 0)
+        {
+            std::string hostStrArray[3] = {"Host Time(sec)", "Host MPixels/sec", "Host Separable"};
+            std::string hostStats[3];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(width * height / hostTime * 1e-6, std::dec);
+            hostStats[2] = engine.isSeparable() ? "Yes" : "No";
+            printStatistics(hostStrArray, hostStats, 3);
+        }
     }
 }
 
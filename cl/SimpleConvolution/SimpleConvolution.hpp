@@ -26,6 +26,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <assert.h>
 #include <string.h>
 #include "CLUtil.hpp"
+#include "ConvolutionEngine.hpp"
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -68,6 +69,11 @@ class SimpleConvolution
 
         SDKTimer *sampleTimer;      /**< SDKTimer object */
 
+        ConvolutionEngine engine;        /**< Host version of the kernel */
+        int          cpuThreads;         /**< Host threads, 0 uses every core */
+        bool         separableMask;      /**< Use a Gaussian mask instead of the cross */
+        cl_double    hostTime;           /**< Time of the host engine */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -91,6 +97,9 @@ class SimpleConvolution
             setupTime = 0;
             totalKernelTime = 0;
             iterations = 1;
+            cpuThreads = 0;
+            separableMask = false;
+            hostTime = 0;
         }
 
         /**
@@ -124,14 +133,15 @@ class SimpleConvolution
 
         /**
          * Reference CPU implementation of Simple Convolution
-         * for performance comparison
+         * for performance comparison, runs the host engine
          * @param output Output matrix after performing convolution
          * @param input  Input  matrix on which convolution is to be performed
          * @param mask   mask matrix using which convolution was to be performed
          * @param inputDimensions dimensions of the input matrix
          * @param maskDimensions  dimensions of the mask matrix
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
          */
-        void simpleConvolutionCPUReference(
+        int simpleConvolutionCPUReference(
             cl_uint  *output,
             const cl_uint  *input,
             const cl_float  *mask,
@@ -17,6 +17,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "SobelFilter.hpp"
 #include <cmath>
+#include <algorithm>
 
 
 int
@@ -372,6 +373,32 @@ SobelFilter::initialize()
 
     delete iteration_option;
 
+    Option* num_threads = new Option;
+    CHECK_ALLOCATION(num_threads, "Memory Allocation error.\n");
+
+    num_threads->_sVersion = "";
+    num_threads->_lVersion = "threads";
+    num_threads->_description =
+        "Number of host threads of the host Sobel operator (0 uses every core)";
+    num_threads->_type = CA_ARG_INT;
+    num_threads->_value = &cpuThreads;
+
+    sampleArgs->AddOption(num_threads);
+    delete num_threads;
+
+    Option* edge_option = new Option;
+    CHECK_ALLOCATION(edge_option, "Memory Allocation error.\n");
+
+    edge_option->_sVersion = "";
+    edge_option->_lVersion = "edges";
+    edge_option->_description =
+        "Gradient length of host edges written to " EDGE_IMAGE " (0 skips them)";
+    edge_option->_type = CA_ARG_INT;
+    edge_option->_value = &edgeThreshold;
+
+    sampleArgs->AddOption(edge_option);
+    delete edge_option;
+
     return SDK_SUCCESS;
 }
 
@@ -492,78 +519,67 @@ SobelFilter::cleanup()
 }
 
 
-void
+int
 SobelFilter::sobelFilterCPUReference()
 {
-    // x-axis gradient mask
-    const int kx[][3] =
-    {
-        { 1, 2, 1},
-        { 0, 0, 0},
-        { -1,-2,-1}
-    };
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
 
-    // y-axis gradient mask
-    const int ky[][3] =
-    {
-        { 1, 0, -1},
-        { 2, 0, -2},
-        { 1, 0, -1}
-    };
-
-    int gx = 0;
-    int gy = 0;
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
 
-    // pointer to input image data
-    cl_uchar *ptr = (cl_uchar*)malloc(width * height * pixelSize);
-    memcpy(ptr, inputImageData, width * height * pixelSize);
+    // The buffer kernel keeps the low byte of lengths above 255
+    int status = engine.filter(inputImageData, (cl_uchar4*)verificationOutput,
+                               width, height, false);
+    CHECK_ERROR(status, SDK_SUCCESS, "SDKSobel::filter() failed");
 
-    // each pixel has 4 uchar components
-    int w = width * 4;
+    sampleTimer->stopTimer(timer);
+    hostTime = (double)(sampleTimer->readTimer(timer));
+    return SDK_SUCCESS;
+}
 
-    int k = 1;
 
-    // apply filter on each pixel (except boundary pixels)
-    for(int i = 0; i < (int)(w * (height - 1)) ; i++)
+int
+SobelFilter::runHostEdges()
+{
+    if(edgeThreshold <= 0)
     {
-        if(i < (k+1)*w - 4 && i >= 4 + k*w)
-        {
-            gx =  kx[0][0] **(ptr + i - 4 - w)
-                  + kx[0][1] **(ptr + i - w)
-                  + kx[0][2] **(ptr + i + 4 - w)
-                  + kx[1][0] **(ptr + i - 4)
-                  + kx[1][1] **(ptr + i)
-                  + kx[1][2] **(ptr + i + 4)
-                  + kx[2][0] **(ptr + i - 4 + w)
-                  + kx[2][1] **(ptr + i + w)
-                  + kx[2][2] **(ptr + i + 4 + w);
-
-
-            gy =  ky[0][0] **(ptr + i - 4 - w)
-                  + ky[0][1] **(ptr + i - w)
-                  + ky[0][2] **(ptr + i + 4 - w)
-                  + ky[1][0] **(ptr + i - 4)
-                  + ky[1][1] **(ptr + i)
-                  + ky[1][2] **(ptr + i + 4)
-                  + ky[2][0] **(ptr + i - 4 + w)
-                  + ky[2][1] **(ptr + i + w)
-                  + ky[2][2] **(ptr + i + 4 + w);
-
-            float gx2 = pow((float)gx, 2);
-            float gy2 = pow((float)gy, 2);
-
-
-            *(verificationOutput + i) = (cl_uchar)(sqrt(gx2 + gy2) / 2.0);
-        }
+        return SDK_SUCCESS;
+    }
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
 
-        // if reached at the end of its row then incr k
-        if(i == (k + 1) * w - 5)
-        {
-            k++;
-        }
+    cl_uchar *edges = (cl_uchar*)malloc(width * height);
+    CHECK_ALLOCATION(edges, "Failed to allocate memory! (edges)");
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    int status = engine.detect(inputImageData, width, height, NULL, NULL, edges,
+                               (cl_ushort)std::min(edgeThreshold, 0xffff));
+    if(status != SDK_SUCCESS)
+    {
+        FREE(edges);
+        error("SDKSobel::detect() failed");
+        return SDK_FAILURE;
     }
 
-    free(ptr);
+    sampleTimer->stopTimer(timer);
+    edgeTime = (double)(sampleTimer->readTimer(timer));
+
+    // write the edges through the input bitmap
+    for(cl_uint i = 0; i < width * height; i++)
+    {
+        pixelData[i].x = pixelData[i].y = pixelData[i].z = edges[i];
+        pixelData[i].w = 255;
+    }
+    FREE(edges);
+    if(!inputBitmap.write(EDGE_IMAGE))
+    {
+        std::cout << "Failed to write edge image!";
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
 }
 
 
@@ -578,7 +594,10 @@ SobelFilter::verifyResults()
     if(sampleArgs->verify)
     {
         // reference implementation
-        sobelFilterCPUReference();
+        if(sobelFilterCPUReference() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
 
         float *outputDevice = new float[width * height * pixelSize];
         CHECK_ALLOCATION(outputDevice,
@@ -647,6 +666,16 @@ SobelFilter::printStats()
         stats[3] = toString(kernelTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        if(hostTime > 0 || edgeTime > 0)
+        {
+            std::string hostStrArray[3] = {"Host Time(sec)", "Host MPixels/sec", "Host Edge Time(sec)"};
+            std::string hostStats[3];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(hostTime > 0 ? width * height / hostTime * 1e-6 : 0, std::dec);
+            hostStats[2] = toString(edgeTime, std::dec);
+            printStatistics(hostStrArray, hostStats, 3);
+        }
     }
 }
 
@@ -688,6 +717,11 @@ main(int argc, char * argv[])
         return SDK_FAILURE;
     }
 
+    if(clSobelFilter.runHostEdges() != SDK_SUCCESS)
+    {
+        return SDK_FAILURE;
+    }
+
     if(clSobelFilter.cleanup() != SDK_SUCCESS)
     {
         return SDK_FAILURE;
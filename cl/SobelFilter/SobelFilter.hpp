@@ -23,6 +23,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <string.h>
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
+#include "SDKSobel.hpp"
 
 using namespace appsdk;
 
@@ -30,6 +31,7 @@ using namespace appsdk;
 
 #define INPUT_IMAGE "SobelFilter_Input.bmp"
 #define OUTPUT_IMAGE "SobelFilter_Output.bmp"
+#define EDGE_IMAGE "SobelFilter_Edges.bmp"
 
 #define GROUP_SIZE 256
 
@@ -69,6 +71,12 @@ class SobelFilter
 
         SDKTimer    *sampleTimer;      /**< SDKTimer object */
 
+        SDKSobel engine;               /**< Host SSE2 Sobel operator */
+        int cpuThreads;                /**< Host threads, 0 uses every core */
+        int edgeThreshold;             /**< Gradient length of a host edge, 0 skips them */
+        cl_double hostTime;            /**< Time of the host filter */
+        cl_double edgeTime;            /**< Time of the host edge detection */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -105,6 +113,10 @@ class SobelFilter
             blockSizeX = GROUP_SIZE;
             blockSizeY = 1;
             iterations = 1;
+            cpuThreads = 0;
+            edgeThreshold = 0;
+            hostTime = 0;
+            edgeTime = 0;
         }
 
         ~SobelFilter()
@@ -134,10 +146,18 @@ class SobelFilter
         int runCLKernels();
 
         /**
-        * Reference CPU implementation of Binomial Option
-        * for performance comparison
+        * Reference CPU implementation of the Sobel filter, runs the host
+        * SSE2 operator into verificationOutput
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        */
+        int sobelFilterCPUReference();
+
+        /**
+        * Detects edges of the input image on the host when --edges is
+        * given and writes them to EDGE_IMAGE
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
-        void sobelFilterCPUReference();
+        int runHostEdges();
 
         /**
         * Override from SDKSample. Print sample stats.
@@ -0,0 +1,620 @@
+/**********************************************************************
+Copyright ©2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+• Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+• Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "MultiPatternSearch.hpp"
+#include <algorithm>
+#include <ctype.h>
+#include <emmintrin.h>
+
+#define NO_STATE 0xFFFFFFFF
+
+/*
+ * Orders matches by offset, then by pattern id
+ */
+static bool matchLess(const PatternMatch &a, const PatternMatch &b)
+{
+    return (a.offset < b.offset) ||
+           (a.offset == b.offset && a.patternId < b.patternId);
+}
+
+/*
+ * Returns the index of the lowest set bit of a non-zero mask
+ */
+static inline cl_uint lowestBit(int mask)
+{
+    cl_uint index = 0;
+    while(!(mask & 1))
+    {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+}
+
+int
+MultiPatternSearch::build(const std::vector<std::string> &patternList,
+                          bool sensitive)
+{
+    if(patternList.empty())
+    {
+        error("MultiPatternSearch needs at least one pattern");
+        return SDK_FAILURE;
+    }
+
+    patterns = patternList;
+    caseSensitive = sensitive;
+    maxPatternLength = 0;
+
+    for(size_t i = 0; i < patterns.size(); i++)
+    {
+        if(patterns[i].empty())
+        {
+            error("MultiPatternSearch does not accept empty patterns");
+            return SDK_FAILURE;
+        }
+        maxPatternLength = std::max(maxPatternLength, (cl_uint)patterns[i].length());
+    }
+
+    /*
+     * Case folding and alphabet reduction are resolved once here:
+     * every byte maps to the class of its folded value, and bytes that do
+     * not occur in any pattern share class 0.
+     */
+    cl_uint foldedClass[256];
+    for(int c = 0; c < 256; c++)
+    {
+        fold[c] = (cl_uchar)(caseSensitive ? c : toupper(c));
+        foldedClass[c] = 0;
+    }
+
+    numClasses = 1;
+    for(size_t i = 0; i < patterns.size(); i++)
+    {
+        for(size_t j = 0; j < patterns[i].length(); j++)
+        {
+            cl_uchar f = fold[(cl_uchar)patterns[i][j]];
+            if(foldedClass[f] == 0)
+            {
+                foldedClass[f] = numClasses++;
+            }
+        }
+    }
+
+    for(int c = 0; c < 256; c++)
+    {
+        byteClass[c] = (cl_uchar)foldedClass[fold[c]];
+    }
+
+    // Build the trie, state 0 is the root
+    std::vector<std::vector<cl_uint> > ownOutputs(1);
+    transitions.assign(numClasses, NO_STATE);
+    numStates = 1;
+
+    for(size_t i = 0; i < patterns.size(); i++)
+    {
+        cl_uint state = 0;
+        for(size_t j = 0; j < patterns[i].length(); j++)
+        {
+            cl_uint cls = byteClass[(cl_uchar)patterns[i][j]];
+            if(transitions[state * numClasses + cls] == NO_STATE)
+            {
+                transitions[state * numClasses + cls] = numStates++;
+                transitions.resize(numStates * numClasses, NO_STATE);
+                ownOutputs.resize(numStates);
+            }
+            state = transitions[state * numClasses + cls];
+        }
+        ownOutputs[state].push_back((cl_uint)i);
+    }
+
+    /*
+     * Breadth first pass computing failure links and completing the
+     * transitions of every state with the ones of its failure state.
+     */
+    std::vector<cl_uint> failure(numStates, 0);
+    std::vector<cl_uint> order;
+    order.reserve(numStates);
+    order.push_back(0);
+
+    for(cl_uint cls = 0; cls < numClasses; cls++)
+    {
+        cl_uint next = transitions[cls];
+        if(next == NO_STATE)
+        {
+            transitions[cls] = 0;
+        }
+        else
+        {
+            failure[next] = 0;
+            order.push_back(next);
+        }
+    }
+
+    for(size_t head = 1; head < order.size(); head++)
+    {
+        cl_uint state = order[head];
+        for(cl_uint cls = 0; cls < numClasses; cls++)
+        {
+            cl_uint next = transitions[state * numClasses + cls];
+            cl_uint fallback = transitions[failure[state] * numClasses + cls];
+            if(next == NO_STATE)
+            {
+                transitions[state * numClasses + cls] = fallback;
+            }
+            else
+            {
+                failure[next] = fallback;
+                order.push_back(next);
+            }
+        }
+    }
+
+    // Every state also reports the outputs of its failure chain
+    std::vector<std::vector<cl_uint> > allOutputs(numStates);
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        cl_uint state = order[i];
+        allOutputs[state] = ownOutputs[state];
+        if(state != 0)
+        {
+            const std::vector<cl_uint> &inherited = allOutputs[failure[state]];
+            allOutputs[state].insert(allOutputs[state].end(),
+                                     inherited.begin(), inherited.end());
+        }
+    }
+
+    outputStart.assign(numStates + 1, 0);
+    outputs.clear();
+    for(cl_uint state = 0; state < numStates; state++)
+    {
+        outputStart[state] = (cl_uint)outputs.size();
+        outputs.insert(outputs.end(), allOutputs[state].begin(),
+                       allOutputs[state].end());
+    }
+    outputStart[numStates] = (cl_uint)outputs.size();
+
+    // Bytes leaving the root drive the SIMD skip loop
+    numRootBytes = 0;
+    for(int c = 0; c < 256; c++)
+    {
+        if(transitions[byteClass[c]] != 0)
+        {
+            if(numRootBytes == MAX_ROOT_BYTES)
+            {
+                numRootBytes = 0;
+                break;
+            }
+            rootBytes[numRootBytes++] = (cl_uchar)c;
+        }
+    }
+
+    return SDK_SUCCESS;
+}
+
+cl_uint
+MultiPatternSearch::skipRoot(const cl_uchar *text, cl_uint pos,
+                             cl_uint end) const
+{
+    __m128i candidates[MAX_ROOT_BYTES];
+    for(cl_uint k = 0; k < numRootBytes; k++)
+    {
+        candidates[k] = _mm_set1_epi8((char)rootBytes[k]);
+    }
+
+    while(pos + 16 <= end)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(text + pos));
+        __m128i hits = _mm_cmpeq_epi8(block, candidates[0]);
+        for(cl_uint k = 1; k < numRootBytes; k++)
+        {
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, candidates[k]));
+        }
+
+        int mask = _mm_movemask_epi8(hits);
+        if(mask != 0)
+        {
+            return pos + lowestBit(mask);
+        }
+        pos += 16;
+    }
+
+    while(pos < end && transitions[byteClass[text[pos]]] == 0)
+    {
+        pos++;
+    }
+    return pos;
+}
+
+void
+MultiPatternSearch::reportMatches(cl_uint state, cl_uint pos, cl_uint begin,
+                                  cl_uint end,
+                                  std::vector<PatternMatch> &matches) const
+{
+    for(cl_uint o = outputStart[state]; o < outputStart[state + 1]; o++)
+    {
+        PatternMatch match;
+        match.patternId = outputs[o];
+        match.offset = pos + 1 - (cl_uint)patterns[match.patternId].length();
+        if(match.offset >= begin && match.offset < end)
+        {
+            matches.push_back(match);
+        }
+    }
+}
+
+void
+MultiPatternSearch::searchAhoCorasick(const cl_uchar *text, cl_uint begin,
+                                      cl_uint end, cl_uint scanEnd,
+                                      std::vector<PatternMatch> &matches) const
+{
+    size_t first = matches.size();
+    const cl_uint *next = &transitions[0];
+
+    if(numRootBytes > 0 || end - begin < SEARCH_LANES * maxPatternLength)
+    {
+        cl_uint state = 0;
+        for(cl_uint pos = begin; pos < scanEnd; pos++)
+        {
+            if(state == 0 && numRootBytes > 0)
+            {
+                pos = skipRoot(text, pos, scanEnd);
+                if(pos == scanEnd)
+                {
+                    break;
+                }
+            }
+
+            state = next[state * numClasses + byteClass[text[pos]]];
+            if(outputStart[state] != outputStart[state + 1])
+            {
+                reportMatches(state, pos, begin, end, matches);
+            }
+        }
+    }
+    else
+    {
+        /*
+         * Every DFA step depends on the previous one, so a single scan is
+         * bound by load latency. Walking SEARCH_LANES independent parts of
+         * the range in lockstep keeps several loads in flight.
+         */
+        cl_uint laneBegin[SEARCH_LANES];
+        cl_uint laneEnd[SEARCH_LANES];
+        cl_uint laneScanEnd[SEARCH_LANES];
+        cl_uint state[SEARCH_LANES];
+        cl_uint steps = scanEnd - begin;
+
+        for(int l = 0; l < SEARCH_LANES; l++)
+        {
+            laneBegin[l] = begin + (cl_uint)(((cl_ulong)(end - begin) * l) / SEARCH_LANES);
+            laneEnd[l] = begin + (cl_uint)(((cl_ulong)(end - begin) * (l + 1)) / SEARCH_LANES);
+            laneScanEnd[l] = (l == SEARCH_LANES - 1) ? scanEnd :
+                             std::min(laneEnd[l] + maxPatternLength - 1, scanEnd);
+            state[l] = 0;
+            steps = std::min(steps, laneScanEnd[l] - laneBegin[l]);
+        }
+
+        for(cl_uint step = 0; step < steps; step++)
+        {
+            for(int l = 0; l < SEARCH_LANES; l++)
+            {
+                cl_uint pos = laneBegin[l] + step;
+                state[l] = next[state[l] * numClasses + byteClass[text[pos]]];
+                if(outputStart[state[l]] != outputStart[state[l] + 1])
+                {
+                    reportMatches(state[l], pos, laneBegin[l], laneEnd[l], matches);
+                }
+            }
+        }
+
+        for(int l = 0; l < SEARCH_LANES; l++)
+        {
+            for(cl_uint pos = laneBegin[l] + steps; pos < laneScanEnd[l]; pos++)
+            {
+                state[l] = next[state[l] * numClasses + byteClass[text[pos]]];
+                if(outputStart[state[l]] != outputStart[state[l] + 1])
+                {
+                    reportMatches(state[l], pos, laneBegin[l], laneEnd[l], matches);
+                }
+            }
+        }
+    }
+
+    std::sort(matches.begin() + first, matches.end(), matchLess);
+}
+
+void
+MultiPatternSearch::searchSinglePattern(const cl_uchar *text,
+                                        cl_uint textLength,
+                                        cl_uint begin, cl_uint end,
+                                        std::vector<PatternMatch> &matches) const
+{
+    const std::string &pattern = patterns[0];
+    cl_uint length = (cl_uint)pattern.length();
+    if(textLength < length)
+    {
+        return;
+    }
+
+    cl_uint lastStart = std::min(end, textLength - length + 1);
+
+    std::vector<cl_uchar> foldedPattern(length);
+    for(cl_uint k = 0; k < length; k++)
+    {
+        foldedPattern[k] = fold[(cl_uchar)pattern[k]];
+    }
+
+    /*
+     * Without case sensitivity, setting bit 0x20 maps both cases of a
+     * letter to the same value. Other bytes may alias, which only adds
+     * candidates that the full comparison below rejects.
+     */
+    cl_uchar firstByte = (cl_uchar)pattern[0];
+    cl_uchar lastByte = (cl_uchar)pattern[length - 1];
+    cl_uchar firstCase = (!caseSensitive && isalpha(firstByte)) ? 0x20 : 0;
+    cl_uchar lastCase = (!caseSensitive && isalpha(lastByte)) ? 0x20 : 0;
+
+    __m128i firstMask = _mm_set1_epi8((char)firstCase);
+    __m128i lastMask = _mm_set1_epi8((char)lastCase);
+    __m128i firstVec = _mm_set1_epi8((char)(firstByte | firstCase));
+    __m128i lastVec = _mm_set1_epi8((char)(lastByte | lastCase));
+
+    cl_uint pos = begin;
+    for(; pos < lastStart && (cl_ulong)pos + length - 1 + 16 <= textLength; pos += 16)
+    {
+        __m128i blockFirst = _mm_loadu_si128((const __m128i*)(text + pos));
+        __m128i blockLast = _mm_loadu_si128((const __m128i*)(text + pos + length - 1));
+
+        __m128i hits = _mm_and_si128(
+                           _mm_cmpeq_epi8(_mm_or_si128(blockFirst, firstMask), firstVec),
+                           _mm_cmpeq_epi8(_mm_or_si128(blockLast, lastMask), lastVec));
+
+        int mask = _mm_movemask_epi8(hits);
+        while(mask != 0)
+        {
+            cl_uint candidate = pos + lowestBit(mask);
+            mask &= mask - 1;
+            if(candidate >= lastStart)
+            {
+                break;
+            }
+
+            cl_uint k = 0;
+            while(k < length && fold[text[candidate + k]] == foldedPattern[k])
+            {
+                k++;
+            }
+            if(k == length)
+            {
+                PatternMatch match;
+                match.patternId = 0;
+                match.offset = candidate;
+                matches.push_back(match);
+            }
+        }
+    }
+
+    for(; pos < lastStart; pos++)
+    {
+        cl_uint k = 0;
+        while(k < length && fold[text[pos + k]] == foldedPattern[k])
+        {
+            k++;
+        }
+        if(k == length)
+        {
+            PatternMatch match;
+            match.patternId = 0;
+            match.offset = pos;
+            matches.push_back(match);
+        }
+    }
+}
+
+void
+MultiPatternSearch::searchRange(const cl_uchar *text, cl_uint textLength,
+                                cl_uint begin, cl_uint end,
+                                std::vector<PatternMatch> &matches) const
+{
+    if(patterns.size() == 1)
+    {
+        searchSinglePattern(text, textLength, begin, end, matches);
+    }
+    else
+    {
+        // Matches starting before end may run up to maxPatternLength - 1 bytes past it
+        cl_ulong scanEnd = (cl_ulong)end + maxPatternLength - 1;
+        searchAhoCorasick(text, begin, end,
+                          (cl_uint)std::min(scanEnd, (cl_ulong)textLength), matches);
+    }
+}
+
+/**
+ * Arguments of the multi-pattern search threads
+ */
+struct patternSearchArgs
+{
+    const MultiPatternSearch *search;
+    const cl_uchar *text;
+    cl_uint textLength;
+    std::vector<PatternMatch> *threadMatches;
+};
+
+static void patternSearchThread(void *data, unsigned int begin,
+                                unsigned int end, unsigned int threadId)
+{
+    patternSearchArgs *args = (patternSearchArgs*)data;
+    args->search->searchRange(args->text, args->textLength, begin, end,
+                              args->threadMatches[threadId]);
+}
+
+int
+MultiPatternSearch::search(const cl_uchar *text, cl_uint textLength,
+                           std::vector<PatternMatch> &matches,
+                           unsigned int numThreads) const
+{
+    if(numStates == 0)
+    {
+        error("MultiPatternSearch::build() must be called before searching");
+        return SDK_FAILURE;
+    }
+
+    matches.clear();
+    if(textLength == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    if(numThreads == 0)
+    {
+        numThreads = getNumCPUCores();
+    }
+    numThreads = std::min(numThreads, textLength);
+
+    std::vector<std::vector<PatternMatch> > threadMatches(numThreads);
+
+    patternSearchArgs args;
+    args.search = this;
+    args.text = text;
+    args.textLength = textLength;
+    args.threadMatches = &threadMatches[0];
+
+    if(!parallelFor(patternSearchThread, &args, textLength, numThreads))
+    {
+        error("Failed to create host threads for the pattern search");
+        return SDK_FAILURE;
+    }
+
+    // Thread ranges are consecutive, so concatenation keeps the global order
+    size_t total = 0;
+    for(unsigned int i = 0; i < numThreads; i++)
+    {
+        total += threadMatches[i].size();
+    }
+    matches.reserve(total);
+    for(unsigned int i = 0; i < numThreads; i++)
+    {
+        matches.insert(matches.end(), threadMatches[i].begin(),
+                       threadMatches[i].end());
+    }
+
+    return SDK_SUCCESS;
+}
+
+/**
+ * Arguments of the streaming search threads
+ */
+struct streamSearchArgs
+{
+    const MultiPatternSearch *search;
+    const cl_uchar *text;
+    cl_ulong textLength;
+    cl_uint chunkSize;
+    std::vector<PatternMatch> *threadMatches;
+};
+
+static void streamSearchThread(void *data, unsigned int begin,
+                               unsigned int end, unsigned int threadId)
+{
+    streamSearchArgs *args = (streamSearchArgs*)data;
+    std::vector<PatternMatch> &matches = args->threadMatches[threadId];
+    cl_uint overlap = args->search->getMaxPatternLength() - 1;
+
+    // Every thread owns a contiguous run of chunks and walks it in order
+    for(unsigned int chunk = begin; chunk < end; chunk++)
+    {
+        cl_ulong base = (cl_ulong)chunk * args->chunkSize;
+        cl_ulong remaining = args->textLength - base;
+        cl_uint chunkLength = (cl_uint)std::min((cl_ulong)args->chunkSize, remaining);
+        cl_uint window = (cl_uint)std::min((cl_ulong)chunkLength + overlap, remaining);
+
+        size_t first = matches.size();
+        args->search->searchRange(args->text + base, window, 0, chunkLength,
+                                  matches);
+        for(size_t i = first; i < matches.size(); i++)
+        {
+            matches[i].offset += base;
+        }
+    }
+}
+
+int
+MultiPatternSearch::searchStream(const cl_uchar *text, cl_ulong textLength,
+                                 cl_uint chunkSize,
+                                 std::vector<PatternMatch> &matches,
+                                 unsigned int numThreads) const
+{
+    if(numStates == 0)
+    {
+        error("MultiPatternSearch::build() must be called before searching");
+        return SDK_FAILURE;
+    }
+
+    if(chunkSize == 0 || chunkSize > 0xFFFFFFFF - maxPatternLength)
+    {
+        error("MultiPatternSearch::searchStream() got an invalid chunk size");
+        return SDK_FAILURE;
+    }
+
+    matches.clear();
+    if(textLength == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    cl_ulong numChunks = (textLength + chunkSize - 1) / chunkSize;
+    if(numChunks > 0xFFFFFFFF)
+    {
+        error("MultiPatternSearch::searchStream() needs a larger chunk size");
+        return SDK_FAILURE;
+    }
+
+    if(numThreads == 0)
+    {
+        numThreads = getNumCPUCores();
+    }
+    numThreads = (unsigned int)std::min((cl_ulong)numThreads, numChunks);
+
+    std::vector<std::vector<PatternMatch> > threadMatches(numThreads);
+
+    streamSearchArgs args;
+    args.search = this;
+    args.text = text;
+    args.textLength = textLength;
+    args.chunkSize = chunkSize;
+    args.threadMatches = &threadMatches[0];
+
+    if(!parallelFor(streamSearchThread, &args, (unsigned int)numChunks, numThreads))
+    {
+        error("Failed to create host threads for the streaming search");
+        return SDK_FAILURE;
+    }
+
+    size_t total = 0;
+    for(unsigned int i = 0; i < numThreads; i++)
+    {
+        total += threadMatches[i].size();
+    }
+    matches.reserve(total);
+    for(unsigned int i = 0; i < numThreads; i++)
+    {
+        matches.insert(matches.end(), threadMatches[i].begin(),
+                       threadMatches[i].end());
+    }
+
+    return SDK_SUCCESS;
+}
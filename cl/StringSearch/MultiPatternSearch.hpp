@@ -0,0 +1,190 @@
+/**********************************************************************
+Copyright ©2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+• Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+• Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef MULTIPATTERNSEARCH_H_
+#define MULTIPATTERNSEARCH_H_
+
+#include <CL/cl.h>
+#include <string>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * Number of independent scans interleaved by one thread
+ */
+#define SEARCH_LANES 4
+
+/**
+ * The SIMD skip over the root state is used up to this many distinct bytes
+ */
+#define MAX_ROOT_BYTES 4
+
+/**
+ * PatternMatch
+ * One occurrence of a pattern in the searched text
+ */
+struct PatternMatch
+{
+    cl_uint patternId;      /**< Index of the pattern in the pattern list */
+    cl_ulong offset;        /**< Offset of the first byte of the match */
+};
+
+/**
+ * MultiPatternSearch
+ * Class implements a host search of many patterns in a single pass.
+ * The patterns are compiled into an Aho-Corasick DFA whose input alphabet is
+ * reduced to the byte classes used by the patterns. Case folding is done
+ * once while building the byte class table, so the case-insensitive scan
+ * costs the same as the case-sensitive one.
+ * A single pattern is searched with an SSE2 filter that compares the first
+ * and last pattern byte against 16 text positions at once and only verifies
+ * the candidate positions.
+ */
+class MultiPatternSearch
+{
+        std::vector<std::string> patterns;  /**< Pattern list */
+        bool caseSensitive;                 /**< Case sensitive matching */
+        cl_uint maxPatternLength;           /**< Length of the longest pattern */
+
+        cl_uchar fold[256];                 /**< Byte after case folding */
+        cl_uchar byteClass[256];            /**< Input class of every byte */
+        cl_uint numClasses;                 /**< Number of input classes */
+        cl_uint numStates;                  /**< Number of DFA states */
+
+        std::vector<cl_uint> transitions;   /**< numStates x numClasses next states */
+        std::vector<cl_uint> outputStart;   /**< First output of every state */
+        std::vector<cl_uint> outputs;       /**< Pattern ids matched in every state */
+
+        cl_uchar rootBytes[MAX_ROOT_BYTES]; /**< Bytes that leave the root state */
+        cl_uint numRootBytes;               /**< Number of rootBytes, 0 if too many */
+
+        /**
+         * Finds the next position in [pos, end) whose byte leaves the root state
+         * @return the position or end if there is none
+         */
+        cl_uint skipRoot(const cl_uchar *text, cl_uint pos, cl_uint end) const;
+
+        /**
+         * Appends the matches of a state reached at pos that start in [begin, end)
+         */
+        void reportMatches(cl_uint state, cl_uint pos, cl_uint begin, cl_uint end,
+                           std::vector<PatternMatch> &matches) const;
+
+        /**
+         * Aho-Corasick scan of text[begin...scanEnd) reporting the matches
+         * that start in [begin, end)
+         */
+        void searchAhoCorasick(const cl_uchar *text, cl_uint begin, cl_uint end,
+                               cl_uint scanEnd, std::vector<PatternMatch> &matches) const;
+
+        /**
+         * SSE2 first/last byte filtered scan of the single pattern
+         * reporting the matches that start in [begin, end)
+         */
+        void searchSinglePattern(const cl_uchar *text, cl_uint textLength,
+                                 cl_uint begin, cl_uint end,
+                                 std::vector<PatternMatch> &matches) const;
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        MultiPatternSearch()
+            : caseSensitive(true),
+              maxPatternLength(0),
+              numClasses(0),
+              numStates(0),
+              numRootBytes(0)
+        {
+        }
+
+        /**
+         * Compiles the pattern list
+         * @param patternList non-empty patterns to search
+         * @param sensitive true for case sensitive matching
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int build(const std::vector<std::string> &patternList, bool sensitive);
+
+        /**
+         * Searches all patterns in text
+         * @param text text to search
+         * @param textLength length of the text in bytes
+         * @param matches all matches ordered by offset, then pattern id
+         * @param numThreads number of host threads, 0 uses every core
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int search(const cl_uchar *text, cl_uint textLength,
+                   std::vector<PatternMatch> &matches,
+                   unsigned int numThreads = 0) const;
+
+        /**
+         * Searches all patterns in a text of any size, e.g. a mapped file.
+         * The text is cut into chunks of chunkSize bytes that are searched
+         * concurrently. Each chunk also scans the first maxPatternLength - 1
+         * bytes of the next one, so matches crossing a chunk boundary are
+         * reported once, by the chunk they start in.
+         * @param text text to search
+         * @param textLength length of the text in bytes
+         * @param chunkSize bytes per chunk
+         * @param matches all matches ordered by offset, then pattern id
+         * @param numThreads number of host threads, 0 uses every core
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int searchStream(const cl_uchar *text, cl_ulong textLength,
+                         cl_uint chunkSize, std::vector<PatternMatch> &matches,
+                         unsigned int numThreads = 0) const;
+
+        /**
+         * Searches the matches starting in [begin, end) on the calling thread.
+         * Matches are appended to the vector ordered by offset, then pattern id.
+         */
+        void searchRange(const cl_uchar *text, cl_uint textLength,
+                         cl_uint begin, cl_uint end,
+                         std::vector<PatternMatch> &matches) const;
+
+        /**
+         * @return number of compiled patterns
+         */
+        cl_uint getNumPatterns() const
+        {
+            return (cl_uint)patterns.size();
+        }
+
+        /**
+         * @return length of the longest compiled pattern
+         */
+        cl_uint getMaxPatternLength() const
+        {
+            return maxPatternLength;
+        }
+
+        /**
+         * @return number of states of the compiled DFA
+         */
+        cl_uint getNumStates() const
+        {
+            return numStates;
+        }
+};
+
+#endif
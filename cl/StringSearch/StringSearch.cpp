@@ -75,6 +75,57 @@ int StringSearch::initialize()
     sampleArgs->AddOption(case_option);
     delete case_option;
 
+    Option* pattern_option = new Option;
+    CHECK_ALLOCATION(pattern_option, "Memory allocation error.\n");
+
+    pattern_option->_sVersion = "";
+    pattern_option->_lVersion = "patterns";
+    pattern_option->_description =
+        "File with one pattern per line for the host multi-pattern search";
+    pattern_option->_type = CA_ARG_STRING;
+    pattern_option->_value = &patternFile;
+
+    sampleArgs->AddOption(pattern_option);
+    delete pattern_option;
+
+    Option* thread_option = new Option;
+    CHECK_ALLOCATION(thread_option, "Memory allocation error.\n");
+
+    thread_option->_sVersion = "";
+    thread_option->_lVersion = "threads";
+    thread_option->_description =
+        "Host threads of the multi-pattern search (0 uses every core)";
+    thread_option->_type = CA_ARG_INT;
+    thread_option->_value = &cpuThreads;
+
+    sampleArgs->AddOption(thread_option);
+    delete thread_option;
+
+    Option* stream_option = new Option;
+    CHECK_ALLOCATION(stream_option, "Memory allocation error.\n");
+
+    stream_option->_sVersion = "";
+    stream_option->_lVersion = "stream";
+    stream_option->_description =
+        "Map the file and search it chunk by chunk instead of loading it";
+    stream_option->_type = CA_NO_ARGUMENT;
+    stream_option->_value = &streamMode;
+
+    sampleArgs->AddOption(stream_option);
+    delete stream_option;
+
+    Option* chunk_option = new Option;
+    CHECK_ALLOCATION(chunk_option, "Memory allocation error.\n");
+
+    chunk_option->_sVersion = "";
+    chunk_option->_lVersion = "chunk";
+    chunk_option->_description = "Chunk size in MB of the streaming search";
+    chunk_option->_type = CA_ARG_INT;
+    chunk_option->_value = &chunkMB;
+
+    sampleArgs->AddOption(chunk_option);
+    delete chunk_option;
+
     return SDK_SUCCESS;
 }
 
@@ -102,6 +153,11 @@ int StringSearch::setupStringSearch()
         return SDK_FAILURE;
     }
 
+    if(streamMode)
+    {
+        return setupStreamSearch();
+    }
+
     // Read the content of the file
     std::ifstream textFile(file.c_str(),
                            std::ios::in|std::ios::binary|std::ios::ate);
@@ -142,6 +198,109 @@ int StringSearch::setupStringSearch()
         std::cout << "Search Pattern : " << subStr << std::endl;
     }
 
+    if(patternFile.length() != 0)
+    {
+        return setupMultiPatternSearch();
+    }
+
+    return SDK_SUCCESS;
+}
+
+int StringSearch::setupStreamSearch()
+{
+    if(subStr.length() == 0)
+    {
+        std::cout << "\nError: Sub-String not specified..." << std::endl;
+        return SDK_FAILURE;
+    }
+
+    if(!mappedFile.open(file.c_str()))
+    {
+        std::cout << "\n Unable to map file: " << file << std::endl;
+        return SDK_FAILURE;
+    }
+    fileLength = mappedFile.size();
+
+    if (fileLength < subStr.length())
+    {
+        std::cout << "\nText size less than search pattern (" << fileLength
+                  << " < " << subStr.length() << ")" << std::endl;
+        return SDK_FAILURE;
+    }
+
+    if(chunkMB < 1 || chunkMB > 1024)
+    {
+        std::cout << "\nChunk size must be between 1 and 1024 MB, using 16 MB"
+                  << std::endl;
+        chunkMB = 16;
+    }
+    chunkSize = (cl_uint)chunkMB << 20;
+
+    /*
+     * The device holds one chunk plus the bytes a match starting at its end
+     * may need from the next one. The whole file is never copied.
+     */
+    textLength = (cl_uint)std::min(fileLength,
+                                   (cl_ulong)chunkSize + subStr.length() - 1);
+
+    if(!sampleArgs->quiet)
+    {
+        std::cout << "Search Pattern : " << subStr << std::endl;
+        std::cout << "Streaming " << fileLength << " bytes in chunks of "
+                  << chunkSize << " bytes" << std::endl;
+    }
+
+    // The host streaming search uses the pattern file or the sub string
+    if(patternFile.length() != 0)
+    {
+        return setupMultiPatternSearch();
+    }
+
+    patterns.push_back(subStr);
+    int status = multiSearch.build(patterns, caseSensitive);
+    CHECK_ERROR(status, SDK_SUCCESS, "Failed to compile the search pattern");
+
+    return SDK_SUCCESS;
+}
+
+int StringSearch::setupMultiPatternSearch()
+{
+    std::ifstream listFile(patternFile.c_str(), std::ios::in|std::ios::binary);
+    if(! listFile.is_open())
+    {
+        std::cout << "\n Unable to open file: " << patternFile << std::endl;
+        return SDK_FAILURE;
+    }
+
+    std::string line;
+    while(std::getline(listFile, line))
+    {
+        if(line.length() != 0 && line[line.length() - 1] == '\r')
+        {
+            line.erase(line.length() - 1);
+        }
+        if(line.length() != 0)
+        {
+            patterns.push_back(line);
+        }
+    }
+    listFile.close();
+
+    if(patterns.empty())
+    {
+        std::cout << "\nError: No pattern found in " << patternFile << std::endl;
+        return SDK_FAILURE;
+    }
+
+    int status = multiSearch.build(patterns, caseSensitive);
+    CHECK_ERROR(status, SDK_SUCCESS, "Failed to compile the pattern list");
+
+    if(!sampleArgs->quiet)
+    {
+        std::cout << "Host search patterns : " << patterns.size()
+                  << " (" << multiSearch.getNumStates() << " DFA states)" << std::endl;
+    }
+
     return SDK_SUCCESS;
 }
 
@@ -292,12 +451,15 @@ int StringSearch::setupCL()
     CHECK_OPENCL_ERROR(status, "clCreateKernel(StringSearchNaive) failed.");
 
     cl_uchar *ptr;
-    // Move text data host to device
-    status = mapBuffer( textBuf, ptr, textLength, CL_MAP_WRITE_INVALIDATE_REGION);
-    CHECK_ERROR(status, SDK_SUCCESS, "Failed to map device buffer.(textBuf)");
-    memcpy(ptr, text, textLength);
-    status = unmapBuffer(textBuf, ptr);
-    CHECK_ERROR(status, SDK_SUCCESS, "Failed to unmap device buffer.(inputBuffer)");
+    // Move text data host to device, streaming moves it chunk by chunk
+    if(!streamMode)
+    {
+        status = mapBuffer( textBuf, ptr, textLength, CL_MAP_WRITE_INVALIDATE_REGION);
+        CHECK_ERROR(status, SDK_SUCCESS, "Failed to map device buffer.(textBuf)");
+        memcpy(ptr, text, textLength);
+        status = unmapBuffer(textBuf, ptr);
+        CHECK_ERROR(status, SDK_SUCCESS, "Failed to unmap device buffer.(inputBuffer)");
+    }
 
     // Move subStr data host to device
     status = mapBuffer( subStrBuf, ptr, subStr.length(),
@@ -444,6 +606,11 @@ int StringSearch::runKernel(std::string kernelName)
 
 int StringSearch::run()
 {
+    if(streamMode)
+    {
+        return runStreamSearch();
+    }
+
     kernelType = KERNEL_NAIVE;
     kernel = &kernelNaive;
 
@@ -477,17 +644,275 @@ int StringSearch::run()
             return SDK_FAILURE;
         }
     }
+
+    if(!patterns.empty())
+    {
+        if(runMultiPatternSearch() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+    }
     return SDK_SUCCESS;
 }
 
-void StringSearch::cpuReferenceImpl()
+int StringSearch::runMultiPatternSearch()
 {
-    static bool refImplemented = false;
-    if(refImplemented)
+    std::cout << "\nExecuting Host multi-pattern search for " <<
+              iterations << " iterations" << std::endl;
+    std::cout << "-------------------------------------------" << std::endl;
+
+    if(cpuThreads < 0)
     {
-        return;
+        cpuThreads = 0;
     }
 
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    for(int i = 0; i < iterations; i++)
+    {
+        int status = multiSearch.search(text, textLength, hostMatches, cpuThreads);
+        CHECK_ERROR(status, SDK_SUCCESS, "Host multi-pattern search failed");
+    }
+
+    sampleTimer->stopTimer(timer);
+    hostSearchTime = (double)(sampleTimer->readTimer(timer));
+
+    int status = SDK_SUCCESS;
+    if(sampleArgs->verify)
+    {
+        std::vector<PatternMatch> refMatches;
+        multiPatternCPUReference(refMatches);
+
+        bool result = (hostMatches.size() == refMatches.size());
+        for(size_t i = 0; result && i < refMatches.size(); i++)
+        {
+            result = (hostMatches[i].patternId == refMatches[i].patternId) &&
+                     (hostMatches[i].offset == refMatches[i].offset);
+        }
+
+        if(result)
+        {
+            std::cout << "Passed!\n" << std::endl;
+        }
+        else
+        {
+            std::cout << "Failed\n" << std::endl;
+            status = SDK_FAILURE;
+        }
+    }
+
+    cl_uint count = (cl_uint)hostMatches.size();
+    printArray<cl_uint>("Number of matches : ", &count, 1, 1);
+    if(!sampleArgs->quiet)
+    {
+        for(size_t i = 0; i < hostMatches.size(); i++)
+        {
+            std::cout << "(" << hostMatches[i].patternId << ", "
+                      << hostMatches[i].offset << ") ";
+        }
+        std::cout << std::endl;
+    }
+
+    if(sampleArgs->timing)
+    {
+        std::string strArray[4] =
+        {
+            "Patterns",
+            "DFA states",
+            "Avg. host search time (sec)",
+            "GB/sec"
+        };
+        std::string stats[4];
+        double avgSearchTime = hostSearchTime / iterations;
+
+        stats[0] = toString(patterns.size(), std::dec);
+        stats[1] = toString(multiSearch.getNumStates(), std::dec);
+        stats[2] = toString(avgSearchTime, std::dec);
+        stats[3] = toString(avgSearchTime > 0 ? textLength / avgSearchTime / 1e9 : 0,
+                            std::dec);
+
+        printStatistics(strArray, stats, 4);
+    }
+
+    return status;
+}
+
+int StringSearch::runStreamSearch()
+{
+    std::cout << "\nExecuting streaming search for " <<
+              iterations << " iterations" << std::endl;
+    std::cout << "-------------------------------------------" << std::endl;
+
+    if(cpuThreads < 0)
+    {
+        cpuThreads = 0;
+    }
+
+    const cl_uchar *data = mappedFile.data();
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    for(int i = 0; i < iterations; i++)
+    {
+        int status = multiSearch.searchStream(data, fileLength, chunkSize,
+                                              streamMatches, cpuThreads);
+        CHECK_ERROR(status, SDK_SUCCESS, "Host streaming search failed");
+    }
+
+    sampleTimer->stopTimer(timer);
+    streamHostTime = (double)(sampleTimer->readTimer(timer));
+
+    int status = SDK_SUCCESS;
+    if(sampleArgs->verify && fileLength <= 0xFFFFFFFF)
+    {
+        // The chunked search must find exactly what a single pass finds
+        std::vector<PatternMatch> refMatches;
+        status = multiSearch.search(data, (cl_uint)fileLength, refMatches,
+                                    cpuThreads);
+        CHECK_ERROR(status, SDK_SUCCESS, "Host multi-pattern search failed");
+
+        bool result = (streamMatches.size() == refMatches.size());
+        for(size_t i = 0; result && i < refMatches.size(); i++)
+        {
+            result = (streamMatches[i].patternId == refMatches[i].patternId) &&
+                     (streamMatches[i].offset == refMatches[i].offset);
+        }
+        std::cout << (result ? "Passed!\n" : "Failed\n") << std::endl;
+        if(!result)
+        {
+            status = SDK_FAILURE;
+        }
+    }
+
+    // The device kernels search a single pattern, the sub string
+    if(patternFile.length() == 0)
+    {
+        if(subStr.length() > 1)
+        {
+            kernelType = KERNEL_LOADBALANCE;
+            kernel = &kernelLoadBalance;
+        }
+        else
+        {
+            kernelType = KERNEL_NAIVE;
+            kernel = &kernelNaive;
+        }
+
+        const cl_uint windowLength = textLength;
+        std::vector<cl_uint> positions;
+
+        sampleTimer->resetTimer(timer);
+        sampleTimer->startTimer(timer);
+
+        /*
+         * Chunks go through the single in-order queue one after another:
+         * copy the chunk plus the overlap, search, read the positions back.
+         */
+        for(cl_ulong base = 0; base < fileLength; base += chunkSize)
+        {
+            cl_ulong remaining = fileLength - base;
+            cl_uint chunkLength = (cl_uint)std::min(remaining, (cl_ulong)chunkSize);
+            textLength = (cl_uint)std::min(remaining, (cl_ulong)windowLength);
+            if(textLength < subStr.length())
+            {
+                break;
+            }
+
+            cl_uchar *ptr;
+            int result = mapBuffer(textBuf, ptr, textLength,
+                                   CL_MAP_WRITE_INVALIDATE_REGION);
+            CHECK_ERROR(result, SDK_SUCCESS, "Failed to map device buffer.(textBuf)");
+            memcpy(ptr, data + base, textLength);
+            result = unmapBuffer(textBuf, ptr);
+            CHECK_ERROR(result, SDK_SUCCESS, "Failed to unmap device buffer.(textBuf)");
+
+            cl_uint totalSearchPos = textLength - (cl_uint)subStr.length() + 1;
+            workGroupCount = (totalSearchPos + searchLenPerWG - 1) / searchLenPerWG;
+
+            if(runCLKernels() != SDK_SUCCESS)
+            {
+                return SDK_FAILURE;
+            }
+
+            result = gatherDeviceResults(positions);
+            CHECK_ERROR(result, SDK_SUCCESS, "Failed to read the device results");
+
+            // Matches starting in the overlap belong to the next chunk
+            for(size_t i = 0; i < positions.size() && positions[i] < chunkLength; i++)
+            {
+                deviceStreamResults.push_back(base + positions[i]);
+            }
+        }
+
+        sampleTimer->stopTimer(timer);
+        streamDeviceTime = (double)(sampleTimer->readTimer(timer));
+        textLength = windowLength;
+
+        if(sampleArgs->verify)
+        {
+            bool result = (deviceStreamResults.size() == streamMatches.size());
+            for(size_t i = 0; result && i < streamMatches.size(); i++)
+            {
+                result = (deviceStreamResults[i] == streamMatches[i].offset);
+            }
+            std::cout << "Device stream " << (result ? "Passed!\n" : "Failed\n")
+                      << std::endl;
+            if(!result)
+            {
+                status = SDK_FAILURE;
+            }
+        }
+    }
+
+    cl_uint count = (cl_uint)streamMatches.size();
+    printArray<cl_uint>("Number of matches : ", &count, 1, 1);
+    if(!sampleArgs->quiet)
+    {
+        for(size_t i = 0; i < streamMatches.size(); i++)
+        {
+            std::cout << "(" << streamMatches[i].patternId << ", "
+                      << streamMatches[i].offset << ") ";
+        }
+        std::cout << std::endl;
+    }
+
+    if(sampleArgs->timing)
+    {
+        std::string strArray[6] =
+        {
+            "File size (bytes)",
+            "Chunk size (bytes)",
+            "Avg. host stream time (sec)",
+            "Host GB/sec",
+            "Device stream time (sec)",
+            "Device GB/sec"
+        };
+        std::string stats[6];
+        double avgHostTime = streamHostTime / iterations;
+
+        stats[0] = toString(fileLength, std::dec);
+        stats[1] = toString(chunkSize, std::dec);
+        stats[2] = toString(avgHostTime, std::dec);
+        stats[3] = toString(avgHostTime > 0 ? fileLength / avgHostTime / 1e9 : 0,
+                            std::dec);
+        stats[4] = toString(streamDeviceTime, std::dec);
+        stats[5] = toString(streamDeviceTime > 0 ?
+                            fileLength / streamDeviceTime / 1e9 : 0, std::dec);
+
+        printStatistics(strArray, stats, 6);
+    }
+
+    return status;
+}
+
+void StringSearch::cpuReferenceImpl()
+{
+    cpuResults.clear();
+
     cl_uint hlen = textLength;
     cl_uint last = (cl_uint)subStr.length() - 1;
     cl_uint badCharSkip[UCHAR_MAX + 1];
@@ -504,12 +929,12 @@ void StringSearch::cpuReferenceImpl()
     {
         if(caseSensitive)
         {
-            badCharSkip[subStr[scan]] = last - scan;
+            badCharSkip[(cl_uchar)subStr[scan]] = last - scan;
         }
         else
         {
-            badCharSkip[toupper(subStr[scan])] = last - scan;
-            badCharSkip[tolower(subStr[scan])] = last - scan;
+            badCharSkip[toupper((cl_uchar)subStr[scan])] = last - scan;
+            badCharSkip[tolower((cl_uchar)subStr[scan])] = last - scan;
         }
     }
 
@@ -528,10 +953,40 @@ void StringSearch::cpuReferenceImpl()
         }
         curPos += (scan == curPos) ? 1 : badCharSkip[text[last+curPos]];
     }
-    refImplemented = true;
 }
 
-int StringSearch::verifyResults()
+void StringSearch::multiPatternCPUReference(std::vector<PatternMatch>
+        &matches)
+{
+    matches.clear();
+    for(cl_uint pos = 0; pos < textLength; pos++)
+    {
+        for(cl_uint id = 0; id < (cl_uint)patterns.size(); id++)
+        {
+            const std::string &pattern = patterns[id];
+            if(pattern.length() > textLength - pos)
+            {
+                continue;
+            }
+
+            size_t k = 0;
+            while(k < pattern.length() && COMPARE(text[pos + k], (cl_uchar)pattern[k]))
+            {
+                k++;
+            }
+
+            if(k == pattern.length())
+            {
+                PatternMatch match;
+                match.patternId = id;
+                match.offset = pos;
+                matches.push_back(match);
+            }
+        }
+    }
+}
+
+int StringSearch::gatherDeviceResults(std::vector<cl_uint> &positions)
 {
     // Read Results Count per workGroup
     cl_uint *ptrCountBuff;
@@ -558,6 +1013,25 @@ int StringSearch::verifyResults()
         }
     }
     std::sort(ptrBuff, ptrBuff+count);
+    positions.assign(ptrBuff, ptrBuff + count);
+
+    // un-map resultCountBuf
+    status = unmapBuffer(resultCountBuf, ptrCountBuff);
+    CHECK_ERROR(status, SDK_SUCCESS,
+                "Failed to unmap device buffer.(resultCountBuf)");
+
+    // un-map resultBuf
+    status = unmapBuffer(resultBuf, ptrBuff);
+    CHECK_ERROR(status, SDK_SUCCESS, "Failed to unmap device buffer.(resultBuf)");
+
+    return SDK_SUCCESS;
+}
+
+int StringSearch::verifyResults()
+{
+    std::vector<cl_uint> positions;
+    int status = gatherDeviceResults(positions);
+    CHECK_ERROR(status, SDK_SUCCESS, "Failed to read the device results");
 
     if(sampleArgs->verify)
     {
@@ -565,8 +1039,7 @@ int StringSearch::verifyResults()
         cpuReferenceImpl();
 
         // compare the results and see if they match
-        bool result = (count == cpuResults.size());
-        result = result && std::equal (ptrBuff, ptrBuff+count, cpuResults.begin());
+        bool result = (positions == cpuResults);
         if(result)
         {
             std::cout << "Passed!\n" << std::endl;
@@ -579,21 +1052,13 @@ int StringSearch::verifyResults()
         }
     }
 
+    cl_uint count = (cl_uint)positions.size();
     printArray<cl_uint>("Number of matches : ", &count, 1, 1);
-    if(!sampleArgs->quiet)
+    if(!sampleArgs->quiet && count > 0)
     {
-        printArray<cl_uint>("Positions : ", ptrBuff, count, 1);
+        printArray<cl_uint>("Positions : ", &positions[0], count, 1);
     }
 
-    // un-map resultCountBuf
-    int result = unmapBuffer(resultCountBuf, ptrCountBuff);
-    CHECK_ERROR(result, SDK_SUCCESS,
-                "Failed to unmap device buffer.(resultCountBuf)");
-
-    // un-map resultBuf
-    result = unmapBuffer(resultBuf, ptrBuff);
-    CHECK_ERROR(result, SDK_SUCCESS, "Failed to unmap device buffer.(resultBuf)");
-
     return status;
 }
 
@@ -25,6 +25,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <assert.h>
 #include <string.h>
 #include "CLUtil.hpp"
+#include "MultiPatternSearch.hpp"
 
 using namespace appsdk;
 
@@ -83,6 +84,23 @@ class StringSearch
         bool caseSensitive;
         bool enable2ndLevelFilter;
 
+        std::string patternFile;            /**< File with one pattern per line */
+        std::vector<std::string> patterns;  /**< Patterns of the host multi-pattern search */
+        MultiPatternSearch multiSearch;     /**< Host multi-pattern search engine */
+        std::vector<PatternMatch> hostMatches; /**< Matches of the host search */
+        cl_double hostSearchTime;           /**< Time of the host multi-pattern search */
+        int cpuThreads;                     /**< Host threads, 0 uses every core */
+
+        bool streamMode;                    /**< Map the file and search it in chunks */
+        int chunkMB;                        /**< Chunk size of the streaming search in MB */
+        SDKMappedFile mappedFile;           /**< Read-only mapping of the input file */
+        cl_ulong fileLength;                /**< Size of the mapped file */
+        cl_uint chunkSize;                  /**< Chunk size in bytes */
+        cl_double streamHostTime;           /**< Time of the host streaming search */
+        cl_double streamDeviceTime;         /**< Time of the chunked device search */
+        std::vector<PatternMatch> streamMatches;    /**< Matches of the host streaming search */
+        std::vector<cl_ulong> deviceStreamResults;  /**< File offsets found by the device */
+
         SDKTimer    *sampleTimer;      /**< SDKTimer object */
 
     public:
@@ -112,7 +130,15 @@ class StringSearch
               kernel(&kernelNaive),
               kernelType(KERNEL_NAIVE),
               caseSensitive(false),
-              enable2ndLevelFilter(false)
+              enable2ndLevelFilter(false),
+              hostSearchTime(0),
+              cpuThreads(0),
+              streamMode(false),
+              chunkMB(64),
+              fileLength(0),
+              chunkSize(0),
+              streamHostTime(0),
+              streamDeviceTime(0)
         {
             sampleArgs = new CLCommandArgs();
             sampleTimer = new SDKTimer();
@@ -256,6 +282,68 @@ class StringSearch
         */
         void cpuReferenceImpl();
 
+        /**
+        *******************************************************************************
+        * @fn setupMultiPatternSearch
+        * @brief Read the pattern file and compile the host multi-pattern search
+        *
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        *******************************************************************************
+        */
+        int setupMultiPatternSearch();
+
+        /**
+        *******************************************************************************
+        * @fn runMultiPatternSearch
+        * @brief Search all patterns on the host, verify and print statistics
+        *
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        *******************************************************************************
+        */
+        int runMultiPatternSearch();
+
+        /**
+        *******************************************************************************
+        * @fn multiPatternCPUReference
+        * @brief Brute force reference of the host multi-pattern search
+        *
+        * @param[out] matches : all matches ordered by offset, then pattern id
+        *******************************************************************************
+        */
+        void multiPatternCPUReference(std::vector<PatternMatch> &matches);
+
+        /**
+        *******************************************************************************
+        * @fn setupStreamSearch
+        * @brief Map the input file and size the device window to one chunk
+        *
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        *******************************************************************************
+        */
+        int setupStreamSearch();
+
+        /**
+        *******************************************************************************
+        * @fn runStreamSearch
+        * @brief Search the mapped file chunk by chunk on the host and on the device
+        *
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        *******************************************************************************
+        */
+        int runStreamSearch();
+
+        /**
+        *******************************************************************************
+        * @fn gatherDeviceResults
+        * @brief Read back and compact the match positions of the last kernel run
+        *
+        * @param[out] positions : sorted match positions
+        *
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        *******************************************************************************
+        */
+        int gatherDeviceResults(std::vector<cl_uint> &positions);
+
         /**
         *******************************************************************************
         * @fn mapBuffer
@@ -385,6 +385,20 @@ URNG::initialize()
 
     delete factor_option;
 
+    Option* threads_option = new Option;
+    CHECK_ALLOCATION(threads_option, "Memory Allocation error.\n");
+
+    threads_option->_sVersion = "";
+    threads_option->_lVersion = "threads";
+    threads_option->_description =
+        "Number of host threads of the host engine (0 uses every core)";
+    threads_option->_type = CA_ARG_INT;
+    threads_option->_value = &cpuThreads;
+
+    sampleArgs->AddOption(threads_option);
+
+    delete threads_option;
+
     return SDK_SUCCESS;
 }
 
@@ -500,9 +514,30 @@ URNG::cleanup()
 
 
 
-void
+int
 URNG::URNGCPUReference()
 {
+    if(verificationOutput == NULL)
+    {
+        verificationOutput = (cl_uchar4*)malloc(width * height * sizeof(cl_uchar4));
+        CHECK_ALLOCATION(verificationOutput,
+                         "Failed to allocate memory! (verificationOutput)");
+    }
+
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    int status = engine.addNoise(inputImageData, verificationOutput, width, height,
+                                 factor);
+    CHECK_ERROR(status, SDK_SUCCESS, "URNGEngine::addNoise() failed");
+
+    sampleTimer->stopTimer(timer);
+    hostTime = (double)(sampleTimer->readTimer(timer));
+
+    return SDK_SUCCESS;
 }
 
 
@@ -518,7 +553,23 @@ URNG::verifyResults()
         }
         mean /= (width * height * factor);
 
-        if(fabs(mean) < 1.0)
+        if(URNGCPUReference() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+
+        // The host engine follows the integer generator of the kernel exactly
+        bool match = true;
+        for(cl_uint i = 0; i < width * height && match; i++)
+        {
+            if(memcmp(&outputImageData[i], &verificationOutput[i], sizeof(cl_uchar4)))
+            {
+                std::cout << "Host and device differ at pixel " << i << std::endl;
+                match = false;
+            }
+        }
+
+        if(match && fabs(mean) < 1.0)
         {
             std::cout << "Passed! \n" << std::endl;
             return SDK_SUCCESS;
@@ -554,6 +605,15 @@ URNG::printStats()
     if(sampleArgs->timing)
     {
         printStatistics(strArray, stats, 4);
+
+        if(hostTime > 0)
+        {
+            std::string hostStrArray[2] = {"Host Time(sec)", "Host MPixels/sec"};
+            std::string hostStats[2];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(width * height / hostTime * 1e-6, std::dec);
+            printStatistics(hostStrArray, hostStats, 2);
+        }
     }
 }
 
@@ -23,6 +23,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <string.h>
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
+#include "URNGEngine.hpp"
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -69,6 +70,10 @@ class URNG
 
         SDKTimer *sampleTimer;      /**< SDKTimer object */
 
+        URNGEngine engine;                  /**< Host version of the kernel */
+        int cpuThreads;                     /**< Host threads, 0 uses every core */
+        cl_double hostTime;                 /**< Time of the host engine */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -95,7 +100,9 @@ class URNG
             : inputImageData(NULL),
               outputImageData(NULL),
               verificationOutput(NULL),
-              byteRWSupport(true)
+              byteRWSupport(true),
+              cpuThreads(0),
+              hostTime(0)
         {
             sampleArgs = new CLCommandArgs();
             sampleTimer = new SDKTimer();
@@ -142,10 +149,11 @@ class URNG
         int runCLKernels();
 
         /**
-        * Reference CPU implementation of Binomial Option
-        * for performance comparison
+        * Reference CPU implementation of the kernel, runs the host engine
+        * into verificationOutput
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
-        void URNGCPUReference();
+        int URNGCPUReference();
 
         /**
         * Override from SDKSample. Print sample stats.
@@ -0,0 +1,186 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "URNGEngine.hpp"
+#include <emmintrin.h>
+
+/*
+ * Park-Miller generator and Bays-Durham shuffle of URNG_Kernels.cl
+ */
+#define IA 16807
+#define IM 2147483647
+#define AM (1.0f / IM)
+#define IQ 127773
+#define IR 2836
+#define NTAB 16
+#define NDIV (1 + (IM - 1) / NTAB)
+
+/**
+ * Arguments of the noise threads
+ */
+struct URNGEngine::rangeArgs
+{
+    const cl_uchar4 *input;
+    cl_uchar4 *output;
+    cl_uint width;
+    cl_float deviation[256];    /**< Noise added to a pixel, by truncated average */
+};
+
+/*
+ * Adds noise[i] to every channel of pixel i of four packed pixels, then
+ * converts as convert_uchar4_sat(): clamped, rounded toward zero and
+ * NaN to 0
+ */
+static inline __m128i
+addNoise4(__m128i pixels, const cl_float *noise)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 maxValue = _mm_set1_ps(255.0f);
+
+    __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+    __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+    __m128i channels[4] =
+    {
+        _mm_unpacklo_epi16(lo, zero),
+        _mm_unpackhi_epi16(lo, zero),
+        _mm_unpacklo_epi16(hi, zero),
+        _mm_unpackhi_epi16(hi, zero)
+    };
+
+    for(int i = 0; i < 4; i++)
+    {
+        __m128 v = _mm_add_ps(_mm_cvtepi32_ps(channels[i]), _mm_set1_ps(noise[i]));
+        v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), maxValue);
+        channels[i] = _mm_cvttps_epi32(v);
+    }
+
+    return _mm_packus_epi16(_mm_packs_epi32(channels[0], channels[1]),
+                            _mm_packs_epi32(channels[2], channels[3]));
+}
+
+/*
+ * Scalar convert_uchar_sat()
+ */
+static inline cl_uchar
+saturate(cl_float v)
+{
+    return v >= 255.0f ? 255 : (v > 0.0f ? (cl_uchar)v : 0);
+}
+
+cl_float
+URNGEngine::uniform(cl_uint average)
+{
+    // The kernel passes -avg, which the int parameter truncates
+    int idum = -(int)average;
+    int iv[NTAB];
+
+    for(int j = NTAB; j >= 0; j--)
+    {
+        int k = idum / IQ;
+        idum = IA * (idum - k * IQ) - IR * k;
+        if(idum < 0)
+        {
+            idum += IM;
+        }
+        if(j < NTAB)
+        {
+            iv[j] = idum;
+        }
+    }
+
+    // The state is not advanced further, only the shuffle is applied
+    int j = iv[0] / NDIV;
+    return AM * iv[j];
+}
+
+void
+URNGEngine::noiseThread(void *data, unsigned int begin, unsigned int end,
+                        unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const cl_uint width = args->width;
+
+    for(cl_uint y = begin; y < end; y++)
+    {
+        const cl_uchar4 *in = args->input + (size_t)y * width;
+        cl_uchar4 *out = args->output + (size_t)y * width;
+
+        cl_uint x = 0;
+        for(; x + 4 <= width; x += 4)
+        {
+            // The kernel averages x, y, z and y again
+            cl_float noise[4];
+            for(int i = 0; i < 4; i++)
+            {
+                const cl_uchar *p = in[x + i].s;
+                noise[i] = args->deviation[(p[0] + 2 * p[1] + p[2]) >> 2];
+            }
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(in + x));
+            _mm_storeu_si128((__m128i*)(out + x), addNoise4(pixels, noise));
+        }
+
+        for(; x < width; x++)
+        {
+            const cl_uchar *p = in[x].s;
+            cl_float noise = args->deviation[(p[0] + 2 * p[1] + p[2]) >> 2];
+            for(int c = 0; c < 4; c++)
+            {
+                out[x].s[c] = saturate(p[c] + noise);
+            }
+        }
+    }
+}
+
+int
+URNGEngine::addNoise(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                     cl_uint height, int factor)
+{
+    if(input == NULL || output == NULL)
+    {
+        error("URNGEngine::addNoise() needs input and output pixels");
+        return SDK_FAILURE;
+    }
+
+    rangeArgs args;
+    args.input = input;
+    args.output = output;
+    args.width = width;
+    for(cl_uint a = 0; a < 256; a++)
+    {
+        args.deviation[a] = (uniform(a) - 0.55f) * factor;
+    }
+
+    if(!parallelFor(noiseThread, &args, height, numThreads))
+    {
+        error("URNGEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+int
+URNGEngine::addNoise(SDKBitMap &image, int factor)
+{
+    if(!image.isLoaded())
+    {
+        error("URNGEngine::addNoise() needs a loaded bitmap");
+        return SDK_FAILURE;
+    }
+
+    cl_uchar4 *pixels = (cl_uchar4*)image.getPixels();
+    return addNoise(pixels, pixels, image.getWidth(), image.getHeight(), factor);
+}
@@ -0,0 +1,92 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef URNGENGINE_H_
+#define URNGENGINE_H_
+
+#include <CL/cl.h>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+#include "SDKBitMap.hpp"
+
+using namespace appsdk;
+
+/**
+ * URNGEngine
+ * Class implements a multi-threaded SSE2 host version of the noise_uniform
+ * kernel.
+ *
+ * The kernel seeds its Park-Miller generator with the truncated average
+ * of a pixel, so the deviation takes one of 256 values. They are computed
+ * once per call with the integer arithmetic of the kernel and looked up
+ * per pixel, which makes the output bit-exact with the device.
+ */
+class URNGEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+
+        struct rangeArgs;
+        static void noiseThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        URNGEngine()
+            : numThreads(0)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Uniform deviate of ran1() in the kernel for a pixel
+         * @param average truncated average of the pixel, 0 to 255
+         * @return deviate in [0, 1)
+         */
+        static cl_float uniform(cl_uint average);
+
+        /**
+         * Adds the noise of noise_uniform to an image, rows are split
+         * between the threads
+         * @param input input pixels, width * height
+         * @param output output pixels, may be input
+         * @param width width of the image
+         * @param height height of the image
+         * @param factor noise factor of the kernel
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int addNoise(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                     cl_uint height, int factor);
+
+        /**
+         * Adds the noise of noise_uniform to the pixels of a loaded bitmap
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int addNoise(SDKBitMap &image, int factor);
+};
+
+#endif
@@ -25,6 +25,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <string.h>
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
+#include "GaussianNoiseEngine.hpp"
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -47,6 +48,7 @@ class GaussianNoise
         cl_double kernelTime;                   /**< time taken to run kernel and read result back */
         cl_uchar4* inputImageData;              /**< Input bitmap data to device */
         cl_uchar4* outputImageData;             /**< Output from device */
+        cl_uchar4* verificationOutput;          /**< Output of the host engine */
         cl::Context context;                    /**< Context */
         std::vector<cl::Device> devices;        /**< vector of devices */
         std::vector<cl::Device> device;         /**< device to be used */
@@ -69,6 +71,10 @@ class GaussianNoise
 
         SDKTimer *sampleTimer;      /**< SDKTimer object */
 
+        GaussianNoiseEngine engine;             /**< Host version of the kernel */
+        int cpuThreads;                         /**< Host threads, 0 uses every core */
+        cl_double hostTime;                     /**< Time of the host engine */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -93,7 +99,10 @@ class GaussianNoise
         */
         GaussianNoise()
             : inputImageData(NULL),
-              outputImageData(NULL)
+              outputImageData(NULL),
+              verificationOutput(NULL),
+              cpuThreads(0),
+              hostTime(0)
         {
             sampleArgs = new CLCommandArgs();
             sampleTimer = new SDKTimer();
@@ -139,10 +148,11 @@ class GaussianNoise
         int runCLKernels();
 
         /**
-        * Reference CPU implementation of Binomial Option
-        * for performance comparison
+        * Reference CPU implementation of the kernel, runs the host engine
+        * into verificationOutput
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
-        void gaussianNoiseCPUReference();
+        int gaussianNoiseCPUReference();
 
         /**
         * Override from SDKSample. Print sample stats.
@@ -0,0 +1,223 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "GaussianNoiseEngine.hpp"
+#include <emmintrin.h>
+#include <cmath>
+
+/*
+ * Park-Miller generator and Bays-Durham shuffle of GaussianNoise_Kernels.cl
+ */
+#define IA 16807
+#define IM 2147483647
+#define AM (1.0 / IM)
+#define IQ 127773
+#define IR 2836
+#define NTAB 4
+#define NDIV (1 + (IM - 1) / NTAB)
+#define PI 3.14
+
+/**
+ * Arguments of the noise threads
+ */
+struct GaussianNoiseEngine::rangeArgs
+{
+    const cl_uchar4 *input;
+    cl_uchar4 *output;
+    cl_uint width;
+    cl_float factor;
+    cl_float radius[256];       /**< Box-Muller radius, by average of the first pixel */
+    cl_float sine[256];         /**< sin of the angle, by average of the second pixel */
+    cl_float cosine[256];       /**< cos of the angle, by average of the second pixel */
+};
+
+/*
+ * Adds noise[i] to every channel of pixel i of four packed pixels, then
+ * converts as convert_uchar4_sat(): clamped, rounded toward zero and
+ * NaN to 0
+ */
+static inline __m128i
+addNoise4(__m128i pixels, const cl_float *noise)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 maxValue = _mm_set1_ps(255.0f);
+
+    __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+    __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+    __m128i channels[4] =
+    {
+        _mm_unpacklo_epi16(lo, zero),
+        _mm_unpackhi_epi16(lo, zero),
+        _mm_unpacklo_epi16(hi, zero),
+        _mm_unpackhi_epi16(hi, zero)
+    };
+
+    for(int i = 0; i < 4; i++)
+    {
+        __m128 v = _mm_add_ps(_mm_cvtepi32_ps(channels[i]), _mm_set1_ps(noise[i]));
+        v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), maxValue);
+        channels[i] = _mm_cvttps_epi32(v);
+    }
+
+    return _mm_packus_epi16(_mm_packs_epi32(channels[0], channels[1]),
+                            _mm_packs_epi32(channels[2], channels[3]));
+}
+
+/*
+ * Scalar convert_uchar4_sat() of one pixel plus noise
+ */
+static inline void
+addNoise1(const cl_uchar4 &pixel, cl_float noise, cl_uchar4 &result)
+{
+    for(int c = 0; c < 4; c++)
+    {
+        cl_float v = pixel.s[c] + noise;
+        result.s[c] = v >= 255.0f ? 255 : (v > 0.0f ? (cl_uchar)v : 0);
+    }
+}
+
+/*
+ * Truncated average of the four channels, as ran1(-avg) sees it
+ */
+static inline cl_uint
+average(const cl_uchar4 &pixel)
+{
+    return (pixel.s[0] + pixel.s[1] + pixel.s[2] + pixel.s[3]) >> 2;
+}
+
+cl_float
+GaussianNoiseEngine::uniform(cl_uint average)
+{
+    int idum = -(int)average;
+    int iv[NTAB];
+
+    for(int j = NTAB; j >= 0; j--)
+    {
+        int k = idum / IQ;
+        idum = IA * (idum - k * IQ) - IR * k;
+        if(idum < 0)
+        {
+            idum += IM;
+        }
+        if(j < NTAB)
+        {
+            iv[j] = idum;
+        }
+    }
+
+    int j = iv[0] / NDIV;
+    return (cl_float)(AM * iv[j]);
+}
+
+void
+GaussianNoiseEngine::noiseThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const cl_uint width = args->width;
+    const cl_uint half = width / 2;
+
+    for(cl_uint y = begin; y < end; y++)
+    {
+        const cl_uchar4 *in0 = args->input + (size_t)y * width;
+        const cl_uchar4 *in1 = in0 + half;
+        cl_uchar4 *out0 = args->output + (size_t)y * width;
+        cl_uchar4 *out1 = out0 + half;
+
+        cl_uint x = 0;
+        for(; x + 4 <= half; x += 4)
+        {
+            cl_float noise0[4];
+            cl_float noise1[4];
+            for(int i = 0; i < 4; i++)
+            {
+                cl_float r = args->radius[average(in0[x + i])];
+                cl_uint theta = average(in1[x + i]);
+                noise0[i] = r * args->sine[theta] * args->factor;
+                noise1[i] = r * args->cosine[theta] * args->factor;
+            }
+
+            // Both halves are read before either is written, for in place use
+            __m128i pixels0 = _mm_loadu_si128((const __m128i*)(in0 + x));
+            __m128i pixels1 = _mm_loadu_si128((const __m128i*)(in1 + x));
+            _mm_storeu_si128((__m128i*)(out0 + x), addNoise4(pixels0, noise0));
+            _mm_storeu_si128((__m128i*)(out1 + x), addNoise4(pixels1, noise1));
+        }
+
+        for(; x < half; x++)
+        {
+            cl_float r = args->radius[average(in0[x])];
+            cl_uint theta = average(in1[x]);
+            cl_uchar4 pixel0 = in0[x];
+            cl_uchar4 pixel1 = in1[x];
+            addNoise1(pixel0, r * args->sine[theta] * args->factor, out0[x]);
+            addNoise1(pixel1, r * args->cosine[theta] * args->factor, out1[x]);
+        }
+
+        if(width % 2 != 0)
+        {
+            out0[width - 1] = in0[width - 1];
+        }
+    }
+}
+
+int
+GaussianNoiseEngine::addNoise(const cl_uchar4 *input, cl_uchar4 *output,
+                              cl_uint width, cl_uint height, int factor)
+{
+    if(input == NULL || output == NULL)
+    {
+        error("GaussianNoiseEngine::addNoise() needs input and output pixels");
+        return SDK_FAILURE;
+    }
+
+    rangeArgs args;
+    args.input = input;
+    args.output = output;
+    args.width = width;
+    args.factor = (cl_float)factor;
+
+    // BoxMuller() of the kernel, split by the pixel each half depends on
+    for(cl_uint a = 0; a < 256; a++)
+    {
+        cl_float u = uniform(a);
+        cl_float theta = (cl_float)(2 * PI * u);
+        args.radius[a] = sqrtf(-2 * logf(u));
+        args.sine[a] = sinf(theta);
+        args.cosine[a] = cosf(theta);
+    }
+
+    if(!parallelFor(noiseThread, &args, height, numThreads))
+    {
+        error("GaussianNoiseEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+int
+GaussianNoiseEngine::addNoise(SDKBitMap &image, int factor)
+{
+    if(!image.isLoaded())
+    {
+        error("GaussianNoiseEngine::addNoise() needs a loaded bitmap");
+        return SDK_FAILURE;
+    }
+
+    cl_uchar4 *pixels = (cl_uchar4*)image.getPixels();
+    return addNoise(pixels, pixels, image.getWidth(), image.getHeight(), factor);
+}
@@ -0,0 +1,97 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef GAUSSIANNOISEENGINE_H_
+#define GAUSSIANNOISEENGINE_H_
+
+#include <CL/cl.h>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+#include "SDKBitMap.hpp"
+
+using namespace appsdk;
+
+/**
+ * GaussianNoiseEngine
+ * Class implements a multi-threaded SSE2 host version of the
+ * gaussian_transform kernel.
+ *
+ * Pixel x of a row is paired with pixel x + width / 2. Their uniforms
+ * come from the Park-Miller generator of the kernel seeded with their
+ * truncated averages, and feed one Box-Muller transform. The radius only
+ * depends on the first average and the angle on the second, so both are
+ * tabulated once per call over the 256 averages. The integer generator
+ * is exact; the normals can differ from the device by the rounding of
+ * log, sin and cos, which moves an output channel by at most one.
+ */
+class GaussianNoiseEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+
+        struct rangeArgs;
+        static void noiseThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        GaussianNoiseEngine()
+            : numThreads(0)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Uniform deviate of ran1() in the kernel for a pixel
+         * @param average truncated average of the pixel, 0 to 255
+         * @return deviate in [0, 1)
+         */
+        static cl_float uniform(cl_uint average);
+
+        /**
+         * Adds the noise of gaussian_transform to an image, rows are split
+         * between the threads. The last column of an odd width has no pair
+         * and is copied.
+         * @param input input pixels, width * height
+         * @param output output pixels, may be input
+         * @param width width of the image
+         * @param height height of the image
+         * @param factor noise factor of the kernel
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int addNoise(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                     cl_uint height, int factor);
+
+        /**
+         * Adds the noise of gaussian_transform to the pixels of a loaded
+         * bitmap
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int addNoise(SDKBitMap &image, int factor);
+};
+
+#endif
@@ -50,7 +50,7 @@ float ran1(int idum, __local int *iv)
         if(j < NTAB)
             iv[NTAB* tid + j] = idum;
     }
-    iy = iv[0];
+    iy = iv[NTAB * tid];
 
 
     k = idum / IQ;
@@ -0,0 +1,708 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "HDRLoader.hpp"
+#include <emmintrin.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+
+/*
+ * Bytes of a chunk of the text layout
+ */
+#define TEXT_CHUNK_BYTES (1 << 20)
+
+/*
+ * Longest token of the text layout
+ */
+#define MAX_TOKEN 64
+
+/*
+ * Rec. 709 luminance weights, as used by the kernel
+ */
+#define LUMINANCE_R 0.2126f
+#define LUMINANCE_G 0.7152f
+#define LUMINANCE_B 0.0722f
+
+/**
+ * Arguments of the decode threads
+ */
+struct HDRLoader::rangeArgs
+{
+    HDRLoader *loader;
+    cl_float *pixels;
+    bool counting;
+};
+
+static inline bool
+isSpace(cl_uchar c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/*
+ * Copies the token starting at or after pos into token and moves pos past
+ * it, returns false at the end of the data
+ */
+static bool
+nextToken(const cl_uchar *data, size_t size, size_t &pos, char *token)
+{
+    while(pos < size && isSpace(data[pos]))
+    {
+        pos++;
+    }
+    if(pos == size)
+    {
+        return false;
+    }
+    size_t length = 0;
+    for(; pos < size && !isSpace(data[pos]); pos++)
+    {
+        if(length < MAX_TOKEN - 1)
+        {
+            token[length++] = (char)data[pos];
+        }
+    }
+    token[length] = '\0';
+    return true;
+}
+
+/*
+ * Copies the line starting at pos without its newline and moves pos past it
+ */
+static bool
+nextLine(const cl_uchar *data, size_t size, size_t &pos, std::string &line)
+{
+    if(pos >= size)
+    {
+        return false;
+    }
+    const cl_uchar *end = (const cl_uchar*)memchr(data + pos, '\n', size - pos);
+    size_t length = end ? (size_t)(end - data) - pos : size - pos;
+    line.assign((const char*)data + pos, length);
+    pos += length + (end ? 1 : 0);
+    return true;
+}
+
+/*
+ * Converts a token like strtof. Decimals of up to seven digits and no
+ * exponent are an exact mantissa over an exact power of ten, so one
+ * float division rounds them the same way.
+ */
+static cl_float
+parseFloat(const char *token)
+{
+    static const cl_float powers[8] =
+    {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f
+    };
+
+    const char *c = token;
+    bool negative = *c == '-';
+    c += (*c == '-' || *c == '+') ? 1 : 0;
+
+    cl_uint mantissa = 0;
+    int digits = 0, decimals = 0;
+    bool point = false;
+    for(; *c != '\0'; c++)
+    {
+        if(*c >= '0' && *c <= '9')
+        {
+            mantissa = mantissa * 10 + (*c - '0');
+            digits++;
+            decimals += point ? 1 : 0;
+        }
+        else if(*c == '.' && !point)
+        {
+            point = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if(*c != '\0' || digits == 0 || digits > 7)
+    {
+        return strtof(token, NULL);
+    }
+    cl_float value = (cl_float)mantissa / powers[decimals];
+    return negative ? -value : value;
+}
+
+/*
+ * New run-length scanlines start with 2, 2 and their width
+ */
+static inline bool
+isRunLength(const cl_uchar *data, size_t pos, size_t size, cl_uint width)
+{
+    return width >= 8 && width < 0x8000 && pos + 4 <= size &&
+           data[pos] == 2 && data[pos + 1] == 2 &&
+           ((cl_uint)data[pos + 2] << 8 | data[pos + 3]) == width;
+}
+
+static inline cl_float
+luminance(const cl_float *pixel)
+{
+    return (LUMINANCE_R * pixel[0]) + (LUMINANCE_G * pixel[1]) + (LUMINANCE_B * pixel[2]);
+}
+
+/*
+ * Sum of the four lanes of the luminance accumulator
+ */
+static inline cl_double
+sumLanes(__m128 sum)
+{
+    cl_float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+    return (cl_double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+int
+HDRLoader::open(const char *fileName)
+{
+    close();
+    if(!mappedFile.open(fileName))
+    {
+        error(std::string("HDRLoader could not open ") + fileName);
+        return SDK_FAILURE;
+    }
+
+    const cl_uchar *data = mappedFile.data();
+    size_t size = mappedFile.size();
+    int status;
+    if(size >= 3 && data[0] == 'P' && (data[1] == 'F' || data[1] == 'f') &&
+            isSpace(data[2]))
+    {
+        format = FORMAT_PFM;
+        status = openPFM();
+    }
+    else if(size >= 2 && data[0] == '#' && data[1] == '?')
+    {
+        format = FORMAT_RGBE;
+        status = openRGBE();
+    }
+    else
+    {
+        format = FORMAT_TEXT;
+        status = openText();
+    }
+
+    if(status != SDK_SUCCESS)
+    {
+        close();
+    }
+    return status;
+}
+
+void
+HDRLoader::close()
+{
+    mappedFile.close();
+    offsets.clear();
+    counts.clear();
+}
+
+int
+HDRLoader::openText()
+{
+    const cl_uchar *data = mappedFile.data();
+    size_t size = mappedFile.size();
+    size_t pos = 0;
+    char token[MAX_TOKEN];
+
+    long w = 0, h = 0;
+    if(nextToken(data, size, pos, token))
+    {
+        w = strtol(token, NULL, 10);
+    }
+    if(nextToken(data, size, pos, token))
+    {
+        h = strtol(token, NULL, 10);
+    }
+    if(w <= 0 || h <= 0)
+    {
+        error("HDRLoader found no image size at the start of the text file");
+        return SDK_FAILURE;
+    }
+    width = (cl_uint)w;
+    height = (cl_uint)h;
+    dataOffset = pos;
+
+    // Chunks start on whitespace, so no token spans two of them
+    offsets.clear();
+    offsets.push_back(dataOffset);
+    for(size_t next = dataOffset + TEXT_CHUNK_BYTES; next < size; next += TEXT_CHUNK_BYTES)
+    {
+        while(next < size && !isSpace(data[next]))
+        {
+            next++;
+        }
+        if(next == size)
+        {
+            break;
+        }
+        offsets.push_back(next);
+    }
+    offsets.push_back(size);
+    return SDK_SUCCESS;
+}
+
+int
+HDRLoader::openPFM()
+{
+    const cl_uchar *data = mappedFile.data();
+    size_t size = mappedFile.size();
+    size_t pos = 2;
+    char token[MAX_TOKEN];
+
+    channels = data[1] == 'F' ? 3 : 1;
+    long w = 0, h = 0;
+    double scale = 0;
+    if(nextToken(data, size, pos, token))
+    {
+        w = strtol(token, NULL, 10);
+    }
+    if(nextToken(data, size, pos, token))
+    {
+        h = strtol(token, NULL, 10);
+    }
+    if(nextToken(data, size, pos, token))
+    {
+        scale = strtod(token, NULL);
+    }
+
+    // A single whitespace byte ends the header
+    if(w <= 0 || h <= 0 || scale == 0 || pos >= size || !isSpace(data[pos]))
+    {
+        error("HDRLoader found a bad PFM header");
+        return SDK_FAILURE;
+    }
+    width = (cl_uint)w;
+    height = (cl_uint)h;
+    dataOffset = pos + 1;
+
+    // A negative scale marks little-endian floats
+    const cl_uint one = 1;
+    bool hostLittle = *(const cl_uchar*)&one == 1;
+    swapBytes = (scale < 0) != hostLittle;
+    flipRows = true;
+
+    cl_ulong bytes = (cl_ulong)width * height * channels * sizeof(cl_float);
+    if(bytes > size - dataOffset)
+    {
+        error("HDRLoader found a truncated PFM file");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+int
+HDRLoader::openRGBE()
+{
+    const cl_uchar *data = mappedFile.data();
+    size_t size = mappedFile.size();
+    size_t pos = 0;
+    std::string line;
+
+    // Variables up to an empty line, then the resolution
+    nextLine(data, size, pos, line);
+    bool gotLine;
+    while((gotLine = nextLine(data, size, pos, line)) && !line.empty())
+    {
+        if(line.compare(0, 7, "FORMAT=") == 0 && line != "FORMAT=32-bit_rle_rgbe")
+        {
+            error("HDRLoader only reads 32-bit_rle_rgbe Radiance files");
+            return SDK_FAILURE;
+        }
+    }
+
+    char yAxis[3], xAxis[3];
+    long w = 0, h = 0;
+    if(!gotLine || !nextLine(data, size, pos, line) ||
+            sscanf(line.c_str(), "%2s %ld %2s %ld", yAxis, &h, xAxis, &w) != 4 ||
+            (strcmp(yAxis, "-Y") != 0 && strcmp(yAxis, "+Y") != 0) ||
+            strcmp(xAxis, "+X") != 0 || w <= 0 || h <= 0)
+    {
+        error("HDRLoader only reads Radiance files of -Y H +X W or +Y H +X W scanlines");
+        return SDK_FAILURE;
+    }
+    width = (cl_uint)w;
+    height = (cl_uint)h;
+    dataOffset = pos;
+    flipRows = yAxis[0] == '+';
+    return indexRGBE();
+}
+
+/*
+ * Finds the start of every scanline, the run lengths of a scanline have to
+ * be walked to find the next one
+ */
+int
+HDRLoader::indexRGBE()
+{
+    const cl_uchar *data = mappedFile.data();
+    const size_t size = mappedFile.size();
+    size_t pos = dataOffset;
+
+    offsets.resize(height + 1);
+    for(cl_uint y = 0; y < height; y++)
+    {
+        offsets[y] = pos;
+        if(isRunLength(data, pos, size, width))
+        {
+            pos += 4;
+            for(int c = 0; c < 4; c++)
+            {
+                for(cl_uint x = 0; x < width; )
+                {
+                    if(pos >= size)
+                    {
+                        error("HDRLoader found a truncated RGBE file");
+                        return SDK_FAILURE;
+                    }
+                    cl_uint count = data[pos++];
+                    bool run = count > 128;
+                    count = run ? count - 128 : count;
+                    if(count == 0 || x + count > width)
+                    {
+                        error("HDRLoader found a bad run in an RGBE scanline");
+                        return SDK_FAILURE;
+                    }
+                    pos += run ? 1 : count;
+                    x += count;
+                }
+            }
+        }
+        else
+        {
+            pos += (size_t)width * 4;
+        }
+        if(pos > size)
+        {
+            error("HDRLoader found a truncated RGBE file");
+            return SDK_FAILURE;
+        }
+    }
+    offsets[height] = pos;
+    return SDK_SUCCESS;
+}
+
+void
+HDRLoader::textThread(void *data, unsigned int begin, unsigned int end,
+                      unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    HDRLoader *loader = args->loader;
+    const cl_uchar *text = loader->mappedFile.data();
+    const size_t values = (size_t)loader->width * loader->height * 4;
+    char token[MAX_TOKEN];
+
+    // begin and end count chunks of the text
+    for(cl_uint i = begin; i < end; i++)
+    {
+        size_t pos = loader->offsets[i];
+        const size_t chunkEnd = loader->offsets[i + 1];
+        if(args->counting)
+        {
+            size_t tokens = 0;
+            for(bool inToken = false; pos < chunkEnd; pos++)
+            {
+                bool space = isSpace(text[pos]);
+                tokens += (!space && !inToken) ? 1 : 0;
+                inToken = !space;
+            }
+            loader->counts[i + 1] = tokens;
+            continue;
+        }
+
+        size_t first = std::min(loader->counts[i], values);
+        size_t last = std::min(loader->counts[i + 1], values);
+        for(size_t v = first; v < last; v++)
+        {
+            nextToken(text, chunkEnd, pos, token);
+            args->pixels[v] = parseFloat(token);
+        }
+
+        // Pixels with all four values in this chunk
+        cl_double sum = 0;
+        for(size_t p = (first + 3) / 4; 4 * p + 4 <= last; p++)
+        {
+            sum += luminance(args->pixels + 4 * p);
+        }
+        loader->sums[i] = sum;
+    }
+}
+
+int
+HDRLoader::decodeText(cl_float *pixels)
+{
+    rangeArgs args;
+    args.loader = this;
+    args.pixels = pixels;
+    args.counting = true;
+
+    // Count the tokens of every chunk, then parse them in place
+    cl_uint numChunks = (cl_uint)offsets.size() - 1;
+    counts.assign(numChunks + 1, 0);
+    sums.assign(numChunks, 0.0);
+    if(!parallelFor(textThread, &args, numChunks, numThreads))
+    {
+        error("HDRLoader could not create its threads");
+        return SDK_FAILURE;
+    }
+    for(cl_uint i = 0; i < numChunks; i++)
+    {
+        counts[i + 1] += counts[i];
+    }
+    const size_t values = (size_t)width * height * 4;
+    if(counts[numChunks] < values)
+    {
+        error("HDRLoader found too few values in the text file");
+        return SDK_FAILURE;
+    }
+
+    args.counting = false;
+    if(!parallelFor(textThread, &args, numChunks, numThreads))
+    {
+        error("HDRLoader could not create its threads");
+        return SDK_FAILURE;
+    }
+
+    // Pixels split between two chunks
+    size_t last = (size_t)-1;
+    for(cl_uint i = 1; i < numChunks; i++)
+    {
+        size_t p = counts[i] / 4;
+        if(counts[i] % 4 != 0 && counts[i] < values && p != last)
+        {
+            sums[i] += luminance(pixels + 4 * p);
+            last = p;
+        }
+    }
+    return SDK_SUCCESS;
+}
+
+/*
+ * Reverses the bytes of four floats
+ */
+static inline __m128
+swapFloats(__m128 value)
+{
+    __m128i v = _mm_castps_si128(value);
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)),
+                            _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_castsi128_ps(v);
+}
+
+static inline __m128
+loadFloats(const cl_uchar *source, bool swap)
+{
+    __m128 value = _mm_loadu_ps((const cl_float*)source);
+    return swap ? swapFloats(value) : value;
+}
+
+void
+HDRLoader::pfmThread(void *data, unsigned int begin, unsigned int end,
+                     unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    HDRLoader *loader = args->loader;
+    const cl_uint width = loader->width;
+    const cl_uint channels = loader->channels;
+    const bool swap = loader->swapBytes;
+    const __m128 ones = _mm_set1_ps(1.0f);
+    const __m128 weights = _mm_setr_ps(LUMINANCE_R, LUMINANCE_G, LUMINANCE_B, 0.0f);
+    const size_t rowBytes = (size_t)width * channels * sizeof(cl_float);
+
+    // begin and end count rows of the file
+    for(cl_uint y = begin; y < end; y++)
+    {
+        const cl_uchar *source = loader->mappedFile.data() + loader->dataOffset +
+                                 y * rowBytes;
+        cl_uint row = loader->flipRows ? loader->height - 1 - y : y;
+        cl_float *out = args->pixels + (size_t)row * width * 4;
+        __m128 sum = _mm_setzero_ps();
+        cl_uint x = 0;
+
+        // Four RGB pixels are three vectors r0g0b0r1 g1b1r2g2 b2r3g3b3
+        for(; channels == 3 && x + 4 <= width; x += 4, source += 48)
+        {
+            __m128 a = loadFloats(source, swap);
+            __m128 b = loadFloats(source + 16, swap);
+            __m128 c = loadFloats(source + 32, swap);
+
+            __m128 p0 = _mm_shuffle_ps(a, _mm_shuffle_ps(a, ones, _MM_SHUFFLE(0, 0, 3, 2)),
+                                       _MM_SHUFFLE(2, 0, 1, 0));
+            __m128 p1 = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 3, 3)),
+                                       _mm_shuffle_ps(b, ones, _MM_SHUFFLE(0, 0, 1, 1)),
+                                       _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 p2 = _mm_shuffle_ps(_mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 0, 3, 2)),
+                                       _mm_shuffle_ps(c, ones, _MM_SHUFFLE(0, 0, 0, 0)),
+                                       _MM_SHUFFLE(2, 0, 1, 0));
+            __m128 p3 = _mm_shuffle_ps(c, _mm_shuffle_ps(c, ones, _MM_SHUFFLE(0, 0, 3, 3)),
+                                       _MM_SHUFFLE(2, 0, 2, 1));
+
+            _mm_storeu_ps(out + 4 * x, p0);
+            _mm_storeu_ps(out + 4 * x + 4, p1);
+            _mm_storeu_ps(out + 4 * x + 8, p2);
+            _mm_storeu_ps(out + 4 * x + 12, p3);
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_add_ps(_mm_add_ps(p0, p1),
+                                             _mm_add_ps(p2, p3)), weights));
+        }
+
+        cl_double tail = 0;
+        for(; x < width; x++)
+        {
+            cl_float value[3] = {0, 0, 0};
+            for(cl_uint c = 0; c < channels; c++, source += 4)
+            {
+                cl_uchar bytes[4];
+                for(int k = 0; k < 4; k++)
+                {
+                    bytes[k] = source[swap ? 3 - k : k];
+                }
+                memcpy(&value[c], bytes, sizeof(cl_float));
+            }
+            cl_float *pixel = out + 4 * x;
+            pixel[0] = value[0];
+            pixel[1] = value[channels == 3 ? 1 : 0];
+            pixel[2] = value[channels == 3 ? 2 : 0];
+            pixel[3] = 1.0f;
+            tail += luminance(pixel);
+        }
+        loader->sums[y] = sumLanes(sum) + tail;
+    }
+}
+
+void
+HDRLoader::rgbeThread(void *data, unsigned int begin, unsigned int end,
+                      unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    HDRLoader *loader = args->loader;
+    const cl_uint width = loader->width;
+    const cl_uchar *file = loader->mappedFile.data();
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32(127 - 68);
+    const __m128 weights = _mm_setr_ps(LUMINANCE_R, LUMINANCE_G, LUMINANCE_B, 0.0f);
+    const __m128 alpha = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    const __m128 rgbMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    std::vector<cl_uchar> scanline((size_t)width * 4);
+
+    // begin and end count scanlines of the file
+    for(cl_uint y = begin; y < end; y++)
+    {
+        const cl_uchar *source = file + loader->offsets[y];
+
+        // Run-length scanlines hold each channel in turn, flat ones are read in place
+        if(isRunLength(file, loader->offsets[y], loader->mappedFile.size(), width))
+        {
+            source += 4;
+            for(int c = 0; c < 4; c++)
+            {
+                for(cl_uint x = 0; x < width; )
+                {
+                    cl_uint count = *source++;
+                    if(count > 128)
+                    {
+                        for(cl_uchar value = *source++; count > 128; count--, x++)
+                        {
+                            scanline[4 * x + c] = value;
+                        }
+                    }
+                    else
+                    {
+                        for(; count > 0; count--, x++)
+                        {
+                            scanline[4 * x + c] = *source++;
+                        }
+                    }
+                }
+            }
+            source = &scanline[0];
+        }
+
+        cl_uint row = loader->flipRows ? loader->height - 1 - y : y;
+        cl_float *out = args->pixels + (size_t)row * width * 4;
+        __m128 sum = _mm_setzero_ps();
+        for(cl_uint x = 0; x < width; x++, source += 4)
+        {
+            // m * 2^(e - 136) as two normal scales, exact like ldexp
+            int bytes;
+            memcpy(&bytes, source, sizeof(bytes));
+            __m128i rgbe = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes),
+                                              zero), zero);
+            __m128i e = _mm_shuffle_epi32(rgbe, _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i e1 = _mm_srli_epi32(e, 1);
+            __m128 scale1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(e1, bias), 23));
+            __m128 scale2 = _mm_castsi128_ps(_mm_slli_epi32(
+                                                 _mm_add_epi32(_mm_sub_epi32(e, e1), bias), 23));
+            __m128 value = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(rgbe), scale1), scale2);
+
+            // A zero exponent is black
+            __m128 keep = _mm_andnot_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(e, zero)), rgbMask);
+            value = _mm_or_ps(_mm_and_ps(value, keep), alpha);
+            _mm_storeu_ps(out + 4 * x, value);
+            sum = _mm_add_ps(sum, _mm_mul_ps(value, weights));
+        }
+        loader->sums[y] = sumLanes(sum);
+    }
+}
+
+int
+HDRLoader::decode(cl_float *pixels, cl_double *averageLuminance)
+{
+    if(pixels == NULL || mappedFile.data() == NULL || width == 0 || height == 0)
+    {
+        error("HDRLoader::decode() needs an image from open() and an output");
+        return SDK_FAILURE;
+    }
+
+    rangeArgs args;
+    args.loader = this;
+    args.pixels = pixels;
+    args.counting = false;
+
+    int status = SDK_SUCCESS;
+    if(format == FORMAT_TEXT)
+    {
+        status = decodeText(pixels);
+    }
+    else
+    {
+        sums.assign(height, 0.0);
+        if(!parallelFor(format == FORMAT_PFM ? pfmThread : rgbeThread, &args, height,
+                        numThreads))
+        {
+            error("HDRLoader could not create its threads");
+            status = SDK_FAILURE;
+        }
+    }
+
+    if(status == SDK_SUCCESS && averageLuminance != NULL)
+    {
+        cl_double total = 0;
+        for(size_t i = 0; i < sums.size(); i++)
+        {
+            total += sums[i];
+        }
+        *averageLuminance = total / ((cl_double)width * height);
+    }
+    close();
+    return status;
+}
@@ -0,0 +1,148 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef HDRLOADER_H_
+#define HDRLOADER_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKFile.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * HDRLoader
+ * Class implements a multi-threaded loader of HDR images into RGBA float
+ * pixels, from the text layout of the sample, PFM or Radiance RGBE files.
+ *
+ * The file is mapped rather than read, and threads decode it straight
+ * from the mapping into the pixels of the caller. The average luminance
+ * is summed by the same threads while their pixels are in cache.
+ */
+class HDRLoader
+{
+    public:
+
+        /**
+         * Layouts of the input file
+         */
+        enum Format
+        {
+            FORMAT_TEXT = 0,            /**< Width, height and RGBA floats as text */
+            FORMAT_PFM = 1,             /**< Portable float map, PF or Pf */
+            FORMAT_RGBE = 2             /**< Radiance RGBE, flat or run-length encoded */
+        };
+
+    private:
+
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+        SDKMappedFile mappedFile;       /**< Read-only mapping of the image file */
+        Format format;                  /**< Layout of the mapped file */
+        cl_uint width;                  /**< Width of the image */
+        cl_uint height;                 /**< Height of the image */
+        size_t dataOffset;              /**< First byte after the header */
+        cl_uint channels;               /**< Floats of a PFM pixel, 1 or 3 */
+        bool swapBytes;                 /**< PFM floats are not in host order */
+        bool flipRows;                  /**< File rows run bottom to top */
+        std::vector<size_t> offsets;    /**< Start of every RGBE scanline, or text chunk */
+        std::vector<size_t> counts;     /**< Tokens before every text chunk */
+        std::vector<cl_double> sums;    /**< Luminance sum of every work item */
+
+        struct rangeArgs;
+        static void textThread(void *data, unsigned int begin, unsigned int end,
+                               unsigned int threadId);
+        static void pfmThread(void *data, unsigned int begin, unsigned int end,
+                              unsigned int threadId);
+        static void rgbeThread(void *data, unsigned int begin, unsigned int end,
+                               unsigned int threadId);
+
+        int openText();
+        int openPFM();
+        int openRGBE();
+        int indexRGBE();
+        int decodeText(cl_float *pixels);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        HDRLoader()
+            : numThreads(0), format(FORMAT_TEXT), width(0), height(0),
+              dataOffset(0), channels(0), swapBytes(false), flipRows(false)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Maps an image file and reads its header, the format is found
+         * from the first bytes of the file
+         * @param fileName name of the image file
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int open(const char *fileName);
+
+        /**
+         * Decodes the image opened by open() and unmaps it. Rows run top to
+         * bottom, and the alpha of PFM and RGBE pixels is 1.
+         * @param pixels RGBA output, width * height * 4 floats
+         * @param averageLuminance mean Rec. 709 luminance of the pixels
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int decode(cl_float *pixels, cl_double *averageLuminance);
+
+        /**
+         * Unmaps the file
+         */
+        void close();
+
+        /**
+         * Returns the layout of the opened file
+         */
+        Format getFormat() const
+        {
+            return format;
+        }
+
+        /**
+         * Returns the width of the opened image
+         */
+        cl_uint getWidth() const
+        {
+            return width;
+        }
+
+        /**
+         * Returns the height of the opened image
+         */
+        cl_uint getHeight() const
+        {
+            return height;
+        }
+};
+
+#endif
@@ -511,6 +511,22 @@ HDRToneMapping::printStats()
         stats[3] = toString(kernelTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        std::string loadStrArray[2] = {"Load Time(sec)", "Load MPixels/sec"};
+        std::string loadStats[2];
+        loadStats[0] = toString(loadTime, std::dec);
+        loadStats[1] = toString(loadTime > 0 ? width * height / loadTime * 1e-6 : 0, std::dec);
+        printStatistics(loadStrArray, loadStats, 2);
+
+        if(hostTime > 0 || frameTime > 0)
+        {
+            std::string hostStrArray[3] = {"Host Time(sec)", "Host MPixels/sec", "Host Frame Time(sec)"};
+            std::string hostStats[3];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(hostTime > 0 ? width * height / hostTime * 1e-6 : 0, std::dec);
+            hostStats[2] = toString(frameTime, std::dec);
+            printStatistics(hostStrArray, hostStats, 3);
+        }
     }
 }
 
@@ -575,6 +591,62 @@ HDRToneMapping::initialize()
 
     delete gamma_option;
 
+    Option* input_option = new Option;
+    CHECK_ALLOCATION(input_option, "Memory Allocation error.\n");
+
+    input_option->_sVersion = "";
+    input_option->_lVersion = "input";
+    input_option->_description =
+        "Input image, as text, PFM or Radiance RGBE (default input.hdr)";
+    input_option->_type = CA_ARG_STRING;
+    input_option->_value = &inputImageName;
+
+    sampleArgs->AddOption(input_option);
+
+    delete input_option;
+
+    Option* num_threads = new Option;
+    CHECK_ALLOCATION(num_threads, "Memory Allocation error.\n");
+
+    num_threads->_sVersion = "";
+    num_threads->_lVersion = "threads";
+    num_threads->_description =
+        "Number of host threads of the image loader and tone mapper (0 uses every core)";
+    num_threads->_type = CA_ARG_INT;
+    num_threads->_value = &cpuThreads;
+
+    sampleArgs->AddOption(num_threads);
+
+    delete num_threads;
+
+    Option* frames_option = new Option;
+    CHECK_ALLOCATION(frames_option, "Memory Allocation error.\n");
+
+    frames_option->_sVersion = "";
+    frames_option->_lVersion = "frames";
+    frames_option->_description =
+        "Frames of a host video run at changing exposures (0 skips it)";
+    frames_option->_type = CA_ARG_INT;
+    frames_option->_value = &videoFrames;
+
+    sampleArgs->AddOption(frames_option);
+
+    delete frames_option;
+
+    Option* adaptation_option = new Option;
+    CHECK_ALLOCATION(adaptation_option, "Memory Allocation error.\n");
+
+    adaptation_option->_sVersion = "";
+    adaptation_option->_lVersion = "adaptation";
+    adaptation_option->_description =
+        "Weight of a new frame in the smoothed luminance of the video run (0 to 1)";
+    adaptation_option->_type = CA_ARG_FLOAT;
+    adaptation_option->_value = &adaptationRate;
+
+    sampleArgs->AddOption(adaptation_option);
+
+    delete adaptation_option;
+
     return SDK_SUCCESS;
 }
 
@@ -609,15 +681,18 @@ HDRToneMapping::setup()
 int
 HDRToneMapping::readInputImage()
 {
-    //Current implementations simply reads from the .txt. It should be changed later.
-    std::ifstream inputFile;
     std::cout << "Input file name " << inputImageName << std::endl;
-    inputFile.open(inputImageName.c_str(), std::ifstream::binary);
+    loader.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
 
-    if (inputFile.is_open())
+    // The file is mapped and only its header is read here
+    if (loader.open(inputImageName.c_str()) == SDK_SUCCESS)
     {
-        inputFile >> width;
-        inputFile >> height;
+        width = loader.getWidth();
+        height = loader.getHeight();
         if(sampleArgs->deviceType.compare("gpu") == 0)
         {
             input = new cl_float[height * width * sizeof(cl_float) * numChannels];
@@ -648,42 +723,25 @@ HDRToneMapping::readInputImage()
             CHECK_ALLOCATION(input, "Allocation failed(output)!!");
 #endif
         }
-
-        for (unsigned int y = 0; y < height; y++)
-        {
-            for (unsigned int x = 0; x < width; x++)
-            {
-                inputFile >> input[(y * width * numChannels) + (x * numChannels + 0)];
-                inputFile >> input[(y * width * numChannels) + (x * numChannels + 1)];
-                inputFile >> input[(y * width * numChannels) + (x * numChannels + 2)];
-                inputFile >> input[(y * width * numChannels) + (x * numChannels + 3)];
-            }
-        }
     }
     else
     {
         std::cout << "not able to open the file  " << inputImageName << std::endl;
         return SDK_FAILURE;
     }
-    std::cout << "Width of the image " << width << std::endl;
-    std::cout << "Height of the image " << height << std::endl;
-    inputFile.close();
-    //Calculating average luminance value
 
-    for (unsigned int y = 0; y < height; y++)
-    {
-        for (unsigned int x = 0; x < width; x++)
-        {
-            float r = input[(y * width * numChannels) + (x * numChannels + 0)];
-            float g = input[(y * width * numChannels) + (x * numChannels + 1)];
-            float b = input[(y * width * numChannels) + (x * numChannels + 2)];
+    // Threads decode the pixels and sum their luminance in one pass
+    cl_double average = 0;
+    int status = loader.decode(input, &average);
+    CHECK_ERROR(status, SDK_SUCCESS, "HDRLoader::decode() failed");
 
-            float luminance = (0.2126f * r ) + ( 0.7152f * g ) + ( 0.0722f * b );
-            averageLuminance += luminance;
-        }
-    }
+    sampleTimer->stopTimer(timer);
+    loadTime = (double)(sampleTimer->readTimer(timer));
 
-    averageLuminance = averageLuminance / (width * height);
+    std::cout << "Width of the image " << width << std::endl;
+    std::cout << "Height of the image " << height << std::endl;
+
+    averageLuminance = (cl_float)average;
     std::cout << "Average luminance value in the image " << averageLuminance <<
               std::endl;
     return SDK_SUCCESS;
@@ -824,112 +882,58 @@ HDRToneMapping::cleanup()
 int
 HDRToneMapping::cpuPattanaikReference()
 {
-    referenceOutput = new cl_float[height * width * numChannels];
-    CHECK_ALLOCATION(referenceOutput, "Allocation failed(referenceOutput)!!");
-
-    cl_float gcPattanaik = cPattanaik * averageLuminance;
-
-    for (unsigned int y = 0; y < height; y++)
+    // The output and the planes of the tone mapper are kept between calls
+    if (referenceOutput == NULL)
     {
-        for (unsigned int x = 0; x < width; x++)
-        {
-            cl_float yLPattanaik = 0.0f;
-            cl_float cLPattanaik = 0.0f;
-
-            cl_float r, g, b, r1, g1, b1;
-            //Finding R, G, B values of a pixel
-            r1 = input[y * width * numChannels + (x * numChannels + 0)];
-            g1 = input[y * width * numChannels + (x * numChannels + 1)];
-            b1 = input[y * width * numChannels + (x * numChannels + 2)];
-            //Calculating the luminance value
-            cl_float yLuminance = (0.2126f * r1) + (0.7152f * g1) + (0.0722f * b1);
-
-            if (x != 0 && y != 0 && x != width - 1 && y != height - 1)
-            {
-                //Calculating mean
-                float leftUp = 0.0f;
-                float up = 0.0f;
-                float rightUp = 0.0f;
-                float left = 0.0f;
-                float right = 0.0f;
-                float leftDown = 0.0f;
-                float down = 0.0f;
-                float rightDown = 0.0f;
-
-                r = input[width * numChannels * (y - 1) + (((x - 1) * numChannels) + 0 )];
-                g = input[width * numChannels * (y - 1) + ((x - 1) * numChannels) + 1 ];
-                b = input[width * numChannels * (y - 1) + ((x - 1) * numChannels) + 2 ];
-
-                leftUp = (0.2126f * r) + (0.7152f * g) + (0.0722f * b);
-
-                r = input[width * numChannels * (y - 1) + ((x) * numChannels) + 0 ];
-                g = input[width * numChannels * (y - 1) + ((x) * numChannels) + 1 ];
-                b = input[width * numChannels * (y - 1) + ((x) * numChannels) + 2 ];
-
-                up = (0.2126f * r) + (0.7152f * g) + (0.0722f * b);
-
-                r = input[width * numChannels * (y - 1) + ((x + 1) * numChannels) + 0 ];
-                g = input[width * numChannels * (y - 1) + ((x + 1) * numChannels) + 1 ];
-                b = input[width * numChannels * (y - 1) + ((x + 1) * numChannels) + 2 ];
-
-                rightUp = (0.2126f * r) + (0.7152f * g) + (0.0722f * b);
-
-                r = input[width * numChannels * (y) + ((x - 1) * numChannels) + 0 ];
-                g = input[width * numChannels * (y) + ((x - 1) * numChannels) + 1 ];
-                b = input[width * numChannels * (y) + ((x - 1) * numChannels) + 2 ];
-
-                left = (0.2126f * r) + (0.7152f * g) + (0.0722f * b);
-
-                r = input[width * numChannels * (y) + ((x + 1) * numChannels) + 0 ];
-                g = input[width * numChannels * (y) + ((x + 1) * numChannels) + 1 ];
-                b = input[width * numChannels * (y) + ((x + 1) * numChannels) + 2 ];
-
-                right = (0.2126f * r) + (0.7152f * g) + (0.0722f * b);
-
-                r = input[width * numChannels * (y + 1) + ((x - 1) * numChannels) + 0 ];
-                g = input[width * numChannels * (y + 1) + ((x - 1) * numChannels) + 1 ];
-                b = input[width * numChannels * (y + 1) + ((x - 1) * numChannels) + 2 ];
-
-                leftDown = (0.2126f * r) + (0.7152f * g) + (0.0722f * b);
-
-                r = input[width * numChannels * (y + 1) + ((x) * numChannels) + 0 ];
-                g = input[width * numChannels * (y + 1) + ((x) * numChannels) + 1 ];
-                b = input[width * numChannels * (y + 1) + ((x) * numChannels) + 2 ];
-
-                down = (0.2126f * r) + (0.7152f * g) + (0.0722f * b);
-
-                r = input[width * numChannels * (y + 1) + ((x + 1) * numChannels) + 0 ];
-                g = input[width * numChannels * (y + 1) + ((x + 1) * numChannels) + 1 ];
-                b = input[width * numChannels * (y + 1) + ((x + 1) * numChannels) + 2 ];
-
-                rightDown = (0.2126f * r) + (0.7152f * g) + (0.0722f * b);
-
-                //Calculate median
+        referenceOutput = new cl_float[height * width * numChannels];
+        CHECK_ALLOCATION(referenceOutput, "Allocation failed(referenceOutput)!!");
+    }
 
-                yLPattanaik = (leftUp + up + rightUp + left + right + leftDown + down +
-                               rightDown) / 8;
-            }
-            else
-            {
-                yLPattanaik = yLuminance;
-            }
+    toneMapper.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+    toneMapper.setParameters(cPattanaik, gammaPattanaik, deltaPattanaik);
+    int status = toneMapper.map(input, referenceOutput, width, height,
+                                averageLuminance);
+    CHECK_ERROR(status, SDK_SUCCESS, "PattanaikEngine::map() failed");
+    return SDK_SUCCESS;
+}
 
-            cLPattanaik =  yLPattanaik * log(deltaPattanaik + yLPattanaik / yLuminance) +
-                           gcPattanaik;
+int
+HDRToneMapping::runHostVideo()
+{
+    if (videoFrames <= 0)
+    {
+        return SDK_SUCCESS;
+    }
 
-            float yDPattanaik = yLuminance / (yLuminance + cLPattanaik);
+    size_t size = (size_t)width * height * numChannels;
+    std::vector<cl_float> frame(size);
+    std::vector<cl_float> mapped(size);
 
-            r = pow((r1 / yLuminance), gammaPattanaik) * yDPattanaik;
-            g = pow((g1 / yLuminance), gammaPattanaik) * yDPattanaik;
-            b = pow((b1 / yLuminance), gammaPattanaik) * yDPattanaik;
+    toneMapper.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+    toneMapper.setParameters(cPattanaik, gammaPattanaik, deltaPattanaik);
+    toneMapper.setAdaptationRate(adaptationRate);
+    toneMapper.resetAdaptation();
 
-            referenceOutput[width * numChannels * y + (x * numChannels + 0)] = r;
-            referenceOutput[width * numChannels * y + (x * numChannels + 1)] = g;
-            referenceOutput[width * numChannels * y + (x * numChannels + 2)] = b;
-            referenceOutput[width * numChannels * y + (x * numChannels + 3)] =
-                input[width * numChannels * y + (x * numChannels + 3)];
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    for (int i = 0; i < videoFrames; i++)
+    {
+        // The exposure of the frames swings between half and twice the input
+        cl_float exposure = (cl_float)pow(2.0, sin(i * 0.25));
+        for (size_t j = 0; j < size; j++)
+        {
+            frame[j] = (j % numChannels == 3) ? input[j] : input[j] * exposure;
         }
+
+        sampleTimer->startTimer(timer);
+        int status = toneMapper.mapFrame(&frame[0], &mapped[0], width, height);
+        sampleTimer->stopTimer(timer);
+        CHECK_ERROR(status, SDK_SUCCESS, "PattanaikEngine::mapFrame() failed");
     }
+    frameTime = (double)(sampleTimer->readTimer(timer)) / videoFrames;
+
+    std::cout << "Smoothed average luminance after " << videoFrames << " frames "
+              << toneMapper.getSmoothedLuminance() << std::endl;
     return SDK_SUCCESS;
 }
 
@@ -947,6 +951,7 @@ HDRToneMapping::verifyResults()
         sampleTimer->stopTimer(timer);
 
         double referenceTime = (double)sampleTimer->readTimer(timer);
+        hostTime = referenceTime;
 
         std::cout<<"Reference time is "<<referenceTime<<" secs"<<std::endl;
 
@@ -1072,6 +1077,12 @@ int main(int argc, char *argv[])
             return SDK_FAILURE;
         }
 
+        // Host video run
+        if(hdrObj->runHostVideo() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+
         // Cleanup
         if(hdrObj->cleanup() != SDK_SUCCESS)
         {
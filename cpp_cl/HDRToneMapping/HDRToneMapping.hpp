@@ -32,6 +32,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
 #include <CL/cl.hpp>
+#include "HDRLoader.hpp"
+#include "PattanaikEngine.hpp"
 
 using namespace appsdk;
 
@@ -71,6 +73,12 @@ class HDRToneMapping
             input = NULL;
             output = NULL;
             referenceOutput = NULL;
+            cpuThreads = 0;
+            loadTime = 0;
+            videoFrames = 0;
+            adaptationRate = 0.1f;
+            hostTime = 0;
+            frameTime = 0;
         }
 
         /**
@@ -101,11 +109,20 @@ class HDRToneMapping
 
         /**
         * \fn int cpuPattanaikReference();
-        * \brief CPU reference implementation of the pattanaik tone mapping operator
+        * \brief CPU reference implementation of the pattanaik tone mapping operator,
+        * runs the host SSE2 tone mapper into referenceOutput
         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
         int cpuPattanaikReference();
 
+        /**
+        * \fn int runHostVideo()
+        * \brief Maps --frames frames of the input at changing exposures on the
+        * host, with the smoothed average luminance of video mode
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+        */
+        int runHostVideo();
+
         /**
         * \fn int runCLKernels()
         * \brief Set values for kernels' arguments, enqueue calls to the kernels
@@ -163,7 +180,9 @@ class HDRToneMapping
 
         /**
         * \fn int readInputImage()
-        * \brief Reading the input image
+        * \brief Reading the input image, a text, PFM or Radiance RGBE file,
+        * and its average luminance
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
         int readInputImage();
 
@@ -207,6 +226,14 @@ class HDRToneMapping
         SDKDeviceInfo deviceInfo;/**< Structure to store device information*/
         KernelWorkGroupInfo kernelInfo;/**< Structure to store kernel related info */
         SDKTimer *sampleTimer;      /**< SDKTimer object */
+        HDRLoader loader;           /**< Mapped multi-threaded image loader */
+        int cpuThreads;             /**< Host threads, 0 uses every core */
+        cl_double loadTime;         /**< Time to load the input image */
+        PattanaikEngine toneMapper; /**< Host SSE2 Pattanaik operator */
+        int videoFrames;            /**< Frames of the host video run, 0 skips it */
+        cl_float adaptationRate;    /**< Weight of a new frame in the smoothed luminance */
+        cl_double hostTime;         /**< Time of the host tone mapper */
+        cl_double frameTime;        /**< Time of a host video frame */
 };
 
 #endif
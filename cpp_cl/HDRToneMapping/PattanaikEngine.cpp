@@ -0,0 +1,407 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "PattanaikEngine.hpp"
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+/*
+ * Floats before and after a plane, so that the loads of the first and
+ * last pixels stay inside it
+ */
+#define PLANE_PADDING 4
+
+/**
+ * Arguments of the luminance and mapping threads
+ */
+struct PattanaikEngine::rangeArgs
+{
+    PattanaikEngine *engine;
+    const cl_float *input;
+    cl_float *output;
+    cl_float gc;
+};
+
+/*
+ * Natural logarithm of four floats, with the polynomial of the Cephes
+ * logf. 0 gives -inf, negative values and NaN give NaN.
+ */
+static inline __m128
+logPs(__m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128i exponentMask = _mm_set1_epi32(0x7f800000);
+
+    // Denormals are scaled into the normal range first
+    __m128 tiny = _mm_cmplt_ps(x, _mm_set1_ps(1.17549435e-38f));
+    __m128 scaled = _mm_mul_ps(x, _mm_set1_ps(33554432.0f));
+    __m128 v = _mm_or_ps(_mm_and_ps(tiny, scaled), _mm_andnot_ps(tiny, x));
+
+    // v = m * 2^e with m in [0.5, 1)
+    __m128i bits = _mm_castps_si128(v);
+    __m128i e = _mm_sub_epi32(_mm_srli_epi32(_mm_and_si128(bits, exponentMask), 23),
+                              _mm_set1_epi32(126));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_andnot_si128(exponentMask, bits),
+                                _mm_castps_si128(_mm_set1_ps(0.5f))));
+    __m128 fe = _mm_sub_ps(_mm_cvtepi32_ps(e), _mm_and_ps(tiny, _mm_set1_ps(25.0f)));
+
+    // Keep m in [sqrt(0.5), sqrt(2))
+    __m128 small = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+    fe = _mm_sub_ps(fe, _mm_and_ps(small, one));
+    m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(small, m)), one);
+
+    __m128 z = _mm_mul_ps(m, m);
+    __m128 p = _mm_set1_ps(7.0376836292e-2f);
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-1.1514610310e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(1.1676998740e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-1.2420140846e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(1.4249322787e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-1.6668057665e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(2.0000714765e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-2.4999993993e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(3.3333331174e-1f));
+    __m128 y = _mm_mul_ps(_mm_mul_ps(p, m), z);
+    y = _mm_add_ps(y, _mm_mul_ps(fe, _mm_set1_ps(-2.12194440e-4f)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    __m128 result = _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(fe, _mm_set1_ps(0.693359375f)));
+
+    // Special values of x
+    const __m128 inf = _mm_set1_ps(INFINITY);
+    __m128 isZero = _mm_cmpeq_ps(x, _mm_setzero_ps());
+    __m128 isInf = _mm_cmpeq_ps(x, inf);
+    __m128 isNaN = _mm_or_ps(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_cmpunord_ps(x, x));
+    result = _mm_or_ps(_mm_andnot_ps(isZero, result), _mm_and_ps(isZero, _mm_sub_ps(
+                           _mm_setzero_ps(), inf)));
+    result = _mm_or_ps(_mm_andnot_ps(isInf, result), _mm_and_ps(isInf, inf));
+    return _mm_or_ps(result, isNaN);
+}
+
+/*
+ * Exponential of four floats, with the polynomial of the Cephes expf.
+ * Results below the smallest normal float are 0.
+ */
+static inline __m128
+expPs(__m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 overflow = _mm_cmpgt_ps(x, _mm_set1_ps(88.7228391116729996f));
+    __m128 underflow = _mm_cmplt_ps(x, _mm_set1_ps(-87.3365447505531f));
+    __m128 isNaN = _mm_cmpunord_ps(x, x);
+    __m128 v = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.3365447505531f)),
+                          _mm_set1_ps(88.7228391116729996f));
+
+    // v = n ln2 + r, with n = floor(v log2(e) + 0.5)
+    __m128 t = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(1.44269504088896341f)),
+                          _mm_set1_ps(0.5f));
+    __m128 n = _mm_cvtepi32_ps(_mm_cvttps_epi32(t));
+    n = _mm_sub_ps(n, _mm_and_ps(_mm_cmpgt_ps(n, t), one));
+    __m128 r = _mm_sub_ps(v, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 z = _mm_mul_ps(r, r);
+    __m128 p = _mm_set1_ps(1.9875691500e-4f);
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.3981999507e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+    __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p, z), r), one);
+
+    // 2^n as two normal factors, n is -126 to 128
+    __m128i n1 = _mm_cvttps_epi32(n);
+    __m128i n2 = _mm_srai_epi32(n1, 1);
+    const __m128i bias = _mm_set1_epi32(127);
+    __m128 scale1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n2, bias), 23));
+    __m128 scale2 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_sub_epi32(n1, n2),
+                                     bias), 23));
+    __m128 result = _mm_mul_ps(_mm_mul_ps(y, scale1), scale2);
+
+    result = _mm_andnot_ps(underflow, result);
+    result = _mm_or_ps(_mm_andnot_ps(overflow, result),
+                       _mm_and_ps(overflow, _mm_set1_ps(INFINITY)));
+    return _mm_or_ps(result, isNaN);
+}
+
+/*
+ * x^gamma as exp(gamma log(x)), 0 for x = 0 and a positive gamma
+ */
+static inline __m128
+powPs(__m128 x, __m128 gamma)
+{
+    return expPs(_mm_mul_ps(gamma, logPs(x)));
+}
+
+/*
+ * Luminance of four transposed pixels, in the order of the kernel
+ */
+static inline __m128
+luminancePs(__m128 r, __m128 g, __m128 b)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.2126f), r),
+                                 _mm_mul_ps(_mm_set1_ps(0.7152f), g)),
+                      _mm_mul_ps(_mm_set1_ps(0.0722f), b));
+}
+
+void
+PattanaikEngine::setParameters(cl_float c, cl_float gamma, cl_float delta)
+{
+    cPattanaik = c;
+    gammaPattanaik = gamma;
+    deltaPattanaik = delta;
+}
+
+void
+PattanaikEngine::setAdaptationRate(cl_float rate)
+{
+    adaptationRate = std::min(std::max(rate, 0.0f), 1.0f);
+}
+
+void
+PattanaikEngine::luminanceThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    PattanaikEngine *eng = args->engine;
+    const cl_uint width = eng->width;
+
+    // begin and end count rows
+    for(cl_uint y = begin; y < end; y++)
+    {
+        const cl_float *in = args->input + (size_t)y * width * 4;
+        cl_float *lum = &eng->luminance[PLANE_PADDING + (size_t)y * width];
+        cl_float *sum3 = &eng->rowSums[PLANE_PADDING + (size_t)y * width];
+
+        __m128 rowSum = _mm_setzero_ps();
+        cl_uint x = 0;
+        for(; x + 4 <= width; x += 4)
+        {
+            __m128 r = _mm_loadu_ps(in + 4 * x);
+            __m128 g = _mm_loadu_ps(in + 4 * x + 4);
+            __m128 b = _mm_loadu_ps(in + 4 * x + 8);
+            __m128 a = _mm_loadu_ps(in + 4 * x + 12);
+            _MM_TRANSPOSE4_PS(r, g, b, a);
+            __m128 l = luminancePs(r, g, b);
+            _mm_storeu_ps(lum + x, l);
+            rowSum = _mm_add_ps(rowSum, l);
+        }
+        cl_float lanes[4];
+        _mm_storeu_ps(lanes, rowSum);
+        cl_double total = (cl_double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        for(; x < width; x++)
+        {
+            const cl_float *p = in + 4 * x;
+            lum[x] = (0.2126f * p[0]) + (0.7152f * p[1]) + (0.0722f * p[2]);
+            total += lum[x];
+        }
+        eng->sums[y] = total;
+
+        // Sums of three neighbours, added left to right like the kernel
+        sum3[0] = 0;
+        x = 1;
+        for(; x + 4 <= width - 1; x += 4)
+        {
+            __m128 s = _mm_add_ps(_mm_loadu_ps(lum + x - 1), _mm_loadu_ps(lum + x));
+            _mm_storeu_ps(sum3 + x, _mm_add_ps(s, _mm_loadu_ps(lum + x + 1)));
+        }
+        for(; x + 1 < width; x++)
+        {
+            sum3[x] = (lum[x - 1] + lum[x]) + lum[x + 1];
+        }
+        sum3[width - 1] = 0;
+    }
+}
+
+void
+PattanaikEngine::mapThread(void *data, unsigned int begin, unsigned int end,
+                           unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const PattanaikEngine *eng = args->engine;
+    const cl_uint width = eng->width;
+    const cl_uint height = eng->height;
+
+    const __m128 gc = _mm_set1_ps(args->gc);
+    const __m128 gamma = _mm_set1_ps(eng->gammaPattanaik);
+    const __m128 delta = _mm_set1_ps(eng->deltaPattanaik);
+    const __m128 eighth = _mm_set1_ps(0.125f);
+    const __m128i lastColumn = _mm_set1_epi32((int)width - 1);
+    cl_float inTail[16], outTail[16];
+
+    // begin and end count rows
+    for(cl_uint y = begin; y < end; y++)
+    {
+        const cl_float *in = args->input + (size_t)y * width * 4;
+        cl_float *out = args->output + (size_t)y * width * 4;
+        const cl_float *lum = &eng->luminance[PLANE_PADDING + (size_t)y * width];
+        const bool borderRow = y == 0 || y == height - 1;
+        const cl_float *above = borderRow ? lum : &eng->rowSums[PLANE_PADDING +
+                                (size_t)(y - 1) * width];
+        const cl_float *below = borderRow ? lum : &eng->rowSums[PLANE_PADDING +
+                                (size_t)(y + 1) * width];
+
+        for(cl_uint x = 0; x < width; x += 4)
+        {
+            // The last pixels of a row go through a padded copy
+            cl_uint n = std::min(4u, width - x);
+            const cl_float *source = in + 4 * x;
+            cl_float *target = out + 4 * x;
+            if(n < 4)
+            {
+                std::fill(inTail, inTail + 16, 1.0f);
+                memcpy(inTail, source, n * 4 * sizeof(cl_float));
+                source = inTail;
+                target = outTail;
+            }
+
+            __m128 r = _mm_loadu_ps(source);
+            __m128 g = _mm_loadu_ps(source + 4);
+            __m128 b = _mm_loadu_ps(source + 8);
+            __m128 a = _mm_loadu_ps(source + 12);
+            _MM_TRANSPOSE4_PS(r, g, b, a);
+            __m128 yLum = _mm_loadu_ps(lum + x);
+
+            // Mean of the eight neighbours, borders use their own luminance
+            __m128 yL = yLum;
+            if(!borderRow)
+            {
+                __m128 sum = _mm_add_ps(_mm_loadu_ps(above + x), _mm_loadu_ps(lum + x - 1));
+                sum = _mm_add_ps(_mm_add_ps(sum, _mm_loadu_ps(lum + x + 1)),
+                                 _mm_loadu_ps(below + x));
+                __m128i column = _mm_add_epi32(_mm_set1_epi32((int)x),
+                                               _mm_setr_epi32(0, 1, 2, 3));
+                __m128 border = _mm_castsi128_ps(_mm_or_si128(
+                                                     _mm_cmpeq_epi32(column, _mm_setzero_si128()),
+                                                     _mm_cmpeq_epi32(column, lastColumn)));
+                yL = _mm_or_ps(_mm_and_ps(border, yLum),
+                               _mm_andnot_ps(border, _mm_mul_ps(sum, eighth)));
+            }
+
+            // One division gives the ratios of the pixel to its luminance
+            __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), yLum);
+            __m128 cL = _mm_add_ps(_mm_mul_ps(yL, logPs(_mm_add_ps(delta, _mm_mul_ps(yL, inverse)))),
+                                   gc);
+            __m128 yD = _mm_div_ps(yLum, _mm_add_ps(yLum, cL));
+            r = _mm_mul_ps(powPs(_mm_mul_ps(r, inverse), gamma), yD);
+            g = _mm_mul_ps(powPs(_mm_mul_ps(g, inverse), gamma), yD);
+            b = _mm_mul_ps(powPs(_mm_mul_ps(b, inverse), gamma), yD);
+
+            _MM_TRANSPOSE4_PS(r, g, b, a);
+            _mm_storeu_ps(target, r);
+            _mm_storeu_ps(target + 4, g);
+            _mm_storeu_ps(target + 8, b);
+            _mm_storeu_ps(target + 12, a);
+            if(n < 4)
+            {
+                memcpy(out + 4 * x, outTail, n * 4 * sizeof(cl_float));
+            }
+        }
+    }
+}
+
+int
+PattanaikEngine::buildPlanes(const cl_float *input, cl_uint width, cl_uint height)
+{
+    // The planes keep their memory while the frame size does not change
+    this->width = width;
+    this->height = height;
+    size_t planeSize = (size_t)width * height + 2 * PLANE_PADDING;
+    luminance.resize(planeSize, 0.0f);
+    rowSums.resize(planeSize, 0.0f);
+    sums.resize(height);
+
+    rangeArgs args;
+    args.engine = this;
+    args.input = input;
+    args.output = NULL;
+    args.gc = 0;
+    if(!parallelFor(luminanceThread, &args, height, numThreads))
+    {
+        error("PattanaikEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+int
+PattanaikEngine::mapPlanes(const cl_float *input, cl_float *output,
+                           cl_float averageLuminance)
+{
+    rangeArgs args;
+    args.engine = this;
+    args.input = input;
+    args.output = output;
+    args.gc = cPattanaik * averageLuminance;
+    if(!parallelFor(mapThread, &args, height, numThreads))
+    {
+        error("PattanaikEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+int
+PattanaikEngine::map(const cl_float *input, cl_float *output, cl_uint width,
+                     cl_uint height, cl_float averageLuminance)
+{
+    if(input == NULL || output == NULL || width == 0 || height == 0)
+    {
+        error("PattanaikEngine::map() needs an input and an output image");
+        return SDK_FAILURE;
+    }
+    if(buildPlanes(input, width, height) != SDK_SUCCESS)
+    {
+        return SDK_FAILURE;
+    }
+    return mapPlanes(input, output, averageLuminance);
+}
+
+int
+PattanaikEngine::mapFrame(const cl_float *input, cl_float *output, cl_uint width,
+                          cl_uint height)
+{
+    if(input == NULL || output == NULL || width == 0 || height == 0)
+    {
+        error("PattanaikEngine::mapFrame() needs an input and an output frame");
+        return SDK_FAILURE;
+    }
+    if(buildPlanes(input, width, height) != SDK_SUCCESS)
+    {
+        return SDK_FAILURE;
+    }
+
+    cl_double total = 0;
+    for(cl_uint y = 0; y < height; y++)
+    {
+        total += sums[y];
+    }
+    cl_double frameLuminance = total / ((cl_double)width * height);
+
+    // Exponential smoothing keeps the exposure from flickering
+    if(!hasHistory)
+    {
+        smoothedLuminance = frameLuminance;
+        hasHistory = true;
+    }
+    else
+    {
+        smoothedLuminance += adaptationRate * (frameLuminance - smoothedLuminance);
+    }
+    return mapPlanes(input, output, (cl_float)smoothedLuminance);
+}
@@ -0,0 +1,132 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef PATTANAIKENGINE_H_
+#define PATTANAIKENGINE_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * PattanaikEngine
+ * Class implements a multi-threaded SSE2 host Pattanaik tone mapping
+ * operator of RGBA float images, for single images and video frames.
+ *
+ * A first pass builds the luminance plane and the sums of every three
+ * horizontal neighbours, so the mean of the eight neighbours of a pixel
+ * is the sums of the rows above and below plus its left and right pixels.
+ * A second pass maps four pixels at a time with vector log and exp.
+ * Threads take blocks of rows, and the planes are kept between frames.
+ */
+class PattanaikEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+        cl_float cPattanaik;            /**< Scale of the average luminance */
+        cl_float gammaPattanaik;        /**< Exponent of the colour ratios */
+        cl_float deltaPattanaik;        /**< Offset inside the adaptation log */
+        cl_float adaptationRate;        /**< Weight of a new frame in the smoothed average */
+        cl_double smoothedLuminance;    /**< Smoothed average luminance of the video */
+        bool hasHistory;                /**< A video frame has been mapped */
+        cl_uint width;                  /**< Width of the planes */
+        cl_uint height;                 /**< Height of the planes */
+        std::vector<cl_float> luminance;    /**< Luminance plane, padded by 4 floats */
+        std::vector<cl_float> rowSums;      /**< Sums of three horizontal luminances */
+        std::vector<cl_double> sums;        /**< Luminance sum of every row */
+
+        struct rangeArgs;
+        static void luminanceThread(void *data, unsigned int begin, unsigned int end,
+                                    unsigned int threadId);
+        static void mapThread(void *data, unsigned int begin, unsigned int end,
+                              unsigned int threadId);
+
+        int buildPlanes(const cl_float *input, cl_uint width, cl_uint height);
+        int mapPlanes(const cl_float *input, cl_float *output, cl_float averageLuminance);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        PattanaikEngine()
+            : numThreads(0), cPattanaik(0.25f), gammaPattanaik(0.4f),
+              deltaPattanaik(0.000002f), adaptationRate(0.1f), smoothedLuminance(0),
+              hasHistory(false), width(0), height(0)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Sets the c, gamma and delta parameters of the operator
+         */
+        void setParameters(cl_float c, cl_float gamma, cl_float delta);
+
+        /**
+         * Sets the weight of a new frame in the smoothed average luminance
+         * of mapFrame(), 1 follows every frame at once
+         */
+        void setAdaptationRate(cl_float rate);
+
+        /**
+         * Forgets the smoothed average luminance, as after a cut
+         */
+        void resetAdaptation()
+        {
+            hasHistory = false;
+        }
+
+        /**
+         * Maps an image like the toneMappingPattanaik kernels
+         * @param input RGBA input, width * height * 4 floats
+         * @param output RGBA output, the alpha is copied
+         * @param averageLuminance average luminance of the image
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int map(const cl_float *input, cl_float *output, cl_uint width,
+                cl_uint height, cl_float averageLuminance);
+
+        /**
+         * Maps a video frame with the smoothed average luminance of the
+         * frames so far, which the luminance pass measures
+         * @param input RGBA input, width * height * 4 floats
+         * @param output RGBA output, the alpha is copied
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int mapFrame(const cl_float *input, cl_float *output, cl_uint width,
+                     cl_uint height);
+
+        /**
+         * Returns the smoothed average luminance used by the last mapFrame()
+         */
+        cl_float getSmoothedLuminance() const
+        {
+            return (cl_float)smoothedLuminance;
+        }
+};
+
+#endif
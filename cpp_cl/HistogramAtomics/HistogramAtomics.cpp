@@ -27,21 +27,19 @@ Histogram::calculateHostBin()
     int status = mapBuffer( inputBuffer, input, inputNBytes, CL_MAP_READ);
     CHECK_ERROR(status, SDK_SUCCESS, "Failed to map device buffer.(inputBuffer)");
 
-    cl_int *p = (cl_int*)input;
+    // Every byte of the input is one 8-bit sample
+    bool computed = hostHistogram.compute8((const unsigned char*)input,
+                                           inputNBytes, cpuhist);
 
-    memset(cpuhist, 0, sizeof(cl_uint) * NBINS);
+    status = unmapBuffer( inputBuffer, input);
+    CHECK_ERROR(status, SDK_SUCCESS, "Failed to unmap device buffer.(inputBuffer)");
 
-    for(unsigned int i = 0; i < inputNBytes / sizeof(cl_uint); i++)
+    if(!computed)
     {
-        cpuhist[ (p[i] >> 24) & 0xff ]++;
-        cpuhist[ (p[i] >> 16) & 0xff ]++;
-        cpuhist[ (p[i] >> 8) & 0xff ]++;
-        cpuhist[ (p[i] >> 0) & 0xff ]++;
+        std::cout << "Failed to compute the host histogram" << std::endl;
+        return SDK_FAILURE;
     }
 
-    status = unmapBuffer( inputBuffer, input);
-    CHECK_ERROR(status, SDK_SUCCESS, "Failed to unmap device buffer.(inputBuffer)");
-
     return SDK_SUCCESS;
 }
 
@@ -523,7 +521,8 @@ Histogram::verifyResults()
         /* reference implementation on host device
          * calculates the histogram bin on host
          */
-        calculateHostBin();
+        status = calculateHostBin();
+        CHECK_ERROR(status, SDK_SUCCESS, "Failed to compute the host histogram");
 
         status = mapBuffer( outputBuffer, output, sizeof(cl_uint) * NBINS, CL_MAP_READ);
         CHECK_ERROR(status, SDK_SUCCESS, "Failed to map device buffer.(outputBuff)");
@@ -25,6 +25,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <assert.h>
 #include <string.h>
 #include "CLUtil.hpp"
+#include "SDKHistogram.hpp"
 
 #define NBINS        256
 #define BITS_PER_PIX 8
@@ -63,6 +64,7 @@ class Histogram
         cl_mem   outputBuffer;
 
         cl_uint cpuhist[NBINS];
+        SDKHistogram hostHistogram;     /**< Multi-threaded host histogram */
 
         cl_context          context;
         cl_device_id        *devices;
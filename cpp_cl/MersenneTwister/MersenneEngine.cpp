@@ -0,0 +1,708 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "MersenneEngine.hpp"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+/*
+ * Bits of the SFMT19937 state, the degree of its characteristic polynomial
+ */
+#define SFMT_BITS (SFMT_N * 128)
+
+/*
+ * 64-bit words of a polynomial of degree below SFMT_BITS
+ */
+#define POLY_WORDS (SFMT_BITS / 64)
+
+/**
+ * Arguments of the generator threads
+ */
+struct MersenneEngine::rangeArgs
+{
+    MersenneEngine *engine;
+    const cl_uint *seeds;
+    cl_uint mulFactor;
+    cl_float *gaussian;
+    cl_uint *bits;
+    cl_uint seed;
+    cl_uint count;
+    cl_float *output;
+    bool normal;
+};
+
+/*
+ * log(x) of four positive normal floats
+ */
+static inline __m128 logPs(__m128 x)
+{
+    // x = 2^e * m with m in [sqrt(0.5), sqrt(2))
+    __m128i xi = _mm_castps_si128(x);
+    __m128i e = _mm_sub_epi32(_mm_srli_epi32(xi, 23), _mm_set1_epi32(126));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(xi, _mm_set1_epi32(0x007fffff)),
+                                             _mm_set1_epi32(0x3f000000)));
+    __m128 fe = _mm_cvtepi32_ps(e);
+
+    __m128 small = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+    fe = _mm_sub_ps(fe, _mm_and_ps(small, _mm_set1_ps(1.0f)));
+    m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(small, m)), _mm_set1_ps(1.0f));
+
+    __m128 z = _mm_mul_ps(m, m);
+    __m128 y = _mm_set1_ps(7.0376836292e-2f);
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+    y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+    y = _mm_add_ps(y, _mm_mul_ps(fe, _mm_set1_ps(-2.12194440e-4f)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    return _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(fe, _mm_set1_ps(0.693359375f)));
+}
+
+/*
+ * sin(2 pi u) and cos(2 pi u) of four floats in [0, 1]
+ */
+static inline void sinCos2PiPs(__m128 u, __m128 &s, __m128 &c)
+{
+    // u = q / 4 + f with |f| <= 1 / 8, the subtraction is exact
+    __m128i q = _mm_cvtps_epi32(_mm_mul_ps(u, _mm_set1_ps(4.0f)));
+    __m128 f = _mm_sub_ps(u, _mm_mul_ps(_mm_cvtepi32_ps(q), _mm_set1_ps(0.25f)));
+    __m128 x = _mm_mul_ps(f, _mm_set1_ps(6.28318530717958648f));
+    __m128 x2 = _mm_mul_ps(x, x);
+
+    __m128 sy = _mm_set1_ps(-1.9515295891e-4f);
+    sy = _mm_add_ps(_mm_mul_ps(sy, x2), _mm_set1_ps(8.3321608736e-3f));
+    sy = _mm_add_ps(_mm_mul_ps(sy, x2), _mm_set1_ps(-1.6666654611e-1f));
+    sy = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sy, x2), x), x);
+
+    __m128 cy = _mm_set1_ps(2.443315711809948e-5f);
+    cy = _mm_add_ps(_mm_mul_ps(cy, x2), _mm_set1_ps(-1.388731625493765e-3f));
+    cy = _mm_add_ps(_mm_mul_ps(cy, x2), _mm_set1_ps(4.166664568298827e-2f));
+    cy = _mm_mul_ps(_mm_mul_ps(cy, x2), x2);
+    cy = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, _mm_set1_ps(0.5f))), cy);
+
+    // Odd quadrants swap sine and cosine, the signs follow the quadrant
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)),
+                                                   _mm_set1_epi32(1)));
+    __m128 sinBase = _mm_or_ps(_mm_and_ps(swap, cy), _mm_andnot_ps(swap, sy));
+    __m128 cosBase = _mm_or_ps(_mm_and_ps(swap, sy), _mm_andnot_ps(swap, cy));
+    __m128i sinSign = _mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30);
+    __m128i cosSign = _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)),
+                                                   _mm_set1_epi32(2)), 30);
+    s = _mm_xor_ps(sinBase, _mm_castsi128_ps(sinSign));
+    c = _mm_xor_ps(cosBase, _mm_castsi128_ps(cosSign));
+}
+
+/*
+ * Low 32 bits of the lane products, SSE2 only multiplies even lanes
+ */
+static inline __m128i mulLoEpi32(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/*
+ * Unsigned ints to the nearest floats, the sum of the halves rounds once
+ */
+static inline __m128 uintToFloatPs(__m128i u)
+{
+    __m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(u, 16));
+    __m128 lo = _mm_cvtepi32_ps(_mm_and_si128(u, _mm_set1_epi32(0xffff)));
+    return _mm_add_ps(_mm_mul_ps(hi, _mm_set1_ps(65536.0f)), lo);
+}
+
+/*
+ * Recursion of SFMT19937: a ^ (a << 8) ^ ((b >> 11) & mask) ^ (c >> 8) ^ (d << 18),
+ * 128-bit shifts for a and c, 32-bit shifts for b and d
+ */
+static inline __m128i sfmtRecursion(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+    const __m128i mask = _mm_setr_epi32(0xdfffffef, 0xddfecb7f, 0xbffaffff, 0xbffffff6);
+    __m128i t = _mm_xor_si128(a, _mm_slli_si128(a, 1));
+    t = _mm_xor_si128(t, _mm_and_si128(_mm_srli_epi32(b, 11), mask));
+    t = _mm_xor_si128(t, _mm_srli_si128(c, 1));
+    return _mm_xor_si128(t, _mm_slli_epi32(d, 18));
+}
+
+/*
+ * Recursion of the gaussianRand kernel
+ */
+static inline __m128i kernelRecursion(__m128i a, __m128i b, __m128i r1, __m128i r2)
+{
+    const __m128i mask = _mm_setr_epi32(0xfdff37ff, 0xef7f3f7d, 0xff777b7d, 0x7ff7fb2f);
+    __m128i t = _mm_xor_si128(a, _mm_slli_si128(a, 3));
+    t = _mm_xor_si128(t, _mm_and_si128(_mm_srli_epi32(b, 13), mask));
+    t = _mm_xor_si128(t, _mm_srli_si128(r1, 3));
+    return _mm_xor_si128(t, _mm_slli_epi32(r2, 15));
+}
+
+/*
+ * Box-Muller transform of two uniforms in (0, 1]
+ */
+static inline void boxMuller(__m128 u1, __m128 u2, __m128 &gaussian1, __m128 &gaussian2)
+{
+    __m128 r = _mm_sqrt_ps(_mm_mul_ps(_mm_set1_ps(-2.0f), logPs(u1)));
+    __m128 sinPhi, cosPhi;
+    sinCos2PiPs(u2, sinPhi, cosPhi);
+    gaussian1 = _mm_mul_ps(r, cosPhi);
+    gaussian2 = _mm_mul_ps(r, sinPhi);
+}
+
+/*
+ * 24-bit uniforms in (0, 1), exact in float
+ */
+static inline __m128 uniformPs(__m128i x)
+{
+    __m128 u = _mm_cvtepi32_ps(_mm_srli_epi32(x, 8));
+    return _mm_mul_ps(_mm_add_ps(u, _mm_set1_ps(0.5f)), _mm_set1_ps(1.0f / 16777216.0f));
+}
+
+inline __m128i
+SFMTEngine::step()
+{
+    cl_uint b = pos + SFMT_POS1;
+    cl_uint c = pos + SFMT_N - 2;
+    cl_uint d = pos + SFMT_N - 1;
+    b = (b >= SFMT_N) ? b - SFMT_N : b;
+    c = (c >= SFMT_N) ? c - SFMT_N : c;
+    d = (d >= SFMT_N) ? d - SFMT_N : d;
+
+    __m128i r = sfmtRecursion(state[pos], state[b], state[c], state[d]);
+    state[pos] = r;
+    pos = (pos + 1 == SFMT_N) ? 0 : pos + 1;
+    return r;
+}
+
+cl_uint
+SFMTEngine::nextBit()
+{
+    return _mm_cvtsi128_si32(step()) & 1;
+}
+
+void
+SFMTEngine::stepAll(__m128i *output)
+{
+    // A whole turn of the ring from word 0, as sfmt_gen_rand_all()
+    __m128i r1 = state[SFMT_N - 2];
+    __m128i r2 = state[SFMT_N - 1];
+    int i;
+    for(i = 0; i < SFMT_N - SFMT_POS1; i++)
+    {
+        state[i] = sfmtRecursion(state[i], state[i + SFMT_POS1], r1, r2);
+        r1 = r2;
+        r2 = state[i];
+    }
+    for(; i < SFMT_N; i++)
+    {
+        state[i] = sfmtRecursion(state[i], state[i + SFMT_POS1 - SFMT_N], r1, r2);
+        r1 = r2;
+        r2 = state[i];
+    }
+    memcpy(output, state, sizeof(state));
+}
+
+void
+SFMTEngine::seed(cl_uint s)
+{
+    cl_uint *p = (cl_uint*)state;
+    p[0] = s;
+    for(cl_uint i = 1; i < 4 * SFMT_N; i++)
+    {
+        p[i] = 1812433253u * (p[i - 1] ^ (p[i - 1] >> 30)) + i;
+    }
+    pos = 0;
+
+    // Period certification: the parity vector must see an odd state
+    const cl_uint parity[4] = {0x00000001u, 0x00000000u, 0x00000000u, 0x13c9e684u};
+    cl_uint inner = 0;
+    for(int i = 0; i < 4; i++)
+    {
+        inner ^= p[i] & parity[i];
+    }
+    for(int i = 16; i > 0; i >>= 1)
+    {
+        inner ^= inner >> i;
+    }
+    if(inner & 1)
+    {
+        return;
+    }
+    for(int i = 0; i < 4; i++)
+    {
+        for(int j = 0; j < 32; j++)
+        {
+            if(parity[i] & (1u << j))
+            {
+                p[i] ^= 1u << j;
+                return;
+            }
+        }
+    }
+}
+
+void
+SFMTEngine::fill(cl_uint *output, size_t count)
+{
+    __m128i *out = (__m128i*)output;
+    while(count > 0)
+    {
+        if(pos == 0 && count >= SFMT_N)
+        {
+            stepAll(out);
+            out += SFMT_N;
+            count -= SFMT_N;
+        }
+        else
+        {
+            _mm_storeu_si128(out++, step());
+            count--;
+        }
+    }
+}
+
+void
+SFMTEngine::uniform(cl_float *output, size_t count)
+{
+    for(size_t i = 0; i < count; i += 4)
+    {
+        _mm_storeu_ps(output + i, uniformPs(step()));
+    }
+}
+
+void
+SFMTEngine::normal(cl_float *output, size_t count)
+{
+    for(size_t i = 0; i < count; i += 8)
+    {
+        __m128 u1 = uniformPs(step());
+        __m128 u2 = uniformPs(step());
+        __m128 gaussian1, gaussian2;
+        boxMuller(u1, u2, gaussian1, gaussian2);
+        _mm_storeu_ps(output + i, gaussian1);
+        _mm_storeu_ps(output + i + 4, gaussian2);
+    }
+}
+
+void
+SFMTEngine::jump(const std::vector<cl_ulong> &poly)
+{
+    // Sum of T^i(state) over the terms x^i of poly, T being one step
+    __m128i sum[SFMT_N];
+    for(int k = 0; k < SFMT_N; k++)
+    {
+        sum[k] = _mm_setzero_si128();
+    }
+
+    int degree = (int)poly.size() * 64;
+    while(degree > 0 && !((poly[(degree - 1) >> 6] >> ((degree - 1) & 63)) & 1))
+    {
+        degree--;
+    }
+    for(int i = 0; i < degree; i++)
+    {
+        if((poly[i >> 6] >> (i & 63)) & 1)
+        {
+            // Words in ring order, oldest first
+            for(cl_uint k = 0, p = pos; k < SFMT_N; k++)
+            {
+                sum[k] = _mm_xor_si128(sum[k], state[p]);
+                p = (p + 1 == SFMT_N) ? 0 : p + 1;
+            }
+        }
+        step();
+    }
+
+    memcpy(state, sum, sizeof(state));
+    pos = 0;
+}
+
+/*
+ * Spreads the 8 bits of a byte over the even bits of 16, for squaring
+ */
+static cl_ushort spreadByte(cl_uint b)
+{
+    cl_ushort r = 0;
+    for(int i = 0; i < 8; i++)
+    {
+        r |= ((b >> i) & 1) << (2 * i);
+    }
+    return r;
+}
+
+void
+MersenneEngine::findCharPoly()
+{
+    if(!charPoly.empty())
+    {
+        return;
+    }
+
+    /**
+     * Berlekamp-Massey on bit 0 of the outputs. The minimal polynomial of
+     * a state may be a divisor of the characteristic polynomial when the
+     * state has no component in some invariant subspace, so seeds are
+     * tried until one gives the full degree.
+     */
+    const int n = 2 * SFMT_BITS;
+    const int words = n / 64 + 2;
+    std::vector<cl_ulong> reversed(words + 1);
+    std::vector<cl_ulong> c(words), b(words), t(words);
+
+    for(cl_uint s = 1; charPoly.empty(); s++)
+    {
+        SFMTEngine engine;
+        engine.seed(s);
+        std::fill(reversed.begin(), reversed.end(), 0);
+        for(int i = 0; i < n; i++)
+        {
+            int k = n - 1 - i;
+            reversed[k >> 6] |= (cl_ulong)engine.nextBit() << (k & 63);
+        }
+
+        std::fill(c.begin(), c.end(), 0);
+        std::fill(b.begin(), b.end(), 0);
+        c[0] = 1;
+        b[0] = 1;
+        int length = 0;
+        int m = 1;
+        for(int i = 0; i < n; i++)
+        {
+            // Discrepancy: sum of c_j s_(i - j), s_(i - j) is bit n - 1 - i + j
+            int offset = n - 1 - i;
+            int shift = offset & 63;
+            const cl_ulong *r = &reversed[offset >> 6];
+            cl_ulong acc = 0;
+            for(int w = 0; w <= (length >> 6); w++)
+            {
+                cl_ulong window = shift ? (r[w] >> shift) | (r[w + 1] << (64 - shift)) : r[w];
+                acc ^= c[w] & window;
+            }
+            acc ^= acc >> 32;
+            acc ^= acc >> 16;
+            acc ^= acc >> 8;
+            acc ^= acc >> 4;
+            acc ^= acc >> 2;
+            acc ^= acc >> 1;
+            if(!(acc & 1))
+            {
+                m++;
+                continue;
+            }
+
+            // c ^= b * x^m
+            t = c;
+            int wordShift = m >> 6;
+            int bitShift = m & 63;
+            int top = std::min(words - 1, (std::max(length, i + 1 - length) >> 6) + 1);
+            for(int w = top; w >= wordShift; w--)
+            {
+                cl_ulong v = b[w - wordShift] << bitShift;
+                if(bitShift && w - wordShift > 0)
+                {
+                    v |= b[w - wordShift - 1] >> (64 - bitShift);
+                }
+                c[w] ^= v;
+            }
+            if(2 * length <= i)
+            {
+                length = i + 1 - length;
+                b.swap(t);
+                m = 1;
+            }
+            else
+            {
+                m++;
+            }
+        }
+
+        if(length == SFMT_BITS)
+        {
+            // The characteristic polynomial is the reciprocal of c
+            charPoly.assign(POLY_WORDS + 1, 0);
+            for(int j = 0; j <= length; j++)
+            {
+                if((c[j >> 6] >> (j & 63)) & 1)
+                {
+                    int k = length - j;
+                    charPoly[k >> 6] |= (cl_ulong)1 << (k & 63);
+                }
+            }
+        }
+    }
+}
+
+void
+MersenneEngine::jumpPolynomial(cl_uint log2Steps, std::vector<cl_ulong> &poly)
+{
+    findCharPoly();
+
+    // charPoly shifted by 0 to 63 bits, so reductions only XOR whole words
+    std::vector<cl_ulong> shifted(64 * (POLY_WORDS + 2), 0);
+    for(int s = 0; s < 64; s++)
+    {
+        cl_ulong *dst = &shifted[s * (POLY_WORDS + 2)];
+        for(int w = 0; w <= POLY_WORDS; w++)
+        {
+            dst[w] |= charPoly[w] << s;
+            if(s)
+            {
+                dst[w + 1] |= charPoly[w] >> (64 - s);
+            }
+        }
+    }
+
+    cl_ushort spread[256];
+    for(cl_uint i = 0; i < 256; i++)
+    {
+        spread[i] = spreadByte(i);
+    }
+
+    // x^(2^k) by k squarings of x, reducing each square
+    poly.assign(POLY_WORDS, 0);
+    poly[0] = 2;
+    std::vector<cl_ulong> square(2 * POLY_WORDS + 2);
+    for(cl_uint k = 0; k < log2Steps; k++)
+    {
+        for(int w = 0; w < POLY_WORDS; w++)
+        {
+            cl_ulong lo = 0;
+            cl_ulong hi = 0;
+            for(int byte = 0; byte < 4; byte++)
+            {
+                lo |= (cl_ulong)spread[(poly[w] >> (8 * byte)) & 0xff] << (16 * byte);
+                hi |= (cl_ulong)spread[(poly[w] >> (32 + 8 * byte)) & 0xff] << (16 * byte);
+            }
+            square[2 * w] = lo;
+            square[2 * w + 1] = hi;
+        }
+        square[2 * POLY_WORDS] = 0;
+        square[2 * POLY_WORDS + 1] = 0;
+
+        for(int bit = 2 * SFMT_BITS - 2; bit >= SFMT_BITS; bit--)
+        {
+            if((square[bit >> 6] >> (bit & 63)) & 1)
+            {
+                int s = bit - SFMT_BITS;
+                const cl_ulong *src = &shifted[(s & 63) * (POLY_WORDS + 2)];
+                cl_ulong *dst = &square[s >> 6];
+                for(int w = 0; w < POLY_WORDS + 2; w++)
+                {
+                    dst[w] ^= src[w];
+                }
+            }
+        }
+        std::copy(square.begin(), square.begin() + POLY_WORDS, poly.begin());
+    }
+}
+
+void
+MersenneEngine::setSpacing(cl_uint log2Steps)
+{
+    if(log2Steps != spacing)
+    {
+        spacing = log2Steps;
+        jumpPolys.clear();
+    }
+}
+
+void
+MersenneEngine::kernelThread(void *data, unsigned int begin, unsigned int end,
+                             unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const __m128i stateMask = _mm_set1_epi32(1812433253);
+    const __m128 scale = _mm_set1_ps(1.0f / 4294967296.0f);
+    const __m128 infinity = _mm_set1_ps(HUGE_VALF);
+
+    for(unsigned int w = begin; w < end; w++)
+    {
+        __m128i state[5];
+        state[0] = _mm_loadu_si128((const __m128i*)(args->seeds + 4 * w));
+        for(int i = 1; i < 5; i++)
+        {
+            __m128i x = _mm_xor_si128(state[i - 1], _mm_srli_epi32(state[i - 1], 30));
+            state[i] = _mm_add_epi32(mulLoEpi32(stateMask, x), _mm_set1_epi32(i));
+        }
+
+        // Operands of the kernel's switch, a, b, r1 and r2 of each output
+        __m128i temp[8];
+        temp[0] = kernelRecursion(state[0], state[2], state[3], state[4]);
+        temp[1] = kernelRecursion(state[1], state[3], state[4], temp[0]);
+        for(cl_uint i = 2; i < args->mulFactor; i++)
+        {
+            __m128i a = (i < 5) ? state[i] : temp[i - 5];
+            __m128i b = (i < 3) ? state[i + 2] : (i < 5) ? state[i - 3] : temp[i - 3];
+            temp[i] = kernelRecursion(a, b, temp[i - 2], temp[i - 1]);
+        }
+
+        if(args->bits != NULL)
+        {
+            for(cl_uint i = 0; i < args->mulFactor; i++)
+            {
+                _mm_storeu_si128((__m128i*)(args->bits + 4 * (w * args->mulFactor + i)),
+                                 temp[i]);
+            }
+        }
+
+        // Pairs overlap as in the kernel: temp[i] and temp[i + 1]
+        cl_float *out = args->gaussian + 4 * w * args->mulFactor;
+        for(cl_uint i = 0; i < args->mulFactor / 2; i++)
+        {
+            __m128 u1 = _mm_mul_ps(uintToFloatPs(temp[i]), scale);
+            __m128 u2 = _mm_mul_ps(uintToFloatPs(temp[i + 1]), scale);
+
+            // log(0) is -inf in the kernel, so r is +inf
+            __m128 zero = _mm_cmpeq_ps(u1, _mm_setzero_ps());
+            __m128 gaussian1, gaussian2;
+            boxMuller(_mm_max_ps(u1, scale), u2, gaussian1, gaussian2);
+            if(_mm_movemask_ps(zero))
+            {
+                __m128 sinPhi, cosPhi;
+                sinCos2PiPs(u2, sinPhi, cosPhi);
+                gaussian1 = _mm_or_ps(_mm_andnot_ps(zero, gaussian1),
+                                      _mm_and_ps(zero, _mm_mul_ps(infinity, cosPhi)));
+                gaussian2 = _mm_or_ps(_mm_andnot_ps(zero, gaussian2),
+                                      _mm_and_ps(zero, _mm_mul_ps(infinity, sinPhi)));
+            }
+            _mm_storeu_ps(out + 8 * i, gaussian1);
+            _mm_storeu_ps(out + 8 * i + 4, gaussian2);
+        }
+    }
+}
+
+int
+MersenneEngine::kernelRandom(const cl_uint *seeds, cl_uint numSeeds, cl_uint mulFactor,
+                             cl_float *gaussian, cl_uint *bits)
+{
+    if(seeds == NULL || gaussian == NULL)
+    {
+        error("MersenneEngine::kernelRandom() needs seeds and an output");
+        return SDK_FAILURE;
+    }
+    if(mulFactor < 2 || mulFactor > 8 || mulFactor % 2)
+    {
+        error("MersenneEngine::kernelRandom() needs an even mulFactor from 2 to 8");
+        return SDK_FAILURE;
+    }
+    if(numSeeds == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    rangeArgs args;
+    args.engine = this;
+    args.seeds = seeds;
+    args.mulFactor = mulFactor;
+    args.gaussian = gaussian;
+    args.bits = bits;
+
+    unsigned int threads = numThreads ? numThreads : getNumCPUCores();
+    if(!parallelFor(kernelThread, &args, numSeeds, std::min(threads, numSeeds)))
+    {
+        error("MersenneEngine::kernelRandom() could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+void
+MersenneEngine::streamThread(void *data, unsigned int begin, unsigned int end,
+                             unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const std::vector< std::vector<cl_ulong> > &jumps = args->engine->jumpPolys;
+
+    // Jump to the first stream of the range, then one stream at a time
+    SFMTEngine start;
+    start.seed(args->seed);
+    for(cl_uint j = 0; (begin >> j) != 0; j++)
+    {
+        if((begin >> j) & 1)
+        {
+            start.jump(jumps[j]);
+        }
+    }
+
+    for(unsigned int s = begin; s < end; s++)
+    {
+        if(s != begin)
+        {
+            start.jump(jumps[0]);
+        }
+        SFMTEngine generator = start;
+        cl_float *out = args->output + (size_t)s * args->count;
+        if(args->normal)
+        {
+            generator.normal(out, args->count);
+        }
+        else
+        {
+            generator.uniform(out, args->count);
+        }
+    }
+}
+
+int
+MersenneEngine::streams(cl_uint seed, cl_uint numStreams, cl_uint count, cl_float *output,
+                        bool normal)
+{
+    if(output == NULL || count % 8)
+    {
+        error("MersenneEngine::streams() needs an output and a multiple of 8 numbers");
+        return SDK_FAILURE;
+    }
+    if(numStreams == 0)
+    {
+        return SDK_SUCCESS;
+    }
+
+    // x^(2^(spacing + j)) for every bit j of the stream indices
+    while((numStreams - 1) >> jumpPolys.size())
+    {
+        jumpPolys.push_back(std::vector<cl_ulong>());
+        jumpPolynomial(spacing + (cl_uint)jumpPolys.size() - 1, jumpPolys.back());
+    }
+    if(jumpPolys.empty())
+    {
+        jumpPolys.push_back(std::vector<cl_ulong>());
+        jumpPolynomial(spacing, jumpPolys.back());
+    }
+
+    rangeArgs args;
+    args.engine = this;
+    args.seed = seed;
+    args.count = count;
+    args.output = output;
+    args.normal = normal;
+
+    unsigned int threads = numThreads ? numThreads : getNumCPUCores();
+    if(!parallelFor(streamThread, &args, numStreams, std::min(threads, numStreams)))
+    {
+        error("MersenneEngine::streams() could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef MERSENNEENGINE_H_
+#define MERSENNEENGINE_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include <emmintrin.h>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+#define SFMT_N 156            ///< 128-bit words of the SFMT19937 state
+#define SFMT_POS1 122         ///< Pick up position of the recursion
+
+/**
+ * SFMTEngine
+ * Class implements the SFMT19937 generator of Saito and Matsumoto with
+ * SSE2. The sequence matches the reference sfmt_init_gen_rand() /
+ * sfmt_genrand_uint32() implementation for the same seed.
+ *
+ * The state is a ring of SFMT_N 128-bit words, each step replaces the
+ * oldest word by the next output. Every step is linear over GF(2), so
+ * jump() moves the state ahead by any number of steps given the
+ * polynomial x^steps modulo the characteristic polynomial.
+ */
+class SFMTEngine
+{
+        __m128i state[SFMT_N];          /**< Ring of state words */
+        cl_uint pos;                    /**< Oldest word, replaced by the next step */
+
+        __m128i step();
+        void stepAll(__m128i *output);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        SFMTEngine()
+            : pos(0)
+        {
+            seed(5489u);
+        }
+
+        /**
+         * Initializes the state from a seed, with period certification
+         */
+        void seed(cl_uint s);
+
+        /**
+         * Writes the next count 128-bit outputs, four 32-bit numbers each
+         */
+        void fill(cl_uint *output, size_t count);
+
+        /**
+         * Writes count uniform floats in (0, 1), count a multiple of 4
+         */
+        void uniform(cl_float *output, size_t count);
+
+        /**
+         * Writes count standard normal floats with the Box-Muller transform,
+         * count a multiple of 8
+         */
+        void normal(cl_float *output, size_t count);
+
+        /**
+         * Moves the state ahead by the steps whose polynomial is given
+         * @param poly x^steps modulo the characteristic polynomial, as made
+         *        by MersenneEngine
+         */
+        void jump(const std::vector<cl_ulong> &poly);
+
+        /**
+         * Output of bit 0 of the next step, used to find the characteristic
+         * polynomial
+         */
+        cl_uint nextBit();
+};
+
+/**
+ * MersenneEngine
+ * Class implements the multi-threaded host generators of the
+ * MersenneTwister sample.
+ *
+ * kernelRandom() runs the gaussianRand kernel's recurrence for every seed,
+ * one seed per SSE2 register. Its integer outputs, and so its uniforms,
+ * are bit-exact with the kernel. The normals only differ by the rounding
+ * of log, sqrt, sin and cos.
+ *
+ * streams() draws from independent SFMT19937 streams of one seed. Stream s
+ * starts s * 2^spacing steps ahead of the seeded state, so streams cannot
+ * overlap before 2^spacing steps. The jumps use the characteristic
+ * polynomial of SFMT19937, found once with the Berlekamp-Massey algorithm,
+ * and the results do not depend on the number of threads.
+ */
+class MersenneEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+        cl_uint spacing;                /**< log2 of the steps between streams */
+        std::vector<cl_ulong> charPoly;     /**< Characteristic polynomial of SFMT19937 */
+        std::vector< std::vector<cl_ulong> > jumpPolys; /**< x^(2^(spacing + j)) mod charPoly */
+
+        struct rangeArgs;
+        static void kernelThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId);
+        static void streamThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId);
+        void findCharPoly();
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        MersenneEngine()
+            : numThreads(0),
+              spacing(64)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Sets log2 of the number of steps between streams
+         */
+        void setSpacing(cl_uint log2Steps);
+
+        /**
+         * Computes x^(2^log2Steps) modulo the characteristic polynomial
+         * @param log2Steps log2 of the steps of the jump
+         * @param poly output polynomial, for SFMTEngine::jump()
+         */
+        void jumpPolynomial(cl_uint log2Steps, std::vector<cl_ulong> &poly);
+
+        /**
+         * Reproduces the gaussianRand kernel
+         * @param seeds numSeeds uint4 seeds, one per work-item
+         * @param numSeeds number of work-items
+         * @param mulFactor float4 outputs per work-item, even, 2 to 8
+         * @param gaussian output, numSeeds * mulFactor float4
+         * @param bits optional output of the integer numbers of the kernel,
+         *        numSeeds * mulFactor uint4, may be NULL
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int kernelRandom(const cl_uint *seeds, cl_uint numSeeds, cl_uint mulFactor,
+                         cl_float *gaussian, cl_uint *bits = NULL);
+
+        /**
+         * Fills output with count numbers of each of numStreams streams
+         * @param seed seed of stream 0
+         * @param count numbers per stream, a multiple of 8
+         * @param output numStreams * count floats, stream major
+         * @param normal standard normal numbers if true, else uniform in (0, 1)
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int streams(cl_uint seed, cl_uint numStreams, cl_uint count, cl_float *output,
+                    bool normal);
+};
+
+#endif
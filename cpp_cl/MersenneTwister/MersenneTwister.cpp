@@ -16,6 +16,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 
 #include "MersenneTwister.hpp"
+#include <float.h>
+#include <algorithm>
 
 int
 MersenneTwister::setupMersenneTwister()
@@ -374,11 +376,44 @@ int MersenneTwister::initialize()
     sampleArgs->AddOption(iteration_option);
     delete iteration_option;
 
+    Option* threads_option = new Option;
+    CHECK_ALLOCATION(threads_option, "Memory Allocation error.\n");
+
+    threads_option->_sVersion = "";
+    threads_option->_lVersion = "threads";
+    threads_option->_description =
+        "Number of host threads of the host generators (0 uses every core)";
+    threads_option->_type = CA_ARG_INT;
+    threads_option->_value = &cpuThreads;
+
+    sampleArgs->AddOption(threads_option);
+    delete threads_option;
+
+    Option* streams_option = new Option;
+    CHECK_ALLOCATION(streams_option, "Memory Allocation error.\n");
+
+    streams_option->_sVersion = "";
+    streams_option->_lVersion = "streams";
+    streams_option->_description =
+        "Also draw the same amount of numbers from this many jumped SFMT19937 "
+        "streams on the host";
+    streams_option->_type = CA_ARG_INT;
+    streams_option->_value = &numStreams;
+
+    sampleArgs->AddOption(streams_option);
+    delete streams_option;
+
     return SDK_SUCCESS;
 }
 
 int MersenneTwister::validateCommandLineOptions()
 {
+    if(numStreams < 0)
+    {
+        std::cout << "Invalid value for --streams option: cannot be negative";
+        return SDK_EXPECTED_FAILURE;
+    }
+
     if(mulFactor % 2 == 0 && mulFactor >= 2 && mulFactor <= 8)
     {
         return SDK_SUCCESS;
@@ -453,9 +488,115 @@ int MersenneTwister::run()
                              1);
     }
 
+    if(numStreams > 0)
+    {
+        if(runHostStreams() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
+    }
+
     return SDK_SUCCESS;
 }
 
+int
+MersenneTwister::runHostStreams()
+{
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+    // As many numbers as the kernel, split over the streams
+    cl_uint total = width * height * mulFactor * 4;
+    streamCount = (total / numStreams) & ~7u;
+    if(streamCount == 0)
+    {
+        std::cout << "Too many streams for " << total << " numbers" << std::endl;
+        return SDK_FAILURE;
+    }
+    streamResult.resize((size_t)numStreams * streamCount);
+
+    // The first call also finds the jump polynomials
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+
+    int status = engine.streams(seeds[0], numStreams, streamCount, &streamResult[0], true);
+    CHECK_ERROR(status, SDK_SUCCESS, "MersenneEngine::streams() failed");
+
+    sampleTimer->stopTimer(timer);
+    jumpSetupTime = (double)(sampleTimer->readTimer(timer));
+
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
+    for(int i = 0; i < iterations; i++)
+    {
+        status = engine.streams(seeds[0], numStreams, streamCount, &streamResult[0], true);
+        CHECK_ERROR(status, SDK_SUCCESS, "MersenneEngine::streams() failed");
+    }
+    sampleTimer->stopTimer(timer);
+    streamTime = (double)(sampleTimer->readTimer(timer)) / iterations;
+
+    if(!sampleArgs->quiet)
+    {
+        printArray<cl_float>("Host streams", &streamResult[0], streamCount, 1);
+    }
+    return SDK_SUCCESS;
+}
+
+
+bool
+MersenneTwister::verifyHostStreams()
+{
+    // A jump must land where stepping does. 2^15 steps is past the degree
+    // of the characteristic polynomial, so the jump polynomial has been
+    // reduced, and the other bits of the distance chain several jumps.
+    const cl_uint distance = (1u << 15) + 123;
+
+    SFMTEngine jumped;
+    SFMTEngine stepped;
+    jumped.seed(seeds[0]);
+    stepped.seed(seeds[0]);
+
+    std::vector<cl_ulong> poly;
+    for(cl_uint bit = 0; (distance >> bit) != 0; bit++)
+    {
+        if((distance >> bit) & 1)
+        {
+            engine.jumpPolynomial(bit, poly);
+            jumped.jump(poly);
+        }
+    }
+
+    std::vector<cl_uint> skip(4 * (size_t)distance);
+    std::vector<cl_uint> jumpedBits(4 * SFMT_N);
+    std::vector<cl_uint> steppedBits(4 * SFMT_N);
+    stepped.fill(&skip[0], distance);
+    stepped.fill(&steppedBits[0], SFMT_N);
+    jumped.fill(&jumpedBits[0], SFMT_N);
+    if(jumpedBits != steppedBits)
+    {
+        std::cout << "Jump ahead differs from stepping" << std::endl;
+        return false;
+    }
+
+    // Mean and variance of the normals within five standard errors
+    double sum = 0;
+    double sumSqr = 0;
+    for(size_t i = 0; i < streamResult.size(); i++)
+    {
+        sum += streamResult[i];
+        sumSqr += streamResult[i] * streamResult[i];
+    }
+    double n = (double)streamResult.size();
+    double mean = sum / n;
+    double var = sumSqr / n - mean * mean;
+    if(fabs(mean) > 5.0 / sqrt(n) || fabs(var - 1.0) > 5.0 * sqrt(2.0 / n))
+    {
+        std::cout << "Host streams are not standard normal: mean " << mean
+                  << " variance " << var << std::endl;
+        return false;
+    }
+    return true;
+}
 
 int
 MersenneTwister::verifyResults()
@@ -478,6 +619,41 @@ MersenneTwister::verifyResults()
             passed = true;
         }
 
+        // The host copy of the kernel has the same integers, so the
+        // normals only differ by the rounding of the math functions
+        int numbers = height * width * (int)mulFactor * 4;
+        hostResult.resize(numbers);
+        engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
+
+        int timer = sampleTimer->createTimer();
+        sampleTimer->resetTimer(timer);
+        sampleTimer->startTimer(timer);
+
+        int status = engine.kernelRandom(seeds, width * height, mulFactor, &hostResult[0]);
+        CHECK_ERROR(status, SDK_SUCCESS, "MersenneEngine::kernelRandom() failed");
+
+        sampleTimer->stopTimer(timer);
+        hostTime = (double)(sampleTimer->readTimer(timer));
+
+        for(int i = 0; i < numbers && passed; ++i)
+        {
+            cl_float host = hostResult[i];
+            cl_float device = deviceResult[i];
+            bool finite = fabs(host) <= FLT_MAX && fabs(device) <= FLT_MAX;
+            if(finite ? fabs(host - device) > 1e-3f * std::max(fabs(device), 1.0f)
+                    : host != device)
+            {
+                std::cout << "Host and device differ at " << i << ": " << host
+                          << " " << device << std::endl;
+                passed = false;
+            }
+        }
+
+        if(passed && numStreams > 0)
+        {
+            passed = verifyHostStreams();
+        }
+
         if(passed == false)
         {
             std::cout << "Failed\n" << std::endl;
@@ -514,6 +690,33 @@ MersenneTwister::printStats()
         stats[3] = toString(height * width * mulFactor * 4 / kernelTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        // GB/s of random bits, 32 per number
+        double bytes = height * width * mulFactor * 16.0;
+        if(hostTime > 0)
+        {
+            std::string hostStrArray[2] = {"Host Time(sec)", "Host GB/s"};
+            std::string hostStats[2];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(bytes / hostTime * 1e-9, std::dec);
+            printStatistics(hostStrArray, hostStats, 2);
+        }
+        if(streamTime > 0)
+        {
+            std::string streamStrArray[4] =
+            {
+                "Streams",
+                "Jump setup Time(sec)",
+                "Streams Time(sec)",
+                "Streams GB/s"
+            };
+            std::string streamStats[4];
+            streamStats[0] = toString(numStreams, std::dec);
+            streamStats[1] = toString(jumpSetupTime, std::dec);
+            streamStats[2] = toString(streamTime, std::dec);
+            streamStats[3] = toString(streamResult.size() * 4.0 / streamTime * 1e-9, std::dec);
+            printStatistics(streamStrArray, streamStats, 4);
+        }
     }
 }
 
@@ -27,6 +27,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <assert.h>
 #include <string.h>
 #include "CLUtil.hpp"
+#include "MersenneEngine.hpp"
 
 #include <malloc.h>
 
@@ -75,6 +76,16 @@ class MersenneTwister
 
         SDKTimer    *sampleTimer;      /**< SDKTimer object */
 
+        MersenneEngine engine;          /**< Host generators */
+        int cpuThreads;                 /**< Host threads, 0 uses every core */
+        int numStreams;                 /**< Host SFMT streams, 0 skips them */
+        cl_uint streamCount;            /**< Numbers per host stream */
+        std::vector<cl_float> hostResult;   /**< Host copy of the kernel's numbers */
+        std::vector<cl_float> streamResult; /**< Numbers of the host streams */
+        cl_double hostTime;             /**< Time of the host copy of the kernel */
+        cl_double jumpSetupTime;        /**< Time to find the jump polynomials */
+        cl_double streamTime;           /**< Average time of the host streams */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -87,7 +98,13 @@ class MersenneTwister
             : blockSizeX(1),
               blockSizeY(1),
               setupTime(0),
-              kernelTime(0)
+              kernelTime(0),
+              cpuThreads(0),
+              numStreams(0),
+              streamCount(0),
+              hostTime(0),
+              jumpSetupTime(0),
+              streamTime(0)
         {
             sampleArgs = new CLCommandArgs();
             sampleTimer = new SDKTimer();
@@ -149,6 +166,20 @@ class MersenneTwister
          */
         int runCLKernels();
 
+        /**
+         * Draws normal numbers from numStreams jumped SFMT19937 streams on
+         * the host and times them
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int runHostStreams();
+
+        /**
+         * Checks a short jump of the host streams against stepping, and the
+         * mean and variance of their numbers
+         * @return true if the host streams pass
+         */
+        bool verifyHostStreams();
+
         /**
          * Override from SDKSample. Print sample stats.
          */
@@ -490,6 +490,21 @@ SobelFilterImage::initialize()
     iteration_option->_value = &iterations;
     sampleArgs->AddOption(iteration_option);
     delete iteration_option;
+
+    Option* num_threads = new Option;
+    if(!num_threads)
+    {
+        error("Memory Allocation error.\n");
+        return SDK_FAILURE;
+    }
+    num_threads->_sVersion = "";
+    num_threads->_lVersion = "threads";
+    num_threads->_description =
+        "Number of host threads of the host Sobel operator (0 uses every core)";
+    num_threads->_type = CA_ARG_INT;
+    num_threads->_value = &cpuThreads;
+    sampleArgs->AddOption(num_threads);
+    delete num_threads;
     return SDK_SUCCESS;
 }
 
@@ -586,87 +601,25 @@ SobelFilterImage::cleanup()
 }
 
 
-void
+int
 SobelFilterImage::sobelFilterImageCPUReference()
 {
-    // x-axis gradient mask
-    const int kx[][3] =
-    {
-        { 1, 2, 1},
-        { 0, 0, 0},
-        { -1, -2, -1}
-    };
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
 
-    // y-axis gradient mask
-    const int ky[][3] =
-    {
-        { 1, 0, -1},
-        { 2, 0, -2},
-        { 1, 0, -1}
-    };
-
-    int gx = 0;
-    int gy = 0;
-
-    // pointer to input image data
-    cl_uchar *ptr = (cl_uchar*)malloc(width * height * pixelSize);
-    memcpy(ptr, inputImageData, width * height * pixelSize);
-
-    // each pixel has 4 uchar components
-    int w = width * 4;
-
-    int k = 1;
-
-    // apply filter on each pixel (except boundary pixels)
-    for(int i = 0; i < (int)(w * (height - 1)) ; i++)
-    {
-        if(i < (k + 1) * w - 4 && i >= 4 + k * w)
-        {
-            gx =  kx[0][0] **(ptr + i - 4 - w)
-                  + kx[0][1] **(ptr + i - w)
-                  + kx[0][2] **(ptr + i + 4 - w)
-                  + kx[1][0] **(ptr + i - 4)
-                  + kx[1][1] **(ptr + i)
-                  + kx[1][2] **(ptr + i + 4)
-                  + kx[2][0] **(ptr + i - 4 + w)
-                  + kx[2][1] **(ptr + i + w)
-                  + kx[2][2] **(ptr + i + 4 + w);
-
-            gy =  ky[0][0] **(ptr + i - 4 - w)
-                  + ky[0][1] **(ptr + i - w)
-                  + ky[0][2] **(ptr + i + 4 - w)
-                  + ky[1][0] **(ptr + i - 4)
-                  + ky[1][1] **(ptr + i)
-                  + ky[1][2] **(ptr + i + 4)
-                  + ky[2][0] **(ptr + i - 4 + w)
-                  + ky[2][1] **(ptr + i + w)
-                  + ky[2][2] **(ptr + i + 4 + w);
-
-            float gx2 = pow((float)gx, 2);
-            float gy2 = pow((float)gy, 2);
-
-            double temp = sqrt(gx2 + gy2) / 2.0;
-
-            // Saturate
-            if(temp > 255)
-            {
-                temp = 255;
-            }
-            if(temp < 0)
-            {
-                temp = 0;
-            }
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
 
-            *(verificationOutput + i) = (cl_uchar)(temp);
-        }
+    // write_imageui saturates the lengths above 255. The kernel clamps its
+    // reads at the border and uses native_sqrt, so only pixels inside the
+    // border are compared.
+    int status = engine.filter(inputImageData, (cl_uchar4*)verificationOutput,
+                               width, height, true);
+    CHECK_ERROR(status, SDK_SUCCESS, "SDKSobel::filter() failed");
 
-        // if reached at the end of its row then incr k
-        if(i == (k + 1) * w - 5)
-        {
-            k++;
-        }
-    }
-    FREE(ptr);
+    sampleTimer->stopTimer(timer);
+    hostTime = (double)(sampleTimer->readTimer(timer));
+    return SDK_SUCCESS;
 }
 
 
@@ -681,7 +634,10 @@ SobelFilterImage::verifyResults()
     if(sampleArgs->verify)
     {
         // reference implementation
-        sobelFilterImageCPUReference();
+        if(sobelFilterImageCPUReference() != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
 
         size_t size = width * height * sizeof(cl_uchar4);
 
@@ -742,6 +698,15 @@ SobelFilterImage::printStats()
         stats[3] = toString(kernelTime, std::dec);
 
         printStatistics(strArray, stats, 4);
+
+        if(hostTime > 0)
+        {
+            std::string hostStrArray[2] = {"Host Time(sec)", "Host MPixels/sec"};
+            std::string hostStats[2];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(width * height / hostTime * 1e-6, std::dec);
+            printStatistics(hostStrArray, hostStats, 2);
+        }
     }
 }
 
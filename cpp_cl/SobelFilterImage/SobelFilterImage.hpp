@@ -25,6 +25,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <string.h>
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
+#include "SDKSobel.hpp"
 
 #define SAMPLE_VERSION "AMD-APP-SDK-v2.9.214.1"
 
@@ -73,6 +74,10 @@ class SobelFilterImage
 
         SDKTimer    *sampleTimer;      /**< SDKTimer object */
 
+        SDKSobel engine;               /**< Host SSE2 Sobel operator */
+        int cpuThreads;                /**< Host threads, 0 uses every core */
+        cl_double hostTime;            /**< Time of the host filter */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -110,6 +115,8 @@ class SobelFilterImage
             blockSizeY = 1;
             iterations = 1;
             imageSupport = 0;
+            cpuThreads = 0;
+            hostTime = 0;
         }
 
         ~SobelFilterImage()
@@ -146,10 +153,11 @@ class SobelFilterImage
         int runCLKernels();
 
         /**
-        * Reference CPU implementation of Binomial Option
-        * for performance comparison
+        * Reference CPU implementation of the Sobel filter, runs the host
+        * SSE2 operator into verificationOutput
+        * @return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
-        void sobelFilterImageCPUReference();
+        int sobelFilterImageCPUReference();
 
         /**
         * Override from SDKSample. Print sample stats.
@@ -121,6 +121,19 @@ UnsharpMask::initialize()
     sampleArgs->AddOption(buffer_option);
     delete buffer_option;
 
+    Option* thread_option = new Option;
+    CHECK_ALLOCATION(thread_option, "Memory allocation error.\n");
+
+    thread_option->_sVersion = "";
+    thread_option->_lVersion = "threads";
+    thread_option->_description =
+        "Number of host threads of the host unsharp mask (0 uses every core)";
+    thread_option->_type = CA_ARG_INT;
+    thread_option->_value = &cpuThreads;
+
+    sampleArgs->AddOption(thread_option);
+    delete thread_option;
+
     return SDK_SUCCESS;
 }
 
@@ -588,81 +601,46 @@ UnsharpMask::run()
 
 }
 
-void
-UnsharpMask::unsharpMask2PassCPU(unsigned char* input, unsigned char* output
-                                 , int width, int height
-                                 , float* gaussianPtr, int gaussianPtrRadius
-                                 , float threshold, float amount)
+int
+UnsharpMask::unsharpMaskHost(unsigned char* input, unsigned char* output
+                             , float* gaussianPtr)
 {
+    engine.setThreads(cpuThreads > 0 ? cpuThreads : 0);
 
-    float* tmp = (float*)malloc(width*height*3*sizeof(float));
-    float* pTmp = tmp;
+    int timer = sampleTimer->createTimer();
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
 
-    // 1D Guassian, horizontal
-    for (int j = 0; j < height; j++)
+    for (int i = 0; i < iterations; i++)
     {
-        for (int i = 0; i < width; i++)
-        {
-            float gb,gg,gr;
-            gb = gg = gr = 0.0f;
-            int tx = i - gaussianPtrRadius;
-            for (int n = 0; n <= gaussianPtrRadius*2; n++,tx++)
-            {
-                Pixel currentPixel = currentPixel = getPixel(input, CLAMP(tx, 0, width-1), j,
-                                                    width);
-                float weight = gaussianPtr[n];
-                gb+= weight*(float)currentPixel.b;
-                gg+= weight*(float)currentPixel.g;
-                gr+= weight*(float)currentPixel.r;
-            }
-            *pTmp++ = gb;
-            *pTmp++ = gg;
-            *pTmp++ = gr;
-        }
+        int status = engine.sharpen((cl_uchar4*)input, (cl_uchar4*)output
+                                    , width, height
+                                    , gaussianPtr, radius
+                                    , threshold, amount);
+        CHECK_ERROR(status, SDK_SUCCESS, "UnsharpMaskEngine::sharpen() failed");
     }
-    // 1D Guassian, vertical
-    for (int j = 0; j < height; j++)
-    {
-        for (int i = 0; i < width; i++)
-        {
-            float gb,gg,gr;
-            gb = gg = gr = 0.0f;
-
-            int ty = j - gaussianPtrRadius;
-            for (int n = 0; n <= gaussianPtrRadius*2; n++,ty++)
-            {
-
-                int clampedY = CLAMP(ty, 0, height-1);
-                pTmp = tmp + (clampedY * width + i) * 3;
-                float weight = gaussianPtr[n];
-
-                gb+= weight **pTmp++;
-                gg+= weight **pTmp++;
-                gr+= weight **pTmp;
-            }
 
-            // diff pixel
-            Pixel currentPixel = getPixel(input, i, j, width);
-            float cp_b = currentPixel.b;
-            float cp_g = currentPixel.g;
-            float cp_r = currentPixel.r;
-
-            float diff_b = cp_b-gb;
-            cp_b += (::fabsf(diff_b) > threshold) ? diff_b*amount : 0.0f;
+    sampleTimer->stopTimer(timer);
+    hostTime = (double)(sampleTimer->readTimer(timer)) / iterations;
 
-            float diff_g = cp_g-gg;
-            cp_g += (::fabsf(diff_g) > threshold) ? diff_g*amount : 0.0f;
+    // Time the fixed-point path on a scratch image
+    std::vector<cl_uchar4> fixedOutput(width * height);
+    sampleTimer->resetTimer(timer);
+    sampleTimer->startTimer(timer);
 
-            float diff_r = cp_r-gr;
-            cp_r += (::fabsf(diff_r) > threshold) ? diff_r*amount : 0.0f;
+    for (int i = 0; i < iterations; i++)
+    {
+        int status = engine.sharpenFixed((cl_uchar4*)input, &fixedOutput[0]
+                                         , width, height
+                                         , gaussianPtr, radius
+                                         , threshold, amount);
+        CHECK_ERROR(status, SDK_SUCCESS, "UnsharpMaskEngine::sharpenFixed() failed");
+    }
 
-            currentPixel.b = (unsigned char)CLAMP(cp_b+0.5f, 0.0f, 255.0f);
-            currentPixel.g = (unsigned char)CLAMP(cp_g+0.5f, 0.0f, 255.0f);
-            currentPixel.r = (unsigned char)CLAMP(cp_r+0.5f, 0.0f, 255.0f);
+    sampleTimer->stopTimer(timer);
+    fixedTime = (double)(sampleTimer->readTimer(timer)) / iterations;
 
-            setPixel(output, i, j, width, currentPixel);
-        }
-    }
+    return SDK_SUCCESS;
 }
 
 int
@@ -700,15 +678,13 @@ UnsharpMask::verifyResults()
         gaussianPtr = (float*) queue.enqueueMapBuffer(gaussian1DBuffer, CL_TRUE,
                       CL_MAP_READ, 0, dimen*sizeof(float));
 
-        for (int i = 0; i < iterations; i++)
-        {
-            unsharpMask2PassCPU(input, cpuUnsharpMaskImage
-                                , width, height
-                                , gaussianPtr, radius
-                                , threshold,amount);
-        }
+        int status = unsharpMaskHost(input, cpuUnsharpMaskImage, gaussianPtr);
 
         queue.enqueueUnmapMemObject(gaussian1DBuffer, gaussianPtr);
+        if(status != SDK_SUCCESS)
+        {
+            return SDK_FAILURE;
+        }
         for (int j = 0; j < height; j++)
         {
             for (int i = 0; i < width; i++)
@@ -793,6 +769,21 @@ UnsharpMask::printStats()
         stats[4] = toString((width * height)/kernelTime ,std::dec);
 
         printStatistics(strArray, stats, 5);
+
+        if(hostTime > 0)
+        {
+            std::string hostStrArray[3] =
+            {
+                "Host Time(sec)",
+                "Host Fixed-Point Time(sec)",
+                "Host Fixed-Point Pixels/sec"
+            };
+            std::string hostStats[3];
+            hostStats[0] = toString(hostTime, std::dec);
+            hostStats[1] = toString(fixedTime, std::dec);
+            hostStats[2] = toString((width * height)/fixedTime, std::dec);
+            printStatistics(hostStrArray, hostStats, 3);
+        }
     }
 }
 
@@ -31,6 +31,7 @@ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVE
 #include <string.h>
 #include "CLUtil.hpp"
 #include "SDKBitMap.hpp"
+#include "UnsharpMaskEngine.hpp"
 
 using namespace appsdk;
 
@@ -112,6 +113,11 @@ class UnsharpMask
 
         SDKTimer    *sampleTimer;      /**< SDKTimer object */
 
+        UnsharpMaskEngine engine;               /**< Host fused unsharp mask */
+        int cpuThreads;                         /**< Host threads, 0 uses every core */
+        cl_double hostTime;                     /**< Time of the float host unsharp mask */
+        cl_double fixedTime;                    /**< Time of the fixed-point host unsharp mask */
+
     public:
 
         CLCommandArgs   *sampleArgs;   /**< CLCommand argument class */
@@ -132,7 +138,10 @@ class UnsharpMask
               ptr(NULL),
               cpuUnsharpMaskImage(NULL),
               unsharpMaskImage(NULL),
-              dImageBuffer(false)
+              dImageBuffer(false),
+              cpuThreads(0),
+              hostTime(0),
+              fixedTime(0)
         {
             sampleArgs = new CLCommandArgs();
             sampleTimer = new SDKTimer();
@@ -262,13 +271,13 @@ class UnsharpMask
         void generateGaussian2D(float sigma, int radius, float* kernel);
 
         /**
-        *Run UnsharpMask in the cpu.
-        *Used for verification purpose.
+        *Run UnsharpMask on the host engine, in float into output and in
+        *fixed point for timing. Used for verification purpose.
+        *@return SDK_SUCCESS on success and SDK_FAILURE on failure
         */
-        void unsharpMask2PassCPU(unsigned char* input, unsigned char* output
-                                 , int width, int height
-                                 , float*gk, int gkRadius
-                                 , float threshold, float amount) ;
+        int unsharpMaskHost(unsigned char* input, unsigned char* output
+                            , float* gk);
+
         /**
         *Load the input image.
         */
@@ -0,0 +1,429 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#include "UnsharpMaskEngine.hpp"
+#include <emmintrin.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+/*
+ * Fewest rows of a strip, strips of a wide Gaussian are 8 * radius rows
+ * so the 2 * radius rows primed per strip stay a small overhead
+ */
+#define STRIP_ROWS 64
+
+/*
+ * Fractional bits of the fixed-point weights and horizontal blur
+ */
+#define WEIGHT_BITS 14
+#define BLUR_BITS 7
+
+/**
+ * Arguments of the strip threads
+ */
+struct UnsharpMaskEngine::rangeArgs
+{
+    const cl_uchar4 *input;
+    cl_uchar4 *output;
+    cl_uint width;
+    cl_uint height;
+    const cl_float *gaussian;
+    cl_uint radius;
+    cl_float threshold;
+    cl_float amount;
+    cl_uint stripRows;
+    const cl_int *weightPairs;  /**< Fixed-point weights n and n + 1 per int */
+};
+
+/*
+ * Index i clamped to [0, n)
+ */
+static inline cl_uint
+clampIndex(int i, cl_uint n)
+{
+    return i < 0 ? 0 : ((cl_uint)i >= n ? n - 1 : (cl_uint)i);
+}
+
+/*
+ * Channels 0 to 2 of a row in planes of length entries, entry i holds
+ * pixel i - radius clamped to the row
+ */
+template<typename T>
+static void
+planarRow(const cl_uchar4 *row, cl_uint width, cl_uint radius, cl_uint length,
+          T *planes)
+{
+    for(cl_uint i = 0; i < length; i++)
+    {
+        const cl_uchar4 &pixel = row[clampIndex((int)i - (int)radius, width)];
+        planes[i] = pixel.s[0];
+        planes[length + i] = pixel.s[1];
+        planes[2 * length + i] = pixel.s[2];
+    }
+}
+
+/*
+ * Four pixels from x, past the end of the row reads zeros
+ */
+static inline __m128i
+loadPixels(const cl_uchar4 *row, cl_uint x, cl_uint width)
+{
+    if(x + 4 <= width)
+    {
+        return _mm_loadu_si128((const __m128i*)(row + x));
+    }
+    cl_uchar4 tail[4];
+    memset(tail, 0, sizeof(tail));
+    memcpy(tail, row + x, (width - x) * sizeof(cl_uchar4));
+    return _mm_loadu_si128((const __m128i*)tail);
+}
+
+static inline void
+storePixels(__m128i pixels, cl_uchar4 *row, cl_uint x, cl_uint width)
+{
+    if(x + 4 <= width)
+    {
+        _mm_storeu_si128((__m128i*)(row + x), pixels);
+        return;
+    }
+    cl_uchar4 tail[4];
+    _mm_storeu_si128((__m128i*)tail, pixels);
+    memcpy(row + x, tail, (width - x) * sizeof(cl_uchar4));
+}
+
+/*
+ * Sharpened channel at bit SHIFT of four pixels, in the order of the kernel
+ */
+template<int SHIFT>
+static inline __m128i
+sharpenChannel(__m128i pixels, __m128 blur, __m128 threshold, __m128 amount)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 current = _mm_cvtepi32_ps(
+                         _mm_and_si128(_mm_srli_epi32(pixels, SHIFT), _mm_set1_epi32(0xff)));
+    __m128 diff = _mm_sub_ps(current, blur);
+    __m128 sharp = _mm_cmpgt_ps(_mm_and_ps(diff, absMask), threshold);
+    current = _mm_add_ps(current, _mm_and_ps(sharp, _mm_mul_ps(diff, amount)));
+    current = _mm_max_ps(_mm_min_ps(_mm_add_ps(current, _mm_set1_ps(0.5f)),
+                                    _mm_set1_ps(255.0f)), _mm_setzero_ps());
+    return _mm_slli_epi32(_mm_cvttps_epi32(current), SHIFT);
+}
+
+/*
+ * Four sharpened pixels, channel 3 is copied
+ */
+static inline __m128i
+sharpenPixels(__m128i pixels, const __m128 blur[3], __m128 threshold, __m128 amount)
+{
+    __m128i result = _mm_and_si128(pixels, _mm_set1_epi32(0xff000000));
+    result = _mm_or_si128(result, sharpenChannel<0>(pixels, blur[0], threshold, amount));
+    result = _mm_or_si128(result, sharpenChannel<8>(pixels, blur[1], threshold, amount));
+    return _mm_or_si128(result, sharpenChannel<16>(pixels, blur[2], threshold, amount));
+}
+
+/*
+ * Horizontal blur of a row into the three planes of a ring row
+ */
+static void
+horizontalFloat(const cl_uchar4 *row, cl_uint width, cl_uint radius,
+                const cl_float *gaussian, cl_uint stride, cl_float *padded,
+                cl_float *ringRow)
+{
+    const cl_uint taps = 2 * radius + 1;
+    const cl_uint length = stride + taps;
+    planarRow(row, width, radius, length, padded);
+
+    for(int c = 0; c < 3; c++)
+    {
+        const cl_float *plane = padded + c * length;
+        cl_float *out = ringRow + c * stride;
+        for(cl_uint x = 0; x < stride; x += 4)
+        {
+            __m128 sum = _mm_setzero_ps();
+            for(cl_uint n = 0; n < taps; n++)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(gaussian[n]),
+                                                 _mm_loadu_ps(plane + x + n)));
+            }
+            _mm_storeu_ps(out + x, sum);
+        }
+    }
+}
+
+static void
+horizontalFixed(const cl_uchar4 *row, cl_uint width, cl_uint radius,
+                const cl_int *weightPairs, cl_uint stride, cl_short *padded,
+                cl_short *ringRow)
+{
+    const cl_uint taps = 2 * radius + 1;
+    const cl_uint length = stride + taps;
+    const __m128i round = _mm_set1_epi32(1 << (WEIGHT_BITS - BLUR_BITS - 1));
+    planarRow(row, width, radius, length, padded);
+
+    for(int c = 0; c < 3; c++)
+    {
+        const cl_short *plane = padded + c * length;
+        cl_short *out = ringRow + c * stride;
+        for(cl_uint x = 0; x < stride; x += 8)
+        {
+            // Taps n and n + 1 of pixels x to x + 7, the last odd tap weighs 0
+            __m128i low = _mm_setzero_si128();
+            __m128i high = _mm_setzero_si128();
+            for(cl_uint n = 0; n < taps; n += 2)
+            {
+                __m128i weights = _mm_set1_epi32(weightPairs[n / 2]);
+                __m128i a = _mm_loadu_si128((const __m128i*)(plane + x + n));
+                __m128i b = _mm_loadu_si128((const __m128i*)(plane + x + n + 1));
+                low = _mm_add_epi32(low, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights));
+                high = _mm_add_epi32(high, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights));
+            }
+            low = _mm_srai_epi32(_mm_add_epi32(low, round), WEIGHT_BITS - BLUR_BITS);
+            high = _mm_srai_epi32(_mm_add_epi32(high, round), WEIGHT_BITS - BLUR_BITS);
+            _mm_storeu_si128((__m128i*)(out + x), _mm_packs_epi32(low, high));
+        }
+    }
+}
+
+void
+UnsharpMaskEngine::floatThread(void *data, unsigned int begin, unsigned int end,
+                               unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const cl_uint width = args->width;
+    const cl_uint height = args->height;
+    const int radius = (int)args->radius;
+    const cl_uint taps = 2 * radius + 1;
+    const cl_uint stride = (width + 7) & ~7u;
+    const __m128 threshold = _mm_set1_ps(args->threshold);
+    const __m128 amount = _mm_set1_ps(args->amount);
+
+    std::vector<cl_float> padded(3 * (stride + taps));
+    std::vector<cl_float> ring((size_t)taps * 3 * stride);
+
+    for(cl_uint s = begin; s < end; s++)
+    {
+        const int y0 = (int)(s * args->stripRows);
+        const int y1 = (int)std::min(height, (s + 1) * args->stripRows);
+        const int first = y0 - radius;
+
+        // Prime the ring with the rows above the strip
+        for(int v = first; v < y0 + radius; v++)
+        {
+            horizontalFloat(args->input + (size_t)clampIndex(v, height) * width, width,
+                            radius, args->gaussian, stride, &padded[0],
+                            &ring[(size_t)((v - first) % taps) * 3 * stride]);
+        }
+
+        for(int y = y0; y < y1; y++)
+        {
+            int v = y + radius;
+            horizontalFloat(args->input + (size_t)clampIndex(v, height) * width, width,
+                            radius, args->gaussian, stride, &padded[0],
+                            &ring[(size_t)((v - first) % taps) * 3 * stride]);
+
+            const cl_uchar4 *inRow = args->input + (size_t)y * width;
+            cl_uchar4 *outRow = args->output + (size_t)y * width;
+            for(cl_uint x = 0; x < width; x += 4)
+            {
+                __m128 blur[3];
+                for(int c = 0; c < 3; c++)
+                {
+                    blur[c] = _mm_setzero_ps();
+                }
+                for(cl_uint n = 0; n < taps; n++)
+                {
+                    const cl_float *ringRow =
+                        &ring[(size_t)((y - radius + (int)n - first) % taps) * 3 * stride];
+                    __m128 weight = _mm_set1_ps(args->gaussian[n]);
+                    for(int c = 0; c < 3; c++)
+                    {
+                        blur[c] = _mm_add_ps(blur[c], _mm_mul_ps(weight,
+                                             _mm_loadu_ps(ringRow + c * stride + x)));
+                    }
+                }
+                __m128i pixels = loadPixels(inRow, x, width);
+                storePixels(sharpenPixels(pixels, blur, threshold, amount), outRow, x, width);
+            }
+        }
+    }
+}
+
+void
+UnsharpMaskEngine::fixedThread(void *data, unsigned int begin, unsigned int end,
+                               unsigned int threadId)
+{
+    rangeArgs *args = (rangeArgs*)data;
+    const cl_uint width = args->width;
+    const cl_uint height = args->height;
+    const int radius = (int)args->radius;
+    const cl_uint taps = 2 * radius + 1;
+    const cl_uint stride = (width + 7) & ~7u;
+    const __m128 threshold = _mm_set1_ps(args->threshold);
+    const __m128 amount = _mm_set1_ps(args->amount);
+    const __m128 blurScale = _mm_set1_ps(1.0f / (1 << BLUR_BITS));
+    const __m128i round = _mm_set1_epi32(1 << (WEIGHT_BITS - 1));
+
+    std::vector<cl_short> padded(3 * (stride + taps));
+    std::vector<cl_short> ring((size_t)taps * 3 * stride);
+    std::vector<const cl_short*> rows(taps + 1);
+
+    for(cl_uint s = begin; s < end; s++)
+    {
+        const int y0 = (int)(s * args->stripRows);
+        const int y1 = (int)std::min(height, (s + 1) * args->stripRows);
+        const int first = y0 - radius;
+
+        // Prime the ring with the rows above the strip
+        for(int v = first; v < y0 + radius; v++)
+        {
+            horizontalFixed(args->input + (size_t)clampIndex(v, height) * width, width,
+                            radius, args->weightPairs, stride, &padded[0],
+                            &ring[(size_t)((v - first) % taps) * 3 * stride]);
+        }
+
+        for(int y = y0; y < y1; y++)
+        {
+            int v = y + radius;
+            horizontalFixed(args->input + (size_t)clampIndex(v, height) * width, width,
+                            radius, args->weightPairs, stride, &padded[0],
+                            &ring[(size_t)((v - first) % taps) * 3 * stride]);
+
+            // Ring rows of the taps, the last odd tap repeats a row at weight 0
+            for(cl_uint n = 0; n < taps; n++)
+            {
+                rows[n] = &ring[(size_t)((y - radius + (int)n - first) % taps) * 3 * stride];
+            }
+            rows[taps] = rows[taps - 1];
+
+            const cl_uchar4 *inRow = args->input + (size_t)y * width;
+            cl_uchar4 *outRow = args->output + (size_t)y * width;
+            for(cl_uint x = 0; x < width; x += 8)
+            {
+                __m128 blurLow[3];
+                __m128 blurHigh[3];
+                for(int c = 0; c < 3; c++)
+                {
+                    __m128i low = _mm_setzero_si128();
+                    __m128i high = _mm_setzero_si128();
+                    for(cl_uint n = 0; n < taps; n += 2)
+                    {
+                        __m128i weights = _mm_set1_epi32(args->weightPairs[n / 2]);
+                        __m128i a = _mm_loadu_si128((const __m128i*)(rows[n] + c * stride + x));
+                        __m128i b = _mm_loadu_si128((const __m128i*)(rows[n + 1] + c * stride + x));
+                        low = _mm_add_epi32(low, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights));
+                        high = _mm_add_epi32(high, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights));
+                    }
+                    low = _mm_srai_epi32(_mm_add_epi32(low, round), WEIGHT_BITS);
+                    high = _mm_srai_epi32(_mm_add_epi32(high, round), WEIGHT_BITS);
+                    blurLow[c] = _mm_mul_ps(_mm_cvtepi32_ps(low), blurScale);
+                    blurHigh[c] = _mm_mul_ps(_mm_cvtepi32_ps(high), blurScale);
+                }
+
+                __m128i pixels = loadPixels(inRow, x, width);
+                storePixels(sharpenPixels(pixels, blurLow, threshold, amount), outRow, x, width);
+                if(x + 4 < width)
+                {
+                    pixels = loadPixels(inRow, x + 4, width);
+                    storePixels(sharpenPixels(pixels, blurHigh, threshold, amount), outRow,
+                                x + 4, width);
+                }
+            }
+        }
+    }
+}
+
+int
+UnsharpMaskEngine::run(void (*func)(void*, unsigned int, unsigned int, unsigned int),
+                       const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                       cl_uint height, const cl_float *gaussian, cl_uint radius,
+                       cl_float threshold, cl_float amount)
+{
+    if(input == NULL || output == NULL || gaussian == NULL || width == 0 || height == 0)
+    {
+        error("UnsharpMaskEngine needs an input and an output image and a Gaussian");
+        return SDK_FAILURE;
+    }
+    if(input == output)
+    {
+        error("UnsharpMaskEngine cannot sharpen in place");
+        return SDK_FAILURE;
+    }
+
+    // Weights rounded to WEIGHT_BITS, the center absorbs the rounding so
+    // they sum to one
+    const cl_uint taps = 2 * radius + 1;
+    std::vector<cl_int> weights(taps + 1, 0);
+    cl_int sum = 0;
+    for(cl_uint n = 0; n < taps; n++)
+    {
+        weights[n] = (cl_int)floor(gaussian[n] * (1 << WEIGHT_BITS) + 0.5f);
+        sum += weights[n];
+    }
+    weights[radius] += (1 << WEIGHT_BITS) - sum;
+    for(cl_uint n = 0; n < taps; n++)
+    {
+        if(weights[n] < 0 || weights[n] > 0x7fff)
+        {
+            error("UnsharpMaskEngine needs Gaussian weights in [0, 1] summing to 1");
+            return SDK_FAILURE;
+        }
+    }
+    std::vector<cl_int> weightPairs(taps / 2 + 1);
+    for(cl_uint n = 0; n < taps; n += 2)
+    {
+        weightPairs[n / 2] = (weights[n] & 0xffff) | (weights[n + 1] << 16);
+    }
+
+    rangeArgs args;
+    args.input = input;
+    args.output = output;
+    args.width = width;
+    args.height = height;
+    args.gaussian = gaussian;
+    args.radius = radius;
+    args.threshold = threshold;
+    args.amount = amount;
+    args.stripRows = std::max((cl_uint)STRIP_ROWS, 8 * radius);
+    args.weightPairs = &weightPairs[0];
+
+    cl_uint numStrips = (height + args.stripRows - 1) / args.stripRows;
+    if(!parallelFor(func, &args, numStrips, numThreads))
+    {
+        error("UnsharpMaskEngine could not create its threads");
+        return SDK_FAILURE;
+    }
+    return SDK_SUCCESS;
+}
+
+int
+UnsharpMaskEngine::sharpen(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                           cl_uint height, const cl_float *gaussian, cl_uint radius,
+                           cl_float threshold, cl_float amount)
+{
+    return run(floatThread, input, output, width, height, gaussian, radius,
+               threshold, amount);
+}
+
+int
+UnsharpMaskEngine::sharpenFixed(const cl_uchar4 *input, cl_uchar4 *output,
+                                cl_uint width, cl_uint height, const cl_float *gaussian,
+                                cl_uint radius, cl_float threshold, cl_float amount)
+{
+    return run(fixedThread, input, output, width, height, gaussian, radius,
+               threshold, amount);
+}
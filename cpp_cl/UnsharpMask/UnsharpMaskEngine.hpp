@@ -0,0 +1,111 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef UNSHARPMASKENGINE_H_
+#define UNSHARPMASKENGINE_H_
+
+#include <CL/cl.h>
+#include <vector>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+using namespace appsdk;
+
+/**
+ * UnsharpMaskEngine
+ * Class implements a multi-threaded host unsharp mask of a 4-channel
+ * image that fuses the horizontal blur, the vertical blur and the
+ * threshold/amount blend of unsharp_mask_pass1 and unsharp_mask_pass2.
+ *
+ * Threads take strips of rows. A strip keeps the horizontally blurred
+ * rows of the vertical window in a ring of 2 * radius + 1 planar rows,
+ * so every output row costs one new horizontal row, and the image is
+ * read and written once. Channels 0 to 2 are blurred in planes of 4 float
+ * or 8 16-bit lanes, channel 3 is copied.
+ */
+class UnsharpMaskEngine
+{
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+
+        struct rangeArgs;
+        static void floatThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId);
+        static void fixedThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId);
+
+        /**
+         * Checks the arguments and runs a strip thread over the image
+         */
+        int run(void (*func)(void*, unsigned int, unsigned int, unsigned int),
+                const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                cl_uint height, const cl_float *gaussian, cl_uint radius,
+                cl_float threshold, cl_float amount);
+
+    public:
+
+        /**
+         * Constructor
+         * Initialize member variables
+         */
+        UnsharpMaskEngine()
+            : numThreads(0)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Sharpens an image in float with the sums in the order of
+         * unsharp_mask_pass1 and unsharp_mask_pass2, so the result matches
+         * the two-pass reference exactly
+         * @param input input pixels, width * height
+         * @param output output pixels, width * height
+         * @param gaussian 2 * radius + 1 weights of the 1D Gaussian
+         * @param radius radius of the Gaussian
+         * @param threshold smallest difference to the blur that is sharpened
+         * @param amount factor of the difference added to a pixel
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int sharpen(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                    cl_uint height, const cl_float *gaussian, cl_uint radius,
+                    cl_float threshold, cl_float amount);
+
+        /**
+         * Sharpens an image with the weights rounded to 14 fractional bits
+         * and the horizontal blur kept with 7 fractional bits, in twice the
+         * lanes of sharpen(). A channel is within one of sharpen() unless
+         * its difference to the blur is that close to the threshold.
+         * @param input input pixels, width * height
+         * @param output output pixels, width * height
+         * @param gaussian 2 * radius + 1 weights of the 1D Gaussian
+         * @param radius radius of the Gaussian
+         * @param threshold smallest difference to the blur that is sharpened
+         * @param amount factor of the difference added to a pixel
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int sharpenFixed(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                         cl_uint height, const cl_float *gaussian, cl_uint radius,
+                         cl_float threshold, cl_float amount);
+};
+
+#endif
@@ -0,0 +1,204 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef SDK_CONTROL_VARIATE_H_
+#define SDK_CONTROL_VARIATE_H_
+
+#include <math.h>
+
+/**
+ * namespace appsdk
+ */
+namespace appsdk
+{
+
+/**
+ * class SDKControlVariate
+ * \brief Monte Carlo estimator with a control variate.
+ *
+ * Collects the payoff y and the control x of every path. A control of
+ * known mean E[x] gives the estimate mean(y) - beta * (mean(x) - E[x]),
+ * beta = cov(x, y) / var(x) being the coefficient of least variance,
+ * estimated from the same paths. Sums are kept in double whatever the
+ * precision of the paths.
+ *
+ *     SDKControlVariate cv;
+ *     for(...) cv.add(payoff, control);
+ *     double price = cv.getEstimate(expected);
+ *     double error = cv.getControlledError();
+ */
+class SDKControlVariate
+{
+    public:
+
+        /**
+         * Constructor
+         */
+        SDKControlVariate()
+        {
+            reset();
+        }
+
+        /**
+         * Forgets every path
+         */
+        void reset()
+        {
+            count = 0;
+            sumY = sumYY = sumX = sumXX = sumXY = 0;
+        }
+
+        /**
+         * Adds one path
+         * @param payoff value whose mean is estimated
+         * @param control correlated value of known mean
+         */
+        void add(double payoff, double control)
+        {
+            count += 1;
+            sumY += payoff;
+            sumYY += payoff * payoff;
+            sumX += control;
+            sumXX += control * control;
+            sumXY += control * payoff;
+        }
+
+        /**
+         * Adds the paths of another estimator, for per-thread partial sums
+         */
+        void merge(const SDKControlVariate &other)
+        {
+            count += other.count;
+            sumY += other.sumY;
+            sumYY += other.sumYY;
+            sumX += other.sumX;
+            sumXX += other.sumXX;
+            sumXY += other.sumXY;
+        }
+
+        /**
+         * @return number of paths
+         */
+        double getCount() const
+        {
+            return count;
+        }
+
+        /**
+         * @return plain mean of the payoffs
+         */
+        double getMean() const
+        {
+            return count > 0 ? sumY / count : 0;
+        }
+
+        /**
+         * @return standard error of getMean()
+         */
+        double getError() const
+        {
+            return count > 1 ? sqrt(varY() / count) : 0;
+        }
+
+        /**
+         * @return coefficient of the control, 0 when the control is constant
+         */
+        double getBeta() const
+        {
+            double vx = varX();
+            return vx > 0 ? covXY() / vx : 0;
+        }
+
+        /**
+         * @param expected known mean of the control
+         * @return mean of the payoffs corrected by the control
+         */
+        double getEstimate(double expected) const
+        {
+            return getMean() - getBeta() * (sumX / (count > 0 ? count : 1) - expected);
+        }
+
+        /**
+         * @return standard error of getEstimate(), the residual variance
+         *         var(y) - cov(x, y)^2 / var(x) over the paths
+         */
+        double getControlledError() const
+        {
+            if(count < 2)
+            {
+                return 0;
+            }
+            double var = varY() - getBeta() * covXY();
+            return sqrt((var > 0 ? var : 0) / count);
+        }
+
+        /**
+         * Undiscounted price of the call on the geometric average of
+         * noOfSum equally spaced prices of a geometric Brownian motion, the
+         * initial price included, as the Asian samples average them. The
+         * log of the average is normal, so the price has a closed form.
+         * @return E[max(G - strike, 0)]
+         */
+        static double geometricAsianCall(double initPrice, double strike,
+                                         double interest, double maturity,
+                                         double sigma, int noOfSum)
+        {
+            double m = noOfSum - 1;
+            double timeStep = maturity / m;
+            double mean = log(initPrice) + (interest - 0.5 * sigma * sigma) * maturity / 2;
+            double var = sigma * sigma * timeStep * m * (2 * m + 1) / (6 * (m + 1));
+            if(var <= 0)
+            {
+                double payoff = exp(mean) - strike;
+                return payoff > 0 ? payoff : 0;
+            }
+
+            double sd = sqrt(var);
+            double d2 = (mean - log(strike)) / sd;
+            double d1 = d2 + sd;
+            return exp(mean + 0.5 * var) * 0.5 * erfc(-d1 / sqrt(2.0)) -
+                   strike * 0.5 * erfc(-d2 / sqrt(2.0));
+        }
+
+    private:
+
+        double varY() const
+        {
+            return (sumYY - sumY * sumY / count) / (count - 1);
+        }
+
+        double varX() const
+        {
+            return count > 1 ? (sumXX - sumX * sumX / count) / (count - 1) : 0;
+        }
+
+        double covXY() const
+        {
+            return count > 1 ? (sumXY - sumX * sumY / count) / (count - 1) : 0;
+        }
+
+        double count;               /**< paths */
+        double sumY;                /**< sum of the payoffs */
+        double sumYY;               /**< sum of the squared payoffs */
+        double sumX;                /**< sum of the controls */
+        double sumXX;               /**< sum of the squared controls */
+        double sumXY;               /**< sum of the products */
+};
+
+}
+
+#endif // SDK_CONTROL_VARIATE_H_
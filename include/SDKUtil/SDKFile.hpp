@@ -35,6 +35,14 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #define GETCWD ::getcwd
 #endif // !_WIN32
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 
 /**
  * namespace appsdk
@@ -204,6 +212,168 @@ class SDKFile
         std::string     source_;    //!< source code of the CL program
 };
 
+/**
+ * class SDKMappedFile
+ * Maps a whole file read-only into the address space, so that large inputs
+ * are paged in on demand instead of being copied into a host buffer
+ */
+class SDKMappedFile
+{
+    public:
+        /**
+         * Default constructor
+         */
+        SDKMappedFile(): data_(NULL), size_(0)
+        {
+#ifdef _WIN32
+            file_ = INVALID_HANDLE_VALUE;
+            mapping_ = NULL;
+#endif
+        }
+
+        /**
+         * Destructor, unmaps the file
+         */
+        ~SDKMappedFile()
+        {
+            close();
+        }
+
+        /**
+         * Maps the file
+         * @param fileName name of the file
+         * @return true if success else false
+         */
+        bool open(const char* fileName)
+        {
+            close();
+#ifdef _WIN32
+            file_ = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if(file_ == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+            LARGE_INTEGER fileSize;
+            if(!GetFileSizeEx(file_, &fileSize))
+            {
+                close();
+                return false;
+            }
+            size_ = (size_t)fileSize.QuadPart;
+            if(size_ == 0)
+            {
+                return true;
+            }
+            mapping_ = CreateFileMapping(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+            if(mapping_ == NULL)
+            {
+                close();
+                return false;
+            }
+            data_ = (const unsigned char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+#else
+            int fd = ::open(fileName, O_RDONLY);
+            if(fd < 0)
+            {
+                return false;
+            }
+            struct stat fileStat;
+            if(fstat(fd, &fileStat) != 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            size_ = (size_t)fileStat.st_size;
+            if(size_ == 0)
+            {
+                ::close(fd);
+                return true;
+            }
+            void* ptr = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            // The mapping keeps its own reference to the file
+            ::close(fd);
+            data_ = (ptr == MAP_FAILED) ? NULL : (const unsigned char*)ptr;
+            if(data_ != NULL)
+            {
+                madvise(ptr, size_, MADV_SEQUENTIAL);
+            }
+#endif
+            if(data_ == NULL)
+            {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * Unmaps the file
+         */
+        void close()
+        {
+#ifdef _WIN32
+            if(data_ != NULL)
+            {
+                UnmapViewOfFile(data_);
+            }
+            if(mapping_ != NULL)
+            {
+                CloseHandle(mapping_);
+                mapping_ = NULL;
+            }
+            if(file_ != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(file_);
+                file_ = INVALID_HANDLE_VALUE;
+            }
+#else
+            if(data_ != NULL)
+            {
+                munmap((void*)data_, size_);
+            }
+#endif
+            data_ = NULL;
+            size_ = 0;
+        }
+
+        /**
+         * data
+         * Returns the first byte of the mapped file, NULL for an empty file
+         */
+        const unsigned char* data() const
+        {
+            return data_;
+        }
+
+        /**
+         * size
+         * Returns the size of the mapped file in bytes
+         */
+        size_t size() const
+        {
+            return size_;
+        }
+
+    private:
+        /**
+         * Disable copy constructor
+         */
+        SDKMappedFile(const SDKMappedFile&);
+
+        /**
+         * Disable operator=
+         */
+        SDKMappedFile& operator=(const SDKMappedFile&);
+
+        const unsigned char* data_; //!< first byte of the mapping
+        size_t          size_;      //!< size of the file in bytes
+#ifdef _WIN32
+        HANDLE          file_;      //!< file handle
+        HANDLE          mapping_;   //!< file mapping handle
+#endif
+};
+
 } // namespace appsdk
 
 #endif  // SDKFile_HPP_
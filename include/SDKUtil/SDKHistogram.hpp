@@ -0,0 +1,379 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+#ifndef SDK_HISTOGRAM_H_
+#define SDK_HISTOGRAM_H_
+
+#include <string.h>
+#include <emmintrin.h>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+/**
+ * Sub-histograms kept by every thread for tables of up to
+ * HISTOGRAM_COPY_LIMIT bins. Consecutive items go to different copies so
+ * runs of equal values do not serialize on one counter.
+ */
+#define HISTOGRAM_COPIES 4
+#define HISTOGRAM_COPY_LIMIT 1024
+
+/**
+ * namespace appsdk
+ */
+namespace appsdk
+{
+
+/**
+ * class SDKHistogram
+ * \brief Multi-threaded host histogram.
+ *
+ * Every thread counts its share of the input into private sub-histograms
+ * which are merged with SSE2 adds at the end, so threads never share a
+ * counter. Values outside the binned range fall into a discard bin past
+ * the end of the table and are not reported.
+ *
+ *     SDKHistogram hist;
+ *     hist.compute8(pixels, numPixels, bins);   // 256 bins
+ */
+class SDKHistogram
+{
+    public:
+
+        /**
+         * Constructor
+         * @param numThreads number of threads, 0 selects getNumCPUCores()
+         */
+        SDKHistogram(unsigned int numThreads = 0)
+            : scratch(NULL), scratchSize(0)
+        {
+            setThreads(numThreads);
+        }
+
+        /**
+         * Destructor
+         */
+        ~SDKHistogram()
+        {
+            freeScratch();
+        }
+
+        /**
+         * Sets the number of threads, 0 selects getNumCPUCores()
+         */
+        void setThreads(unsigned int numThreads)
+        {
+            threads = numThreads ? numThreads : getNumCPUCores();
+        }
+
+        /**
+         * Histogram of 8-bit values
+         * @param data input values
+         * @param count number of values
+         * @param bins 256 output counters
+         * @return true on success
+         */
+        bool compute8(const unsigned char* data, unsigned int count,
+                      unsigned int* bins)
+        {
+            Binner8 binner = { data };
+            return compute(binner, count, 256, bins);
+        }
+
+        /**
+         * Histogram of 16-bit values, each bin covers 1 << shift values
+         * @param bins (65536 >> shift) output counters
+         */
+        bool compute16(const unsigned short* data, unsigned int count,
+                       unsigned int shift, unsigned int* bins)
+        {
+            if(shift > 15)
+            {
+                return false;
+            }
+            Binner16 binner = { data, shift };
+            return compute(binner, count, 65536 >> shift, bins);
+        }
+
+        /**
+         * Histogram of integer bin indices, values >= numBins are ignored
+         * @param bins numBins output counters
+         */
+        bool computeUint(const unsigned int* data, unsigned int count,
+                         unsigned int numBins, unsigned int* bins)
+        {
+            BinnerUint binner = { data, numBins };
+            return compute(binner, count, numBins, bins);
+        }
+
+        /**
+         * Histogram of numBins equal bins over [minValue, maxValue].
+         * maxValue falls into the last bin, values outside the range and
+         * NaNs are ignored.
+         * @param bins numBins output counters
+         */
+        bool computeFloat(const float* data, unsigned int count,
+                          float minValue, float maxValue,
+                          unsigned int numBins, unsigned int* bins)
+        {
+            if(!(maxValue > minValue))
+            {
+                return false;
+            }
+            BinnerFloat binner = { data, minValue, maxValue,
+                                   numBins / (maxValue - minValue), numBins
+                                 };
+            return compute(binner, count, numBins, bins);
+        }
+
+        /**
+         * Per-channel histograms of interleaved RGBA pixels
+         * @param data numPixels * 4 bytes
+         * @param numPixels number of pixels
+         * @param bins 4 * 256 output counters, channel c at bins[c * 256]
+         * @return true on success
+         */
+        bool computeRGBA(const unsigned char* data, unsigned int numPixels,
+                         unsigned int* bins)
+        {
+            BinnerRGBA binner = { data };
+            return compute(binner, numPixels, 4 * 256, bins);
+        }
+
+    private:
+
+        //! 8-bit values are their own bin
+        struct Binner8
+        {
+            const unsigned char* data;
+            static const unsigned int ITEMS = 1;
+            void operator()(unsigned int* hist, unsigned int i) const
+            {
+                hist[data[i]]++;
+            }
+        };
+
+        //! 16-bit values are shifted down to the bin range
+        struct Binner16
+        {
+            const unsigned short* data;
+            unsigned int shift;
+            static const unsigned int ITEMS = 1;
+            void operator()(unsigned int* hist, unsigned int i) const
+            {
+                hist[data[i] >> shift]++;
+            }
+        };
+
+        //! out of range indices go to the discard bin
+        struct BinnerUint
+        {
+            const unsigned int* data;
+            unsigned int numBins;
+            static const unsigned int ITEMS = 1;
+            void operator()(unsigned int* hist, unsigned int i) const
+            {
+                unsigned int v = data[i];
+                hist[v < numBins ? v : numBins]++;
+            }
+        };
+
+        //! linear binning of a float range
+        struct BinnerFloat
+        {
+            const float* data;
+            float minValue;
+            float maxValue;
+            float scale;
+            unsigned int numBins;
+            static const unsigned int ITEMS = 1;
+            void operator()(unsigned int* hist, unsigned int i) const
+            {
+                float v = data[i];
+                unsigned int bin = numBins;
+                if(v >= minValue && v <= maxValue)
+                {
+                    bin = (unsigned int)((v - minValue) * scale);
+                    bin = bin < numBins ? bin : numBins - 1;
+                }
+                hist[bin]++;
+            }
+        };
+
+        //! four channels per pixel into four 256 bin tables
+        struct BinnerRGBA
+        {
+            const unsigned char* data;
+            static const unsigned int ITEMS = 4;
+            void operator()(unsigned int* hist, unsigned int i) const
+            {
+                const unsigned char* p = data + 4 * i;
+                hist[p[0]]++;
+                hist[256 + p[1]]++;
+                hist[512 + p[2]]++;
+                hist[768 + p[3]]++;
+            }
+        };
+
+        //! per-call state shared by the worker threads
+        template<typename Binner>
+        struct histogramArgs
+        {
+            Binner binner;
+            unsigned int* scratch;
+            unsigned int stride;        /**< counters per sub-histogram */
+            unsigned int copies;        /**< sub-histograms per thread */
+        };
+
+        /**
+         * Counts items [begin, end) into the sub-histograms of threadId
+         * and folds them into the first one.
+         */
+        template<typename Binner>
+        static void histogramRange(void* data, unsigned int begin,
+                                   unsigned int end, unsigned int threadId)
+        {
+            histogramArgs<Binner>* args = (histogramArgs<Binner>*)data;
+            const Binner binner = args->binner;
+            unsigned int stride = args->stride;
+            unsigned int* hist = args->scratch + threadId * stride * args->copies;
+            memset(hist, 0, sizeof(unsigned int) * stride * args->copies);
+
+            unsigned int i = begin;
+            if(args->copies == HISTOGRAM_COPIES)
+            {
+                unsigned int* hist1 = hist + stride;
+                unsigned int* hist2 = hist + 2 * stride;
+                unsigned int* hist3 = hist + 3 * stride;
+                for(; i + 4 <= end; i += 4)
+                {
+                    binner(hist, i);
+                    binner(hist1, i + 1);
+                    binner(hist2, i + 2);
+                    binner(hist3, i + 3);
+                }
+            }
+            for(; i < end; i++)
+            {
+                binner(hist, i);
+            }
+
+            for(unsigned int c = 1; c < args->copies; c++)
+            {
+                addCounters(hist, hist + c * stride, stride);
+            }
+        }
+
+        //! dst += src over count counters, both 16 byte aligned
+        static void addCounters(unsigned int* dst, const unsigned int* src,
+                                unsigned int count)
+        {
+            for(unsigned int b = 0; b < count; b += 4)
+            {
+                __m128i a = _mm_load_si128((const __m128i*)(dst + b));
+                __m128i s = _mm_load_si128((const __m128i*)(src + b));
+                _mm_store_si128((__m128i*)(dst + b), _mm_add_epi32(a, s));
+            }
+        }
+
+        template<typename Binner>
+        bool compute(const Binner& binner, unsigned int count,
+                     unsigned int numBins, unsigned int* bins)
+        {
+            if(numBins == 0 || bins == NULL)
+            {
+                return false;
+            }
+
+            // Room for the discard bin, rounded up to a cache line
+            unsigned int stride = (numBins + 1 + 15) & ~15u;
+            unsigned int copies = numBins <= HISTOGRAM_COPY_LIMIT ?
+                                  HISTOGRAM_COPIES : 1;
+
+            // Small inputs are not worth waking threads for
+            unsigned int numThreads = threads;
+            unsigned long long minItems =
+                (unsigned long long)stride * copies * 16 / Binner::ITEMS;
+            if((unsigned long long)count < minItems * numThreads)
+            {
+                numThreads = (unsigned int)(count / minItems);
+            }
+            numThreads = numThreads ? numThreads : 1;
+
+            size_t needed = (size_t)stride * copies * numThreads;
+            if(needed > scratchSize)
+            {
+                freeScratch();
+#if defined (_WIN32)
+                scratch = (unsigned int*)_aligned_malloc(needed * sizeof(unsigned int), 16);
+#else
+                scratch = (unsigned int*)memalign(16, needed * sizeof(unsigned int));
+#endif
+                if(scratch == NULL)
+                {
+                    scratchSize = 0;
+                    return false;
+                }
+                scratchSize = needed;
+            }
+
+            histogramArgs<Binner> args;
+            args.binner = binner;
+            args.scratch = scratch;
+            args.stride = stride;
+            args.copies = copies;
+
+            if(count == 0)
+            {
+                memset(scratch, 0, sizeof(unsigned int) * stride);
+            }
+            else
+            {
+                parallelFor(histogramRange<Binner>, (void*)&args, count, numThreads);
+            }
+
+            for(unsigned int t = 1; t < numThreads; t++)
+            {
+                addCounters(scratch, scratch + t * stride * copies, stride);
+            }
+            memcpy(bins, scratch, sizeof(unsigned int) * numBins);
+
+            return true;
+        }
+
+        void freeScratch()
+        {
+            if(scratch != NULL)
+            {
+#if defined (_WIN32)
+                ALIGNED_FREE(scratch);
+#else
+                FREE(scratch);
+#endif
+            }
+            scratchSize = 0;
+        }
+
+        unsigned int threads;       /**< worker threads */
+        unsigned int* scratch;      /**< private sub-histograms of all threads */
+        size_t scratchSize;         /**< counters allocated in scratch */
+
+        // Scratch is owned, disable copying
+        SDKHistogram(const SDKHistogram&);
+        SDKHistogram& operator=(const SDKHistogram&);
+};
+
+}
+
+#endif // SDK_HISTOGRAM_H_
@@ -0,0 +1,474 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef SDK_SEPARABLE_BOX_H_
+#define SDK_SEPARABLE_BOX_H_
+
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <emmintrin.h>
+#include <CL/cl.h>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+/**
+ * Columns of a strip of the vertical pass of SDKSeparableBox, a multiple of 4
+ */
+#define BOX_STRIP_PIXELS 64
+
+/**
+ * Widest window whose sums stay below 2^24, where float division is exact
+ */
+#define BOX_MAX_WINDOW 65535
+
+/**
+ * namespace appsdk
+ */
+namespace appsdk
+{
+
+/**
+ * class SDKSeparableBox
+ * \brief Multi-threaded host separable box filter of a uchar4 image with
+ * running sums, and a Gaussian blur of iterated box filters.
+ *
+ * Each pass slides its window by adding the incoming pixel and subtracting
+ * the outgoing one, so a pixel costs the same for any filter width. Rows
+ * are filtered in parallel. The vertical pass walks the rows of a strip of
+ * columns in order, keeping the running sums of the whole strip in SSE2
+ * registers and a small buffer, so it reads the image row by row.
+ *
+ *     SDKSeparableBox box;
+ *     box.filter(input, output, width, height, 9);
+ */
+class SDKSeparableBox
+{
+    public:
+
+        /**
+         * Constructor
+         * @param threads number of host threads, 0 uses every core
+         */
+        SDKSeparableBox(unsigned int threads = 0)
+            : numThreads(threads)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Box filters an image like the box_filter_horizontal and
+         * box_filter_vertical kernels: each pass sums the 2k + 1 pixels
+         * around a pixel, k = (filterWidth - 1) / 2, and divides by
+         * filterWidth with integer truncation into a uchar. Pixels closer
+         * than k to a border are 0 after the pass.
+         * @param input input pixels, width * height
+         * @param output output pixels, width * height
+         * @param filterWidth width of the filter, 1 to 65535
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int filter(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                   cl_uint height, cl_uint filterWidth)
+        {
+            if(input == NULL || output == NULL || width == 0 || height == 0)
+            {
+                error("SDKSeparableBox::filter() needs an input and an output image");
+                return SDK_FAILURE;
+            }
+            if(filterWidth == 0 || filterWidth > BOX_MAX_WINDOW)
+            {
+                error("SDKSeparableBox::filter() supports filter widths 1 to 65535");
+                return SDK_FAILURE;
+            }
+
+            return pass(input, output, width, height, (filterWidth - 1) / 2, filterWidth,
+                        false);
+        }
+
+        /**
+         * Approximates a Gaussian blur with passes box filters of odd
+         * widths whose variances add up to sigma^2. Borders repeat the edge
+         * pixels and averages are rounded to the nearest value. The cost
+         * per pixel does not depend on sigma.
+         * @param input input pixels, width * height
+         * @param output output pixels, width * height, may be input
+         * @param sigma standard deviation of the Gaussian in pixels
+         * @param passes number of box filters, 3 is within 3% of a Gaussian
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int blur(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                 cl_uint height, cl_float sigma, cl_uint passes = 3)
+        {
+            if(input == NULL || output == NULL || width == 0 || height == 0)
+            {
+                error("SDKSeparableBox::blur() needs an input and an output image");
+                return SDK_FAILURE;
+            }
+            if(!(sigma >= 0) || passes == 0)
+            {
+                error("SDKSeparableBox::blur() needs sigma >= 0 and at least one pass");
+                return SDK_FAILURE;
+            }
+
+            std::vector<cl_uint> widths;
+            gaussianBoxes(sigma, passes, widths);
+            if(widths.back() > BOX_MAX_WINDOW)
+            {
+                error("SDKSeparableBox::blur() sigma is too large");
+                return SDK_FAILURE;
+            }
+
+            const cl_uchar4 *source = input;
+            for(cl_uint i = 0; i < passes; i++)
+            {
+                int status = pass(source, output, width, height, (widths[i] - 1) / 2,
+                                  widths[i], true);
+                if(status != SDK_SUCCESS)
+                {
+                    return status;
+                }
+                source = output;
+            }
+            return SDK_SUCCESS;
+        }
+
+        /**
+         * Odd widths of the box filters of blur(), one per pass, whose
+         * variances (w^2 - 1) / 12 add up to about sigma^2
+         * @param sigma standard deviation of the Gaussian in pixels
+         * @param passes number of box filters
+         * @param widths widths of the passes, narrowest first
+         */
+        static void gaussianBoxes(cl_float sigma, cl_uint passes,
+                                  std::vector<cl_uint> &widths)
+        {
+            widths.assign(passes, 1);
+            if(sigma <= 0 || passes == 0)
+            {
+                return;
+            }
+
+            // Widths lower and upper around the ideal width, m passes of the lower
+            double variance = 12.0 * sigma * sigma;
+            double ideal = sqrt(variance / passes + 1.0);
+            int lower = (int)floor(ideal);
+            if(lower % 2 == 0)
+            {
+                lower--;
+            }
+            lower = std::max(lower, 1);
+            int upper = lower + 2;
+            double m = (variance - passes * lower * lower - 4.0 * passes * lower - 3.0 * passes)
+                       / (-4.0 * lower - 4.0);
+            int numLower = std::min(std::max((int)floor(m + 0.5), 0), (int)passes);
+
+            for(cl_uint i = 0; i < passes; i++)
+            {
+                widths[i] = (int)i < numLower ? lower : upper;
+            }
+        }
+
+    private:
+
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+        std::vector<cl_uchar4> temp;    /**< Output of the horizontal pass */
+
+        /**
+         * Arguments of the row and strip threads
+         */
+        struct rangeArgs
+        {
+            const cl_uchar4 *input;
+            cl_uchar4 *output;
+            cl_uint width;
+            cl_uint height;
+            cl_uint k;                  /**< Half width of the window */
+            cl_uint divisor;
+            bool clampEdges;            /**< Repeat edge pixels, else zero the apron */
+        };
+
+        /**
+         * Channels of a pixel as 32-bit lanes
+         */
+        static __m128i loadPixel(const cl_uchar4 *pixel)
+        {
+            int value;
+            memcpy(&value, pixel, sizeof(value));
+            const __m128i zero = _mm_setzero_si128();
+            return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero),
+                                      zero);
+        }
+
+        /**
+         * Channels of four pixels as four vectors of 32-bit channels
+         */
+        static void loadPixels(const cl_uchar4 *pixels, __m128i channels[4])
+        {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i bytes = _mm_loadu_si128((const __m128i*)pixels);
+            __m128i low = _mm_unpacklo_epi8(bytes, zero);
+            __m128i high = _mm_unpackhi_epi8(bytes, zero);
+            channels[0] = _mm_unpacklo_epi16(low, zero);
+            channels[1] = _mm_unpackhi_epi16(low, zero);
+            channels[2] = _mm_unpacklo_epi16(high, zero);
+            channels[3] = _mm_unpackhi_epi16(high, zero);
+        }
+
+        /**
+         * Truncated (sum + bias) / divisor of each channel
+         */
+        static __m128i average(__m128i sum, __m128i bias, __m128 divisor)
+        {
+            return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_add_epi32(sum, bias)),
+                                               divisor));
+        }
+
+        /**
+         * Saturates 32-bit channels into a pixel
+         */
+        static void storePixel(__m128i channels, cl_uchar4 *pixel)
+        {
+            __m128i packed = _mm_packs_epi32(channels, channels);
+            int value = _mm_cvtsi128_si32(_mm_packus_epi16(packed, packed));
+            memcpy(pixel, &value, sizeof(value));
+        }
+
+        /**
+         * Index i clamped to [0, n)
+         */
+        static cl_uint clampIndex(int i, cl_uint n)
+        {
+            return i < 0 ? 0 : ((cl_uint)i >= n ? n - 1 : (cl_uint)i);
+        }
+
+        /**
+         * Output range of a pass over n pixels, empty if the window does not fit
+         */
+        static bool passRange(cl_uint n, cl_uint k, bool clampEdges, cl_uint &first,
+                              cl_uint &last)
+        {
+            if(clampEdges)
+            {
+                first = 0;
+                last = n - 1;
+                return true;
+            }
+            if(2 * (cl_ulong)k + 1 > n)
+            {
+                return false;
+            }
+            first = k;
+            last = n - 1 - k;
+            return true;
+        }
+
+        /**
+         * Horizontal pass over the rows begin to end
+         */
+        static void rowThread(void *data, unsigned int begin, unsigned int end,
+                              unsigned int threadId)
+        {
+            rangeArgs *args = (rangeArgs*)data;
+            const cl_uint width = args->width;
+            const int k = (int)args->k;
+            const __m128i bias = _mm_set1_epi32(args->clampEdges ? args->divisor / 2 : 0);
+            const __m128 divisor = _mm_set1_ps((cl_float)args->divisor);
+
+            for(cl_uint y = begin; y < end; y++)
+            {
+                const cl_uchar4 *in = args->input + (size_t)y * width;
+                cl_uchar4 *out = args->output + (size_t)y * width;
+
+                cl_uint first, last;
+                if(!passRange(width, k, args->clampEdges, first, last))
+                {
+                    memset(out, 0, width * sizeof(cl_uchar4));
+                    continue;
+                }
+                memset(out, 0, first * sizeof(cl_uchar4));
+                memset(out + last + 1, 0, (width - 1 - last) * sizeof(cl_uchar4));
+
+                __m128i sum = _mm_setzero_si128();
+                for(int i = -k; i <= k; i++)
+                {
+                    sum = _mm_add_epi32(sum, loadPixel(&in[clampIndex((int)first + i, width)]));
+                }
+
+                // Slide the window, the edges are clamped only near the borders
+                for(cl_uint x = first; ; x++)
+                {
+                    storePixel(average(sum, bias, divisor), &out[x]);
+                    if(x == last)
+                    {
+                        break;
+                    }
+                    __m128i incoming = loadPixel(&in[clampIndex((int)x + k + 1, width)]);
+                    __m128i outgoing = loadPixel(&in[clampIndex((int)x - k, width)]);
+                    sum = _mm_sub_epi32(_mm_add_epi32(sum, incoming), outgoing);
+                }
+            }
+        }
+
+        /**
+         * Vertical pass over the strips of columns begin to end
+         */
+        static void stripThread(void *data, unsigned int begin, unsigned int end,
+                                unsigned int threadId)
+        {
+            rangeArgs *args = (rangeArgs*)data;
+            const cl_uint width = args->width;
+            const cl_uint height = args->height;
+            const int k = (int)args->k;
+            const __m128i bias = _mm_set1_epi32(args->clampEdges ? args->divisor / 2 : 0);
+            const __m128 divisor = _mm_set1_ps((cl_float)args->divisor);
+
+            // Running sums of the columns of a strip, 4 channels per column
+            __m128i sums[BOX_STRIP_PIXELS];
+
+            for(cl_uint s = begin; s < end; s++)
+            {
+                const cl_uint x0 = s * BOX_STRIP_PIXELS;
+                const cl_uint n = std::min((cl_uint)BOX_STRIP_PIXELS, width - x0);
+                const cl_uint vectorEnd = n & ~3u;
+                const cl_uchar4 *in = args->input + x0;
+                cl_uchar4 *out = args->output + x0;
+
+                cl_uint first, last;
+                if(!passRange(height, k, args->clampEdges, first, last))
+                {
+                    for(cl_uint y = 0; y < height; y++)
+                    {
+                        memset(out + (size_t)y * width, 0, n * sizeof(cl_uchar4));
+                    }
+                    continue;
+                }
+                for(cl_uint y = 0; y < first; y++)
+                {
+                    memset(out + (size_t)y * width, 0, n * sizeof(cl_uchar4));
+                }
+                for(cl_uint y = last + 1; y < height; y++)
+                {
+                    memset(out + (size_t)y * width, 0, n * sizeof(cl_uchar4));
+                }
+
+                for(cl_uint x = 0; x < n; x++)
+                {
+                    sums[x] = _mm_setzero_si128();
+                }
+                for(int i = -k; i <= k; i++)
+                {
+                    const cl_uchar4 *row = in + (size_t)clampIndex((int)first + i, height) * width;
+                    for(cl_uint x = 0; x < n; x++)
+                    {
+                        sums[x] = _mm_add_epi32(sums[x], loadPixel(&row[x]));
+                    }
+                }
+
+                // Walk down the rows, four columns per step
+                for(cl_uint y = first; ; y++)
+                {
+                    cl_uchar4 *outRow = out + (size_t)y * width;
+                    bool lastRow = (y == last);
+                    const cl_uchar4 *incoming =
+                        in + (size_t)clampIndex((int)y + k + 1, height) * width;
+                    const cl_uchar4 *outgoing =
+                        in + (size_t)clampIndex((int)y - k, height) * width;
+
+                    cl_uint x = 0;
+                    for(; x < vectorEnd; x += 4)
+                    {
+                        __m128i avg01 = _mm_packs_epi32(average(sums[x], bias, divisor),
+                                                        average(sums[x + 1], bias, divisor));
+                        __m128i avg23 = _mm_packs_epi32(average(sums[x + 2], bias, divisor),
+                                                        average(sums[x + 3], bias, divisor));
+                        _mm_storeu_si128((__m128i*)(outRow + x), _mm_packus_epi16(avg01, avg23));
+                        if(!lastRow)
+                        {
+                            __m128i add[4];
+                            __m128i sub[4];
+                            loadPixels(incoming + x, add);
+                            loadPixels(outgoing + x, sub);
+                            for(int i = 0; i < 4; i++)
+                            {
+                                sums[x + i] = _mm_sub_epi32(_mm_add_epi32(sums[x + i], add[i]),
+                                                            sub[i]);
+                            }
+                        }
+                    }
+                    for(; x < n; x++)
+                    {
+                        storePixel(average(sums[x], bias, divisor), &outRow[x]);
+                        if(!lastRow)
+                        {
+                            sums[x] = _mm_sub_epi32(_mm_add_epi32(sums[x], loadPixel(&incoming[x])),
+                                                    loadPixel(&outgoing[x]));
+                        }
+                    }
+                    if(lastRow)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+
+        /**
+         * One horizontal and one vertical running-sum pass
+         */
+        int pass(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                 cl_uint height, cl_uint k, cl_uint divisor, bool clampEdges)
+        {
+            temp.resize((size_t)width * height);
+
+            rangeArgs args;
+            args.input = input;
+            args.output = &temp[0];
+            args.width = width;
+            args.height = height;
+            args.k = k;
+            args.divisor = divisor;
+            args.clampEdges = clampEdges;
+
+            if(!parallelFor(rowThread, &args, height, numThreads))
+            {
+                error("SDKSeparableBox could not create its threads");
+                return SDK_FAILURE;
+            }
+
+            args.input = &temp[0];
+            args.output = output;
+            cl_uint numStrips = (width + BOX_STRIP_PIXELS - 1) / BOX_STRIP_PIXELS;
+            if(!parallelFor(stripThread, &args, numStrips, numThreads))
+            {
+                error("SDKSeparableBox could not create its threads");
+                return SDK_FAILURE;
+            }
+            return SDK_SUCCESS;
+        }
+};
+
+}
+
+#endif // SDK_SEPARABLE_BOX_H_
@@ -0,0 +1,542 @@
+/**********************************************************************
+Copyright 2013 Advanced Micro Devices, Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+   Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+********************************************************************/
+
+
+#ifndef SDK_SOBEL_H_
+#define SDK_SOBEL_H_
+
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <emmintrin.h>
+#include <CL/cl.h>
+#include "SDKUtil.hpp"
+#include "SDKThread.hpp"
+
+/**
+ * Rows of a block taken by one thread of SDKSobel
+ */
+#define SOBEL_BLOCK_ROWS 32
+
+/**
+ * Zeroed 16-bit lanes after a padded row of SDKSobel
+ */
+#define SOBEL_ROW_PADDING 16
+
+/**
+ * namespace appsdk
+ */
+namespace appsdk
+{
+
+/**
+ * class SDKSobel
+ * \brief Multi-threaded SSE2 host Sobel operator of a uchar4 image, as the
+ * reference of the Sobel samples and as an edge detection stage.
+ *
+ * The operator is separable: each row is smoothed [1 2 1] and
+ * differenced [1 0 -1] across the rows above and below in 16-bit lanes,
+ * then the other way along the row. Threads take blocks of rows and
+ * stream through them, so each input row is read by at most three
+ * output rows of the same block.
+ *
+ *     SDKSobel sobel;
+ *     sobel.filter(input, output, width, height, false);
+ */
+class SDKSobel
+{
+    public:
+
+        /**
+         * Directions of the gradient returned by detect(), y grows down
+         */
+        enum Orientation
+        {
+            GRADIENT_X = 0,             /**< Along x, a vertical edge */
+            GRADIENT_DIAGONAL = 1,      /**< Along +x +y or -x -y */
+            GRADIENT_Y = 2,             /**< Along y, a horizontal edge */
+            GRADIENT_ANTIDIAGONAL = 3   /**< Along +x -y or -x +y */
+        };
+
+        /**
+         * Constructor
+         * @param threads number of host threads, 0 uses every core
+         */
+        SDKSobel(unsigned int threads = 0)
+            : numThreads(threads)
+        {
+        }
+
+        /**
+         * Sets the number of host threads, 0 uses every core
+         */
+        void setThreads(unsigned int threads)
+        {
+            numThreads = threads;
+        }
+
+        /**
+         * Filters every channel: the output is the truncated half of the
+         * gradient length, and the border pixels are 0. This is the
+         * arithmetic of the buffer sobel_filter kernel. The image kernel
+         * reads clamped pixels at the border and uses native_sqrt and
+         * native_divide, so it only agrees inside the border, up to the
+         * rounding of the native functions.
+         * @param input input pixels, width * height
+         * @param output output pixels, width * height
+         * @param saturate clamp results above 255, else keep their low
+         *        byte like the conversion of the buffer kernel
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int filter(const cl_uchar4 *input, cl_uchar4 *output, cl_uint width,
+                   cl_uint height, bool saturate)
+        {
+            if(input == NULL || output == NULL || width == 0 || height == 0)
+            {
+                error("SDKSobel::filter() needs an input and an output image");
+                return SDK_FAILURE;
+            }
+
+            // The first and last rows and columns have no gradient
+            memset(output, 0, (size_t)width * sizeof(cl_uchar4));
+            memset(output + (size_t)(height - 1) * width, 0, (size_t)width * sizeof(cl_uchar4));
+            if(width < 3 || height < 3)
+            {
+                memset(output, 0, (size_t)width * height * sizeof(cl_uchar4));
+                return SDK_SUCCESS;
+            }
+
+            rangeArgs args;
+            args.input = input;
+            args.output = output;
+            args.saturate = saturate;
+            args.width = width;
+            args.height = height;
+
+            cl_uint numBlocks = (height + SOBEL_BLOCK_ROWS - 1) / SOBEL_BLOCK_ROWS;
+            if(!parallelFor(filterThread, &args, numBlocks, numThreads))
+            {
+                error("SDKSobel could not create its threads");
+                return SDK_FAILURE;
+            }
+            return SDK_SUCCESS;
+        }
+
+        /**
+         * Detects edges on the luma of channels 0 to 2 as R, G and B.
+         * Outputs that are NULL are skipped, the border pixels are 0.
+         * @param input input pixels, width * height
+         * @param magnitude rounded gradient lengths, 0 to 1443
+         * @param orientation Orientation of each gradient
+         * @param edges 255 where the magnitude is at least threshold and a
+         *        maximum along the gradient, else 0
+         * @param threshold smallest magnitude of an edge
+         * @return SDK_SUCCESS on success and SDK_FAILURE on failure
+         */
+        int detect(const cl_uchar4 *input, cl_uint width, cl_uint height,
+                   cl_ushort *magnitude, cl_uchar *orientation, cl_uchar *edges,
+                   cl_ushort threshold)
+        {
+            if(input == NULL || width == 0 || height == 0)
+            {
+                error("SDKSobel::detect() needs an input image");
+                return SDK_FAILURE;
+            }
+            if(width < 3 || height < 3)
+            {
+                size_t size = (size_t)width * height;
+                if(magnitude != NULL)
+                {
+                    memset(magnitude, 0, size * sizeof(cl_ushort));
+                }
+                if(orientation != NULL)
+                {
+                    memset(orientation, 0, size);
+                }
+                if(edges != NULL)
+                {
+                    memset(edges, 0, size);
+                }
+                return SDK_SUCCESS;
+            }
+
+            rangeArgs args;
+            args.input = input;
+            args.output = NULL;
+            args.magnitude = magnitude;
+            args.orientation = orientation;
+            args.edges = edges;
+            args.threshold = threshold;
+            args.saturate = false;
+            args.width = width;
+            args.height = height;
+
+            cl_uint numBlocks = (height + SOBEL_BLOCK_ROWS - 1) / SOBEL_BLOCK_ROWS;
+            if(!parallelFor(detectThread, &args, numBlocks, numThreads))
+            {
+                error("SDKSobel could not create its threads");
+                return SDK_FAILURE;
+            }
+            return SDK_SUCCESS;
+        }
+
+    private:
+
+        unsigned int numThreads;        /**< Host threads, 0 uses every core */
+
+        /**
+         * Arguments of the filter and detect threads
+         */
+        struct rangeArgs
+        {
+            const cl_uchar4 *input;
+            cl_uchar4 *output;
+            cl_ushort *magnitude;
+            cl_uchar *orientation;
+            cl_uchar *edges;
+            cl_ushort threshold;
+            bool saturate;
+            cl_uint width;
+            cl_uint height;
+        };
+
+        /**
+         * Half the gradient length of eight lanes, truncated like the kernel
+         */
+        static __m128i halfLength(__m128i gx, __m128i gy)
+        {
+            const __m128 half = _mm_set1_ps(0.5f);
+            __m128i lo = _mm_unpacklo_epi16(gx, gy);
+            __m128i hi = _mm_unpackhi_epi16(gx, gy);
+            __m128 lengthLo = _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lo, lo)));
+            __m128 lengthHi = _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(hi, hi)));
+            return _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(lengthLo, half)),
+                                   _mm_cvttps_epi32(_mm_mul_ps(lengthHi, half)));
+        }
+
+        /**
+         * Sums s = up + 2 mid + down and differences d = up - down of n bytes
+         */
+        static void verticalPass(const cl_uchar *up, const cl_uchar *mid,
+                                 const cl_uchar *down, cl_uint n, cl_short *s,
+                                 cl_short *d)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            cl_uint i = 0;
+            for(; i + 16 <= n; i += 16)
+            {
+                __m128i u = _mm_loadu_si128((const __m128i*)(up + i));
+                __m128i m = _mm_loadu_si128((const __m128i*)(mid + i));
+                __m128i w = _mm_loadu_si128((const __m128i*)(down + i));
+
+                __m128i u0 = _mm_unpacklo_epi8(u, zero), u1 = _mm_unpackhi_epi8(u, zero);
+                __m128i m0 = _mm_unpacklo_epi8(m, zero), m1 = _mm_unpackhi_epi8(m, zero);
+                __m128i w0 = _mm_unpacklo_epi8(w, zero), w1 = _mm_unpackhi_epi8(w, zero);
+
+                _mm_storeu_si128((__m128i*)(s + i),
+                                 _mm_add_epi16(_mm_add_epi16(u0, w0), _mm_add_epi16(m0, m0)));
+                _mm_storeu_si128((__m128i*)(s + i + 8),
+                                 _mm_add_epi16(_mm_add_epi16(u1, w1), _mm_add_epi16(m1, m1)));
+                _mm_storeu_si128((__m128i*)(d + i), _mm_sub_epi16(u0, w0));
+                _mm_storeu_si128((__m128i*)(d + i + 8), _mm_sub_epi16(u1, w1));
+            }
+            for(; i < n; i++)
+            {
+                s[i] = (cl_short)(up[i] + 2 * mid[i] + down[i]);
+                d[i] = (cl_short)(up[i] - down[i]);
+            }
+        }
+
+        /**
+         * Filters the rows of blocks begin to end
+         */
+        static void filterThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId)
+        {
+            rangeArgs *args = (rangeArgs*)data;
+            const cl_uint width = args->width;
+            const cl_uint height = args->height;
+            const cl_uint n = 4 * width;
+            const __m128i lowByte = _mm_set1_epi16(0xff);
+
+            std::vector<cl_short> s(n + SOBEL_ROW_PADDING, 0);
+            std::vector<cl_short> d(n + SOBEL_ROW_PADDING, 0);
+            std::vector<cl_uchar> row(n + SOBEL_ROW_PADDING);
+
+            // begin and end count blocks of SOBEL_BLOCK_ROWS rows
+            for(cl_uint b = begin; b < end; b++)
+            {
+                cl_uint y0 = std::max(b * SOBEL_BLOCK_ROWS, 1u);
+                cl_uint y1 = std::min((b + 1) * SOBEL_BLOCK_ROWS, height - 1);
+                for(cl_uint y = y0; y < y1; y++)
+                {
+                    const cl_uchar *mid = (const cl_uchar*)(args->input + (size_t)y * width);
+                    verticalPass(mid - n, mid, mid + n, n, &s[0], &d[0]);
+
+                    // Lanes of a channel are four apart, gx = [1 2 1] d and gy = [1 0 -1] s
+                    for(cl_uint i = 4; i < n - 4; i += 8)
+                    {
+                        __m128i dl = _mm_loadu_si128((const __m128i*)&d[i - 4]);
+                        __m128i dc = _mm_loadu_si128((const __m128i*)&d[i]);
+                        __m128i dr = _mm_loadu_si128((const __m128i*)&d[i + 4]);
+                        __m128i sl = _mm_loadu_si128((const __m128i*)&s[i - 4]);
+                        __m128i sr = _mm_loadu_si128((const __m128i*)&s[i + 4]);
+
+                        __m128i gx = _mm_add_epi16(_mm_add_epi16(dl, dr), _mm_add_epi16(dc, dc));
+                        __m128i gy = _mm_sub_epi16(sl, sr);
+                        __m128i value = halfLength(gx, gy);
+                        if(!args->saturate)
+                        {
+                            value = _mm_and_si128(value, lowByte);
+                        }
+                        _mm_storel_epi64((__m128i*)&row[i], _mm_packus_epi16(value, value));
+                    }
+
+                    cl_uchar *out = (cl_uchar*)(args->output + (size_t)y * width);
+                    memset(out, 0, 4);
+                    memcpy(out + 4, &row[4], n - 8);
+                    memset(out + n - 4, 0, 4);
+                }
+            }
+        }
+
+        /**
+         * BT.601 luma of a row in 8.8 fixed point
+         */
+        static void lumaRow(const cl_uchar4 *input, cl_uint width, cl_uchar *luma)
+        {
+            for(cl_uint x = 0; x < width; x++)
+            {
+                const cl_uchar *p = input[x].s;
+                luma[x] = (cl_uchar)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+            }
+        }
+
+        /**
+         * Rounded gradient lengths and orientations of row y from the luma
+         * rows above, at and below it. Columns 0 and width - 1 are 0.
+         */
+        static void gradientRow(const cl_uchar *up, const cl_uchar *mid,
+                                const cl_uchar *down, cl_uint width, cl_short *s,
+                                cl_short *d, cl_ushort *magnitude, cl_uchar *orientation)
+        {
+            verticalPass(up, mid, down, width, s, d);
+
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i one = _mm_set1_epi32(1);
+            const __m128i two = _mm_set1_epi32(2);
+            const __m128i three = _mm_set1_epi32(3);
+            const __m128 tan22 = _mm_set1_ps(0.41421356f);
+            const __m128 tan67 = _mm_set1_ps(2.41421356f);
+            const __m128 sign = _mm_set1_ps(-0.0f);
+
+            for(cl_uint x = 1; x < width - 1; x += 8)
+            {
+                // gx = right - left smoothed down the column, gy = down - up along the row
+                __m128i sl = _mm_loadu_si128((const __m128i*)&s[x - 1]);
+                __m128i sr = _mm_loadu_si128((const __m128i*)&s[x + 1]);
+                __m128i dl = _mm_loadu_si128((const __m128i*)&d[x - 1]);
+                __m128i dc = _mm_loadu_si128((const __m128i*)&d[x]);
+                __m128i dr = _mm_loadu_si128((const __m128i*)&d[x + 1]);
+                __m128i gx = _mm_sub_epi16(sr, sl);
+                __m128i gy = _mm_sub_epi16(zero, _mm_add_epi16(_mm_add_epi16(dl, dr),
+                                           _mm_add_epi16(dc, dc)));
+
+                __m128i lo = _mm_unpacklo_epi16(gx, gy);
+                __m128i hi = _mm_unpackhi_epi16(gx, gy);
+                __m128 lengthLo = _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lo, lo)));
+                __m128 lengthHi = _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(hi, hi)));
+                _mm_storeu_si128((__m128i*)&magnitude[x],
+                                 _mm_packs_epi32(_mm_cvtps_epi32(lengthLo),
+                                                 _mm_cvtps_epi32(lengthHi)));
+
+                if(orientation == NULL)
+                {
+                    continue;
+                }
+
+                __m128i direction[2];
+                for(int half = 0; half < 2; half++)
+                {
+                    __m128i gx32 = half ? _mm_unpackhi_epi16(gx, gx) : _mm_unpacklo_epi16(gx, gx);
+                    __m128i gy32 = half ? _mm_unpackhi_epi16(gy, gy) : _mm_unpacklo_epi16(gy, gy);
+                    __m128 fx = _mm_cvtepi32_ps(_mm_srai_epi32(gx32, 16));
+                    __m128 fy = _mm_cvtepi32_ps(_mm_srai_epi32(gy32, 16));
+                    __m128 ax = _mm_andnot_ps(sign, fx);
+                    __m128 ay = _mm_andnot_ps(sign, fy);
+
+                    __m128i alongX = _mm_castps_si128(_mm_cmple_ps(ay, _mm_mul_ps(ax, tan22)));
+                    __m128i alongY = _mm_castps_si128(_mm_cmpgt_ps(ay, _mm_mul_ps(ax, tan67)));
+                    __m128i sameSign = _mm_castps_si128(_mm_cmpgt_ps(_mm_mul_ps(fx, fy),
+                                                        _mm_setzero_ps()));
+                    __m128i diagonal = _mm_or_si128(_mm_and_si128(sameSign, one),
+                                                    _mm_andnot_si128(sameSign, three));
+                    diagonal = _mm_andnot_si128(_mm_or_si128(alongX, alongY), diagonal);
+                    direction[half] = _mm_or_si128(_mm_and_si128(alongY, two), diagonal);
+                }
+                __m128i packed = _mm_packs_epi32(direction[0], direction[1]);
+                _mm_storel_epi64((__m128i*)&orientation[x], _mm_packus_epi16(packed, packed));
+            }
+
+            magnitude[0] = magnitude[width - 1] = 0;
+            if(orientation != NULL)
+            {
+                orientation[0] = orientation[width - 1] = 0;
+            }
+        }
+
+        /**
+         * Keeps the pixels of row mid that are at least threshold and a
+         * maximum along their gradient, ties go to the first neighbour
+         */
+        static void suppressRow(const cl_ushort *up, const cl_ushort *mid,
+                                const cl_ushort *down, const cl_uchar *orientation,
+                                cl_uint width, cl_ushort threshold, cl_uchar *edges)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i limit = _mm_set1_epi16((short)(std::min(threshold,
+                                                                  (cl_ushort)0x7fff) - 1));
+
+            for(cl_uint x = 1; x < width - 1; x += 8)
+            {
+                __m128i m = _mm_loadu_si128((const __m128i*)&mid[x]);
+                __m128i dir = _mm_unpacklo_epi8(
+                                  _mm_loadl_epi64((const __m128i*)&orientation[x]), zero);
+
+                __m128i isX = _mm_cmpeq_epi16(dir, _mm_set1_epi16(GRADIENT_X));
+                __m128i isDiagonal = _mm_cmpeq_epi16(dir, _mm_set1_epi16(GRADIENT_DIAGONAL));
+                __m128i isY = _mm_cmpeq_epi16(dir, _mm_set1_epi16(GRADIENT_Y));
+                __m128i isAnti = _mm_cmpeq_epi16(dir, _mm_set1_epi16(GRADIENT_ANTIDIAGONAL));
+
+                // Neighbours before (a) and after (b) the pixel along each direction
+                __m128i a = _mm_or_si128(
+                                _mm_or_si128(
+                                    _mm_and_si128(isX, _mm_loadu_si128((const __m128i*)&mid[x - 1])),
+                                    _mm_and_si128(isDiagonal, _mm_loadu_si128((const __m128i*)&up[x - 1]))),
+                                _mm_or_si128(
+                                    _mm_and_si128(isY, _mm_loadu_si128((const __m128i*)&up[x])),
+                                    _mm_and_si128(isAnti, _mm_loadu_si128((const __m128i*)&up[x + 1]))));
+                __m128i b = _mm_or_si128(
+                                _mm_or_si128(
+                                    _mm_and_si128(isX, _mm_loadu_si128((const __m128i*)&mid[x + 1])),
+                                    _mm_and_si128(isDiagonal, _mm_loadu_si128((const __m128i*)&down[x + 1]))),
+                                _mm_or_si128(
+                                    _mm_and_si128(isY, _mm_loadu_si128((const __m128i*)&down[x])),
+                                    _mm_and_si128(isAnti, _mm_loadu_si128((const __m128i*)&down[x - 1]))));
+
+                // Lengths are below 1444, so signed compares are safe
+                __m128i keep = _mm_and_si128(_mm_cmpgt_epi16(m, a),
+                                             _mm_andnot_si128(_mm_cmpgt_epi16(b, m),
+                                                     _mm_cmpgt_epi16(m, limit)));
+                _mm_storel_epi64((__m128i*)&edges[x], _mm_packs_epi16(keep, keep));
+            }
+            edges[0] = edges[width - 1] = 0;
+        }
+
+        /**
+         * Detects the edges of the rows of blocks begin to end
+         */
+        static void detectThread(void *data, unsigned int begin, unsigned int end,
+                                 unsigned int threadId)
+        {
+            rangeArgs *args = (rangeArgs*)data;
+            const cl_uint width = args->width;
+            const cl_uint height = args->height;
+            const size_t stride = width + SOBEL_ROW_PADDING;
+            const bool needOrientation = args->orientation != NULL || args->edges != NULL;
+
+            // Rings of three rows, row y lives in slot y % 3
+            std::vector<cl_uchar> luma(3 * stride, 0);
+            std::vector<cl_ushort> magnitude(3 * stride, 0);
+            std::vector<cl_uchar> orientation(3 * stride, 0);
+            std::vector<cl_short> s(stride, 0);
+            std::vector<cl_short> d(stride, 0);
+            std::vector<cl_uchar> edges(stride, 0);
+
+            // begin and end count blocks of SOBEL_BLOCK_ROWS rows
+            for(cl_uint b = begin; b < end; b++)
+            {
+                const cl_uint y0 = b * SOBEL_BLOCK_ROWS;
+                const cl_uint y1 = std::min(y0 + SOBEL_BLOCK_ROWS, height);
+
+                // Suppression of rows y0..y1 needs the gradients of a row either side
+                const cl_uint first = y0 > 0 ? y0 - 1 : 0;
+                const cl_uint last = std::min(y1 + 1, height);
+                cl_uint lumaEnd = first > 0 ? first - 1 : 0;
+
+                for(cl_uint y = first; y < last; y++)
+                {
+                    cl_ushort *mag = &magnitude[(y % 3) * stride];
+                    cl_uchar *dir = &orientation[(y % 3) * stride];
+                    if(y == 0 || y == height - 1)
+                    {
+                        memset(mag, 0, width * sizeof(cl_ushort));
+                        memset(dir, 0, width);
+                    }
+                    else
+                    {
+                        for(; lumaEnd <= y + 1; lumaEnd++)
+                        {
+                            lumaRow(args->input + (size_t)lumaEnd * width, width,
+                                    &luma[(lumaEnd % 3) * stride]);
+                        }
+                        gradientRow(&luma[((y - 1) % 3) * stride], &luma[(y % 3) * stride],
+                                    &luma[((y + 1) % 3) * stride], width, &s[0], &d[0], mag,
+                                    needOrientation ? dir : NULL);
+                    }
+
+                    if(y >= y0 && y < y1)
+                    {
+                        if(args->magnitude != NULL)
+                        {
+                            memcpy(args->magnitude + (size_t)y * width, mag,
+                                   width * sizeof(cl_ushort));
+                        }
+                        if(args->orientation != NULL)
+                        {
+                            memcpy(args->orientation + (size_t)y * width, dir, width);
+                        }
+                    }
+
+                    // Row y - 1 has both of its neighbours now
+                    cl_uint r = y - 1;
+                    if(args->edges == NULL || y == 0 || r < y0 || r >= y1)
+                    {
+                        continue;
+                    }
+                    if(r == 0)
+                    {
+                        memset(args->edges, 0, width);
+                        continue;
+                    }
+                    suppressRow(&magnitude[((r - 1) % 3) * stride], &magnitude[(r % 3) * stride],
+                                mag, &orientation[(r % 3) * stride], width, args->threshold,
+                                &edges[0]);
+                    memcpy(args->edges + (size_t)r * width, &edges[0], width);
+                }
+
+                // The last row of the image has no row below it
+                if(args->edges != NULL && y1 == height)
+                {
+                    memset(args->edges + (size_t)(height - 1) * width, 0, width);
+                }
+            }
+        }
+};
+
+}
+
+#endif // SDK_SOBEL_H_
@@ -14,7 +14,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ********************************************************************/
 #ifndef _SDK_THREAD_H_
-#define _SDK_THREAD_H
+#define _SDK_THREAD_H_
 
 #ifdef _WIN32
 #ifndef _WIN32_WINNT
@@ -36,6 +36,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #else
 #include "pthread.h"
+#include <unistd.h>
 #define EXPORT
 #endif
 
@@ -239,7 +240,7 @@ class EXPORT CondVar
 
 };
 #ifdef _WIN32
-unsigned _stdcall win32ThreadFunc(void* args);
+inline unsigned _stdcall win32ThreadFunc(void* args);
 #endif
 /**
  * \class Thread
@@ -370,7 +371,7 @@ class EXPORT SDKThread
 #ifdef _WIN32
 //! Windows thread callback - invokes the callback set by
 //! the application in Thread constructor
-unsigned _stdcall win32ThreadFunc(void* args)
+inline unsigned _stdcall win32ThreadFunc(void* args)
 {
     argsToThreadFunc* ptr = (argsToThreadFunc*) args;
     SDKThread *obj = (SDKThread *) ptr->data;
@@ -758,11 +759,11 @@ class CondVarImpl
 
 };
 
-        CondVar::CondVar()
+        inline CondVar::CondVar()
         {
             _condVarImpl = new CondVarImpl();
         }
-        CondVar::~CondVar()
+        inline CondVar::~CondVar()
         {
             delete _condVarImpl;
         }
@@ -770,7 +771,7 @@ class CondVarImpl
         /**
          * Initialize condition variable
          */
-        bool CondVar::init(unsigned int maxThreadCount)
+        inline bool CondVar::init(unsigned int maxThreadCount)
         {
             return _condVarImpl->init(maxThreadCount);
         }
@@ -778,7 +779,7 @@ class CondVarImpl
         /**
          * Destroy condition variable
          */
-        bool CondVar::destroy()
+        inline bool CondVar::destroy()
         {
             return _condVarImpl->destroy();
         }
@@ -786,11 +787,111 @@ class CondVarImpl
         /**
          * Synchronize threads
          */
-        void CondVar::syncThreads()
+        inline void CondVar::syncThreads()
         {
             _condVarImpl->syncThreads();
         }
 
+/**
+ * getNumCPUCores
+ * Returns the number of online CPU cores (at least 1)
+ */
+inline unsigned int getNumCPUCores()
+{
+#ifdef _WIN32
+    SYSTEM_INFO sysInfo;
+    GetSystemInfo(&sysInfo);
+    unsigned int cores = (unsigned int)sysInfo.dwNumberOfProcessors;
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return cores > 0 ? (unsigned int)cores : 1;
+}
+
+/**
+ * Entry point for a range of work handed out by parallelFor.
+ * Processes the items [begin, end) on behalf of thread threadId.
+ */
+typedef void (*rangeFunc)(void* data, unsigned int begin, unsigned int end,
+                          unsigned int threadId);
+
+//! per-thread arguments of parallelFor
+typedef struct __argsToRangeFunc
+{
+    rangeFunc func;
+    void* data;
+    unsigned int begin;
+    unsigned int end;
+    unsigned int threadId;
+
+} argsToRangeFunc;
+
+//! SDKThread entry point used by parallelFor
+inline void* rangeThreadFunc(void* args)
+{
+    argsToRangeFunc* ptr = (argsToRangeFunc*) args;
+    ptr->func(ptr->data, ptr->begin, ptr->end, ptr->threadId);
+    return NULL;
+}
+
+/**
+ * parallelFor
+ * Splits [0, count) into numThreads contiguous ranges and runs func on
+ * each of them. The last range is processed by the calling thread.
+ * The split depends only on count and numThreads, so callers that keep
+ * per-thread state indexed by threadId get reproducible results.
+ * @param func function processing one range
+ * @param data user data passed to func
+ * @param count number of items
+ * @param numThreads number of threads, 0 selects getNumCPUCores()
+ * @return true on success, false if a thread could not be created
+ */
+inline bool parallelFor(rangeFunc func, void* data, unsigned int count,
+                        unsigned int numThreads = 0)
+{
+    if(numThreads == 0)
+    {
+        numThreads = getNumCPUCores();
+    }
+    if(numThreads > count)
+    {
+        numThreads = count > 0 ? count : 1;
+    }
+
+    argsToRangeFunc* args = new argsToRangeFunc[numThreads];
+    SDKThread* threads = new SDKThread[numThreads];
+    bool created = true;
+
+    for(unsigned int i = 0; i < numThreads; i++)
+    {
+        args[i].func = func;
+        args[i].data = data;
+        args[i].begin = (unsigned int)(((unsigned long long)count * i) / numThreads);
+        args[i].end = (unsigned int)(((unsigned long long)count * (i + 1)) / numThreads);
+        args[i].threadId = i;
+    }
+
+    for(unsigned int i = 0; i + 1 < numThreads; i++)
+    {
+        if(!threads[i].create(rangeThreadFunc, (void*)&args[i]))
+        {
+            // Fall back to running the range on the calling thread
+            rangeThreadFunc((void*)&args[i]);
+            created = false;
+        }
+    }
+    rangeThreadFunc((void*)&args[numThreads - 1]);
+
+    for(unsigned int i = 0; i + 1 < numThreads; i++)
+    {
+        threads[i].join();
+    }
+
+    delete []threads;
+    delete []args;
+    return created;
+}
+
 
 }
 